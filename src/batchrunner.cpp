@@ -0,0 +1,331 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <iostream>
+
+#include "batchrunner.h"
+#include "circuitwidget.h"
+#include "circuit.h"
+#include "mcucomponent.h"
+#include "baseprocessor.h"
+#include "simulator.h"
+#include "probe.h"
+
+BatchUart::BatchUart( QString fileName, QObject* parent )
+         : QObject( parent )
+{
+    m_file.setFileName( fileName );
+}
+BatchUart::~BatchUart(){}
+
+bool BatchUart::open()
+{
+    return m_file.open( QFile::WriteOnly | QFile::Truncate );
+}
+
+void BatchUart::uartOut( uint32_t value )
+{
+    m_file.putChar( (char)value );
+}
+
+BatchRunner::BatchRunner( QObject* parent )
+           : QObject( parent )
+{
+    m_simTime     = 1;
+    m_sampleSteps = 1000;
+    m_outDir      = ".";
+    m_wave        = false;
+    m_error       = false;
+}
+BatchRunner::~BatchRunner(){}
+
+bool BatchRunner::isBatch( int argc, char* argv[] )
+{
+    for( int i=1; i<argc; i++ )
+    {
+        QString arg = argv[i];
+        if( (arg == "--batch") || (arg == "-b") ) return true;
+    }
+    return false;
+}
+
+bool BatchRunner::parseArgs( QStringList args )
+{
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addPositionalArgument( "circuit", "Circuit file (.simu)." );
+
+    QCommandLineOption batchOption( QStringList() << "b" << "batch", "Run without GUI." );
+    QCommandLineOption firmOption(  QStringList() << "f" << "firmware", "Firmware to load in Mcu, use mcuId=file with several Mcus.", "file" );
+    QCommandLineOption timeOption(  QStringList() << "t" << "time", "Seconds to simulate (default 1).", "seconds", "1" );
+    QCommandLineOption sampOption(  QStringList() << "s" << "sample", "Probe sample period in us (default 1000).", "us", "1000" );
+    QCommandLineOption outOption(   QStringList() << "o" << "output", "Output folder (default current).", "folder", "." );
+    QCommandLineOption waveOption(  QStringList() << "w" << "wave", "Record Probes and Mcu pins to waves.vcd and waves.wvb." );
+    QCommandLineOption loadOption(  "load-state", "Start from simulation state saved in file.", "file" );
+    QCommandLineOption saveOption(  "save-state", "Save simulation state to file at the end.", "file" );
+
+    parser.addOption( batchOption );
+    parser.addOption( firmOption );
+    parser.addOption( timeOption );
+    parser.addOption( sampOption );
+    parser.addOption( outOption );
+    parser.addOption( waveOption );
+    parser.addOption( loadOption );
+    parser.addOption( saveOption );
+
+    if( !parser.parse( args ) )
+    {
+        error( parser.errorText() );
+        return false;
+    }
+    if( parser.positionalArguments().size() != 1 )
+    {
+        error( "One circuit file expected\n"+parser.helpText() );
+        return false;
+    }
+    m_circFile = QFileInfo( parser.positionalArguments().first() ).absoluteFilePath();
+
+    foreach( QString firm, parser.values( firmOption ) )
+    {
+        QString mcuId = "";
+        if( firm.contains( "=" ) )
+        {
+            mcuId = firm.section( "=", 0, 0 );
+            firm  = firm.section( "=", 1 );
+        }
+        firm = QFileInfo( firm ).absoluteFilePath();
+        m_firmware.append( mcuId.isEmpty() ? firm : mcuId+"="+firm );
+    }
+
+    bool ok = true;
+    m_simTime = parser.value( timeOption ).toDouble( &ok );
+    if( !ok || (m_simTime <= 0) )
+    {
+        error( "Wrong simulation time: "+parser.value( timeOption ) );
+        return false;
+    }
+    m_sampleSteps = parser.value( sampOption ).toInt( &ok );
+    if( !ok || (m_sampleSteps < 1) )
+    {
+        error( "Wrong sample period: "+parser.value( sampOption ) );
+        return false;
+    }
+    m_outDir = parser.value( outOption );
+    m_wave   = parser.isSet( waveOption );
+
+    if( parser.isSet( loadOption ) ) m_loadState = QFileInfo( parser.value( loadOption ) ).absoluteFilePath();
+    if( parser.isSet( saveOption ) ) m_saveState = QFileInfo( parser.value( saveOption ) ).absoluteFilePath();
+    return true;
+}
+
+int BatchRunner::run( QStringList args )
+{
+    if( !parseArgs( args ) ) return 1;
+
+    // Modal dialogs would block the run: close them and report error
+    connect( &m_dialogTimer, SIGNAL( timeout() ), this, SLOT( closeDialogs() ) );
+    m_dialogTimer.start( 100 );
+
+    if( !m_circFile.endsWith(".simu") || !QFileInfo::exists( m_circFile ) )
+    {
+        error( "Circuit file not found: "+m_circFile );
+        return 1;
+    }
+    CircuitWidget::self()->loadCirc( m_circFile );
+
+    QList<McuComponent*> mcuList;
+    foreach( Component* comp, *(Circuit::self()->compList()) )
+    {
+        McuComponent* mcu = qobject_cast<McuComponent*>( comp );
+        if( mcu ) mcuList.append( mcu );
+    }
+    foreach( QString firm, m_firmware )
+    {
+        McuComponent* mcu = 0l;
+        if( !firm.contains( "=" ) )                   // Only with one Mcu
+        {
+            if( mcuList.size() > 1 )
+            {
+                error( "Several Mcus in circuit, use mcuId=file: "+firm );
+                return 1;
+            }
+            if( mcuList.size() == 1 ) mcu = mcuList.first();
+        }
+        else                                          // mcuId=file
+        {
+            QString mcuId = firm.section( "=", 0, 0 );
+            firm = firm.section( "=", 1 );
+
+            foreach( McuComponent* m, mcuList ) 
+                if( m->itemID() == mcuId ) { mcu = m; break; }
+        }
+        if( !mcu )
+        {
+            error( "No Mcu in circuit to load firmware: "+firm );
+            return 1;
+        }
+        mcu->load( firm );
+
+        if( !mcu->processor()->getLoadStatus() )
+            error( "Could not load firmware: "+firm );
+    }
+    if( m_error || !openOutput() || !openUarts( mcuList ) ) return 1;
+
+    if( m_wave )
+    {
+        foreach( Probe* probe, m_probes ) probe->setRecord( true );
+        foreach( McuComponent* mcu, mcuList ) mcu->setRecordPins( true );
+    }
+    Simulator* sim = Simulator::self();
+    sim->setBatchMode( true );
+    sim->startSim();
+
+    if( !sim->isRunning() ) error( "Failed to start simulation" );
+
+    if( !m_loadState.isEmpty() && !sim->loadStateFile( m_loadState ) )
+    {
+        error( "State doesn't match circuit or firmware: "+m_loadState );
+        sim->stopSim();
+        sim->setBatchMode( false );
+        return 1;
+    }
+
+    if( m_wave && !sim->startRecording( QDir( m_outDir ).filePath( "waves.vcd" ) ) )
+        error( "Could not record waveforms to: "+m_outDir );
+
+    QElapsedTimer timer;
+    timer.start();
+
+    uint64_t endStep = sim->step()+m_simTime*1e6;    // 1 step = 1 us
+
+    while( sim->isRunning() && (sim->step() < endStep) )
+    {
+        uint64_t steps = endStep-sim->step();
+        if( steps > (uint64_t)m_sampleSteps ) steps = m_sampleSteps;
+
+        sim->runSteps( steps );
+
+        if( sim->hasError() )
+        {
+            error( "Failed to solve Matrix" );
+            break;
+        }
+        sampleProbes();
+    }
+    std::cout << "\nBatch Simulated:  " << sim->step()/1e6 << " s"
+              << "\nBatch Real Time:  " << timer.elapsed()/1e3 << " s"
+              << std::endl;
+
+    if( !m_saveState.isEmpty() && !sim->saveStateFile( m_saveState ) )
+        error( "Could not save state to: "+m_saveState );
+
+    sim->stopSim();                          // Also stops recording
+    sim->setBatchMode( false );
+
+    m_probeOut.flush();
+    m_probeFile.close();
+    foreach( BatchUart* uart, m_uarts ) uart->close();
+
+    return m_error ? 1 : 0;
+}
+
+bool BatchRunner::openOutput()
+{
+    QDir outDir( m_outDir );
+    if( !outDir.exists() && !outDir.mkpath(".") )
+    {
+        error( "Can not create folder: "+m_outDir );
+        return false;
+    }
+    m_probeFile.setFileName( outDir.filePath( "probes.csv" ) );
+
+    if( !m_probeFile.open( QFile::WriteOnly | QFile::Text | QFile::Truncate ) )
+    {
+        error( "Can not write to folder: "+m_outDir );
+        return false;
+    }
+    m_probeOut.setDevice( &m_probeFile );
+    m_probeOut << "time";
+
+    foreach( Component* comp, *(Circuit::self()->compList()) )
+    {
+        if( comp->itemType() != "Probe" ) continue;
+
+        m_probes.append( static_cast<Probe*>( comp ) );
+        m_probeOut << "," << comp->itemID();
+    }
+    m_probeOut << "\n";
+    return true;
+}
+
+bool BatchRunner::openUarts( QList<McuComponent*> mcuList )
+{
+    QDir outDir( m_outDir );
+
+    foreach( McuComponent* mcu, mcuList ) // Each Mcu writes to uart_<mcuId>.txt
+    {
+        BatchUart* uart = new BatchUart( outDir.filePath( "uart_"+mcu->itemID()+".txt" ), this );
+        m_uarts.append( uart );
+
+        if( !uart->open() )
+        {
+            error( "Can not write to folder: "+m_outDir );
+            return false;
+        }
+        connect( mcu->processor(), SIGNAL( uartDataOut(uint32_t) ),
+                 uart,             SLOT( uartOut(uint32_t) ), Qt::DirectConnection );
+    }
+    return true;
+}
+
+void BatchRunner::sampleProbes()
+{
+    if( m_probes.isEmpty() ) return;
+
+    // 1 step = 1 us: fixed 6 decimals keeps full resolution at any time
+    m_probeOut << QString::number( Simulator::self()->step()/1e6, 'f', 6 );
+
+    foreach( Probe* probe, m_probes )
+    {
+        probe->updateStep();
+        m_probeOut << "," << probe->getVolt();
+    }
+    m_probeOut << "\n";
+}
+
+void BatchRunner::closeDialogs()
+{
+    QWidget* widget = QApplication::activeModalWidget();
+    if( !widget ) return;
+
+    QMessageBox* msgBox = qobject_cast<QMessageBox*>( widget );
+    if( msgBox ) error( msgBox->windowTitle()+" "+msgBox->text() );
+    else         error( "Dialog: "+widget->windowTitle() );
+
+    QDialog* dialog = qobject_cast<QDialog*>( widget );
+    if( dialog ) dialog->reject();
+    else         widget->close();
+}
+
+void BatchRunner::error( QString msg )
+{
+    m_error = true;
+    std::cerr << "Batch Error: " << msg.toStdString() << std::endl;
+}
+
+#include "moc_batchrunner.cpp"
@@ -0,0 +1,97 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QtWidgets>
+
+class Probe;
+class McuComponent;
+
+// Uart output of one Mcu to its own file
+class MAINMODULE_EXPORT BatchUart : public QObject
+{
+    Q_OBJECT
+
+    public:
+        BatchUart( QString fileName, QObject* parent=0 );
+        ~BatchUart();
+
+        bool open();
+        void close() { m_file.close(); }
+
+    public slots:
+        void uartOut( uint32_t value );
+
+    private:
+        QFile m_file;
+};
+
+// Runs a circuit without GUI as fast as possible:
+// qtardusim --batch circuit.simu [-f firmware.hex] [-t seconds]
+//           [-s sample_us] [-o output_dir] [-w]
+//           [--load-state file] [--save-state file]
+// Probe voltages are written to probes.csv and Uart output of each Mcu
+// to uart_<mcuId>.txt, with -w all Probes and Mcu pins are recorded
+// to waves.vcd and waves.wvb. Runs can start from a saved state and
+// save theirs at the end, so several runs can fork from one state.
+class MAINMODULE_EXPORT BatchRunner : public QObject
+{
+    Q_OBJECT
+
+    public:
+        BatchRunner( QObject* parent=0 );
+        ~BatchRunner();
+
+ static bool isBatch( int argc, char* argv[] );
+
+        int run( QStringList args );
+
+    private slots:
+        void closeDialogs();
+
+    private:
+        bool parseArgs( QStringList args );
+        bool openOutput();
+        bool openUarts( QList<McuComponent*> mcuList );
+        void sampleProbes();
+        void error( QString msg );
+
+        QString m_circFile;
+        QStringList m_firmware;      // "file" or "mcuId=file"
+        QString m_outDir;
+        QString m_loadState;
+        QString m_saveState;
+
+        double m_simTime;     // Seconds to simulate
+        int    m_sampleSteps; // Steps between Probe samples
+        bool   m_wave;        // Record waveforms
+
+        QList<Probe*> m_probes;
+
+        QFile m_probeFile;
+        QList<BatchUart*> m_uarts;
+        QTextStream m_probeOut;
+
+        QTimer m_dialogTimer;
+
+        bool m_error;
+};
+
+#endif
@@ -32,6 +32,8 @@ static const char* Circuit_properties[] = {
     QT_TRANSLATE_NOOP("App::Property","ReactStep"),
     QT_TRANSLATE_NOOP("App::Property","NoLinStep"),
     QT_TRANSLATE_NOOP("App::Property","NoLinAcc"),
+    QT_TRANSLATE_NOOP("App::Property","Sparse Solver"),
+    QT_TRANSLATE_NOOP("App::Property","Adaptive Step"),
     QT_TRANSLATE_NOOP("App::Property","Draw Grid"),
     QT_TRANSLATE_NOOP("App::Property","Show ScrollBars")
 };
@@ -89,6 +91,36 @@ void Circuit::setNoLinAcc( int ac )
     Simulator::self()->setNoLinAcc( ac );
 }
 
+bool Circuit::sparseSolver()
+{
+    return Simulator::self()->sparseSolver();
+}
+
+void Circuit::setSparseSolver( bool sparse )
+{
+    Simulator::self()->setSparseSolver( sparse );
+}
+
+bool Circuit::adaptiveStep()
+{
+    return Simulator::self()->adaptiveStep();
+}
+
+void Circuit::setAdaptiveStep( bool adaptive )
+{
+    Simulator::self()->setAdaptiveStep( adaptive );
+}
+
+int Circuit::mcuQuantum()
+{
+    return Simulator::self()->mcuQuantum();
+}
+
+void Circuit::setMcuQuantum( int quantum )
+{
+    Simulator::self()->setMcuQuantum( quantum );
+}
+
 int Circuit::reactStep()
 {
     return Simulator::self()->reaClock();
@@ -248,9 +280,23 @@ bool Circuit::animate()
 void Circuit::setAnimate( bool an )
 {
     m_animate = an;
+
+    if( an ) // Connectors show current levels, not the ones before animate was off
+    {
+        if( !Simulator::self()->isRunning() ) Simulator::self()->publishVolts();
+
+        foreach( Component* comp, m_conList )
+            static_cast<Connector*>( comp )->resetAnimate();
+    }
     update();
 }
 
+void Circuit::animateStep()
+{
+    foreach( Component* comp, m_conList )
+        static_cast<Connector*>( comp )->animateStep();
+}
+
 double Circuit::fontScale() 
 { 
     return MainWindow::self()->fontScale(); 
@@ -401,6 +447,9 @@ void Circuit::loadDomDoc( QDomDocument* doc )
     if( circuit.hasAttribute( "reactStep" )) setReactStep( circuit.attribute("reactStep").toInt() );
     if( circuit.hasAttribute( "noLinStep" )) setNoLinStep( circuit.attribute("noLinStep").toInt() );
     if( circuit.hasAttribute( "noLinAcc" ))  setNoLinAcc( circuit.attribute("noLinAcc").toInt() );
+    if( circuit.hasAttribute( "sparseSolver" )) setSparseSolver( circuit.attribute("sparseSolver").toInt() );
+    if( circuit.hasAttribute( "adaptiveStep" )) setAdaptiveStep( circuit.attribute("adaptiveStep").toInt() );
+    if( circuit.hasAttribute( "mcuQuantum" ))   setMcuQuantum( circuit.attribute("mcuQuantum").toInt() );
     if( circuit.hasAttribute( "animate" ))   setAnimate( circuit.attribute("animate").toInt() );
     /*if( circuit.hasAttribute( "drawGrid" ) )    
     {
@@ -670,6 +719,9 @@ void Circuit::circuitToDom()
     circuit.setAttribute( "reactStep", QString::number( reactStep() ) );
     circuit.setAttribute( "noLinStep", QString::number( noLinStep() ) );
     circuit.setAttribute( "noLinAcc",  QString::number( noLinAcc() ) );
+    circuit.setAttribute( "sparseSolver", QString::number( sparseSolver() ) );
+    circuit.setAttribute( "adaptiveStep", QString::number( adaptiveStep() ) );
+    circuit.setAttribute( "mcuQuantum",   QString::number( mcuQuantum() ) );
     circuit.setAttribute( "animate",  QString::number( animate() ) );
     //circuit.setAttribute( "drawGrid",    QString( drawGrid()?"true":"false"));
     //circuit.setAttribute( "showScroll",  QString( showScroll()?"true":"false"));
@@ -36,6 +36,9 @@ class MAINMODULE_EXPORT Circuit : public QGraphicsScene
     Q_PROPERTY( int ReactStep READ reactStep WRITE setReactStep DESIGNABLE true USER true )
     Q_PROPERTY( int NoLinStep READ noLinStep WRITE setNoLinStep DESIGNABLE true USER true )
     Q_PROPERTY( int NoLinAcc  READ noLinAcc  WRITE setNoLinAcc  DESIGNABLE true USER true )
+    Q_PROPERTY( bool Sparse_Solver READ sparseSolver WRITE setSparseSolver DESIGNABLE true USER true )
+    Q_PROPERTY( bool Adaptive_Step READ adaptiveStep WRITE setAdaptiveStep DESIGNABLE true USER true )
+    Q_PROPERTY( int  Mcu_Quantum   READ mcuQuantum   WRITE setMcuQuantum   DESIGNABLE true USER true )
     
     Q_PROPERTY( bool Draw_Grid        READ drawGrid   WRITE setDrawGrid   DESIGNABLE true USER true )
     Q_PROPERTY( bool Show_ScrollBars  READ showScroll WRITE setShowScroll DESIGNABLE true USER true )
@@ -59,6 +62,15 @@ class MAINMODULE_EXPORT Circuit : public QGraphicsScene
         
         int  noLinAcc();
         void setNoLinAcc( int ac );
+
+        bool sparseSolver();
+        void setSparseSolver( bool sparse );
+
+        bool adaptiveStep();
+        void setAdaptiveStep( bool adaptive );
+
+        int  mcuQuantum();
+        void setMcuQuantum( int quantum );
         
         bool drawGrid();
         void setDrawGrid( bool draw );
@@ -68,6 +80,7 @@ class MAINMODULE_EXPORT Circuit : public QGraphicsScene
         
         bool animate();
         void setAnimate( bool an );
+        void animateStep();     // Repaint only connectors with changed level
         
         double fontScale();
         void   setFontScale( double scale );
@@ -47,6 +47,8 @@ CircuitWidget::CircuitWidget( QWidget *parent  )
     m_horizontLayout.addWidget( &m_terminal );
     m_horizontLayout.addWidget( &m_serial);
     
+    m_terminalList.append( &m_terminal );
+    
     connect( this,      &CircuitWidget::dataAvailable,
              &m_serial, &SerialPortWidget::slotWriteData );
     
@@ -96,6 +98,19 @@ void CircuitWidget::createActions()
     powerCircAct = new QAction( QIcon(":/poweroff.png"),tr("Power Circuit"), this);
     powerCircAct->setStatusTip(tr("Power the Circuit"));
     connect( powerCircAct, SIGNAL( triggered()), this, SLOT(powerCirc()));
+
+    recordAct = new QAction( QIcon(":/oscope.png"),tr("Record Waveform"), this);
+    recordAct->setStatusTip(tr("Record signals marked to record to a VCD file"));
+    recordAct->setCheckable( true );
+    connect( recordAct, SIGNAL( triggered()), this, SLOT(recordWave()));
+
+    saveStateAct = new QAction( QIcon(":/saveimage.png"),tr("Save State"), this);
+    saveStateAct->setStatusTip(tr("Save simulation state to restore it later"));
+    connect( saveStateAct, SIGNAL( triggered()), this, SLOT(saveSimState()));
+
+    restoreStateAct = new QAction( QIcon(":/reload.png"),tr("Restore State"), this);
+    restoreStateAct->setStatusTip(tr("Restore saved simulation state"));
+    connect( restoreStateAct, SIGNAL( triggered()), this, SLOT(restoreSimState()));
     
     infoAct = new QAction( QIcon(":/help.png"),tr("Online Help"), this);
     infoAct->setStatusTip(tr("Online Help"));
@@ -119,6 +134,9 @@ void CircuitWidget::createToolBars()
     m_circToolBar.addAction(saveCircAsAct);
     m_circToolBar.addSeparator();//..........................
     m_circToolBar.addAction(powerCircAct);
+    m_circToolBar.addAction(recordAct);
+    m_circToolBar.addAction(saveStateAct);
+    m_circToolBar.addAction(restoreStateAct);
     m_circToolBar.addSeparator();//..........................
     m_circToolBar.addWidget( m_rateLabel );
 
@@ -238,7 +256,60 @@ void CircuitWidget::powerCircOff()
 {
         powerCircAct->setIcon(QIcon(":/poweroff.png"));
         powerCircAct->setIconText("Off");
-        Simulator::self()->stopSim();
+        Simulator::self()->stopSim();           // Also stops recording
+        recordAct->setChecked( false );
+}
+
+void CircuitWidget::recordWave()
+{
+    if( !recordAct->isChecked() )
+    {
+        Simulator::self()->stopRecording();
+        return;
+    }
+    QString fileName = QFileDialog::getSaveFileName( this, tr("Record Waveform"), m_lastCircDir,
+                                                     tr("Waveforms (*.vcd);;All files (*.*)"));
+    if( fileName.isEmpty() )
+    {
+        recordAct->setChecked( false );
+        return;
+    }
+    if( !Simulator::self()->startRecording( fileName ) )
+    {
+        recordAct->setChecked( false );
+        QMessageBox::warning( this, tr("Record Waveform"),
+                              tr("Could not record:\nNo signals to record or can't write file\n")+fileName );
+    }
+}
+
+void CircuitWidget::saveSimState()
+{
+    QString fileName = QFileDialog::getSaveFileName( this, tr("Save State"), m_lastCircDir,
+                                                     tr("Simulation States (*.simstate);;All files (*.*)"));
+    if( fileName.isEmpty() ) return;
+
+    if( !Simulator::self()->saveStateFile( fileName ) )
+    {
+        QMessageBox::warning( this, tr("Save State"),
+                              tr("Could not save state:\n"
+                                 "simulation must be running or paused, or can't write file\n")+fileName );
+    }
+}
+
+void CircuitWidget::restoreSimState()
+{
+    QString fileName = QFileDialog::getOpenFileName( this, tr("Restore State"), m_lastCircDir,
+                                                     tr("Simulation States (*.simstate);;All files (*.*)"));
+    if( fileName.isEmpty() ) return;
+
+    if( powerCircAct->iconText() == "Off" ) powerCircOn();
+
+    if( !Simulator::self()->loadStateFile( fileName ) )
+    {
+        QMessageBox::warning( this, tr("Restore State"),
+                              tr("Saved state doesn't match the circuit:\n"
+                                 "components or firmware changed since it was saved\n")+fileName );
+    }
 }
 
 void CircuitWidget::powerCircDebug( bool run )
@@ -291,6 +362,50 @@ void CircuitWidget::setRate( int rate )
         m_rateLabel->setText( tr("    Real Speed: ")+QString::number(rate) +" %" );
 }
 
+TerminalWidget* CircuitWidget::openTerminal( BaseProcessor* proc, QString name )
+{
+    TerminalWidget* term = 0l;
+    
+    foreach( TerminalWidget* t, m_terminalList )     // Already open or free
+    {
+        if( t->processor() == proc ) { term = t; break; }
+        if( !term && !t->processor() ) term = t;
+    }
+    if( !term )                             // All in use: add a new one
+    {
+        term = new TerminalWidget( this );
+        m_horizontLayout.insertWidget( m_terminalList.size()+1, term );
+        m_terminalList.append( term );
+    }
+    term->setProcessor( proc, name );
+    term->setVisible( true );
+    
+    return term;
+}
+
+void CircuitWidget::closeTerminal( BaseProcessor* proc )
+{
+    foreach( TerminalWidget* term, m_terminalList )
+    {
+        if( term->processor() != proc ) continue;
+        
+        term->setProcessor( 0l );
+        term->setVisible( false );
+    }
+}
+
+void CircuitWidget::publishTerminals()
+{
+    foreach( TerminalWidget* term, m_terminalList ) 
+        if( term->processor() ) term->publish();
+}
+
+void CircuitWidget::stepTerminals()
+{
+    foreach( TerminalWidget* term, m_terminalList ) 
+        if( term->processor() ) term->step();
+}
+
 void CircuitWidget::showSerialPortWidget( bool showIt )
 {
     m_serial.setVisible( showIt );
@@ -45,6 +45,11 @@ class MAINMODULE_EXPORT CircuitWidget : public QWidget
         
         void setRate( int rate );
 
+        TerminalWidget* openTerminal( BaseProcessor* proc, QString name );
+        void closeTerminal( BaseProcessor* proc );
+        void publishTerminals();
+        void stepTerminals();
+
         void showSerialPortWidget( bool showIt );
         
         void writeSerialPortWidget( const QByteArray &data );
@@ -60,6 +65,9 @@ class MAINMODULE_EXPORT CircuitWidget : public QWidget
         void saveCirc();
         bool saveCircAs();
         void powerCirc();
+        void recordWave();
+        void saveSimState();
+        void restoreSimState();
         void openInfo();
         void about();
 
@@ -75,6 +83,7 @@ class MAINMODULE_EXPORT CircuitWidget : public QWidget
         CircuitView    m_circView;
         
         TerminalWidget    m_terminal;
+        QList<TerminalWidget*> m_terminalList; // One Serial Monitor per Mcu
         PlotterWidget     m_plotter;
         SerialPortWidget  m_serial;
         
@@ -86,6 +95,9 @@ class MAINMODULE_EXPORT CircuitWidget : public QWidget
         QAction* saveCircAct;
         QAction* saveCircAsAct;
         QAction* powerCircAct;
+        QAction* recordAct;
+        QAction* saveStateAct;
+        QAction* restoreStateAct;
         QAction* infoAct;
         QAction* aboutAct;
         QAction* aboutQtAct;
@@ -74,15 +74,32 @@ BJT::BJT( QObject* parent, QString type, QString id )
     m_pin[2]->setLabelColor( QColor( 0, 0, 0 ) );
     m_ePin[2] = m_pin[2];
     
+    m_conducting = false;
+    
+    Simulator::self()->addToUpdateList( this );
+    
     resetState();
 }
 BJT::~BJT(){}
 
 void BJT::updateStep()
 {
+    if( !Circuit::self()->animate() ) return;
+    
+    bool conducting = m_baseCurr > 1e-4;
+    if( conducting == m_conducting ) return;
+    
+    m_conducting = conducting;
     update();
 }
 
+void BJT::remove()
+{
+    Simulator::self()->remFromUpdateList( this );
+    
+    Component::remove();
+}
+
 void BJT::setPnp( bool pnp ) 
 {
     m_PNP = pnp;
@@ -103,8 +120,8 @@ void BJT::paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *w
 {
     Component::paint( p, option, widget );
     
-    if( Circuit::self()->animate() && m_baseCurr > 1e-4 )  p->setBrush( Qt::yellow );
-    else                                                   p->setBrush( Qt::white );
+    if( Circuit::self()->animate() && m_conducting )  p->setBrush( Qt::yellow );
+    else                                              p->setBrush( Qt::white );
 
     p->drawEllipse( m_area );
     
@@ -47,6 +47,12 @@ class MAINMODULE_EXPORT BJT : public Component, public eBJT
         void setBCd( bool bcd );
 
         virtual void paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *widget );
+        
+    public slots:
+        void remove();
+        
+    private:
+        bool m_conducting;    // Shown in animate mode, set by updateStep()
 };
 
 #endif
@@ -42,18 +42,40 @@ Clock::Clock( QObject* parent, QString type, QString id )
 }
 Clock::~Clock(){}
 
-void Clock::simuClockStep()
+void Clock::initialize()
 {
-    m_step++;
+    if( m_isRunning ) Simulator::self()->addEvent( Simulator::self()->step()+m_stepsPC/2, this );
+}
 
-    if ( m_step >= m_stepsPC/2 )
+void Clock::updateStep() // Clock is driven by Simulator events, not by Simulation Clock
+{
+    if( m_changed )
     {
-        m_out->setOut( !m_out->out() );
-        m_out->stampOutput();
-        m_step = 0;
+        if( m_isRunning ) Simulator::self()->addEvent( Simulator::self()->step()+m_stepsPC/2, this );
+        else
+        {
+            m_out->setOut( false );
+            Simulator::self()->cancelEvent( this );
+        }
+        LogicInput::updateStep();
     }
 }
 
+void Clock::runEvent()
+{
+    m_out->setOut( !m_out->out() );
+    m_out->stampOutput();
+
+    Simulator::self()->addEvent( Simulator::self()->step()+m_stepsPC/2, this );
+}
+
+void Clock::remove()
+{
+    Simulator::self()->cancelEvent( this );
+
+    ClockBase::remove();
+}
+
 void Clock::paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *widget )
 {
     Component::paint( p, option, widget );
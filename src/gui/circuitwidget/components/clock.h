@@ -36,9 +36,14 @@ class MAINMODULE_EXPORT Clock : public ClockBase
         static Component* construct( QObject* parent, QString type, QString id );
         static LibraryItem *libraryItem();
         
-        virtual void simuClockStep();
+        virtual void initialize();
+        virtual void updateStep();
+        virtual void runEvent();
 
         virtual void paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *widget );
+
+    public slots:
+        virtual void remove();
 };
 
 #endif
@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <string.h>
+
+#include <QtAlgorithms>
+
+#include "displaybuffer.h"
+
+DisplayBuffer::DisplayBuffer()
+{
+    m_colorOff = qRgb( 200, 215, 180 );
+    m_colorOn  = qRgb( 0, 0, 0 );
+
+    setSize( 1, 1 );
+}
+DisplayBuffer::~DisplayBuffer(){}
+
+void DisplayBuffer::setSize( int width, int height, int scale )
+{
+    m_width  = width;
+    m_height = height;
+    m_scale  = scale;
+    m_stride = (width+7)/8;
+
+    m_plane.assign( m_stride*height, 0 );
+    m_dirty.assign( (height+31)/32, 0 );
+
+    m_image = QImage( width*scale, height*scale, QImage::Format_MonoLSB );
+    m_image.setColor( 0, m_colorOff );
+    m_image.setColor( 1, m_colorOn );
+    m_image.fill( 0 );
+
+    m_mode    = Normal;
+    m_pubMode = Normal;
+    m_changed = true;
+}
+
+void DisplayBuffer::setColors( QRgb off, QRgb on )
+{
+    m_colorOff = off;
+    m_colorOn  = on;
+    m_image.setColor( 0, off );
+    m_image.setColor( 1, on );
+}
+
+void DisplayBuffer::clear()
+{
+    memset( m_plane.data(), 0, m_plane.size() );
+    for( int row=0; row<m_height; row++ ) setDirty( row );
+}
+
+void DisplayBuffer::setMode( int mode )
+{
+    if( mode == m_mode ) return;
+    m_mode = mode;
+    m_changed = true;
+}
+
+void DisplayBuffer::setPixel( int x, int y, bool on )
+{
+    uint8_t* byte = &m_plane[ y*m_stride+(x>>3) ];
+    uint8_t  mask = 1<<(x & 7);
+    uint8_t  old  = *byte;
+
+    if( on ) *byte |= mask;
+    else     *byte &= ~mask;
+
+    if( *byte != old ) setDirty( y );
+}
+
+void DisplayBuffer::setColumn( int x, int y, uint8_t bits )
+{
+    for( int i=0; i<8; i++ )
+    {
+        setPixel( x, y+i, bits & 1 );
+        bits >>= 1;
+    }
+}
+
+bool DisplayBuffer::publish()
+{
+    if( !m_changed ) return false;
+
+    bool all = (m_mode != m_pubMode);   // Mode changes every row
+    m_pubMode = m_mode;
+
+    for( int w=0; w<(int)m_dirty.size(); w++ )
+    {
+        uint32_t dirty = all ? 0xFFFFFFFF : m_dirty[w];
+        m_dirty[w] = 0;
+
+        while( dirty )
+        {
+            int row = w*32+qCountTrailingZeroBits( dirty );
+            dirty &= dirty-1;
+            if( row >= m_height ) break;
+
+            publishRow( row );
+        }
+    }
+    m_changed = false;
+    return true;
+}
+
+void DisplayBuffer::publishRow( int row )
+{
+    const uint8_t* src = &m_plane[ row*m_stride ];
+    uchar* dst = m_image.scanLine( row*m_scale );
+
+    if( m_scale == 1 )
+    {
+        if     ( m_pubMode == Normal )  memcpy( dst, src, m_stride );
+        else if( m_pubMode == Inverse ) for( int i=0; i<m_stride; i++ ) dst[i] = ~src[i];
+        else if( m_pubMode == Blank )   memset( dst, 0x00, m_stride );
+        else                            memset( dst, 0xFF, m_stride );
+        return;
+    }
+    int bytes = (m_width*m_scale+7)/8;
+    memset( dst, 0, bytes );
+
+    for( int x=0; x<m_width; x++ )
+    {
+        bool on = src[x>>3] & (1<<(x & 7));
+
+        if     ( m_pubMode == Inverse ) on = !on;
+        else if( m_pubMode == Blank )   on = false;
+        else if( m_pubMode == AllOn )   on = true;
+        if( !on ) continue;
+
+        for( int s=0; s<m_scale; s++ )
+        {
+            int px = x*m_scale+s;
+            dst[px>>3] |= 1<<(px & 7);
+        }
+    }
+    for( int s=1; s<m_scale; s++ )              // Repeat scaled row
+        memcpy( m_image.scanLine( row*m_scale+s ), dst, bytes );
+}
@@ -0,0 +1,87 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef DISPLAYBUFFER_H
+#define DISPLAYBUFFER_H
+
+#include <vector>
+#include <stdint.h>
+
+#include <QImage>
+
+// Monochrome pixels of a display controller, shared with the GUI.
+//
+// Controller writes (circuit thread) go to a packed bitplane, one bit per
+// pixel, LSB first: the layout of QImage::Format_MonoLSB. Written rows are
+// marked in a dirty-row bitmap.
+// publish(), called from updateStep() with the circuit thread stopped,
+// copies only dirty rows to the image that paint() draws, scaled by an
+// integer factor (no smooth scaling in the view).
+
+class MAINMODULE_EXPORT DisplayBuffer
+{
+    public:
+        DisplayBuffer();
+        ~DisplayBuffer();
+
+        enum displayMode_t {
+            Normal = 0,
+            Inverse,
+            Blank,    // All pixels off, bitplane is kept
+            AllOn
+        };
+
+        void setSize( int width, int height, int scale=1 ); // Clears all
+        void setColors( QRgb off, QRgb on );
+
+        int width()  { return m_width; }
+        int height() { return m_height; }
+
+        // Controller side
+        void clear();
+        void setMode( int mode );
+        void setPixel( int x, int y, bool on );
+        void setColumn( int x, int y, uint8_t bits ); // 8 pixels down from y, LSB first
+
+        // GUI side
+        bool publish();               // Image updated from dirty rows
+        const QImage &image() { return m_image; }
+
+    private:
+        void setDirty( int row ) { m_dirty[row>>5] |= 1u<<(row & 31); m_changed = true; }
+        void publishRow( int row );
+
+        int m_width;
+        int m_height;
+        int m_scale;
+        int m_stride;        // Bytes per bitplane row
+
+        int m_mode;
+        int m_pubMode;       // Mode of image rows
+        bool m_changed;
+
+        QRgb m_colorOff;
+        QRgb m_colorOn;
+
+        std::vector<uint8_t>  m_plane;
+        std::vector<uint32_t> m_dirty;
+
+        QImage m_image;
+};
+
+#endif
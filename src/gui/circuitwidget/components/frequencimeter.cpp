@@ -91,6 +91,22 @@ void Frequencimeter::resetState()
     m_display.setText( "0 Hz" );
 }
 
+void Frequencimeter::saveState( QDataStream &out )
+{
+    out << m_rising << m_falling << m_lastData << m_max << m_min << m_freq << m_numMax
+        << quint64( m_step ) << quint64( m_lastMax ) << quint64( m_totalP );
+}
+
+void Frequencimeter::loadState( QDataStream &in )
+{
+    quint64 step, lastMax, totalP;
+    in >> m_rising >> m_falling >> m_lastData >> m_max >> m_min >> m_freq >> m_numMax
+       >> step >> lastMax >> totalP;
+    m_step    = step;
+    m_lastMax = lastMax;
+    m_totalP  = totalP;
+}
+
 void Frequencimeter::updateStep()
 {
     if( m_step > 1e6 ) resetState();
@@ -39,6 +39,9 @@ class MAINMODULE_EXPORT Frequencimeter : public Component, public eElement
         void simuClockStep();
         void resetState();
         void updateStep();
+
+        void saveState( QDataStream &out );
+        void loadState( QDataStream &in );
         
         virtual void paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *widget );
         
@@ -36,6 +36,7 @@ class MAINMODULE_EXPORT Gate : public Component, public eGate
     Q_PROPERTY( double Out_Imped    READ outImp     WRITE setOutImp     DESIGNABLE true USER true )
     Q_PROPERTY( bool   Inverted     READ inverted   WRITE setInverted   DESIGNABLE true USER true )
     Q_PROPERTY( bool Open_Collector READ openCol  WRITE setOpenCol  DESIGNABLE true USER true )
+    Q_PROPERTY( int    Prop_Delay   READ propDelay  WRITE setPropDelay  DESIGNABLE true USER true )
     
 
     public:
@@ -46,10 +46,22 @@ LibraryItem* Hd44780::libraryItem()
 Hd44780::Hd44780( QObject* parent, QString type, QString id )
        : Component( parent, type, id )
        , eElement( (id+"-eElement").toStdString() )
-       , m_fontImg(":font2.png")
 {
     Q_UNUSED( Hd44780_properties );
     
+    QImage fontImg(":font2.png");          // 5x7 characters drawn at 2x
+    
+    for( int ch=0; ch<256; ch++ )
+    {
+        for( int y=0; y<7; y++ )
+        {
+            m_font[ch][y] = 0;
+            for( int x=0; x<5; x++ )
+                if( qAlpha( fontImg.pixel( ch*10+x*2, y*2 ) ) > 127 ) m_font[ch][y] |= 16>>x;
+        }
+    }
+    m_buffer.setColors( qRgb(200, 220, 180), qRgb(0, 0, 0) );
+    
     m_rows = 2;
     m_cols = 16;
     
@@ -113,8 +125,36 @@ void Hd44780::resetState()
     m_area = QRectF( 0, -(m_imgHeight+33), m_imgWidth+20, m_imgHeight+33 );
     setTransformOriginPoint( togrid( m_area.center() ));
     
+    m_buffer.setSize( m_cols*6-1, m_rows*9-1, 2 );
+    for( int i=0; i<80; i++ ) m_shownChar[i] = -1;
+    m_cursorCell = -1;
+    m_blinkStep  = 0;
+    
     clearLcd();
+    updateStep();
+}
+void Hd44780::saveState( QDataStream &out )
+{
+    for( int i=0; i<80; i++ ) out << m_DDram[i];
+    for( int i=0; i<64; i++ ) out << m_CGram[i];
+
+    out << m_cursPos << m_shiftPos << m_direction << m_shiftDisp
+        << m_dispOn << m_cursorOn << m_cursorBlink << m_dataLength << m_lineLength
+        << m_DDaddr << m_CGaddr << m_nibble << m_input << m_blinkStep
+        << m_lastClock << m_writeDDRAM;
+}
+
+void Hd44780::loadState( QDataStream &in )
+{
+    for( int i=0; i<80; i++ ) in >> m_DDram[i];
+    for( int i=0; i<64; i++ ) in >> m_CGram[i];
+
+    in >> m_cursPos >> m_shiftPos >> m_direction >> m_shiftDisp
+       >> m_dispOn >> m_cursorOn >> m_cursorBlink >> m_dataLength >> m_lineLength
+       >> m_DDaddr >> m_CGaddr >> m_nibble >> m_input >> m_blinkStep
+       >> m_lastClock >> m_writeDDRAM;
 }
+
 void Hd44780::setVChanged()             // Called when clock Pin changes 
 {
     if( m_pinEn->getVolt()>2.5 )                      // Clk Pin is High
@@ -326,9 +366,82 @@ void Hd44780::setRows( int rows )
     resetState();
 }
 
-void Hd44780::updateStep()
+void Hd44780::updateStep() // Circuit stopped: draw changed characters
 {
-    update();
+    bool cgChanged = (memcmp( m_shownCGram, m_CGram, sizeof(m_CGram) ) != 0);
+    if( cgChanged ) memcpy( m_shownCGram, m_CGram, sizeof(m_CGram) );
+    
+    int cursorCell = -1;
+    
+    for( int row=0; row<m_rows; row++ )
+    {
+        for( int col=0; col<m_cols; col++ )
+        {
+            int memPos  = memPosition( row, col );
+            int cell    = row*m_cols+col;
+            int charNum = m_DDram[memPos];
+            
+            if( memPos == m_DDaddr ) cursorCell = cell;
+            
+            if( (charNum == m_shownChar[cell]) && !(cgChanged && (charNum < 8)) ) continue;
+            
+            m_shownChar[cell] = charNum;
+            drawChar( row, col, charNum );
+        }
+    }
+    m_buffer.setMode( m_dispOn ? DisplayBuffer::Normal : DisplayBuffer::Blank );
+    
+    if( !m_dispOn || !m_cursorOn ) cursorCell = -1;
+    else if( m_cursorBlink )
+    {
+        if( ++m_blinkStep >= 40 ) m_blinkStep = 0;
+        if( m_blinkStep >= 20 )   cursorCell = -1;
+    }
+    else m_blinkStep = 0;
+    
+    bool changed = m_buffer.publish();
+    
+    if( cursorCell != m_cursorCell )
+    {
+        m_cursorCell = cursorCell;
+        changed = true;
+    }
+    if( changed ) update();
+}
+
+int Hd44780::memPosition( int row, int col )
+{
+    int mem_pos = 0;
+    if( row < 2 ) mem_pos += row*40+col;
+    else          mem_pos += (row-2)*40+20+col;
+    
+    int lineEnd = 79;
+    int lineStart = 0;
+    
+    if( m_lineLength == 40 ) 
+    {
+        if( mem_pos < 40 ) lineEnd   = 39;
+        else               lineStart = 40;
+    }
+    
+    mem_pos += m_shiftPos;
+    if( mem_pos>lineEnd )   mem_pos -= m_lineLength;
+    if( mem_pos<lineStart ) mem_pos += m_lineLength;
+    
+    return mem_pos;
+}
+
+void Hd44780::drawChar( int row, int col, int charNum )
+{
+    for( int y=0; y<7; y++ )
+    {
+        int data;
+        if( charNum < 8 ) data = m_CGram[charNum*8+y];       // CGRam Character
+        else              data = m_font[charNum & 255][y];
+        
+        for( int x=0; x<5; x++ )
+            m_buffer.setPixel( col*6+x, row*9+y, data & (16>>x) );
+    }
 }
 
 void Hd44780::remove()
@@ -379,71 +492,14 @@ void Hd44780::paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidge
     p->drawRoundedRect( m_area, 2, 2 );
     p->setBrush( QColor(200, 220, 180) );
     p->drawRoundedRect( 4, -(29+m_imgHeight), m_imgWidth+12, m_imgHeight+12, 8, 8 );
-
-    if( m_dispOn == 0 ) return;
     
-    for( int row=0; row<m_rows; row++ )
+    p->drawImage( 10, -(m_imgHeight+22), m_buffer.image() );
+    
+    if( m_cursorCell >= 0 )                  // Draw cursor: bottom line of character
     {
-        for( int col=0; col<m_cols; col++ )
-        {
-            int mem_pos = 0;
-            if( row < 2 ) mem_pos += row*40+col;
-            else          mem_pos += (row-2)*40+20+col;
-            
-            int lineEnd = 79;
-            int lineStart = 0;
-            
-            if( m_lineLength == 40 ) 
-            {
-                if( mem_pos < 40 ) lineEnd   = 39;
-                else               lineStart = 40;
-            }
-            
-            mem_pos += m_shiftPos;
-            if( mem_pos>lineEnd )   mem_pos -= m_lineLength;
-            if( mem_pos<lineStart ) mem_pos += m_lineLength;
-            
-            //qDebug() << row << col << mem_pos;
-            int char_num = m_DDram[mem_pos];
-            QImage charact = m_fontImg.copy(char_num*10, 0, 10, 14);
-            
-            if( char_num < 8 )                        // CGRam Character
-            {
-                int addr = char_num*8;
-                
-                for( int y=0; y<14; y+=2 )
-                {
-                    int data = m_CGram[ addr ];
-                    addr++;
-                    
-                    for( int x=9; x>0; x-=2 )
-                    {
-                        if( data & 1 )
-                        {
-                            charact.setPixel(x,   y,   qRgb(0, 0, 0));
-                            charact.setPixel(x-1, y,   qRgb(0, 0, 0));
-                            charact.setPixel(x,   y+1, qRgb(0, 0, 0));
-                            charact.setPixel(x-1, y+1, qRgb(0, 0, 0));
-                        }
-                        data = data>>1;
-                    }
-                }
-            }
-            p->drawImage(10+col*12,-(m_imgHeight+22)+row*18,charact );
-            
-            if( (mem_pos == m_DDaddr) & m_cursorOn )      // Draw cursor
-            {
-                if( m_cursorBlink ) m_blinkStep++;
-                else                m_blinkStep = 0;
-                
-                if( m_blinkStep < 20 )//m_cursorBlink
-                {
-                    charact = m_fontImg.copy(95*10, 0, 10, 14);
-                    p->drawImage(10+col*12,-(m_imgHeight+22)+row*18,charact );
-                }
-                if( m_blinkStep == 40 ) m_blinkStep = 0;
-            }
-        }
+        int row = m_cursorCell/m_cols;
+        int col = m_cursorCell%m_cols;
+        p->fillRect( 10+col*12, -(m_imgHeight+22)+row*18+12, 10, 2, Qt::black );
     }
 }
 
@@ -24,6 +24,7 @@
 #include "component.h"
 #include "e-element.h"
 #include "pin.h"
+#include "displaybuffer.h"
 
 class MAINMODULE_EXPORT Hd44780 : public Component, public eElement
 {
@@ -48,6 +49,9 @@ class MAINMODULE_EXPORT Hd44780 : public Component, public eElement
         void resetState();
         void setVChanged();
         void updateStep();
+
+        void saveState( QDataStream &out );
+        void loadState( QDataStream &in );
         void showPins( bool show );
         
         ePin* getEpin( QString pinName );
@@ -70,7 +74,12 @@ class MAINMODULE_EXPORT Hd44780 : public Component, public eElement
         void setDDaddr( int addr );
         void setCGaddr( int addr );
         
-        QImage m_fontImg;                  //Characters image
+        int  memPosition( int row, int col );   // DDRAM address shown at row, col
+        void drawChar( int row, int col, int charNum );
+        
+        uint8_t m_font[256][7];            //5x7 characters, bit 4 = left
+        
+        DisplayBuffer m_buffer;            //Pixels of all characters
 
         int m_DDram[80];                   //80 DDRAM
         int m_CGram[64];                   //64 CGRAM
@@ -97,6 +106,10 @@ class MAINMODULE_EXPORT Hd44780 : public Component, public eElement
         int m_input;
         
         int m_blinkStep;
+        int m_cursorCell;                  //Cursor shown at this cell, -1 = none
+        
+        int m_shownChar[80];               //Characters in m_buffer
+        int m_shownCGram[64];
         
         bool m_lastClock;
         bool m_writeDDRAM;
@@ -94,6 +94,27 @@ void I2CRam::resetState()
     m_phase = 3;
 }
 
+void I2CRam::saveState( QDataStream &out )
+{
+    eI2C::saveState( out );
+    out << m_addrPtr << m_phase << m_size;
+    for( int i=0; i<m_size; i++ ) out << m_ram[i];
+}
+
+void I2CRam::loadState( QDataStream &in )
+{
+    eI2C::loadState( in );
+    int size = 0;
+    in >> m_addrPtr >> m_phase >> size;
+
+    for( int i=0; i<size; i++ )
+    {
+        int data;
+        in >> data;
+        if( i < 65536 ) m_ram[i] = data;
+    }
+}
+
 void I2CRam::setVChanged()             // Some Pin Changed State, Manage it
 {
     bool A0 = eLogicDevice::getInputState( 1 );
@@ -46,6 +46,9 @@ class MAINMODULE_EXPORT I2CRam : public LogicComponent, public eI2C
         virtual void initialize();
         virtual void resetState();
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         virtual void writeByte();
         virtual void readByte();
         
@@ -81,9 +81,7 @@ Ks0108::Ks0108( QObject* parent, QString type, QString id )
         m_dataeSource[i]->setImp( high_imp );
     }
     
-    m_pdisplayImg = new QImage( 128, 64, QImage::Format_MonoLSB );
-    m_pdisplayImg->setColor( 1, qRgb(0,0,0));
-    m_pdisplayImg->setColor( 0, qRgb(200,215,180) );
+    m_buffer.setSize( 128, 64 );
     
     Simulator::self()->addToUpdateList( this );
     
@@ -112,6 +110,26 @@ void Ks0108::resetState()
     updateStep();
 }
 
+void Ks0108::saveState( QDataStream &out )
+{
+    out.writeRawData( (const char*)m_aDispRam, sizeof(m_aDispRam) );
+
+    out << m_input << m_addrX1 << m_addrY1 << m_addrX2 << m_addrY2 << m_startLin
+        << m_Cs1 << m_Cs2 << m_dispOn << m_lastScl << m_reset << m_Write;
+}
+
+void Ks0108::loadState( QDataStream &in )
+{
+    in.readRawData( (char*)m_aDispRam, sizeof(m_aDispRam) );
+
+    in >> m_input >> m_addrX1 >> m_addrY1 >> m_addrX2 >> m_addrY2 >> m_startLin
+       >> m_Cs1 >> m_Cs2 >> m_dispOn >> m_lastScl >> m_reset >> m_Write;
+
+    for( int row=0; row<8; row++ )
+        for( int col=0; col<128; col++ ) m_buffer.setColumn( col, row*8, m_aDispRam[row][col] );
+    dispOn( m_dispOn );
+}
+
 void Ks0108::setVChanged()                 // Called when En Pin changes 
 {
     if( m_pinRst.getVolt()<2.5 ) reset();            // Reset Pin is Low
@@ -221,11 +239,13 @@ void Ks0108::writeData( int data )
     {
         //qDebug() << "Ks0108::writeData 1  "<<m_addrX1 <<m_addrY1<<data;
         m_aDispRam[m_addrX1][m_addrY1]    = data;  // Write Half 1 
+        m_buffer.setColumn( m_addrY1, m_addrX1*8, data );
     }
     if( m_Cs2 ) 
     {
         //qDebug() << "Ks0108::writeData 2  "<<m_addrX2 <<m_addrY2<<data;
         m_aDispRam[m_addrX2][m_addrY2+64] = data;  // Write Half 2 
+        m_buffer.setColumn( m_addrY2+64, m_addrX2*8, data );
     }
     incrementPointer();
 }
@@ -243,6 +263,7 @@ void Ks0108::proccessCommand( int command )
 void Ks0108::dispOn( int state )
 {
     m_dispOn = (state > 0);
+    m_buffer.setMode( m_dispOn ? DisplayBuffer::Normal : DisplayBuffer::Blank );
 }
 
 void Ks0108::setYaddr( int addr )
@@ -266,7 +287,7 @@ void Ks0108::startLin( int line )
 
 void Ks0108::clearLcd() 
 {
-    m_pdisplayImg->fill(0);
+    m_buffer.clear();
 }
 
 void Ks0108::clearDDRAM() 
@@ -313,8 +334,8 @@ void Ks0108::reset()
     m_addrX2  = 0;
     m_addrY2  = 0;
     m_startLin = 0;
-    m_dispOn = false;
     m_reset = true;
+    dispOn( 0 );
 }
 
 void Ks0108::remove()
@@ -333,31 +354,14 @@ void Ks0108::remove()
         delete m_dataeSource[i];
     }
     
-    delete m_pdisplayImg;
     Simulator::self()->remFromUpdateList( this );
     
     Component::remove();
 }
 
-void Ks0108::updateStep()
+void Ks0108::updateStep() // Circuit stopped: copy changed rows to image
 {
-    if( !m_dispOn ) m_pdisplayImg->fill(0);               // Display Off
-    else
-    {
-        for(int row=0;row<8;row++) 
-        {
-            for( int col=0;col<128;col++ ) 
-            {
-                char abyte = m_aDispRam[row][col];
-                for( int bit=0; bit<8; bit++ ) 
-                {
-                    m_pdisplayImg->setPixel(col,row*8+bit,(abyte & 1) );
-                    abyte >>= 1;
-                }
-            }
-        }
-    }
-    update();
+    if( m_buffer.publish() ) update();
 }
 
 void Ks0108::paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *widget )
@@ -369,7 +373,7 @@ void Ks0108::paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidget
     p->drawRoundedRect( m_area,2,2 );
     p->setBrush( QColor(200, 220, 180) );
     p->drawRoundedRect( -70, -48, 140, 76, 8, 8 );
-    p->drawImage(-64,-42,*m_pdisplayImg );
+    p->drawImage(-64,-42, m_buffer.image() );
 }
 
 #include "moc_ks0108.cpp"
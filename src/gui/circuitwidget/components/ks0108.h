@@ -24,6 +24,7 @@
 #include "itemlibrary.h"
 #include "e-source.h"
 #include "pin.h"
+#include "displaybuffer.h"
 
 class MAINMODULE_EXPORT Ks0108 : public Component, public eElement
 {
@@ -43,6 +44,9 @@ class MAINMODULE_EXPORT Ks0108 : public Component, public eElement
         void setVChanged();
         
         void updateStep();
+
+        void saveState( QDataStream &out );
+        void loadState( QDataStream &in );
         
         virtual void paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget );
 
@@ -70,7 +74,7 @@ class MAINMODULE_EXPORT Ks0108 : public Component, public eElement
         
         void clearDDRAM();
         
-        QImage *m_pdisplayImg;        //Visual representation of the LCD
+        DisplayBuffer m_buffer;       //Visual representation of the LCD
 
         unsigned char m_aDispRam[8][128];                 //128x64 DDRAM
 
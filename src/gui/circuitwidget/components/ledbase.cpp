@@ -154,25 +154,26 @@ void LedBase::paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidge
     else
     {
         int overBight = 100;
+        int bright = m_bright;           // Published by updateStep(), don't modify
         
-        if( m_bright > 25 )
+        if( bright > 25 )
         {
-            m_bright += 15;                          // Set a Minimun Bright
+            bright += 15;                            // Set a Minimun Bright
             
-            if( m_bright > 255 ) 
+            if( bright > 255 ) 
             {
-                overBight += m_bright-255;
-                m_bright = 255;
+                overBight += bright-255;
+                bright = 255;
             }
         }
         
-        color = QColor( m_bright, m_bright, overBight ); // Default = yellow
+        color = QColor( bright, bright, overBight ); // Default = yellow
         
-        if     ( m_ledColor == red )    color = QColor( m_bright,  m_bright/3, overBight );
-        else if( m_ledColor == green )  color = QColor( overBight, m_bright,   m_bright*2/3 );
-        else if( m_ledColor == blue )   color = QColor( overBight, m_bright/2, m_bright );
-        else if( m_ledColor == orange ) color = QColor( m_bright,  m_bright*2/3, overBight );
-        else if( m_ledColor == purple ) color = QColor( m_bright,  overBight,  m_bright*2/3 );
+        if     ( m_ledColor == red )    color = QColor( bright,    bright/3,   overBight );
+        else if( m_ledColor == green )  color = QColor( overBight, bright,     bright*2/3 );
+        else if( m_ledColor == blue )   color = QColor( overBight, bright/2,   bright );
+        else if( m_ledColor == orange ) color = QColor( bright,    bright*2/3, overBight );
+        else if( m_ledColor == purple ) color = QColor( bright,    overBight,  bright*2/3 );
     }
     p->setPen(pen);
     drawBackground( p );
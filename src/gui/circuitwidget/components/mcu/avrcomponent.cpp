@@ -23,6 +23,7 @@
 #include "mainwindow.h"
 #include "circuit.h"
 #include "utils.h"
+#include "simulator.h"
 
 LibraryItem* AVRComponent::libraryItem()
 {
@@ -36,31 +37,23 @@ LibraryItem* AVRComponent::libraryItem()
 
 Component* AVRComponent::construct( QObject* parent, QString type, QString id )
 { 
-    if( m_canCreate ) 
+    AVRComponent* avr = new AVRComponent( parent, type,  id );
+    if( m_error > 0 )
     {
-        AVRComponent* avr = new AVRComponent( parent, type,  id );
-        if( m_error > 0 )
-        {
-            Circuit::self()->compList()->removeOne( avr );
-            avr->deleteLater();
-            avr = 0l;
-            m_error = 0;
-            m_canCreate = true;
-            
-        }
-        return avr;
+        Circuit::self()->compList()->removeOne( avr );
+        avr->deleteLater();
+        avr = 0l;
+        m_error = 0;
     }
-    MessageBoxNB( tr("Error")
-                , tr("Only 1 Mcu allowed\n to be in the Circuit.") );
-
-    return 0l;
+    return avr;
 }
 
 AVRComponent::AVRComponent( QObject* parent, QString type, QString id )
             : McuComponent( parent, type, id )
 {
     m_pSelf = this;
-    m_processor = AvrProcessor::self();
+    m_processor = &m_avr;
+    m_processor->setMcu( this );
 
     initChip();
     if( m_error == 0 )
@@ -93,6 +86,51 @@ void AVRComponent::attachPins()
     avr_irq_register_notify( adcIrq, adc_hook, this );
     
     m_attached = true;
+    if( m_recordPins ) recordPorts( true );
+}
+
+void AVRComponent::terminate()
+{
+    recordPorts( false );               // Irqs are deleted with the cpu
+    McuComponent::terminate();
+}
+
+void AVRComponent::setRecordPins( bool record )
+{
+    McuComponent::setRecordPins( record );
+    if( m_attached ) recordPorts( record );
+}
+
+void AVRComponent::recordPorts( bool record ) // PORTx and DDRx registers
+{
+    avr_t* cpu = m_avr.getCpu();
+    if( !cpu ) return;
+
+    QString ports;
+    foreach( McuComponentPin* mcupin, m_pinList )
+    {
+        QString id = mcupin->pinId();
+        if( id.startsWith("P") && !ports.contains( id.at(1) ) ) ports.append( id.at(1) );
+    }
+    WaveRecorder* recorder = Simulator::self()->recorder();
+
+    foreach( QChar port, ports )
+    {
+        uint32_t ioctl = AVR_IOCTL_IOPORT_GETIRQ( port.toLatin1() );
+        avr_irq_t* portIrq = avr_io_getirq( cpu, ioctl, IOPORT_IRQ_REG_PORT );
+        avr_irq_t* ddrIrq  = avr_io_getirq( cpu, ioctl, IOPORT_IRQ_DIRECTION_ALL );
+
+        if( record )
+        {
+            recorder->addIrq( portIrq, m_id+".PORT"+port, 8 );
+            recorder->addIrq( ddrIrq,  m_id+".DDR"+port,  8 );
+        }
+        else
+        {
+            recorder->remIrq( portIrq );
+            recorder->remIrq( ddrIrq );
+        }
+    }
 }
 
 void AVRComponent::addPin( QString id, QString type, QString label, int pos, int xpos, int ypos, int angle )
@@ -43,6 +43,8 @@ class AVRComponent : public McuComponent
         int getRamValue( int address );
         
         void adcread( int channel );
+
+        virtual void setRecordPins( bool record );
         
  static void adc_hook( struct avr_irq_t* irq, uint32_t value, void* param )
         {
@@ -54,7 +56,11 @@ class AVRComponent : public McuComponent
             ptrAVRComponent->adcread( channel );
         }
 
+    public slots:
+        virtual void terminate();
+
     private:
+        void recordPorts( bool record );
         void attachPins();
         void addPin( QString id, QString type, QString label, int pos, int xpos, int ypos, int angle );
         
@@ -42,7 +42,7 @@ void AVRComponentPin::attach( avr_t*  AvrProcessor )
         // PORTX Register change irq
         QString portName = "PORT";
         portName.append( m_id.at(1) );
-        int portAddr = BaseProcessor::self()->getRegAddress( portName );
+        int portAddr = m_mcuComponent->processor()->getRegAddress( portName );
         if( portAddr < 0 )
         {
             qDebug()  << tr("Register descriptor file for this AVR processor %1 is corrupted - cannot attach pin").arg(AvrProcessor->mmcu)
@@ -64,7 +64,7 @@ void AVRComponentPin::attach( avr_t*  AvrProcessor )
         // DDRX Register change irq
         QString ddrName = "DDR";
         ddrName.append( m_id.at(1) );
-        int ddrAddr = BaseProcessor::self()->getRegAddress( ddrName );
+        int ddrAddr = m_mcuComponent->processor()->getRegAddress( ddrName );
         if( ddrAddr < 0 )
         {
             qDebug()  << tr("Register descriptor file for this AVR processor %1 is corrupted - cannot attach pin \n").arg(AvrProcessor->mmcu)
@@ -143,7 +143,27 @@ void AVRComponentPin::resetState()
 
 void AVRComponentPin::setVChanged()
 {
-    float volt = m_ePin[0]->getVolt();
+    double volt = m_ePin[0]->getVolt();
+    BaseProcessor* proc = m_mcuComponent->processor();
+
+    if( proc->isThreaded() ) proc->pushInEvent( this, volt ); // Run in Mcu thread
+    else                     voltChanged( volt );
+}
+
+void AVRComponentPin::runPinEvent( McuPinEvent &ev )
+{
+    switch( ev.type )
+    {
+        case McuPinEvent::Output:    set_pinVoltage( ev.value );   break;
+        case McuPinEvent::Direction: set_pinImpedance( ev.value ); break;
+        case McuPinEvent::Pullup:    setPullup( ev.value );        break;
+        case McuPinEvent::Input:     voltChanged( ev.volt );       break;
+    }
+}
+
+void AVRComponentPin::voltChanged( double volt )
+{
+    m_mcuVolt = volt;
 
     //qDebug() << m_id << m_type << volt;
     if( m_pinType == 1 )                                 // Is an IO Pin
@@ -153,8 +173,8 @@ void AVRComponentPin::setVChanged()
     }
     else if( m_pinType == 21 ) // reset
     {
-        if( volt < 3 )  BaseProcessor::self()->hardReset( true );
-        else            BaseProcessor::self()->hardReset( false );
+        if( volt < 3 )  m_mcuComponent->processor()->hardReset( true );
+        else            m_mcuComponent->processor()->hardReset( false );
     }
     else if( m_pinType == 22 ) { m_AvrProcessor->vcc  = volt*1000;}
     else if( m_pinType == 23 ) { m_AvrProcessor->avcc = volt*1000;}
@@ -184,10 +204,6 @@ void AVRComponentPin::setPullup( uint32_t value )
     }
     
     m_ePin[0]->stampCurrent( m_voltOut/m_imp );
-    //if( m_ePin[0]->getEnode()->needFastUpdate() ) 
-    {
-        Simulator::self()->runExtraStep();
-    }
 }
 
 void AVRComponentPin::set_pinVoltage( uint32_t value )
@@ -206,10 +222,6 @@ void AVRComponentPin::set_pinVoltage( uint32_t value )
     eSource::setOut( value > 0 );
     eSource::stampOutput();
     //m_ePin[0]->stampCurrent( m_voltOut/m_imp ); // Save some calls
-    //if( m_ePin[0]->getEnode()->needFastUpdate() ) 
-    {
-        Simulator::self()->runExtraStep();
-    }
 }
 
 void AVRComponentPin::set_pinImpedance( uint32_t value )
@@ -236,7 +248,10 @@ void AVRComponentPin::set_pinImpedance( uint32_t value )
 void AVRComponentPin::adcread()
 {
     //qDebug() << "ADC Read channel:    pin: " << m_id <<m_ePin[0]->getVolt()*1000 ;
-    avr_raise_irq( m_Write_adc_irq, m_ePin[0]->getVolt()*1000 );
+    double volt = m_mcuVolt;              // Mcu thread: last voltage received
+    if( !m_mcuComponent->processor()->isThreaded() ) volt = m_ePin[0]->getVolt();
+    
+    avr_raise_irq( m_Write_adc_irq, volt*1000 );
 }
 
 #include "moc_avrcomponentpin.cpp"
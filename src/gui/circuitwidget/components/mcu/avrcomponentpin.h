@@ -49,6 +49,8 @@ class AVRComponentPin : public McuComponentPin
         void resetOutput();
         
         void setVChanged();
+
+        void runPinEvent( McuPinEvent &ev );
         
         void adcread();
         
@@ -60,7 +62,7 @@ class AVRComponentPin : public McuComponentPin
             // get the pointer out of param and asign it to AVRComponentPin*
             AVRComponentPin* ptrAVRComponentPin = reinterpret_cast<AVRComponentPin*> (param);
 
-            ptrAVRComponentPin->set_pinVoltage(value);
+            ptrAVRComponentPin->mcuEvent( McuPinEvent::Output, value );
         }
         
         static void port_reg_hook( struct avr_irq_t* irq, uint32_t value, void* param )
@@ -69,7 +71,7 @@ class AVRComponentPin : public McuComponentPin
             // get the pointer out of param and asign it to AVRComponentPin*
             AVRComponentPin* ptrAVRComponentPin = reinterpret_cast<AVRComponentPin*> (param);
 
-            ptrAVRComponentPin->setPullup(value);
+            ptrAVRComponentPin->mcuEvent( McuPinEvent::Pullup, value );
         }
 
         static void ddr_hook( struct avr_irq_t* irq, uint32_t value, void* param )
@@ -78,11 +80,12 @@ class AVRComponentPin : public McuComponentPin
             // get the pointer out of param and asign it to AVRComponentPin*
             AVRComponentPin * ptrAVRComponentPin = reinterpret_cast<AVRComponentPin *> (param);
 
-            ptrAVRComponentPin->set_pinImpedance(value);
+            ptrAVRComponentPin->mcuEvent( McuPinEvent::Direction, value );
         }
 
     protected:
         void setPullup( uint32_t value );
+        void voltChanged( double volt );
 
         int  m_channel;
 
@@ -39,7 +39,6 @@ static const char* McuComponent_properties[] = {
 };
 
 McuComponent* McuComponent::m_pSelf = 0l;
-bool McuComponent::m_canCreate = true;
 
 McuComponent::McuComponent( QObject* parent, QString type, QString id )
             : Chip( parent, type, id )
@@ -48,10 +47,10 @@ McuComponent::McuComponent( QObject* parent, QString type, QString id )
     
     qDebug() << "        Initializing"<<m_id<<"...";
     
-    m_canCreate = false;
     m_serPort   = false;
     m_serMon    = false;
     m_attached  = false;
+    m_recordPins = false;
     
     m_processor  = 0l;
     m_symbolFile = "";
@@ -151,7 +150,7 @@ void McuComponent::setFreq( double freq )
     if     ( freq < 0  )  freq = 0;
     else if( freq > 100 ) freq = 100;
     
-    BaseProcessor::self()->setSteps( freq );
+    m_processor->setSteps( freq );
     m_freq = freq; 
 }
 
@@ -168,7 +167,7 @@ void McuComponent::terminate()
     qDebug() <<"        Terminating"<<m_id<<"...";
     m_processor->terminate();
     for( int i=0; i<m_numpins; i++ ) m_pinList[i]->terminate();
-    m_pSelf = 0l;
+    if( m_pSelf == this ) m_pSelf = 0l;
     //reset();
     qDebug() <<"     ..."<<m_id<<"Terminated\n";
 }
@@ -183,10 +182,9 @@ void McuComponent::remove()
     }
     slotCloseTerm();
     slotCloseSerial();
+    setRecordPins( false );
     terminate();
     m_pinList.clear();
-    
-    m_canCreate = true;
 
     Component::remove();
 }
@@ -223,6 +221,11 @@ void McuComponent::contextMenu( QGraphicsSceneContextMenuEvent* event, QMenu* me
     QAction* closeSerial = menu->addAction( QIcon(":/closeterminal.png"),tr("Close Serial Port") );
     connect( closeSerial, SIGNAL(triggered()), this, SLOT(slotCloseSerial()) );
 
+    QAction* recordPins = menu->addAction( tr("Record Pins Waveform") );
+    recordPins->setCheckable( true );
+    recordPins->setChecked( m_recordPins );
+    connect( recordPins, SIGNAL(triggered()), this, SLOT(slotRecordPins()) );
+
     menu->addSeparator();
 
     Component::contextMenu( event, menu );
@@ -231,28 +234,35 @@ void McuComponent::contextMenu( QGraphicsSceneContextMenuEvent* event, QMenu* me
 
 void McuComponent::slotOpenSerial()
 {
+    BaseProcessor* proc = SerialPortWidget::self()->processor();
+    if( proc && (proc != m_processor) && proc->mcu() ) // Only 1 Mcu per Port
+        proc->mcu()->slotCloseSerial();
+    
     CircuitWidget::self()->showSerialPortWidget( true );
+    SerialPortWidget::self()->setProcessor( m_processor );
     m_processor->setSerPort( true );
     m_serPort = true;
 }
 
 void McuComponent::slotCloseSerial()
 {
-    CircuitWidget::self()->showSerialPortWidget( false );
+    if( SerialPortWidget::self()->processor() == m_processor )
+    {
+        CircuitWidget::self()->showSerialPortWidget( false );
+        SerialPortWidget::self()->setProcessor( 0l );
+    }
     m_processor->setSerPort( false );
     m_serPort = false;
 }
 
 void McuComponent::slotOpenTerm()
 {
-    TerminalWidget::self()->setVisible( true );
     m_processor->setUsart( true );
     m_serMon = true;
 }
 
 void McuComponent::slotCloseTerm()
 {
-    TerminalWidget::self()->setVisible( false );
     m_processor->setUsart( false );
     m_serMon = false;
 }
@@ -336,6 +346,30 @@ void McuComponent::setSerMon( bool set )
     else      slotCloseTerm();
 }
 
+void McuComponent::setRecordPins( bool record )
+{
+    m_recordPins = record;
+    WaveRecorder* recorder = Simulator::self()->recorder();
+
+    foreach( McuComponentPin* mcupin, m_pinList )
+    {
+        Pin* pin = mcupin->pin();
+
+        if( record && !pin->unused() ) recorder->addPin( pin, m_id+"."+mcupin->pinId(), true );
+        else                           recorder->remPin( pin );
+    }
+}
+
+void McuComponent::slotRecordPins()
+{
+    bool pauseSim = Simulator::self()->isRunning();
+    if( pauseSim ) Simulator::self()->pauseSim();
+
+    setRecordPins( !m_recordPins );
+
+    if( pauseSim ) Simulator::self()->resumeSim();
+}
+
 void McuComponent::paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget )
 {
     Chip::paint( p, option, widget );
@@ -34,18 +34,21 @@ class MAINMODULE_EXPORT McuComponent : public Chip
     Q_PROPERTY( double   Mhz         READ freq    WRITE setFreq    DESIGNABLE true  USER true )
     Q_PROPERTY( bool     Ser_Port    READ serPort WRITE setSerPort )
     Q_PROPERTY( bool     Ser_Monitor READ serMon  WRITE setSerMon )
+    Q_PROPERTY( bool     Record_Pins READ recordPins WRITE setRecordPins )
 
     public:
 
         McuComponent( QObject* parent, QString type, QString id );
         ~McuComponent();
         
- static McuComponent* self() { return m_pSelf; }
+ static McuComponent* self() { return m_pSelf; } // Last Mcu created
 
         QString program()   const      { return  m_symbolFile; }
         void setProgram( QString pro );
         
         QString device() { return m_device; }
+        
+        BaseProcessor* processor() { return m_processor; }
 
         double freq();
         virtual void setFreq( double freq );
@@ -56,6 +59,10 @@ class MAINMODULE_EXPORT McuComponent : public Chip
         
         bool serMon();
         void setSerMon( bool set );
+
+        // Add pins to wave recorder as logic signals
+        bool recordPins() { return m_recordPins; }
+        virtual void setRecordPins( bool record );
         
         QList<McuComponentPin*> getPinList() { return m_pinList; }
 
@@ -72,12 +79,12 @@ class MAINMODULE_EXPORT McuComponent : public Chip
         void slotCloseTerm();
         void slotOpenSerial();
         void slotCloseSerial();
+        void slotRecordPins();
         
         void contextMenu( QGraphicsSceneContextMenuEvent* event, QMenu* menu );
         
     protected:
  static McuComponent* m_pSelf;
- static bool m_canCreate;
         
         virtual void contextMenuEvent(QGraphicsSceneContextMenuEvent* event);
 
@@ -91,6 +98,7 @@ class MAINMODULE_EXPORT McuComponent : public Chip
         bool m_attached;
         bool m_serPort;
         bool m_serMon;
+        bool m_recordPins;
 
         QString m_device;       // Name of device
         QString m_symbolFile;   // firmware file loaded
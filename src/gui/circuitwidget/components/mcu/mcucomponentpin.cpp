@@ -35,6 +35,7 @@ McuComponentPin::McuComponentPin( McuComponent *mcuComponent, QString id, QStrin
     m_attached = false;
     m_isInput  = true;
     m_openColl = false;
+    m_mcuVolt  = 0;
 
     Pin* pin = new Pin( angle, QPoint (xpos, ypos), mcuComponent->itemID()+"-"+id, pos, m_mcuComponent );
     pin->setLabelText( label );
@@ -74,6 +75,18 @@ void McuComponentPin::resetState()
     }
 }
 
+void McuComponentPin::saveState( QDataStream &out )
+{
+    eSource::saveState( out );
+    out << m_isInput << m_mcuVolt;
+}
+
+void McuComponentPin::loadState( QDataStream &in )
+{
+    eSource::loadState( in );
+    in >> m_isInput >> m_mcuVolt;
+}
+
 void McuComponentPin::initialize()
 {
     //if( m_pinType == 1 ) eSource::setImp( high_imp );// All  IO Pins should be inputs at start-up
@@ -91,6 +104,22 @@ void McuComponentPin::resetOutput()
     eSource::stampOutput();
 }
 
+void McuComponentPin::mcuEvent( int type, uint32_t value )
+{
+    BaseProcessor* proc = m_mcuComponent->processor();
+
+    // Mcu thread: all pin state is changed in circuit thread, at its step
+    if( proc->isThreaded() ) proc->pushOutEvent( this, type, value );
+
+    // Not connected pins don't touch the circuit: run now
+    else if( m_ePin[0]->isConnected() ) proc->addStepEvent( this, type, value );
+    else
+    {
+        McuPinEvent ev = { 0, this, type, value, 0 };
+        runPinEvent( ev );
+    }
+}
+
 void McuComponentPin::move( int dx, int dy )
 {
     pin()->moveBy( dx, dy );
@@ -21,6 +21,7 @@
 #define MCUCOMPONENTPIN_H
 
 #include "mcucomponent.h"
+#include "baseprocessor.h"
 #include "e-source.h"
 #include "pin.h"
 
@@ -36,15 +37,25 @@ class MAINMODULE_EXPORT McuComponentPin : public QObject, public eSource
 
         virtual void initialize();
         virtual void resetState();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         void terminate();
 
         void move( int dx, int dy );
         
         void resetOutput();
+
+        // Pin changes from Mcu, queued to end of step or to circuit thread
+        void mcuEvent( int type, uint32_t value );
+        virtual void runPinEvent( McuPinEvent &ev ) { Q_UNUSED(ev); }
+
+        void syncMcuVolt() { m_mcuVolt = m_ePin[0]->getVolt(); }
         
         int angle() { return m_angle;}
         
         QString ptype() { return m_type; }
+        QString pinId() { return m_id; }
 
     protected:
         McuComponent* m_mcuComponent;
@@ -59,6 +70,8 @@ class MAINMODULE_EXPORT McuComponentPin : public QObject, public eSource
         int m_pinType;
         int m_angle;
 
+        double m_mcuVolt;       // Pin voltage as seen by Mcu thread
+
         QString m_type;
         QString m_id;
 };
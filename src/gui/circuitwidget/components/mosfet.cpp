@@ -74,12 +74,20 @@ Mosfet::Mosfet( QObject* parent, QString type, QString id )
     newPin->setLabelColor( QColor( 0, 0, 0 ) );
     m_ePin[1] = newPin;
     
+    m_conducting = false;
+    
     Simulator::self()->addToUpdateList( this );
 }
 Mosfet::~Mosfet(){}
 
 void Mosfet::updateStep()
 {
+    if( !Circuit::self()->animate() ) return;
+    
+    bool conducting = m_gateV > 0;
+    if( conducting == m_conducting ) return;
+    
+    m_conducting = conducting;
     update();
 }
 
@@ -110,8 +118,8 @@ void Mosfet::paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidget
 {
     Component::paint( p, option, widget );
     
-    if( Circuit::self()->animate() && m_gateV > 0 )  p->setBrush( Qt::yellow );
-    else                                             p->setBrush( Qt::white );
+    if( Circuit::self()->animate() && m_conducting )  p->setBrush( Qt::yellow );
+    else                                              p->setBrush( Qt::white );
 
     p->drawEllipse( m_area );
     
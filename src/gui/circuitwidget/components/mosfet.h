@@ -51,6 +51,9 @@ class MAINMODULE_EXPORT Mosfet : public Component, public eMosfet
         
     public slots:
         void remove();
+        
+    private:
+        bool m_conducting;    // Shown in animate mode, set by updateStep()
 };
 
 #endif
@@ -25,7 +25,11 @@
 #include "oscopewidget.h"
 
 static const char* Oscope_properties[] = {
-    QT_TRANSLATE_NOOP("App::Property","Filter")
+    QT_TRANSLATE_NOOP("App::Property","Filter"),
+    QT_TRANSLATE_NOOP("App::Property","Trigger"),
+    QT_TRANSLATE_NOOP("App::Property","Trig Edge"),
+    QT_TRANSLATE_NOOP("App::Property","Trig Level"),
+    QT_TRANSLATE_NOOP("App::Property","Pre Trigger")
 };
 
 Component* Oscope::construct( QObject* parent, QString type, QString id )
@@ -31,13 +31,29 @@ class LibraryItem;
 class MAINMODULE_EXPORT Oscope : public Component, public eElement
 {
     Q_OBJECT
-    Q_PROPERTY( double Filter READ filter  WRITE setFilter DESIGNABLE true USER true )
+    Q_PROPERTY( double     Filter      READ filter     WRITE setFilter     DESIGNABLE true USER true )
+    Q_PROPERTY( trig_mode  Trigger     READ trigMode   WRITE setTrigMode   DESIGNABLE true USER true )
+    Q_PROPERTY( trig_edge  Trig_Edge   READ trigEdge   WRITE setTrigEdge   DESIGNABLE true USER true )
+    Q_PROPERTY( double     Trig_Level  READ trigLevel  WRITE setTrigLevel  DESIGNABLE true USER true )
+    Q_PROPERTY( double     Pre_Trigger READ preTrigger WRITE setPreTrigger DESIGNABLE true USER true )
+    Q_ENUMS( trig_mode )
+    Q_ENUMS( trig_edge )
 
     public:
 
         Oscope( QObject* parent, QString type, QString id );
         ~Oscope();
 
+        enum trig_mode {
+            Auto = 0,
+            Normal,
+            Single
+        };
+        enum trig_edge {
+            Rising = 0,
+            Falling
+        };
+
         static Component* construct( QObject* parent, QString type, QString id );
         static LibraryItem* libraryItem();
         
@@ -49,6 +65,18 @@ class MAINMODULE_EXPORT Oscope : public Component, public eElement
         double filter()                 { return m_oscopeW->filter(); }
         void setFilter( double filter ) { m_oscopeW->setFilter( filter ); }
 
+        trig_mode trigMode()              { return (trig_mode)m_oscopeW->trigMode(); }
+        void setTrigMode( trig_mode mode ) { m_oscopeW->setTrigMode( mode ); }
+
+        trig_edge trigEdge()              { return m_oscopeW->trigFalling() ? Falling : Rising; }
+        void setTrigEdge( trig_edge edge ) { m_oscopeW->setTrigFalling( edge == Falling ); }
+
+        double trigLevel()                { return m_oscopeW->trigLevel(); }
+        void setTrigLevel( double level )  { m_oscopeW->setTrigLevel( level ); }
+
+        double preTrigger()               { return m_oscopeW->preTrigger(); }
+        void setPreTrigger( double pre )   { m_oscopeW->setPreTrigger( pre ); }
+
         virtual void paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget );
 
     public slots:
@@ -66,9 +66,7 @@ Pcd8544::Pcd8544( QObject* parent, QString type, QString id )
     m_pSi.setLabelText(  " DIN" );
     m_pScl.setLabelText( " CLK" );
     
-    m_pdisplayImg = new QImage( 84, 48, QImage::Format_MonoLSB );
-    m_pdisplayImg->setColor( 1, qRgb(0,0,0));
-    m_pdisplayImg->setColor( 0, qRgb(200,215,180) );
+    m_buffer.setSize( 84, 48 );
     
     Simulator::self()->addToUpdateList( this );
     
@@ -99,6 +97,28 @@ void Pcd8544::resetState()
     updateStep();
 }
 
+void Pcd8544::saveState( QDataStream &out )
+{
+    out.writeRawData( (const char*)m_aDispRam, sizeof(m_aDispRam) );
+
+    out << m_bPD << m_bV << m_bH << m_bD << m_bE << m_lastScl
+        << m_addrX << m_addrY << m_inBit << quint8( m_cinBuf );
+}
+
+void Pcd8544::loadState( QDataStream &in )
+{
+    in.readRawData( (char*)m_aDispRam, sizeof(m_aDispRam) );
+
+    quint8 cinBuf;
+    in >> m_bPD >> m_bV >> m_bH >> m_bD >> m_bE >> m_lastScl
+       >> m_addrX >> m_addrY >> m_inBit >> cinBuf;
+    m_cinBuf = cinBuf;
+
+    for( int row=0; row<6; row++ )
+        for( int col=0; col<84; col++ ) m_buffer.setColumn( col, row*8, m_aDispRam[row][col] );
+    updateMode();
+}
+
 void Pcd8544::setVChanged()               // Called when Scl Pin changes 
 {
     if( m_pRst.getVolt()<0.3 )                       // Reset Pin is Low
@@ -129,6 +149,7 @@ void Pcd8544::setVChanged()               // Called when Scl Pin changes
         if( m_pDc.getVolt()>1.6 )                          // Write Data
         {
             m_aDispRam[m_addrY][m_addrX] = m_cinBuf;
+            m_buffer.setColumn( m_addrX, m_addrY*8, m_cinBuf );
             incrementPointer();
         } 
         else                                            // Write Command
@@ -140,6 +161,7 @@ void Pcd8544::setVChanged()               // Called when Scl Pin changes
                 m_bH  = ((m_cinBuf & 1) == 1);
                 m_bV  = ((m_cinBuf & 2) == 2);
                 m_bPD = ((m_cinBuf & 4) == 4);
+                updateMode();
             }
             else
             {
@@ -156,6 +178,7 @@ void Pcd8544::setVChanged()               // Called when Scl Pin changes
                     {
                         m_bD = ((m_cinBuf & 0x04) == 0x04);
                         m_bE =  (m_cinBuf & 0x01);
+                        updateMode();
                     } 
                     else if((m_cinBuf & 0xF8) == 0x40)// Set Y RAM address
                     {
@@ -179,35 +202,26 @@ void Pcd8544::setVChanged()               // Called when Scl Pin changes
     }
 }
 
-void Pcd8544::updateStep()
+void Pcd8544::updateStep() // Circuit stopped: copy changed rows to image
 {
-    if     ( m_bPD )          m_pdisplayImg->fill(0); // Power-Down mode
-    else if( !m_bD && !m_bE ) m_pdisplayImg->fill(0);// Blank Display mode, blank the visuals
-    else if( !m_bD && m_bE )  m_pdisplayImg->fill(1);  //All segments on
-    else
-    {
-        for(int row=0;row<6;row++) 
-        {
-            for( int col=0;col<84;col++ ) 
-            {
-                char abyte = m_aDispRam[row][col];
-                for( int bit=0; bit<8; bit++ ) 
-                {
-                    //This takes inverse video mode into account:
-                    m_pdisplayImg->setPixel(col,row*8+bit,
-                        (abyte & 1) ^ ((m_bD && m_bE) ? 1 : 0) );
+    if( m_buffer.publish() ) update();
+}
 
-                    abyte >>= 1;
-                }
-            }
-        }
-    }
-    update();
+void Pcd8544::updateMode()
+{
+    int mode = DisplayBuffer::Normal;
+    
+    if     ( m_bPD )          mode = DisplayBuffer::Blank;   // Power-Down mode
+    else if( !m_bD && !m_bE ) mode = DisplayBuffer::Blank;   // Blank Display mode
+    else if( !m_bD && m_bE )  mode = DisplayBuffer::AllOn;   // All segments on
+    else if(  m_bD && m_bE )  mode = DisplayBuffer::Inverse; // Inverse video mode
+    
+    m_buffer.setMode( mode );
 }
 
 void Pcd8544::clearLcd() 
 {
-    m_pdisplayImg->fill(0);
+    m_buffer.clear();
 }
 
 void Pcd8544::clearDDRAM() 
@@ -258,6 +272,7 @@ void Pcd8544::reset()
     m_bH  = false;
     m_bE  = false;
     m_bD  = false;
+    updateMode();
 }
 
 void Pcd8544::remove()
@@ -268,7 +283,6 @@ void Pcd8544::remove()
     if( m_pSi.isConnected() ) m_pSi.connector()->remove();
     if( m_pScl.isConnected() ) m_pScl.connector()->remove();
     
-    delete m_pdisplayImg;
     Simulator::self()->remFromUpdateList( this );
     
     Component::remove();
@@ -283,7 +297,7 @@ void Pcd8544::paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidge
     p->drawRoundedRect( m_area,2,2 );
     p->setBrush( QColor(200, 220, 180) );
     p->drawRoundedRect( -48, -48, 96, 60, 8, 8 );
-    p->drawImage(-42,-42,*m_pdisplayImg );
+    p->drawImage(-42,-42, m_buffer.image() );
     /*p->setFont(QFont("sans",6));
     p->drawText(-48, 40,QString("D/C /RST /CS SCL SI")); //TODO: beautify this
     p->setFont(QFont());
@@ -35,6 +35,7 @@
 #include "itemlibrary.h"
 #include "e-element.h"
 #include "pin.h"
+#include "displaybuffer.h"
 
 class MAINMODULE_EXPORT Pcd8544 : public Component, public eElement
 {
@@ -52,6 +53,9 @@ class MAINMODULE_EXPORT Pcd8544 : public Component, public eElement
         void setVChanged();
         
         void updateStep();
+
+        void saveState( QDataStream &out );
+        void loadState( QDataStream &in );
         
         void paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget );
 
@@ -69,7 +73,9 @@ class MAINMODULE_EXPORT Pcd8544 : public Component, public eElement
         
         void clearDDRAM();
         
-        QImage *m_pdisplayImg;        //Visual representation of the LCD
+        void updateMode();
+        
+        DisplayBuffer m_buffer;       //Visual representation of the LCD
 
         unsigned char m_aDispRam[6][84];                   //84x48 DDRAM
 
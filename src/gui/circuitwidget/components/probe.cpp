@@ -29,7 +29,8 @@
 #include <math.h>
 
 static const char* Probe_properties[] = {
-    QT_TRANSLATE_NOOP("App::Property","PlotterCh")
+    QT_TRANSLATE_NOOP("App::Property","PlotterCh"),
+    QT_TRANSLATE_NOOP("App::Property","Record")
 };
 
 Component* Probe::construct( QObject* parent, QString type, QString id )
@@ -55,6 +56,7 @@ Probe::Probe( QObject* parent, QString type, QString id )
     m_readPin = 0l;
     m_readConn = 0l;
     m_voltTrig = 2.5;
+    m_record = false;
     m_plotterLine = 0;
     m_plotterColor = QColor( 255, 255, 255 );
 
@@ -91,6 +93,13 @@ Probe::~Probe()
 }
 
 void Probe::updateStep()
+{
+    readVolt();
+
+    if( m_plotterLine > 0 ) PlotterWidget::self()->setChannelPin( m_plotterLine, plotPin() );
+}
+
+void Probe::readVolt()
 {
     m_readPin = 0l;
     m_readConn = 0l;
@@ -152,11 +161,16 @@ void Probe::setVolt( double volt )
     
     m_valLabel->setPlainText( QString("%1 V").arg(double(dispVolt)/100) );
 
-    if( m_plotterLine > 0 ) PlotterWidget::self()->setData( m_plotterLine, m_voltIn*100 );
-
     update();       // Repaint
 }
 
+ePin* Probe::plotPin()
+{
+    if     ( m_inputpin->isConnected() ) return m_inputpin;
+    else if( m_readConn != 0l )          return m_readConn->startPin();
+    return m_readPin;
+}
+
 double Probe::getVolt()
 {
     double volt = 0;
@@ -171,6 +185,7 @@ void Probe::remove()
     if( m_inputpin->isConnected() ) m_inputpin->connector()->remove();
 
     slotPlotterRem();
+    setRecord( false );
     
     Simulator::self()->remFromUpdateList( this );
     
@@ -190,28 +205,32 @@ void Probe::setPlotter( int channel )
     {
         slotPlotterRem(); 
         m_plotterLine = channel;
-        PlotterWidget::self()->setData( m_plotterLine, int(m_voltIn*100) );
         m_plotterColor = PlotterWidget::self()->getColor( m_plotterLine );
         update();       // Repaint
     }
 }
 
-void Probe::slotPlotter1() { setPlotter( 1 ); }
-void Probe::slotPlotter2() { setPlotter( 2 ); }
-void Probe::slotPlotter3() { setPlotter( 3 ); }
-void Probe::slotPlotter4() { setPlotter( 4 ); }
+void Probe::setRecord( bool record )
+{
+    bool pauseSim = Simulator::self()->isRunning();
+    if( pauseSim ) Simulator::self()->pauseSim();
+
+    m_record = record;
+
+    if( record ) Simulator::self()->recorder()->addPin( m_inputpin, m_id );
+    else         Simulator::self()->recorder()->remPin( m_inputpin );
 
-/*void Probe::slotPlotterAdd()
+    if( pauseSim ) Simulator::self()->resumeSim();
+}
+
+void Probe::slotRecord() { setRecord( !m_record ); }
+
+void Probe::slotPlotterAdd()
 {
     if( m_plotterLine != 0 ) return;            // Already have plotter
     
-    m_plotterLine = PlotterWidget::self()->getChannel();
-    if( m_plotterLine < 1 ) return;
-
-    PlotterWidget::self()->setData( m_plotterLine, int(m_voltIn*100) );
-    m_plotterColor = PlotterWidget::self()->getColor( m_plotterLine );
-    update();       // Repaint
-}*/
+    setPlotter( PlotterWidget::self()->getChannel() );
+}
 
 void Probe::slotPlotterRem()
 {
@@ -229,20 +248,16 @@ void Probe::contextMenuEvent(QGraphicsSceneContextMenuEvent *event)
     QMenu* menu  = new QMenu();
     QMenu *pmenu = menu->addMenu(QIcon(":/fileopen.png"),tr("Plotter Channel"));
 
-    QAction* plotter1Action = pmenu->addAction(QIcon(":/fileopen.png"),tr("Channel 1"));
-    connect(plotter1Action, SIGNAL(triggered()), this, SLOT(slotPlotter1()));
-    
-    QAction* plotter2Action = pmenu->addAction(QIcon(":/fileopen.png"),tr("Channel 2"));
-    connect(plotter2Action, SIGNAL(triggered()), this, SLOT(slotPlotter2()));
-    
-    QAction* plotter3Action = pmenu->addAction(QIcon(":/fileopen.png"),tr("Channel 3"));
-    connect(plotter3Action, SIGNAL(triggered()), this, SLOT(slotPlotter3()));
-    
-    QAction* plotter4Action = pmenu->addAction(QIcon(":/fileopen.png"),tr("Channel 4"));
-    connect(plotter4Action, SIGNAL(triggered()), this, SLOT(slotPlotter4()));
+    QAction* plotterAddAction = pmenu->addAction(QIcon(":/fileopen.png"),tr("Add to Plotter"));
+    connect(plotterAddAction, SIGNAL(triggered()), this, SLOT(slotPlotterAdd()));
 
     QAction* plotterRemAction = pmenu->addAction(QIcon(":/fileopen.png"),tr("Remove from Plotter"));
     connect(plotterRemAction, SIGNAL(triggered()), this, SLOT(slotPlotterRem()));
+
+    QAction* recordAction = menu->addAction( tr("Record Waveform") );
+    recordAction->setCheckable( true );
+    recordAction->setChecked( m_record );
+    connect( recordAction, SIGNAL(triggered()), this, SLOT(slotRecord()) );
     
     menu->addSeparator();
 
@@ -24,6 +24,7 @@
 #include "e-element.h"
 
 class Pin;
+class ePin;
 class eSource;
 class Connector;
 class LibraryItem;
@@ -33,6 +34,7 @@ class MAINMODULE_EXPORT Probe : public Component, public eElement
     Q_OBJECT
     Q_PROPERTY( bool Show_volt READ showVal  WRITE setShowVal DESIGNABLE true USER true )
     Q_PROPERTY( int PlotterCh  READ plotter  WRITE setPlotter )
+    Q_PROPERTY( bool Record    READ record   WRITE setRecord )
 
     public:
         Probe( QObject* parent, QString type, QString id );
@@ -47,6 +49,10 @@ class MAINMODULE_EXPORT Probe : public Component, public eElement
         int plotter();
         void setPlotter( int channel );
 
+        // Add input pin voltage to wave recorder (only if pin connected)
+        bool record() { return m_record; }
+        void setRecord( bool record );
+
         virtual void updateStep();
 
         virtual QPainterPath shape() const;
@@ -55,20 +61,23 @@ class MAINMODULE_EXPORT Probe : public Component, public eElement
     public slots:
         virtual void remove();
 
-        void slotPlotter1();
-        void slotPlotter2();
-        void slotPlotter3();
-        void slotPlotter4();
-        
+        void slotPlotterAdd();
         void slotPlotterRem();
 
+        void slotRecord();
+
     protected:
         void contextMenuEvent(QGraphicsSceneContextMenuEvent *event);
 
     private: 
+        void readVolt();
+        ePin* plotPin();       // Pin with the voltage read, for Plotter sampler
+
         double m_voltIn;
         double m_voltTrig;
 
+        bool   m_record;
+
         int    m_plotterLine;
         QColor m_plotterColor;
 
@@ -123,6 +123,19 @@ void RelayBase::initialize()
     setSwitch( m_nClose );
 }
 
+void RelayBase::saveState( QDataStream &out )
+{
+    eInductor::saveState( out );
+    out << m_closed;
+}
+
+void RelayBase::loadState( QDataStream &in )
+{
+    eInductor::loadState( in );
+    in >> m_closed;               // Switches are restored by their own eResistor
+    update();
+}
+
 void RelayBase::setVChanged()
 {
     eInductor::setVChanged();
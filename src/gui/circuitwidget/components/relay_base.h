@@ -56,6 +56,9 @@ class MAINMODULE_EXPORT RelayBase : public Component, public eInductor
         void setVChanged();
         virtual void initialize();
 
+        void saveState( QDataStream &out );
+        void loadState( QDataStream &in );
+
         virtual void paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *widget );
 
     public slots:
@@ -97,6 +97,21 @@ void Servo::resetState()
     eLogicDevice::resetState();
 }
 
+void Servo::saveState( QDataStream &out )
+{
+    eLogicDevice::saveState( out );
+    out << m_pos << m_targetPos << quint64( m_pulseStart ) << quint64( m_lastUpdate );
+}
+
+void Servo::loadState( QDataStream &in )
+{
+    eLogicDevice::loadState( in );
+    quint64 pulseStart, lastUpdate;
+    in >> m_pos >> m_targetPos >> pulseStart >> lastUpdate;
+    m_pulseStart = pulseStart;
+    m_lastUpdate = lastUpdate;
+}
+
 void Servo::updateStep()
 {
     uint64_t step = Simulator::self()->step();
@@ -46,6 +46,9 @@ class MAINMODULE_EXPORT Servo : public LogicComponent, public eLogicDevice
         void resetState();
         void setVChanged();
         void updateStep();
+
+        void saveState( QDataStream &out );
+        void loadState( QDataStream &in );
         
         virtual QPainterPath shape() const;
         void paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget );
@@ -103,6 +103,18 @@ void SR04::resetState()
     m_echouS = 0;
 }
 
+void SR04::saveState( QDataStream &out )
+{
+    out << quint64( m_lastStep ) << m_lastTrig << m_trigCount << m_echouS;
+}
+
+void SR04::loadState( QDataStream &in )
+{
+    quint64 lastStep;
+    in >> lastStep >> m_lastTrig >> m_trigCount >> m_echouS;
+    m_lastStep = lastStep;
+}
+
 void SR04::setVChanged()              // Called when Trigger Pin changes
 {
     bool trigState = m_trigpin->getVolt()>2.5;
@@ -42,6 +42,9 @@ class MAINMODULE_EXPORT SR04 : public Component, public eElement
         void setVChanged();
         void simuClockStep();
 
+        void saveState( QDataStream &out );
+        void loadState( QDataStream &in );
+
         virtual void paint( QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *widget );
         
     public slots:
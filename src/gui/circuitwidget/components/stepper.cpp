@@ -97,6 +97,16 @@ Stepper::~Stepper()
 {
 }
 
+void Stepper::saveState( QDataStream &out )
+{
+    out << m_ang << m_Ppos;
+}
+
+void Stepper::loadState( QDataStream &in )
+{
+    in >> m_ang >> m_Ppos;
+}
+
 void Stepper::setVChanged()
 {
     double voltCom = m_pinCo.getVolt();
@@ -51,6 +51,9 @@ class MAINMODULE_EXPORT Stepper : public Component, public eElement
         virtual void initialize();
         virtual void setVChanged();
         virtual void updateStep();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
         virtual void paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget );
         
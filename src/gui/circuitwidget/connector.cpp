@@ -34,6 +34,7 @@ Connector::Connector( QObject* parent, QString type, QString id, Pin* startpin,
     
     m_isBus = false;
     m_freeLine = false;
+    m_dispHigh = false;
 
     if( startpin )
     {
@@ -513,6 +514,19 @@ double Connector::getVolt()
     return m_startPin->getVolt();
 }
 
+double Connector::dispVolt() { return m_startPin->dispVolt(); }
+
+void Connector::animateStep()
+{
+    if( m_isBus ) return;
+    
+    bool high = dispVolt() > 2.5;
+    if( high == m_dispHigh ) return;
+    
+    m_dispHigh = high;
+    foreach( ConnectorLine* line, m_conLineList ) line->update();
+}
+
 QList<ConnectorLine*>* Connector::lineList() { return &m_conLineList; }
 
 void Connector::incActLine() 
@@ -64,6 +64,12 @@ class MAINMODULE_EXPORT Connector : public Component
         void setEnode( eNode* enode );
 
         double getVolt();
+        double dispVolt();
+        
+        // Animate mode: lines are repainted only when shown level changes
+        void animateStep();
+        void resetAnimate() { m_dispHigh = !m_isBus && (dispVolt() > 2.5); }
+        bool dispHigh() { return m_dispHigh; }
 
         QList<ConnectorLine*>* lineList();
 
@@ -120,6 +126,8 @@ class MAINMODULE_EXPORT Connector : public Component
         int m_actLine;
         int m_lastindex;
         
+        bool m_dispHigh;    // Voltage level shown by lines
+        
         bool m_isBus;
         
         QString m_startpinid;
@@ -446,8 +446,8 @@ void ConnectorLine::paint( QPainter* p, const QStyleOptionGraphicsItem* option,
     if( isSelected() ) color = QColor( Qt::darkGray );
     else if( !m_isBus  && Circuit::self()->animate() )               //color = QColor( 40, 40, 60 /*Qt::black*/ );
     {
-        if( m_pConnector->getVolt() > 2.5 ) color = QColor( 200, 50, 50 );
-        else                                color = QColor( 50, 50, 200 );
+        if( m_pConnector->dispHigh() ) color = QColor( 200, 50, 50 );
+        else                           color = QColor( 50, 50, 200 );
         //int volt = 50*int( m_pConnector->getVolt() );
         //if( volt > 250 )volt = 250;
         //if( volt < 0 ) volt = 0;
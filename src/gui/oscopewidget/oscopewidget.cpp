@@ -21,8 +21,6 @@
 #include "simulator.h"
 #include "oscope.h"
 
-#include <math.h>   // fabs(x,y)
-
 OscopeWidget::OscopeWidget(  QWidget *parent  )
             : QWidget( parent )
             , eElement( "oscope" )
@@ -42,17 +40,27 @@ OscopeWidget::OscopeWidget(  QWidget *parent  )
     m_prevVpos = 0;
     m_Vpos     = 0;
     
-    m_ampli = 0;
-    m_filter = 0.3;
+    m_trigMode    = Auto;
+    m_trigFalling = false;
+    m_trigLevel   = 2.5;
+    m_preTrigger  = 10;
+    m_filter      = 0.3;
 
-    m_newRead = true;
+    m_freq  = 0;
+    m_ampli = 0;
+    m_autoLevel = 2.5;
+    m_done = false;
     m_auto = true;
     
     m_oscope  = 0l;
-    //clear();
+    m_channel = 0l;
+
+    for( int i=0; i<140; i++ ) { m_dataMin[i] = 1; m_dataMax[i] = 0; } // Empty
+    restart( 0 );
 }
 OscopeWidget::~OscopeWidget()
 { 
+    if( m_channel ) Simulator::self()->capture()->remChannel( m_channel );
 }
 
 void OscopeWidget::resetState()
@@ -62,169 +70,241 @@ void OscopeWidget::resetState()
 
 void OscopeWidget::setOscope( Oscope* oscope )
 {
+    ScopeCapture* capture = Simulator::self()->capture();
+
+    if( m_channel ) capture->remChannel( m_channel );
+    m_channel = 0l;
     m_oscope = oscope;
-    
-    if( oscope  ) Simulator::self()->addToSimuClockList( this );
-    else          Simulator::self()->remFromSimuClockList( this );
+
+    if( oscope ) m_channel = capture->addChannel( oscope->getEpin(0), oscope->getEpin(1) );
+}
+
+void OscopeWidget::setTrigMode( int mode )
+{
+    m_trigMode = mode;
+    m_pending = false;
+    m_done = false;                                      // Rearm Single
+}
+
+void OscopeWidget::setPreTrigger( double pre )
+{
+    if     ( pre < 0 )   pre = 0;
+    else if( pre > 100 ) pre = 100;
+    m_preTrigger = pre;
 }
 
 void OscopeWidget::clear()
 {
-    for( int i=0; i<140; i++ ) m_data[i] = 2.5*28;
-    m_display->setData( m_data );
-    
-    m_newRead = true;
-    m_rising   = false;
-    m_falling  = false;
-    
-    m_step = 0;
-    m_totalP = 0;
-    m_numCycles = 0;
-    m_numMax = 0;
-    m_lastData =0;
-    m_counter = 0;
+    for( int i=0; i<140; i++ ) { m_dataMin[i] = 1; m_dataMax[i] = 0; }
+    m_display->setData( m_dataMax, m_dataMin );
+    m_display->setMaxMin( 0, 0 );
+
+    restart( 0 );
+    m_done  = false;
+    m_freq  = 0;
     m_ampli = 0;
-    m_tick = 0;
-    m_max =-1e12;
-    m_min = 1e12;
-    Hpos = 0;
-    m_freq = 500;
     
     m_freqLabel->setText( "Frq: 000 Hz" );
     m_ampLabel->setText( "Amp: 0.00 V" );
 }
 
-void OscopeWidget::read()
+void OscopeWidget::restart( uint64_t step )
 {
-    if( m_step > 1e6 ) clear();
-    if( m_numMax < 2 ) return;
-    m_numMax--;
-    
-    double freq = 1e6/(double)(m_totalP/m_numMax);
-    //qDebug() <<"Frequencimeter::simuClockStep"<<m_totalP<<m_numMax<<m_totalP/m_numMax;
-    if( m_freq != freq )
+    m_scanStep  = step;
+    m_trigStep  = 0;
+    m_lastTrig  = 0;
+    m_lastShown = step;
+    m_armed   = false;
+    m_pending = false;
+
+    m_totalP = 0;
+    m_numP   = 0;
+    m_sMax = -1e12;
+    m_sMin =  1e12;
+}
+
+void OscopeWidget::read() // Circuit thread stopped: read new samples
+{
+    if( !m_channel ) return;
+
+    ScopeCapture* capture = Simulator::self()->capture();
+    uint64_t first = capture->firstStep();
+    uint64_t last  = capture->lastStep();
+    if( first > last ) return;                          // Nothing captured
+
+    if( (m_scanStep < first) || (m_scanStep > last+1) ) restart( first ); // Capture reset
+
+    int window = 140*m_Hscale;
+    double pre = (double)window*m_preTrigger/100;
+    double delay = m_Hpos-pre;                       // Window start from trigger
+
+    // Triggers up to this one have their window captured
+    double lastComplete = (double)last-window+1-delay;
+
+    scan( m_scanStep, last, lastComplete );
+    m_scanStep = last+1;
+
+    uint64_t timeout = 2*window;
+    if( timeout < 50000 ) timeout = 50000;              // 50 ms
+
+    if( m_pending && ((double)m_trigStep <= lastComplete) )
     {
-        m_freq = freq;
-        if     ( freq >= 10000 ) m_freqLabel->setText( "Frq: "+QString::number( freq, 'f', 0 )+" Hz" );
-        else if( freq >= 1000 )  m_freqLabel->setText( "Frq: "+QString::number( freq, 'f', 1 )+" Hz" );
-        else                     m_freqLabel->setText( "Frq: "+QString::number( freq, 'f', 2 )+" Hz" );
+        display( (double)m_trigStep+delay );
+        m_lastShown = m_trigStep;
+        m_pending = false;
+        if( m_trigMode == Single ) m_done = true;
     }
-    m_totalP = 0;
-    m_numMax = 0;
-    m_step   = 0;
-    
-        m_reading = true;
-        
-    double tick = 20*m_Hscale;
-    double val = tick/1e6;
-    QString unit = " S";
-    
-    if( val < 1 )
+    else if( (m_trigMode == Auto) && (last-m_lastShown > timeout) ) // Free run
     {
-        unit = " mS";
-        val = tick/1e3;
-        if( val < 1 )
-        {
-            unit = " uS";
-            val = tick;
-        }
+        display( (double)last-window+1 );
     }
-    m_tickLabel->setText( "Div:  "+QString::number( val,'f', 2)+unit );
-    m_ampLabel->setText(  "Amp: " +QString::number( m_ampli,'f', 2)+" V" );
+    measure( last-m_lastTrig > timeout );
+    updateLabels();
 }
 
-void OscopeWidget::simuClockStep()
+void OscopeWidget::scan( uint64_t from, uint64_t to, double lastComplete )
 {
-    m_step++;
+    ScopeCapture* capture = Simulator::self()->capture();
+    double level = m_auto ? m_autoLevel : m_trigLevel;
 
-    double data = m_oscope->getVolt();
-    double delta = data-m_lastData;
-    
-    if( data > m_max ) m_max = data;
-    if( data < m_min ) m_min = data;
-    
-    if( delta > m_filter )                                     // Rising 
+    for( uint64_t s=from; s<=to; s++ )
     {
-        if( m_reading && m_newRead && ( m_numCycles > 1 ))// Wait for a full wave
-        {
-            double mid = m_min + m_ampli/2;
+        double data = capture->sample( m_channel, s );
 
-            if( data >= mid )                             // Rising edge
+        if( data > m_sMax ) m_sMax = data;
+        if( data < m_sMin ) m_sMin = data;
+
+        if( m_trigFalling )                         // Above level+filter then down to level
+        {
+            if( data > level+m_filter ) m_armed = true;
+            else if( m_armed && (data <= level) )
             {
-                m_numCycles = 0;
-                int per = 1e6/m_freq;
-                if( per > 1 )
-                {
-                    if( m_auto ) 
-                    {
-                        m_Vpos = mid;
-                        m_Hpos = 0;
-                        m_Vscale = 5/m_ampli;
-                        if     ( m_Vscale > 1000 )  m_Vscale = 1000;
-                        else if( m_Vscale < 0.001 ) m_Vscale = 0.001;
-                        
-                        m_Hscale = abs(per/70)+1;
-                        if( m_Hscale > 10000 ) m_Hscale = 10000;
-                    }
-                    Hpos = 0;
-                    m_tick = 0;
-                    m_counter = 0;
-                    m_newRead = false;
-                }
+                m_armed = false;
+                trigger( s, lastComplete );
             }
         }
-        if( m_falling && !m_rising )                        // Min Found
+        else                                        // Below level-filter then up to level
         {
-            m_ampli = m_max-m_min;
-            m_display->setMaxMin( m_max, m_min );
-            m_falling = false;
-            m_max = -1e12;
+            if( data < level-m_filter ) m_armed = true;
+            else if( m_armed && (data >= level) )
+            {
+                m_armed = false;
+                trigger( s, lastComplete );
+            }
         }
-        m_rising = true;
-        m_lastData = data;
     }
-    else if( delta < -m_filter )                              // Falling
+}
+
+void OscopeWidget::trigger( uint64_t step, double lastComplete )
+{
+    if( m_lastTrig ) 
     {
-        if( m_rising && !m_falling )                        // Max Found
-        {
-            if( m_numMax > 0 ) m_totalP += m_step-m_lastMax;
-
-            m_lastMax = m_step;
-            m_numMax++;
-            m_numCycles++;
-            m_ampli = m_max-m_min;
-            m_display->setMaxMin( m_max, m_min );
-            m_rising = false;
-            m_min = 1e12;
-        }
-        m_falling = true;
-        m_lastData = data;
+        m_totalP += step-m_lastTrig;
+        m_numP++;
     }
-    if( m_counter == 140 )                   // DataSet Ready to display
+    m_lastTrig = step;
+
+    if( m_done ) return;                            // Single already captured
+    if( m_pending )
     {
-        m_display->setData( m_data );
-        m_newRead = true;
-        m_reading = false;
-        m_numCycles = 0;
-        m_counter = 0;
-        return; 
+        if( m_trigMode == Single ) return;                // Keep first one
+        if( (double)step > lastComplete ) return; // Keep the one that completes first
     }
-    if( m_newRead == false )                          // Data Set saving
+    m_trigStep = step;                            // Newest with complete window
+    m_pending = true;
+}
+
+void OscopeWidget::measure( bool noTrigger )
+{
+    bool period = (m_numP > 0);
+
+    if( period ) 
+    {
+        m_freq = 1e6*m_numP/(double)m_totalP;              // Steps are 1 us
+        m_totalP = 0;
+        m_numP   = 0;
+    }
+    else if( noTrigger ) m_freq = 0;
+    else return;                                     // Wait for a full period
+
+    if( m_sMax < m_sMin ) return;
+
+    m_ampli = m_sMax-m_sMin;
+    m_autoLevel = m_sMin+m_ampli/2;
+    m_sMax = -1e12;
+    m_sMin =  1e12;
+
+    if( !m_auto ) return;
+
+    m_Vpos = m_autoLevel;
+    if( m_ampli > 1e-6 )
+    {
+        m_Vscale = 5/m_ampli;
+        if     ( m_Vscale > 1000 )  m_Vscale = 1000;
+        else if( m_Vscale < 0.001 ) m_Vscale = 0.001;
+    }
+    if( m_freq > 0 )                                   // Two periods in screen
     {
-        if( m_counter == 140 ) return;          // Done, Wait for update
+        int per = 1e6/m_freq;
+        m_Hscale = per/70+1;
+        if( m_Hscale > 10000 ) m_Hscale = 10000;
+    }
+}
 
-        if( Hpos < m_Hpos ) Hpos++;                 // Wait for H offset
-        else                                                // Save data 
+void OscopeWidget::display( double start )
+{
+    Simulator::self()->capture()->minMax( m_channel, start, m_Hscale, 140, m_min, m_max );
+
+    double max = -1e12;
+    double min =  1e12;
+    for( int i=0; i<140; i++ )
+    {
+        if( m_min[i] > m_max[i] )                           // Not captured
         {
-            if(( m_counter == 0 )||( ++m_tick == m_Hscale ))
-            {
-                m_data[m_counter] = ((data-m_Vpos)*m_Vscale+2.5)*28;
+            m_dataMin[i] = 1;
+            m_dataMax[i] = 0;
+            continue;
+        }
+        if( m_max[i] > max ) max = m_max[i];
+        if( m_min[i] < min ) min = m_min[i];
 
-                m_counter++;
-                m_tick = 0;
-            }
+        double dMin = ((m_min[i]-m_Vpos)*m_Vscale+2.5)*28;
+        double dMax = ((m_max[i]-m_Vpos)*m_Vscale+2.5)*28;
+        if     ( dMin < -5 )  dMin = -5;                  // Keep in screen
+        else if( dMin > 145 ) dMin = 145;
+        if     ( dMax < -5 )  dMax = -5;
+        else if( dMax > 145 ) dMax = 145;
+        m_dataMin[i] = dMin;
+        m_dataMax[i] = dMax;
+    }
+    if( max >= min ) m_display->setMaxMin( max, min );
+    m_display->setData( m_dataMax, m_dataMin );
+}
+
+void OscopeWidget::updateLabels()
+{
+    double freq = m_freq;
+    if     ( freq >= 10000 ) m_freqLabel->setText( "Frq: "+QString::number( freq, 'f', 0 )+" Hz" );
+    else if( freq >= 1000 )  m_freqLabel->setText( "Frq: "+QString::number( freq, 'f', 1 )+" Hz" );
+    else if( freq > 0 )      m_freqLabel->setText( "Frq: "+QString::number( freq, 'f', 2 )+" Hz" );
+    else                     m_freqLabel->setText( "Frq: 000 Hz" );
+        
+    double tick = 20*m_Hscale;
+    double val = tick/1e6;
+    QString unit = " S";
+    
+    if( val < 1 )
+    {
+        unit = " mS";
+        val = tick/1e3;
+        if( val < 1 )
+        {
+            unit = " uS";
+            val = tick;
         }
     }
+    m_tickLabel->setText( "Div:  "+QString::number( val,'f', 2)+unit );
+    m_ampLabel->setText(  "Amp: " +QString::number( m_ampli,'f', 2)+" V" );
 }
 
 void OscopeWidget::HscaleChanged( int Hscale )
@@ -23,6 +23,7 @@
 #include <QtWidgets>
 
 #include "e-element.h"
+#include "scopecapture.h"
 #include "renderoscope.h"
 #include "probe.h"
 
@@ -36,14 +37,28 @@ class MAINMODULE_EXPORT OscopeWidget : public QWidget, public eElement
         OscopeWidget( QWidget *parent );
         ~OscopeWidget();
         
+        enum trigMode_t {
+            Auto = 0,   // Free run if no trigger
+            Normal,     // Hold last capture if no trigger
+            Single      // First capture only, rearmed by clear()
+        };
+
         void setOscope( Oscope* oscope );
         void read();
         void clear();
         void setupWidget( int size );
         double filter()                 { return m_filter; }
         void setFilter( double filter ) { m_filter = filter; }
+
+        int  trigMode() { return m_trigMode; }
+        void setTrigMode( int mode );
+        bool trigFalling()                 { return m_trigFalling; }
+        void setTrigFalling( bool falling ) { m_trigFalling = falling; }
+        double trigLevel()                 { return m_trigLevel; }
+        void setTrigLevel( double level )  { m_trigLevel = level; }
+        double preTrigger()                { return m_preTrigger; }
+        void setPreTrigger( double pre );
         
-        virtual void simuClockStep();
         virtual void resetState();
         
     public slots:
@@ -54,6 +69,13 @@ class MAINMODULE_EXPORT OscopeWidget : public QWidget, public eElement
         void autoChanged( int au );
 
     private:
+        void restart( uint64_t step );
+        void scan( uint64_t from, uint64_t to, double lastComplete );
+        void trigger( uint64_t step, double lastComplete );
+        void measure( bool noTrigger );
+        void display( double start );
+        void updateLabels();
+
         QHBoxLayout* m_horizontalLayout;
         QVBoxLayout* m_verticalLayout;
         
@@ -68,38 +90,47 @@ class MAINMODULE_EXPORT OscopeWidget : public QWidget, public eElement
         RenderOscope* m_display;
         
         Oscope* m_oscope;
+        ScopeChannel* m_channel;
+
+        float m_min[140];      // Min and Max of each column
+        float m_max[140];
+        int m_dataMin[140];
+        int m_dataMax[140];
+
+        // Trigger
+        int    m_trigMode;
+        bool   m_trigFalling;
+        double m_trigLevel;
+        double m_preTrigger;    // % of window before trigger
+        double m_filter;        // Trigger hysteresis
+
+        uint64_t m_scanStep;    // Next step to scan for triggers
+        uint64_t m_trigStep;    // Trigger waiting for its window
+        uint64_t m_lastTrig;    // Last trigger found
+        uint64_t m_lastShown;   // Last trigger displayed
+        bool m_armed;           // Signal crossed level-hysteresis
+        bool m_pending;         // m_trigStep not displayed yet
+        bool m_done;            // Single capture done
+
+        // Measures
+        uint64_t m_totalP;      // Sum of trigger periods
+        int m_numP;
+        double m_freq;
+        double m_ampli;
+        double m_sMax;          // Signal Max and Min since last measure
+        double m_sMin;
+        double m_autoLevel;
         
-        int m_data[140];
-        int m_counter;
-        int m_step;
-        int m_totalP;
-        int m_ticksPs;
-        int m_tick;
-        int m_lastMax;
-        int m_numMax;
-        int m_numCycles;
-        int m_freq;
-        
-        int m_Hscale;
+        int m_Hscale;           // Steps per column
         int m_prevHscale;
-        int Hpos;
-        int m_Hpos;
+        int m_Hpos;             // Window delay in steps
         int m_prevHpos;
         
         double m_Vscale;
         double m_prevVscale;
         double m_Vpos;
         double m_prevVpos;
-        double m_ampli;
-        double m_filter;
-        double m_lastData;
-        double m_max;
-        double m_min;
         
-        bool m_reading;
-        bool m_newRead;
-        bool m_rising;
-        bool m_falling;
         bool m_auto;
 };
 
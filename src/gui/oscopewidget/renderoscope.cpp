@@ -34,7 +34,8 @@ RenderOscope::RenderOscope( int width, int height, QWidget *parent )
     m_scale = ((double)width-30*m_scale)/140;
     m_vMax = 0;
     m_vMin = 0;
-    m_data = 0l;
+    m_dataMax = 0l;
+    m_dataMin = 0l;
 }
 
 QSize RenderOscope::minimumSizeHint() const  {  return QSize( m_width, m_height );  }
@@ -46,9 +47,10 @@ void RenderOscope::setMaxMin( double max, double min )
     m_vMax = max;
     m_vMin = min;
 }
-void RenderOscope::setData( int data[] )
+void RenderOscope::setData( int max[], int min[] )
 {
-    m_data = data;
+    m_dataMax = max;
+    m_dataMin = min;
     update();
 }
 
@@ -77,18 +79,33 @@ void RenderOscope::paintEvent( QPaintEvent* /* event */ )
         p.drawLine( cero, i, end, i );
     }
     
-    if( m_data )
+    if( m_dataMax )
     {
         QPen pen2( QColor( 240, 240, 100 ), 2, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin );
         
         p.setPen( pen2 );
         
-        QPointF lastP = QPointF( m_margin, end-(double)m_data[0]*m_scale );
-        for( int i=1; i<140; i++ )
+        // Max and Min envelopes, vertical line where a column has several values
+        bool last = false;
+        QPointF lastMax, lastMin;
+        for( int i=0; i<140; i++ )
         {
-            QPointF thisP = QPointF( (double)i*m_scale+m_margin, end-(double)m_data[i]*m_scale );
-            p.drawLine( lastP, thisP );
-            lastP = thisP;
+            if( m_dataMin[i] > m_dataMax[i] ) { last = false; continue; }
+
+            double x = (double)i*m_scale+m_margin;
+            QPointF thisMax = QPointF( x, end-(double)m_dataMax[i]*m_scale );
+            QPointF thisMin = QPointF( x, end-(double)m_dataMin[i]*m_scale );
+
+            if( m_dataMax[i] != m_dataMin[i] ) p.drawLine( thisMin, thisMax );
+            if( last )
+            {
+                p.drawLine( lastMax, thisMax );
+                if( (m_dataMin[i] != m_dataMax[i]) || (lastMin != lastMax) )
+                    p.drawLine( lastMin, thisMin );
+            }
+            lastMax = thisMax;
+            lastMin = thisMin;
+            last = true;
         }
     }
     
@@ -33,7 +33,7 @@ class RenderOscope : public QWidget
         QSize minimumSizeHint() const;
         QSize sizeHint() const;
 
-        void setData( int data[] );
+        void setData( int max[], int min[] ); // Column empty if min > max
         void setMaxMin( double max, double min );
 
     protected:
@@ -42,7 +42,8 @@ class RenderOscope : public QWidget
     private:
         int m_width;
         int m_height;
-        int* m_data;
+        int* m_dataMax;
+        int* m_dataMin;
         
         double m_hCenter;
         double m_vCenter;
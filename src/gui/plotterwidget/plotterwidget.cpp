@@ -17,6 +17,9 @@
  *                                                                         *
  ***************************************************************************/
 
+#include <cmath>
+#include <algorithm>
+
 #include "plotterwidget.h"
 #include "renderarea.h"
 #include "mainwindow.h"
@@ -24,6 +27,8 @@
 
 PlotterWidget* PlotterWidget::m_pSelf = 0l;
 
+static const int historyBits = 20;              // 1M samples per channel
+
 PlotterWidget::PlotterWidget(  QWidget *parent  )
              : QWidget( parent )
 {
@@ -35,160 +40,298 @@ PlotterWidget::PlotterWidget(  QWidget *parent  )
     setMinimumSize(QSize(200, 200));
     setMaximumSize(QSize(1000, 200));
 
-    m_color[0] = QColor( 190, 190, 0 );
-    m_color[1] = QColor( 255, 110, 50 );
-    m_color[2] = QColor( 100, 120, 255 );
-    m_color[3] = QColor( 0, 230, 100 );
-
-    setupWidget();
-    
     m_maxVolt = 500;
     m_minVolt = -500;
     m_offset  = 0;
     m_numTracks = 1;
     m_xScale = 1;
+    m_sampleUs = 1000;
 
-    m_rArea->setAntialiased(true);
+    m_mask = (1ull<<historyBits)-1;
+    m_samples    = 0;
+    m_lastSample = 0;
 
-    m_ticksPs = 20;
-    m_counter = 0;
-    m_numchan = 0;
+    setupWidget();
 
-    for( int i=0; i<4; i++ )
-    {
-        m_data[i] = -1000;
-        m_channel[i] = false;
-    }
-    xScaleChanged( 1 );
+    m_rArea->setAntialiased(true);
+
+    xScaleChanged( 16 );
+    setSampleUs( 1000 );
     clear();
 }
-PlotterWidget::~PlotterWidget(){ }
+PlotterWidget::~PlotterWidget()
+{
+    foreach( PlotterChannel* ch, m_channels ) delete ch;
+}
 
 void PlotterWidget::clear()
 {
-    int numchan = m_numchan;
-    m_numchan = 1;
-    for( int i=0; i<1000; i++ ) step();
-    m_numchan = numchan;
+    m_samples    = 0;
+    m_lastSample = 0;
+    foreach( PlotterChannel* ch, m_channels ) 
+        std::fill( ch->data.begin(), ch->data.end(), NAN );
+
+    updateScroll();
+    render();
 }
 
-/*int PlotterWidget::getChannel()
+int PlotterWidget::getChannel()
 {
-    for( int i=0; i<4; i++ )                   // Find available channel
+    int channel = 1;
+    foreach( PlotterChannel* ch, m_channels )    // Sorted: first gap
     {
-        if( m_channel[i] == true ) continue;
-
-        addChannel( i+1 );
-        return i+1;                    // return channel number assigned
+        if( ch->number != channel ) break;
+        channel++;
     }
-    return 0;                              // -1 = not channel available
-}*/
+    return channel;
+}
+
+PlotterChannel* PlotterWidget::channel( int number )
+{
+    foreach( PlotterChannel* ch, m_channels ) 
+        if( ch->number == number ) return ch;
+    return 0l;
+}
 
 bool PlotterWidget::addChannel( int channel )
 {
-    channel--;
-    
-    if( m_channel[channel] ) return false;
-    m_numchan++;                                    // Inc used channels
-    m_channel[channel] = true;                    // Set channel to busy
-    m_chanLabel[channel]->setEnabled( true );
-    m_chanLabel[channel]->setText( " 0.00 V" );
-    if( m_numchan > 0 ) setVisible( true );
+    if( channel < 1 || this->channel( channel ) ) return false;
+
+    PlotterChannel* ch = new PlotterChannel;
+    ch->number = channel;
+    ch->color  = getColor( channel );
+    ch->data.assign( m_mask+1, NAN );
+    ch->last   = 0;
+
+    QFont font;
+    font.setPixelSize( 14*MainWindow::self()->fontScale() );
+
+    ch->label = new QLineEdit( this );
+    ch->label->setObjectName( "voltLabel"+QString::number( channel ) );
+    ch->label->setAlignment(Qt::AlignRight|Qt::AlignTrailing|Qt::AlignVCenter);
+    ch->label->setMaxLength(9);
+    ch->label->setFont(font);
+    ch->label->setAcceptDrops(false);
+    ch->label->setReadOnly(true);
+    ch->label->setFixedHeight(20);
+    ch->label->setFixedWidth(85);
+
+    QPalette p = ch->label->palette();
+    p.setColor( QPalette::Active, QPalette::Base, ch->color );
+    ch->label->setPalette(p);
+    setLabel( ch );
+
+    int pos = 0;                                   // Keep sorted by number
+    while( pos < m_channels.size() && m_channels.at(pos)->number < channel ) pos++;
+
+    bool pauseSim = Simulator::self()->isRunning();
+    if( pauseSim ) Simulator::self()->pauseSim();
+
+    m_channels.insert( pos, ch );
+    Simulator::self()->plotSampler()->addChannel( channel );
+    Simulator::self()->plotSampler()->setPeriod( m_sampleUs ); // Simulator may be new
+
+    if( pauseSim ) Simulator::self()->resumeSim();
+
+    m_chanLayout->insertWidget( pos, ch->label );
+    setVisible( true );
+    render();
     return true;
 }
 
 void PlotterWidget::remChannel( int channel )
 {
-    channel--;
-    if( channel < 0 || channel > 3 || m_channel[channel] == false ) return; // Nothing to do
-    
-    setData( channel+1, 0 );
-
-    m_numchan--;                                // Decrease used channel
-    m_channel[channel] = false;               // Set channel to not busy
-    m_chanLabel[channel]->setEnabled( false );  // Disable channel label
-    //m_data[channel] = 0;                                   // reset data
-    m_chanLabel[channel]->setText( "--.-- V" );
-    m_rArea->setData( channel, 0 );
-    
-    if( m_numchan == 0 )               // Hide this if no channel active
+    PlotterChannel* ch = this->channel( channel );
+    if( !ch ) return;                                       // Nothing to do
+
+    bool pauseSim = Simulator::self()->isRunning();
+    if( pauseSim ) Simulator::self()->pauseSim();
+
+    m_channels.removeOne( ch );
+    Simulator::self()->plotSampler()->remChannel( channel );
+
+    if( pauseSim ) Simulator::self()->resumeSim();
+
+    delete ch->label;
+    delete ch;
+
+    if( m_channels.isEmpty() )           // Hide this if no channel active
     {
         setVisible( false );
         clear();
     }
+    else render();
 }
 
-QColor PlotterWidget::getColor( int channel )
+void PlotterWidget::setChannelPin( int channel, ePin* pin )
 {
-    channel--;
-    return m_color[channel];
+    Simulator::self()->plotSampler()->setPin( channel, pin );
 }
 
-void PlotterWidget::step()
+QColor PlotterWidget::getColor( int channel )
 {
-    if( m_numchan == 0 ) return; // No data to plot
-
-    if( ++m_counter >= m_ticksPs )
+    switch( channel )
     {
-        m_counter = 0;
-        m_rArea->drawVmark();
+        case 1: return QColor( 190, 190, 0 );
+        case 2: return QColor( 255, 110, 50 );
+        case 3: return QColor( 100, 120, 255 );
+        case 4: return QColor( 0, 230, 100 );
     }
-    for( int i=0; i<4; i++ )                   // Find available channel
-    {
-        if( m_channel[i] == false ) setRenderData( i, 1e9 ); // Don't plot
-        else                        setRenderData( i, m_data[i] );
-    }
-    m_rArea->printData();
+    return QColor::fromHsv( (channel*67)%360, 200, 255 );
 }
-    
+
 void PlotterWidget::updateStep()
 {
-    m_rArea->update();
+    PlotSampler* sampler = Simulator::self()->plotSampler();
+    PlotterChannel* ch = 0l;
+    bool newData = false;
+
+    PlotSample s;
+    while( sampler->pop( s ) )
+    {
+        if( s.sample != m_lastSample )                      // Next sample
+        {
+            m_lastSample = s.sample;
+            uint64_t index = m_samples++ & m_mask;
+            foreach( PlotterChannel* c, m_channels ) c->data[index] = NAN;
+        }
+        if( !ch || ch->number != s.channel )
+        {
+            ch = channel( s.channel );
+            if( !ch ) continue;                        // Removed meanwhile
+        }
+        ch->data[(m_samples-1) & m_mask] = s.volt;
+        ch->last = s.volt;
+        newData = true;
+    }
+    if( !newData ) return;
+
+    foreach( PlotterChannel* c, m_channels ) setLabel( c );
+    updateScroll();
+    render();
 }
 
-void PlotterWidget::setData( int channel, int data )
+void PlotterWidget::setLabel( PlotterChannel* ch )
 {
-    channel--;
-    if( data == m_data[channel] ) return;
-
-    float vf = data;
+    float vf = int( ch->last*100 );
     vf = vf/100;
     QString volt;
     volt.setNum( vf );
     if( !volt.contains(".") ) volt.append(".00");
     else if( volt.split(".").last().length() == 1 ) volt.append("0");
     volt.append( " V" );
-    m_chanLabel[channel]->setText( volt );   // Update volt Label
-    if( data>m_maxVolt || data<m_minVolt ) data = 1e9;
-    m_data[channel] = data;
-    //setRenderData( channel, data );
+    ch->label->setText( volt );   // Update volt Label
 }
 
-void PlotterWidget::setRenderData( int channel, int data )
+void PlotterWidget::updateScroll()
 {
-    int renderData = data*1000/(m_maxVolt-m_minVolt)-m_offset;
-    renderData /= m_numTracks;
+    uint64_t held = m_samples;
+    if( held > m_mask+1 ) held = m_mask+1;
 
-    if( m_numTracks == 2 )
+    uint64_t visible = (uint64_t)m_rArea->columns()*m_xScale;
+    int max = 0;
+    if( held > visible ) max = (held-visible)/m_xScale;
+
+    bool live = ( m_scroll->value() == m_scroll->maximum() );
+
+    m_scroll->blockSignals( true );
+    if( live ) 
     {
-        if( channel > 1 ) renderData -= 250;
-        else              renderData += 250;
+        m_scroll->setMaximum( max );
+        m_scroll->setValue( max );                            // Follow new samples
     }
-    else if( m_numTracks == 4 )
+    else                                               // Keep same samples in view
     {
-        renderData += 375-channel*250;
+        int back = m_scroll->maximum()-m_scroll->value();
+        m_scroll->setMaximum( max );
+        m_scroll->setValue( max-back );
     }
-    m_rArea->setData( channel, renderData );
+    m_scroll->setPageStep( m_rArea->columns() );
+    m_scroll->blockSignals( false );
+}
+
+void PlotterWidget::scrollChanged( int )
+{
+    render();
 }
 
-void PlotterWidget::setTicksPs( int tps )
+int PlotterWidget::renderData( int track, double volt )
 {
-    m_ticksPs = tps;
+    int data = volt*100;
+    if     ( data > m_maxVolt ) data = m_maxVolt;
+    else if( data < m_minVolt ) data = m_minVolt;
+
+    int renderData = data*1000/(m_maxVolt-m_minVolt)-m_offset;
+    renderData /= m_numTracks;
+    renderData += 500-(2*track+1)*500/m_numTracks;               // Track center
+
+    return renderData;
 }
 
-void PlotterWidget::setPlotterTick( int tickUs )
+void PlotterWidget::render() // Min and Max of samples in each column
 {
-    m_rArea->setTick( tickUs );
+    int cols = m_rArea->columns();
+
+    uint64_t held = m_samples;
+    if( held > m_mask+1 ) held = m_mask+1;
+    int64_t first = m_samples-held;
+
+    int64_t back  = (int64_t)(m_scroll->maximum()-m_scroll->value())*m_xScale;
+    int64_t end   = (int64_t)m_samples-back;
+    int64_t start = end-(int64_t)cols*m_xScale;         // Sample at column 0
+
+    int64_t markSamples = 100*m_xScale;                 // Vertical mark every 100 columns
+    int64_t mark = ( start >= 0 ) ? (start+markSamples-1)/markSamples : -((-start)/markSamples);
+    m_rArea->setGrid( (mark*markSamples-start)/m_xScale, mark );
+
+    QVector<int> max( cols );
+    QVector<int> min( cols );
+
+    int numChan = m_channels.size();
+    int places = ( numChan > m_numTracks ) ? numChan : m_numTracks;
+    m_rArea->setNumTraces( numChan );
+
+    for( int c=0; c<numChan; c++ )
+    {
+        PlotterChannel* ch = m_channels.at(c);
+        const float* data = ch->data.data();
+        int track = c*m_numTracks/places;
+
+        for( int col=0; col<cols; col++ )
+        {
+            int64_t s = start+(int64_t)col*m_xScale;
+            int64_t e = s+m_xScale;
+            if( s < first ) s = first;
+
+            float mx = -1e30;
+            float mn =  1e30;
+            for( ; s<e; s++ )
+            {
+                float v = data[s & m_mask];
+                if( std::isnan( v ) ) continue;
+                if( v > mx ) mx = v;
+                if( v < mn ) mn = v;
+            }
+            if( mn > mx ) { max[col] = 0; min[col] = 1; continue; } // No samples
+
+            max[col] = renderData( track, mx );
+            min[col] = renderData( track, mn );
+        }
+        QPen pen( ch->color, 2.5, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin );
+        m_rArea->setTrace( c, pen, max, min );
+    }
+    m_rArea->update();
+}
+
+void PlotterWidget::setSampleUs( int us )
+{
+    if( us < 1 ) us = 1;
+    m_sampleUs = us;
+    m_sampleBox->setValue( us );
+
+    Simulator::self()->plotSampler()->setPeriod( us );      // Steps are 1 us
+    m_rArea->setTick( 100*m_xScale*m_sampleUs );
+    m_rArea->update();
 }
 
 double PlotterWidget::maxVolt() 
@@ -236,37 +379,29 @@ void  PlotterWidget::xScaleChanged( int scale )
 {
     if( scale == m_xScale ) return;
     
-    if( scale == 3 )
+    if     ( scale == m_xScale+1 ) scale = m_xScale*2;          // Spin up
+    else if( scale == m_xScale-1 ) scale = m_xScale/2;          // Spin down
+    else                                               // Powers of 2
     {
-        if( m_xScale == 2 ) scale = 4;
-        else                scale = 2;
+        int sc = 1;
+        while( sc < scale ) sc <<= 1;
+        scale = sc;
     }
+    if     ( scale < 1 )    scale = 1;
+    else if( scale > 1024 ) scale = 1024;
+
     m_xScale = scale;
     m_XScale->setValue( scale );
     
-    m_ticksPs = 20;
-    int timSc = 1;
-    
-    if( scale > 1) 
-    {
-        timSc = 2;
-        m_ticksPs = 40;
-    }
-    Simulator::self()->setTimerScale( timSc );
-    Simulator::self()->simuRateChanged( Simulator::self()->simuRate() );
-    
-    if( scale > 2 ) scale = 2;
-    else            scale = 1;
-    m_rArea->setXScale( scale );
+    m_rArea->setTick( 100*m_xScale*m_sampleUs );
+    updateScroll();
+    render();
 }
 
 void PlotterWidget::setScale()
 {
     m_offset = (m_maxVolt+m_minVolt)*500/(m_maxVolt-m_minVolt);
-    m_rArea->setZero( -m_offset );
-    
-    for( int i=0; i<4; i++ ) 
-        if( m_channel[i] ) setRenderData( i, m_data[i] );
+    render();
 }
 
 int PlotterWidget::tracks()
@@ -277,13 +412,11 @@ int PlotterWidget::tracks()
 void PlotterWidget::setTracks( int tracks )
 {
     if( tracks == m_numTracks ) return;
-    if( tracks == 3 )
-    {
-        if( m_numTracks == 2 ) tracks = 4;
-        else                   tracks = 2;
-    }
+    if( tracks < 1 ) tracks = 1;
+
     m_numTracks = tracks;
     m_tracks->setValue( tracks );
+    render();
 }
 
 void PlotterWidget::setupWidget()
@@ -297,29 +430,20 @@ void PlotterWidget::setupWidget()
     m_verticalLayout->setContentsMargins(0, 0, 0, 0);
     m_verticalLayout->setSpacing(1);
 
-    QFont font;
-    font.setPixelSize( 14*MainWindow::self()->fontScale() );
+    QWidget* chanWidget = new QWidget();          // Volt Labels, one per channel
+    m_chanLayout = new QVBoxLayout( chanWidget );
+    m_chanLayout->setContentsMargins(0, 0, 0, 0);
+    m_chanLayout->setSpacing(1);
+    m_chanLayout->addStretch();
+
+    QScrollArea* chanArea = new QScrollArea( this );
+    chanArea->setWidget( chanWidget );
+    chanArea->setWidgetResizable( true );
+    chanArea->setFrameShape( QFrame::NoFrame );
+    chanArea->setHorizontalScrollBarPolicy( Qt::ScrollBarAlwaysOff );
+    chanArea->setFixedWidth( 100 );
+    m_verticalLayout->addWidget( chanArea );
 
-    for( int i=0; i<4; i++ )    // Create volt Labels
-    {
-        m_chanLabel[i] = new QLineEdit( this );
-        m_chanLabel[i]->setObjectName(QString::fromUtf8("voltLabel"+i));
-        m_chanLabel[i]->setAlignment(Qt::AlignRight|Qt::AlignTrailing|Qt::AlignVCenter);
-        m_chanLabel[i]->setMaxLength(7);
-        m_chanLabel[i]->setFont(font);
-        m_chanLabel[i]->setAcceptDrops(false);
-        m_chanLabel[i]->setReadOnly(true);
-        m_chanLabel[i]->setText("--.-- V");
-        m_chanLabel[i]->setFixedHeight(20);
-        m_chanLabel[i]->setFixedWidth(85);
-        m_chanLabel[i]->setVisible( true );
-        m_chanLabel[i]->setEnabled( false );
-
-        QPalette p = m_chanLabel[i]->palette();
-        p.setColor( QPalette::Active, QPalette::Base, m_color[i] );
-        m_chanLabel[i]->setPalette(p);
-        m_verticalLayout->addWidget( m_chanLabel[i] );
-    }
     QFrame* line = new QFrame();
     line->setFrameShape(QFrame::HLine);
     line->setFrameShadow(QFrame::Sunken);
@@ -347,7 +471,7 @@ void PlotterWidget::setupWidget()
                    
     m_XScale = new QSpinBox( this );
     m_XScale->setSizePolicy(QSizePolicy::Ignored,QSizePolicy::Ignored);
-    m_XScale->setMaximum( 4 );
+    m_XScale->setMaximum( 1024 );
     m_XScale->setMinimum( 1 );
     m_XScale->setPrefix( tr("Scale:   ") );
     m_XScale->setValue( 1 );
@@ -357,27 +481,42 @@ void PlotterWidget::setupWidget()
                    
     m_tracks = new QSpinBox( this );
     m_tracks->setSizePolicy(QSizePolicy::Ignored,QSizePolicy::Ignored);
-    m_tracks->setMaximum( 4 );
+    m_tracks->setMaximum( 8 );
     m_tracks->setMinimum( 1 );
     m_tracks->setPrefix( tr("Tracks: ") );
     m_tracks->setValue( 1 );
     m_verticalLayout->addWidget( m_tracks );
     connect( m_tracks, SIGNAL( valueChanged(int) ),
                  this, SLOT( setTracks(int) ));
+
+    m_sampleBox = new QSpinBox( this );
+    m_sampleBox->setSizePolicy(QSizePolicy::Ignored,QSizePolicy::Ignored);
+    m_sampleBox->setMaximum( 1000000 );
+    m_sampleBox->setMinimum( 1 );
+    m_sampleBox->setPrefix( tr("Rate: ") );
+    m_sampleBox->setSuffix( tr(" us") );
+    m_sampleBox->setValue( m_sampleUs );
+    m_verticalLayout->addWidget( m_sampleBox );
+    connect( m_sampleBox, SIGNAL( valueChanged(int) ),
+                    this, SLOT( setSampleUs(int) ));
         
     m_horizontalLayout->addLayout( m_verticalLayout );
 
-    m_rArea = new RenderArea( 1000, 180, this );
+    QVBoxLayout* plotLayout = new QVBoxLayout();
+    plotLayout->setContentsMargins(0, 0, 0, 0);
+    plotLayout->setSpacing(0);
+
+    m_rArea = new RenderArea( 1000, 166, this );
     m_rArea->setObjectName( "oscope" );
+    plotLayout->addWidget( m_rArea );
 
-    QPen pen( m_color[0], 2.5, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin );
+    m_scroll = new QScrollBar( Qt::Horizontal, this );   // History, right end: live
+    m_scroll->setRange( 0, 0 );
+    plotLayout->addWidget( m_scroll );
+    connect( m_scroll, SIGNAL( valueChanged(int) ),
+                 this, SLOT( scrollChanged(int) ));
 
-    for( int i=0; i<4; i++ )
-    {
-        pen.setColor( m_color[i] );
-        m_rArea->setPen( i, pen );
-    }
-    m_horizontalLayout->addWidget(m_rArea);
+    m_horizontalLayout->addLayout( plotLayout );
 }
 
 #include "moc_plotterwidget.cpp"
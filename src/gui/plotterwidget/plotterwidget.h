@@ -21,18 +21,32 @@
 #define PLOTTERWIDGET_H
 
 #include <QtWidgets>
+#include <vector>
+#include <stdint.h>
 
 class RenderArea;
+class ePin;
+
+// One Plotter channel: history of samples in a ring, NaN = no sample
+struct PlotterChannel
+{
+    int        number;
+    QColor     color;
+    QLineEdit* label;
+    std::vector<float> data;
+    float      last;
+};
 
 class MAINMODULE_EXPORT PlotterWidget : public QWidget
 {
     Q_OBJECT
     
     Q_PROPERTY( QString  itemtype  READ itemType )
-    Q_PROPERTY( double MaxVolt READ maxVolt  WRITE setMaxVolt )
-    Q_PROPERTY( double MinVolt READ minVolt  WRITE setMinVolt )
-    Q_PROPERTY( int    Scale   READ xScale    WRITE xScaleChanged )
-    Q_PROPERTY( int    Tracks  READ tracks   WRITE setTracks )
+    Q_PROPERTY( double MaxVolt  READ maxVolt  WRITE setMaxVolt )
+    Q_PROPERTY( double MinVolt  READ minVolt  WRITE setMinVolt )
+    Q_PROPERTY( int    Scale    READ xScale   WRITE xScaleChanged )
+    Q_PROPERTY( int    Tracks   READ tracks   WRITE setTracks )
+    Q_PROPERTY( int    SampleUs READ sampleUs WRITE setSampleUs )
 
     public:
         PlotterWidget( QWidget *parent );
@@ -42,17 +56,14 @@ class MAINMODULE_EXPORT PlotterWidget : public QWidget
  
         QString itemType(){ return "Plotter"; }
 
-        //int  getChannel();
+        int  getChannel();              // First free channel number
         bool addChannel( int channel );
         void remChannel( int channel );
+        void setChannelPin( int channel, ePin* pin ); // Circuit stopped
 
         QColor getColor( int channel );
 
         void clear();
-        void step();
-        void setData( int channel, int data );
-        void setTicksPs( int tps );
-        void setPlotterTick( int tickUs );
         
         double maxVolt();
         void setMaxVolt( double volt );
@@ -60,45 +71,55 @@ class MAINMODULE_EXPORT PlotterWidget : public QWidget
         double minVolt();
         void setMinVolt( double volt );
         
-        int xScale() { return m_xScale; }
+        int xScale() { return m_xScale; }   // Samples per pixel
         
         int tracks();
-        
-        void updateStep();
-        
 
+        int sampleUs() { return m_sampleUs; }
+
+        void updateStep();              // Take new samples, circuit running
+        
     public slots:
         void maxChanged( double value );
         void minChanged( double value );
         void xScaleChanged( int scale );
         void setTracks( int tracks );
+        void setSampleUs( int us );
+        void scrollChanged( int value );
         
     private:
  static PlotterWidget* m_pSelf;
 
         void setupWidget();
-        void setRenderData( int channel, int data );
         void setScale();
+        void setLabel( PlotterChannel* ch );
+        void updateScroll();
+        void render();
+        int  renderData( int track, double volt );
+
+        PlotterChannel* channel( int number );
 
         QHBoxLayout* m_horizontalLayout;
         QVBoxLayout* m_verticalLayout;
-        QLineEdit*   m_chanLabel[4];
+        QVBoxLayout* m_chanLayout;
         QDoubleSpinBox* m_maxValue;
         QDoubleSpinBox* m_minValue;
         QSpinBox*       m_XScale;
         QSpinBox*       m_tracks;
+        QSpinBox*       m_sampleBox;
+        QScrollBar*     m_scroll;
 
         RenderArea*  m_rArea;
 
-        QColor m_color[4];
+        QList<PlotterChannel*> m_channels;   // Sorted by number
+
+        uint64_t m_mask;        // History ring: depth-1
+        uint64_t m_samples;     // Samples received
+        uint64_t m_lastSample;  // Sampler number of last one
 
-        bool m_channel[4];
-        int  m_data[4];
-        int  m_numchan;
-        int  m_counter;
-        int  m_ticksPs;
         int  m_xScale;
         int  m_numTracks;
+        int  m_sampleUs;
         
         int m_maxVolt;
         int m_minVolt;
@@ -106,4 +127,3 @@ class MAINMODULE_EXPORT PlotterWidget : public QWidget
 };
 
 #endif
-
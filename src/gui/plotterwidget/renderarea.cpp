@@ -29,70 +29,15 @@
 
      m_width  = width; //1000;
      m_height = height; //180;
-     setZero( 0 );
-     setXScale( 1 );
-
-     QFont font;
-     font.setPixelSize(9);
-     pixmap = QPixmap( m_width, m_height );
-     QPainter p( &pixmap );
-     p.setFont( font );
-     p.end();
-
-     //drawBackground();
-     for( int i=0; i<4; i++ )
-     {
-         m_data[i] = 0;
-         m_dataP[i] = 0;
-     }
-
-     m_sec = 0;
- }
 
-void RenderArea::drawVmark()
-{
-    m_sec++;
-
-    int last = m_width-m_xScale;
-    QString sec = "";
-
-    QPainter p( &pixmap );
-    /*if( m_sec == 10 )
-     {
-         m_sec = 0;
-         p.setPen( QColor( 90, 90, 150 ) );
-     }
-     else p.setPen( QColor( 50, 50, 100 ) );*/
-    if( m_sec == 10 )
-    {
-        m_sec = 0;
-        QPen pen( QColor( 170, 170, 255 ), 1, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin );
-        p.setPen( pen );
-    }
-    else 
-    {
-        QPen pen( QColor( 100, 100, 200 ), 1, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin );
-        p.setPen( pen );
-    }
-    sec.setNum(m_sec);
-
-    //int base = m_height-20;
-
-    p.drawLine( last, 0, last, m_height );
-    //p.drawText( last-10, base-5, 10, 20, Qt::AlignHCenter, sec );
-    p.end();
-}
+     m_gridCol  = 0;
+     m_gridMark = 0;
+ }
 
  QSize RenderArea::minimumSizeHint() const  {  return QSize( 100, 150 );  }
 
  QSize RenderArea::sizeHint() const  { return QSize( 400, 200 ); }
 
- void RenderArea::setPen( int channel, const QPen &pen )
- {
-     this->m_pen[channel] = pen;
-     //update();
- }
-
  void RenderArea::setBrush( const QBrush &brush )
  {
      this->brush = brush;
@@ -105,64 +50,55 @@ void RenderArea::drawVmark()
      //update();
  }
 
-void RenderArea::setData( const int channel, int data )
+int RenderArea::toY( int data )
 {
     data = (data/2+250)*m_height/520;
-    data = m_height-data-4;
-    m_dataP[channel] = m_data[channel];
-    m_data[channel] = data;
-}
- 
-void RenderArea::setZero( int zero )
-{
-    int zero0 = zero/2-250;
-    m_zero0 = (zero0/2+250)*m_height/520;
-    m_zero0 = m_height-m_zero0-4;
-    
-    int zero1 = zero/2+250;
-    m_zero1 = (zero1/2+250)*m_height/520;
-    m_zero1 = m_height-m_zero1-4;
+    return m_height-data-4;
 }
 
-void RenderArea::setXScale( int scale )
+void RenderArea::setNumTraces( int traces )
 {
-    m_xScale = scale;
+    while( m_pen.size() > traces )
+    {
+        m_pen.removeLast();
+        m_max.removeLast();
+        m_min.removeLast();
+    }
+    while( m_pen.size() < traces )
+    {
+        m_pen.append( QPen() );
+        m_max.append( QVector<int>() );
+        m_min.append( QVector<int>() );
+    }
 }
 
-void RenderArea::printData()
+void RenderArea::setTrace( int trace, const QPen &pen, const QVector<int> &max, const QVector<int> &min )
 {
-    pixmap.scroll( -m_xScale, 0, pixmap.rect() );
+    if( trace >= m_pen.size() ) setNumTraces( trace+1 );
 
-    QPainter p( &pixmap );
-    
-    int last = m_width-m_xScale;
-    
-    //p.setPen( QColor( 10, 15, 50 ) );
-    QPen pen( QColor( 5, 10, 30 ), 1, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin );
-    p.setPen( pen );
-    
-    for( int i=0; i<m_xScale; i++ )
-    {
-        p.drawLine( last+i, 0, last+i, m_height ); // erase previous line
-
-        /*p.setPen( QColor( 150, 150, 170 ) );
-        p.drawLine( last-m_xScale, m_zero0, last, m_zero0 ); // Linea de base ( 0 ch 0-1)
-        p.drawLine( last-m_xScale, m_zero1, last, m_zero1 ); // Linea de base ( 0 ch 2-3)
-        //p.drawLine( last-1, m_height-33, last, m_height-33 );*/
-    }
-    if( antialiased ) p.setRenderHint( QPainter::Antialiasing, true );
+    m_pen[trace] = pen;
+    QVector<int> &tMax = m_max[trace];
+    QVector<int> &tMin = m_min[trace];
+    tMax.resize( max.size() );
+    tMin.resize( min.size() );
 
-    for( int i=0; i<4; i++ )
+    for( int i=0; i<max.size(); i++ )
     {
-        int data  = m_data[i];
-        int dataP = m_dataP[i];
-        if(( data > 60000 ) || ( dataP > 60000 )) continue;
-        
-        p.setPen( m_pen[i] );
-        p.drawLine( last-m_xScale, dataP, last, data );
-        m_dataP[i] = data;
+        if( min[i] > max[i] )                        // Empty: keep min > max
+        {
+            tMax[i] = -1;
+            tMin[i] = 0;
+            continue;
+        }
+        tMax[i] = toY( max[i] );                   // Y grows down
+        tMin[i] = toY( min[i] );
     }
-    p.end();
+}
+
+void RenderArea::setGrid( int firstCol, int firstMark )
+{
+    m_gridCol  = firstCol;
+    m_gridMark = firstMark;
 }
  
 void RenderArea::setTick( int tickUs )
@@ -190,12 +126,45 @@ void RenderArea::paintEvent( QPaintEvent * /* event */ )
 {
     QPainter painter( this );
 
-    //painter.drawPixmap( 0, 0, pixmap );
-    int origX = width()-m_width;
-    //int origy = 0; //height(),
-    painter.drawPixmap( origX, 0, /*m_width, height(),*/ pixmap );
-    painter.setPen( QColor( 255, 255, 255 ) );
+    int origX = width()-m_width;      // Right side is the newest
+    painter.translate( origX, 0 );
+    painter.fillRect( 0, 0, m_width, m_height, QColor( 5, 10, 30 ) );
+
+    int mark = m_gridMark;
+    for( int x=m_gridCol; x<m_width; x+=100 )
+    {
+        QColor color = ( mark%10 == 0 ) ? QColor( 170, 170, 255 ) : QColor( 100, 100, 200 );
+        painter.setPen( QPen( color, 1, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin ) );
+        painter.drawLine( x, 0, x, m_height );
+        mark++;
+    }
+    if( antialiased ) painter.setRenderHint( QPainter::Antialiasing, true );
+
+    // Max and Min polylines, vertical line where a column has several values
+    for( int t=0; t<m_pen.size(); t++ )
+    {
+        painter.setPen( m_pen[t] );
 
+        const QVector<int> &max = m_max[t];
+        const QVector<int> &min = m_min[t];
+        bool last = false;
+
+        for( int i=0; i<max.size(); i++ )
+        {
+            if( min[i] < max[i] ) { last = false; continue; }      // Empty
+
+            if( min[i] != max[i] ) painter.drawLine( i, min[i], i, max[i] );
+            if( last )
+            {
+                painter.drawLine( i-1, max[i-1], i, max[i] );
+                if( (min[i] != max[i]) || (min[i-1] != max[i-1]) )
+                    painter.drawLine( i-1, min[i-1], i, min[i] );
+            }
+            last = true;
+        }
+    }
+    painter.translate( -origX, 0 );
+    painter.setPen( QColor( 255, 255, 255 ) );
     painter.drawText( 0, 5, 100, 20, Qt::AlignHCenter, "Tick: "+m_tick );
 
     painter.end();
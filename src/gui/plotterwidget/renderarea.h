@@ -35,17 +35,16 @@ class RenderArea : public QWidget
         QSize minimumSizeHint() const;
         QSize sizeHint() const;
 
-        void setData( const int channel, int data );
-        void printData();
-        void drawVmark();
-         
+        int columns() { return m_width; }
+
+        // Min and Max of each column (-500 to 500), column empty if min > max
+        void setTrace( int trace, const QPen &pen, const QVector<int> &max, const QVector<int> &min );
+        void setNumTraces( int traces );
+
+        void setGrid( int firstCol, int firstMark ); // Vertical marks every 100 columns
         void setTick( int tickUs );
-        
-        void setZero( int zero );
-        void setXScale( int scale );
 
     public slots:
-        void setPen( const int channel, const QPen &pen );
         void setBrush( const QBrush &brush );
         void setAntialiased( const bool antialiased );
 
@@ -53,22 +52,21 @@ class RenderArea : public QWidget
         void paintEvent( QPaintEvent *event );
 
     private:
-        QPen m_pen[4];
+        int toY( int data );
+
         QBrush brush;
         bool antialiased;
-        QPixmap pixmap;
 
-        int m_data[4];
-        int m_dataP[4];
+        QList<QPen>         m_pen;
+        QList<QVector<int>> m_max;     // Already in pixels
+        QList<QVector<int>> m_min;
+
         int m_width;
         int m_height;
-        int m_sec;
-        int m_zero0;
-        int m_zero1;
-        int m_xScale;
+        int m_gridCol;
+        int m_gridMark;
          
         QString m_tick;
  };
 
  #endif
-
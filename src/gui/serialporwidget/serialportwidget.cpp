@@ -76,6 +76,7 @@ SerialPortWidget::SerialPortWidget( QWidget *parent )
     m_pSelf = this;
     
     m_serial = new QSerialPort( this );
+    m_processor = 0l;
 
     intValidator = new QIntValidator( 0, 4000000, this );
 
@@ -204,7 +205,9 @@ void SerialPortWidget::readData()
 
     //qDebug()<<"SerialPortWidget::readData" << data;
 
-    for( int i=0; i<data.size(); i++ ) BaseProcessor::self()->uartIn( data.at(i) );
+    if( !m_processor ) return;
+    
+    for( int i=0; i<data.size(); i++ ) m_processor->uartIn( data.at(i) );
 }
 
 void SerialPortWidget::writeData( const QByteArray &data )
@@ -65,6 +65,7 @@ class SerialPortWidget;
 }
 
 class QIntValidator;
+class BaseProcessor;
 
 
 class SerialPortWidget : public QWidget
@@ -103,6 +104,9 @@ class SerialPortWidget : public QWidget
         
  static SerialPortWidget* self() { return m_pSelf; }
 
+        BaseProcessor* processor() { return m_processor; }
+        void setProcessor( BaseProcessor* proc ) { m_processor = proc; }
+
         Settings settings() const;
 
         void writeData( const QByteArray &data );
@@ -134,6 +138,7 @@ class SerialPortWidget : public QWidget
         Settings       currentSettings;
         QIntValidator* intValidator;
         QSerialPort*   m_serial;
+        BaseProcessor* m_processor;   // Mcu attached to the port
 };
 
 #endif // SETTINGSDIALOG_H
@@ -54,18 +54,26 @@ void OutPanelText::appendText( const QString &text )
 void OutPanelText::writeText( const QString &text )
 {
     //qDebug() << text;
-    m_text.append( text );
+    m_pubText.append( text );
     step();
     repaint();
 }
 
+void OutPanelText::publish()
+{
+    if( m_text == "" ) return;
+    
+    m_pubText.append( m_text );
+    m_text = "";
+}
+
 void OutPanelText::step()
 {
-    if( m_text != "" )
+    if( m_pubText != "" )
     {
-        QPlainTextEdit::insertPlainText( m_text );
+        QPlainTextEdit::insertPlainText( m_pubText );
         ensureCursorVisible();
-        m_text = "";
+        m_pubText = "";
     }
 }
 
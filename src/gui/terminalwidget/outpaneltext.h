@@ -38,12 +38,14 @@ class MAINMODULE_EXPORT OutPanelText : public QPlainTextEdit
         void appendText( const QString &text );
         void writeText( const QString &text );
         
+        void publish();     // Take text appended by Simulation
         void step();
 
     private:
  //static OutPanelText* m_pSelf;
  
         QString m_text;
+        QString m_pubText;
  
         OutHighlighter* m_highlighter;
 
@@ -34,9 +34,10 @@ TerminalWidget::TerminalWidget( QWidget *parent )
     ,m_ascciButton(this)
     ,m_valueButton(this)
 {
-    m_pSelf = this;
+    if( !m_pSelf ) m_pSelf = this;
     this->setVisible( false );
 
+    m_processor  = 0l;
     m_printASCII = true;
     
     setMinimumSize(QSize(200, 200));
@@ -86,9 +87,9 @@ TerminalWidget::TerminalWidget( QWidget *parent )
     m_verticalLayout.addWidget( myFrame );*/
     
     QHBoxLayout* textLabelsLayout = new QHBoxLayout();
-    QLabel* sentLabel = new QLabel(this);
-    sentLabel->setText(tr("Received From Micro:"));
-    textLabelsLayout->addWidget( sentLabel );
+    m_sentLabel = new QLabel(this);
+    m_sentLabel->setText(tr("Received From Micro:"));
+    textLabelsLayout->addWidget( m_sentLabel );
     QLabel* recvLabel = new QLabel(this);
     recvLabel->setText(tr("Sent to Micro:"));
     textLabelsLayout->addWidget( recvLabel );
@@ -111,7 +112,18 @@ TerminalWidget::TerminalWidget( QWidget *parent )
     connect( &m_valueButton, SIGNAL( clicked()),
                        this, SLOT( valueButtonClicked()) );
 }
-TerminalWidget::~TerminalWidget() { }
+TerminalWidget::~TerminalWidget() 
+{
+    if( m_pSelf == this ) m_pSelf = 0l;
+}
+
+void TerminalWidget::setProcessor( BaseProcessor* proc, QString name )
+{
+    m_processor = proc;
+
+    if( name.isEmpty() ) m_sentLabel->setText(tr("Received From Micro:"));
+    else                 m_sentLabel->setText(tr("Received From %1:").arg(name));
+}
 
 void TerminalWidget::onTextChanged()
 {
@@ -120,14 +132,16 @@ void TerminalWidget::onTextChanged()
     
     QByteArray array = text.toLatin1();
     
-    for( int i=0; i<array.size(); i++ ) BaseProcessor::self()->uartIn( array.at(i) );
+    if( !m_processor ) return;
+    
+    for( int i=0; i<array.size(); i++ ) m_processor->uartIn( array.at(i) );
 }
 
 void TerminalWidget::onValueChanged()
 {
     QString text = m_sendValue.text();
 
-    BaseProcessor::self()->uartIn( text.toInt() );
+    if( m_processor ) m_processor->uartIn( text.toInt() );
 }
 
 void TerminalWidget::valueButtonClicked()
@@ -142,6 +156,12 @@ void TerminalWidget::ascciButtonClicked()
     m_valueButton.setChecked( !m_printASCII );
 }
 
+void TerminalWidget::publish()
+{
+    m_uartInPanel.publish();
+    m_uartOutPanel.publish();
+}
+
 void TerminalWidget::step()
 {
     m_uartInPanel.step();
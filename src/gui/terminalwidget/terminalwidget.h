@@ -24,6 +24,8 @@
 
 #include "outpaneltext.h"
 
+class BaseProcessor;
+
 class MAINMODULE_EXPORT TerminalWidget : public QWidget
 {
     Q_OBJECT
@@ -34,9 +36,13 @@ class MAINMODULE_EXPORT TerminalWidget : public QWidget
         
  static TerminalWidget* self() { return m_pSelf; }
 
+        BaseProcessor* processor() { return m_processor; }
+        void setProcessor( BaseProcessor* proc, QString name="" );
+
         void uartIn( uint32_t value );
         void uartOut( uint32_t value );
 
+        void publish();
         void step();
  
     private slots:
@@ -47,6 +53,8 @@ class MAINMODULE_EXPORT TerminalWidget : public QWidget
 
     private:
  static TerminalWidget* m_pSelf;
+
+        BaseProcessor* m_processor;   // Mcu attached to this terminal
  
         QVBoxLayout   m_verticalLayout;
         QHBoxLayout   m_sendLayout;
@@ -57,6 +65,7 @@ class MAINMODULE_EXPORT TerminalWidget : public QWidget
         OutPanelText  m_uartOutPanel;
         QPushButton   m_ascciButton;
         QPushButton   m_valueButton;
+        QLabel*       m_sentLabel;
 
         bool m_printASCII;
 };
@@ -21,6 +21,7 @@
 #include <QTranslator>
 
 #include "mainwindow.h"
+#include "batchrunner.h"
 
 int main(int argc, char *argv[])
 {
@@ -45,6 +46,9 @@ int main(int argc, char *argv[])
     }
 #endif
 
+    bool batch = BatchRunner::isBatch( argc, argv );
+    if( batch ) qputenv( "QT_QPA_PLATFORM", "offscreen" ); // No X server needed
+
     //QApplication::setGraphicsSystem( "raster" );//native, raster, opengl
     QApplication app( argc, argv );
 
@@ -59,6 +63,13 @@ int main(int argc, char *argv[])
     app.installTranslator( &translator );
 
     MainWindow window;
+
+    if( batch )
+    {
+        app.setApplicationVersion( APP_VERSION );
+        BatchRunner runner;
+        return runner.run( app.arguments() );
+    }
     
     /*QRect screenGeometry = QApplication::desktop()->screenGeometry();
     int x = ( screenGeometry.width()-window.width() ) / 2;
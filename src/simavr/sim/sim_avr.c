@@ -78,6 +78,7 @@ avr_init(
 	avr->flash = malloc(avr->flashend + 1);
 	memset(avr->flash, 0xff, avr->flashend + 1);
 	avr->codeend = avr->flashend;
+	avr_decode_init(avr);
 	avr->data = malloc(avr->ramend + 1);
 	memset(avr->data, 0, avr->ramend + 1);
 #ifdef CONFIG_SIMAVR_TRACE
@@ -121,7 +122,9 @@ avr_terminate(
 		avr->vcd = NULL;
 	}
 	avr_deallocate_ios(avr);
+	avr_cycle_timer_free(avr);
 
+	avr_decode_free(avr);
 	if (avr->flash) free(avr->flash);
 	if (avr->data) free(avr->data);
 	if (avr->io_console_buffer.buf) {
@@ -228,6 +231,7 @@ avr_loadcode(
         return -1;
 	}
 	memcpy(avr->flash + address, code, size);
+	avr_decode_invalidate(avr, address, size);
     return 0;
 }
 
@@ -323,6 +327,39 @@ avr_callback_sleep_raw(
 	}
 }
 
+/*
+ * Co-simulation sleep: the host advances time itself, so there is nothing
+ * to wait for; the core just fast-forwards avr->cycle (see below)
+ */
+void
+avr_callback_sleep_cosim(
+		avr_t * avr,
+		avr_cycle_count_t howLong)
+{
+}
+
+/*
+ * In co-simulation, never fast-forward past run_cycle_target, the host
+ * sets it to the end of its current step. run_cycle_limit can't be used
+ * here: it was set before the block that ended in SLEEP, which already
+ * used part of it.
+ */
+static inline avr_cycle_count_t
+avr_sleep_cycles_limited(
+		avr_t * avr,
+		avr_cycle_count_t sleep)
+{
+	if (avr->sleep != avr_callback_sleep_cosim)
+		return sleep;
+
+	avr_cycle_count_t left = avr->run_cycle_target > avr->cycle ?
+			avr->run_cycle_target - avr->cycle : 0;
+	// the SLEEP cycle itself is added after the fast-forward
+	if (sleep >= left)
+		sleep = left ? left - 1 : 0;
+	return sleep;
+}
+
 void
 avr_callback_run_raw(
 		avr_t * avr)
@@ -352,6 +389,7 @@ avr_callback_run_raw(
 		/*
 		 * try to sleep for as long as we can (?)
 		 */
+		sleep = avr_sleep_cycles_limited(avr, sleep);
 		avr->sleep(avr, sleep);
 		avr->cycle += 1 + sleep;
 	}
@@ -381,6 +419,7 @@ avr_core_allocate(
 {
 	uint8_t * b = malloc(coreLen);
 	memcpy(b, core, coreLen);
+	((avr_t *)b)->core_size = coreLen;
 	return (avr_t *)b;
 }
 
@@ -179,6 +179,8 @@ typedef struct avr_t {
 
 	// filled by the ELF data, this allow tracking of invalid jumps
 	uint32_t			codeend;
+	// size of the core block (avr_t and IO modules), see avr_core_allocate
+	uint32_t			core_size;
 
 	int					state;		// stopped, running, sleeping
 	uint32_t			frequency;	// frequency we are running at
@@ -192,8 +194,14 @@ typedef struct avr_t {
 
 	// these next two allow the core to freely run between cycle timers and also allows
 	// for a maximum run cycle limit... run_cycle_count is set during cycle timer processing.
+	// run_cycle_limit defaults to 1 (one instruction per run() call), set it higher
+	// to let avr_run_one() execute blocks of instructions; a block always ends on
+	// any access to an IO register that has a callback or an irq attached.
 	avr_cycle_count_t	run_cycle_count;	// cycles to run before next timer
 	avr_cycle_count_t	run_cycle_limit;	// maximum run cycle interval limit
+	// in "cosim" mode, the host sets the cycle it runs up to, sleeping
+	// never fast-forwards past it
+	avr_cycle_count_t	run_cycle_target;
 
 	/**
 	 * Sleep requests are accumulated in sleep_usec until the minimum sleep value
@@ -228,7 +236,9 @@ typedef struct avr_t {
 	/*!
 	 * Sleep default behaviour.
 	 * In "raw" mode, it calls usleep, in gdb mode, it waits
-	 * for howLong for gdb command on it's sockets.
+	 * for howLong for gdb command on it's sockets. In "cosim" mode
+	 * the host drives the time, it doesn't wait at all and the
+	 * fast-forward is bound to run_cycle_target.
 	 */
 	void (*sleep)(struct avr_t * avr, avr_cycle_count_t howLong);
 
@@ -304,6 +314,9 @@ typedef struct avr_t {
 
 	// flash memory (initialized to 0xff, and code loaded into it)
 	uint8_t *		flash;
+	// pre-decoded instruction cache, one entry per flash word, decoded
+	// lazily by avr_run_one() and invalidated whenever flash is written
+	struct avr_decoded_t * decoded;
 	// this is the general purpose registers, IO registers, and SRAM
 	uint8_t *		data;
 
@@ -464,6 +477,7 @@ void avr_callback_sleep_gdb(avr_t * avr, avr_cycle_count_t howLong);
 void avr_callback_run_gdb(avr_t * avr);
 void avr_callback_sleep_raw(avr_t * avr, avr_cycle_count_t howLong);
 void avr_callback_run_raw(avr_t * avr);
+void avr_callback_sleep_cosim(avr_t * avr, avr_cycle_count_t howLong);
 
 /**
  * Accumulates sleep requests (and returns a sleep time of 0) until
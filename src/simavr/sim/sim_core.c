@@ -176,6 +176,13 @@ uint8_t avr_core_watch_read(avr_t *avr, uint16_t addr)
 	return avr->data[addr];
 }
 
+/*
+ * An IO register with a callback or an irq attached was touched; end the
+ * current run of instructions right after this one so the cycle timers and
+ * interrupts are processed at the exact cycle, as if stepping one by one.
+ */
+#define IO_BLOCK_END(avr) (avr)->run_cycle_count = 0
+
 /*
  * Set a register (r < 256)
  * if it's an IO register (> 31) also (try to) call any callback that was
@@ -193,14 +200,16 @@ static inline void _avr_set_r(avr_t * avr, uint16_t r, uint8_t v)
 	}
 	if (r > 31) {
 		avr_io_addr_t io = AVR_DATA_TO_IO(r);
-		if (avr->io[io].w.c)
+		if (avr->io[io].w.c) {
 			avr->io[io].w.c(avr, r, v, avr->io[io].w.param);
-		else
+			IO_BLOCK_END(avr);
+		} else
 			avr->data[r] = v;
 		if (avr->io[io].irq) {
 			avr_raise_irq(avr->io[io].irq + AVR_IOMEM_IRQ_ALL, v);
 			for (int i = 0; i < 8; i++)
 				avr_raise_irq(avr->io[io].irq + i, (v >> i) & 1);
+			IO_BLOCK_END(avr);
 		}
 	} else
 		avr->data[r] = v;
@@ -265,14 +274,17 @@ static inline uint8_t _avr_get_ram(avr_t * avr, uint16_t addr)
 	} else if (addr > 31 && addr < 31 + MAX_IOs) {
 		avr_io_addr_t io = AVR_DATA_TO_IO(addr);
 
-		if (avr->io[io].r.c)
+		if (avr->io[io].r.c) {
 			avr->data[addr] = avr->io[io].r.c(avr, addr, avr->io[io].r.param);
+			IO_BLOCK_END(avr);
+		}
 
 		if (avr->io[io].irq) {
 			uint8_t v = avr->data[addr];
 			avr_raise_irq(avr->io[io].irq + AVR_IOMEM_IRQ_ALL, v);
 			for (int i = 0; i < 8; i++)
 				avr_raise_irq(avr->io[io].irq + i, (v >> i) & 1);
+			IO_BLOCK_END(avr);
 		}
 	}
 	return avr_core_watch_read(avr, addr);
@@ -589,26 +601,362 @@ _avr_flags_znv0s (struct avr_t * avr, uint8_t res)
 	_avr_flags_zns(avr, res);
 }
 
+/*
+ * Pre-decoded instruction cache
+ *
+ * Every flash word gets one entry, filled the first time the word is
+ * executed as an instruction. The entry holds an "operation" number that
+ * the executor can switch on directly, plus the operands already extracted
+ * from the opcode and its base cycle count, so the hot loop neither walks
+ * the nested opcode switch nor shifts and masks bits again. 32 bits instructions also have their
+ * second word pre-read into 'k'.
+ *
+ * Any write to flash (loadcode, SPM, gdb) must invalidate the entries
+ * covering it, including the one before, as it might be the first half of
+ * a 32 bits instruction.
+ */
+enum {
+	AVR_OP_UNDECODED = 0,
+	AVR_OP_INVALID,
+	AVR_OP_NOP,
+	AVR_OP_CPC, AVR_OP_ADD, AVR_OP_SBC, AVR_OP_MOVW, AVR_OP_MULS, AVR_OP_FMUL,
+	AVR_OP_SUB, AVR_OP_CPSE, AVR_OP_CP, AVR_OP_ADC,
+	AVR_OP_AND, AVR_OP_EOR, AVR_OP_OR, AVR_OP_MOV,
+	AVR_OP_CPI, AVR_OP_SBCI, AVR_OP_SUBI, AVR_OP_ORI, AVR_OP_ANDI,
+	AVR_OP_LDD_Z, AVR_OP_STD_Z, AVR_OP_LDD_Y, AVR_OP_STD_Y,
+	AVR_OP_BSET, AVR_OP_BCLR,
+	AVR_OP_SLEEP, AVR_OP_BREAK, AVR_OP_WDR, AVR_OP_SPM,
+	AVR_OP_IJMP, AVR_OP_RETI, AVR_OP_RET, AVR_OP_LPM_R0, AVR_OP_ELPM_R0,
+	AVR_OP_LDS, AVR_OP_LPM, AVR_OP_ELPM,
+	AVR_OP_LD_X, AVR_OP_ST_X, AVR_OP_LD_Y, AVR_OP_ST_Y, AVR_OP_STS,
+	AVR_OP_LD_Z, AVR_OP_ST_Z, AVR_OP_POP, AVR_OP_PUSH,
+	AVR_OP_COM, AVR_OP_NEG, AVR_OP_SWAP, AVR_OP_INC, AVR_OP_ASR, AVR_OP_LSR,
+	AVR_OP_ROR, AVR_OP_DEC, AVR_OP_JMP, AVR_OP_CALL,
+	AVR_OP_ADIW, AVR_OP_SBIW, AVR_OP_CBI, AVR_OP_SBIC, AVR_OP_SBI, AVR_OP_SBIS,
+	AVR_OP_MUL, AVR_OP_OUT, AVR_OP_IN, AVR_OP_RJMP, AVR_OP_RCALL, AVR_OP_LDI,
+	AVR_OP_BRXX, AVR_OP_BLD, AVR_OP_BST, AVR_OP_SBRX,
+	AVR_OP_COUNT
+};
+
+typedef struct avr_decoded_t {
+	int32_t		k;		// immediate, offset, address or second opcode word
+	uint16_t	opcode;	// raw opcode, for the few that still need bits of it
+	uint8_t		op;		// AVR_OP_*
+	uint8_t		size;	// instruction size, 2 or 4 bytes
+	uint8_t		d;		// destination register, pointer pair, IO or SREG bit
+	uint8_t		r;		// source register, bit, displacement, mask or IO
+	uint8_t		cycles;	// base cycles, without branch, skip or return address
+} avr_decoded_t;
+
+// cycles over the first one taken by each operation
+static const uint8_t _avr_op_extra_cycles[AVR_OP_COUNT] = {
+	[AVR_OP_MULS] = 1, [AVR_OP_FMUL] = 1, [AVR_OP_MUL] = 1,
+	[AVR_OP_LDD_Z] = 1, [AVR_OP_STD_Z] = 1, [AVR_OP_LDD_Y] = 1, [AVR_OP_STD_Y] = 1, // 3 cycles for tinyavr
+	[AVR_OP_LPM_R0] = 2, [AVR_OP_ELPM_R0] = 2, [AVR_OP_LPM] = 2, [AVR_OP_ELPM] = 2,
+	[AVR_OP_LDS] = 1, [AVR_OP_STS] = 1,
+	[AVR_OP_LD_X] = 1, [AVR_OP_ST_X] = 1, [AVR_OP_LD_Y] = 1, [AVR_OP_ST_Y] = 1,
+	[AVR_OP_LD_Z] = 1, [AVR_OP_ST_Z] = 1,		// except tinyavr
+	[AVR_OP_POP] = 1, [AVR_OP_PUSH] = 1,
+	[AVR_OP_ADIW] = 1, [AVR_OP_SBIW] = 1, [AVR_OP_CBI] = 1, [AVR_OP_SBI] = 1,
+	[AVR_OP_JMP] = 2, [AVR_OP_RJMP] = 1,
+	// plus the return address push/pop, added when run
+	[AVR_OP_IJMP] = 1, [AVR_OP_RETI] = 1, [AVR_OP_RET] = 1, [AVR_OP_CALL] = 1,
+};
+
+void
+avr_decode_init(
+		avr_t * avr)
+{
+	avr_decode_free(avr);
+	avr->decoded = calloc((avr->flashend + 2) >> 1, sizeof(avr_decoded_t));
+}
+
+void
+avr_decode_free(
+		avr_t * avr)
+{
+	if (avr->decoded)
+		free(avr->decoded);
+	avr->decoded = NULL;
+}
+
+void
+avr_decode_invalidate(
+		avr_t * avr,
+		avr_flashaddr_t addr,
+		uint32_t size)
+{
+	if (!avr->decoded || !size)
+		return;
+	avr_flashaddr_t start = addr >> 1;
+	avr_flashaddr_t end = (addr + size + 1) >> 1;
+	avr_flashaddr_t count = (avr->flashend + 2) >> 1;
+	// the previous word might be the start of a 32 bits instruction
+	if (start)
+		start--;
+	if (end > count)
+		end = count;
+	if (start < end)
+		memset(avr->decoded + start, 0, (end - start) * sizeof(avr_decoded_t));
+}
+
+/*
+ * Decode the opcode at 'pc', following exactly the same tree as the
+ * original decoder did; this is run only once per flash word.
+ */
+static void
+_avr_decode_one(
+		avr_t * avr,
+		avr_flashaddr_t pc,
+		avr_decoded_t * o)
+{
+	const uint16_t opcode = _avr_flash_read16le(avr, pc);
+
+	memset(o, 0, sizeof(*o));
+	o->opcode = opcode;
+	o->size = 2;
+	o->op = AVR_OP_INVALID;
+	// most common operand layouts, harmless for the opcodes that don't use them
+	o->d = (opcode >> 4) & 0x1f;
+	o->r = ((opcode >> 5) & 0x10) | (opcode & 0xf);
+
+	switch (opcode & 0xf000) {
+		case 0x0000: {
+			if (opcode == 0x0000) {
+				o->op = AVR_OP_NOP;
+				break;
+			}
+			switch (opcode & 0xfc00) {
+				case 0x0400: o->op = AVR_OP_CPC; break;
+				case 0x0c00: o->op = AVR_OP_ADD; break;
+				case 0x0800: o->op = AVR_OP_SBC; break;
+				default:
+					switch (opcode & 0xff00) {
+						case 0x0100:
+							o->op = AVR_OP_MOVW;
+							o->d = ((opcode >> 4) & 0xf) << 1;
+							o->r = ((opcode) & 0xf) << 1;
+							break;
+						case 0x0200:
+							o->op = AVR_OP_MULS;
+							o->d = 16 + ((opcode >> 4) & 0xf);
+							o->r = 16 + (opcode & 0xf);
+							break;
+						case 0x0300:
+							o->op = AVR_OP_FMUL;
+							o->d = 16 + ((opcode >> 4) & 0x7);
+							o->r = 16 + (opcode & 0x7);
+							break;
+					}
+			}
+		}	break;
+		case 0x1000: {
+			switch (opcode & 0xfc00) {
+				case 0x1800: o->op = AVR_OP_SUB; break;
+				case 0x1000: o->op = AVR_OP_CPSE; break;
+				case 0x1400: o->op = AVR_OP_CP; break;
+				case 0x1c00: o->op = AVR_OP_ADC; break;
+			}
+		}	break;
+		case 0x2000: {
+			switch (opcode & 0xfc00) {
+				case 0x2000: o->op = AVR_OP_AND; break;
+				case 0x2400: o->op = AVR_OP_EOR; break;
+				case 0x2800: o->op = AVR_OP_OR; break;
+				case 0x2c00: o->op = AVR_OP_MOV; break;
+			}
+		}	break;
+		case 0x3000:
+		case 0x4000:
+		case 0x5000:
+		case 0x6000:
+		case 0x7000:
+		case 0xe000: {
+			static const uint8_t imm[16] = {
+				[0x3] = AVR_OP_CPI, [0x4] = AVR_OP_SBCI, [0x5] = AVR_OP_SUBI,
+				[0x6] = AVR_OP_ORI, [0x7] = AVR_OP_ANDI, [0xe] = AVR_OP_LDI,
+			};
+			o->op = imm[opcode >> 12];
+			o->d = 16 + ((opcode >> 4) & 0xf);
+			o->r = ((opcode & 0x0f00) >> 4) | (opcode & 0xf);
+		}	break;
+		case 0xa000:
+		case 0x8000: {
+			int store = (opcode & 0x0200) != 0;
+			o->r = ((opcode & 0x2000) >> 8) | ((opcode & 0x0c00) >> 7) | (opcode & 0x7);
+			if (opcode & 0x0008)
+				o->op = store ? AVR_OP_STD_Y : AVR_OP_LDD_Y;
+			else
+				o->op = store ? AVR_OP_STD_Z : AVR_OP_LDD_Z;
+		}	break;
+		case 0x9000: {
+			if ((opcode & 0xff0f) == 0x9408) {
+				o->op = (opcode & 0x0080) ? AVR_OP_BCLR : AVR_OP_BSET;
+				o->d = (opcode >> 4) & 7;
+				break;
+			}
+			switch (opcode) {
+				case 0x9588: o->op = AVR_OP_SLEEP; break;
+				case 0x9598: o->op = AVR_OP_BREAK; break;
+				case 0x95a8: o->op = AVR_OP_WDR; break;
+				case 0x95e8: o->op = AVR_OP_SPM; break;
+				case 0x9409:
+				case 0x9419:
+				case 0x9509:
+				case 0x9519: o->op = AVR_OP_IJMP; break;
+				case 0x9518: o->op = AVR_OP_RETI; break;
+				case 0x9508: o->op = AVR_OP_RET; break;
+				case 0x95c8: o->op = AVR_OP_LPM_R0; break;
+				case 0x95d8: o->op = AVR_OP_ELPM_R0; break;
+				default: {
+					// post increment/pre decrement mode for the LD/ST/LPM family
+					o->r = opcode & 3;
+					switch (opcode & 0xfe0f) {
+						case 0x9000:
+							o->op = AVR_OP_LDS;
+							o->size = 4;
+							o->k = _avr_flash_read16le(avr, pc + 2);
+							break;
+						case 0x9005:
+						case 0x9004: o->op = AVR_OP_LPM; o->r = opcode & 1; break;
+						case 0x9006:
+						case 0x9007: o->op = AVR_OP_ELPM; o->r = opcode & 1; break;
+						case 0x900c:
+						case 0x900d:
+						case 0x900e: o->op = AVR_OP_LD_X; break;
+						case 0x920c:
+						case 0x920d:
+						case 0x920e: o->op = AVR_OP_ST_X; break;
+						case 0x9009:
+						case 0x900a: o->op = AVR_OP_LD_Y; break;
+						case 0x9209:
+						case 0x920a: o->op = AVR_OP_ST_Y; break;
+						case 0x9200:
+							o->op = AVR_OP_STS;
+							o->size = 4;
+							o->k = _avr_flash_read16le(avr, pc + 2);
+							break;
+						case 0x9001:
+						case 0x9002: o->op = AVR_OP_LD_Z; break;
+						case 0x9201:
+						case 0x9202: o->op = AVR_OP_ST_Z; break;
+						case 0x900f: o->op = AVR_OP_POP; break;
+						case 0x920f: o->op = AVR_OP_PUSH; break;
+						case 0x9400: o->op = AVR_OP_COM; break;
+						case 0x9401: o->op = AVR_OP_NEG; break;
+						case 0x9402: o->op = AVR_OP_SWAP; break;
+						case 0x9403: o->op = AVR_OP_INC; break;
+						case 0x9405: o->op = AVR_OP_ASR; break;
+						case 0x9406: o->op = AVR_OP_LSR; break;
+						case 0x9407: o->op = AVR_OP_ROR; break;
+						case 0x940a: o->op = AVR_OP_DEC; break;
+						case 0x940c:
+						case 0x940d:
+						case 0x940e:
+						case 0x940f: {
+							avr_flashaddr_t a = ((opcode & 0x01f0) >> 3) | (opcode & 1);
+							o->op = (opcode & 2) ? AVR_OP_CALL : AVR_OP_JMP;
+							o->size = 4;
+							o->k = (a << 16) | _avr_flash_read16le(avr, pc + 2);
+						}	break;
+						default: {
+							switch (opcode & 0xff00) {
+								case 0x9600:
+								case 0x9700:
+									o->op = (opcode & 0x0100) ? AVR_OP_SBIW : AVR_OP_ADIW;
+									o->d = 24 + ((opcode >> 3) & 0x6);
+									o->r = ((opcode & 0x00c0) >> 2) | (opcode & 0xf);
+									break;
+								case 0x9800:
+								case 0x9900:
+								case 0x9a00:
+								case 0x9b00: {
+									static const uint8_t io[4] = {
+										AVR_OP_CBI, AVR_OP_SBIC, AVR_OP_SBI, AVR_OP_SBIS };
+									o->op = io[(opcode >> 8) & 3];
+									o->d = ((opcode >> 3) & 0x1f) + 32;
+									o->r = 1 << (opcode & 0x7);
+								}	break;
+								default:
+									if ((opcode & 0xfc00) == 0x9c00) {
+										o->op = AVR_OP_MUL;
+										o->r = ((opcode >> 5) & 0x10) | (opcode & 0xf);
+									}
+							}
+						}	break;
+					}
+				}	break;
+			}
+		}	break;
+		case 0xb000: {
+			o->op = (opcode & 0x0800) ? AVR_OP_OUT : AVR_OP_IN;
+			o->r = ((((opcode >> 9) & 3) << 4) | ((opcode) & 0xf)) + 32;
+		}	break;
+		case 0xc000:
+		case 0xd000: {
+			o->op = (opcode & 0x1000) ? AVR_OP_RCALL : AVR_OP_RJMP;
+			o->k = ((int16_t)((opcode << 4) & 0xffff)) >> 3;
+		}	break;
+		case 0xf000: {
+			switch (opcode & 0xfe00) {
+				case 0xf000:
+				case 0xf200:
+				case 0xf400:
+				case 0xf600:
+					o->op = AVR_OP_BRXX;
+					o->k = ((int16_t)(opcode << 6)) >> 9;
+					o->d = opcode & 7;
+					o->r = (opcode & 0x0400) == 0;		// this bit means BRXC otherwise BRXS
+					break;
+				case 0xf800:
+				case 0xf900: o->op = AVR_OP_BLD; o->r = opcode & 7; break;
+				case 0xfa00:
+				case 0xfb00: o->op = AVR_OP_BST; o->r = opcode & 7; break;
+				case 0xfc00:
+				case 0xfe00: o->op = AVR_OP_SBRX; o->r = opcode & 7; break;
+			}
+		}	break;
+	}
+	o->cycles = 1 + _avr_op_extra_cycles[o->op];
+}
+
+static inline avr_decoded_t *
+_avr_decoded_get(
+		avr_t * avr,
+		avr_flashaddr_t pc,
+		avr_decoded_t * local)
+{
+	avr_decoded_t * o = avr->decoded ? avr->decoded + (pc >> 1) : local;
+	if (!avr->decoded || unlikely(o->op == AVR_OP_UNDECODED))
+		_avr_decode_one(avr, pc, o);
+	return o;
+}
+
 static inline int _avr_is_instruction_32_bits(avr_t * avr, avr_flashaddr_t pc)
 {
-	uint16_t o = _avr_flash_read16le(avr, pc) & 0xfc0f;
-	return	o == 0x9200 || // STS ! Store Direct to Data Space
-			o == 0x9000 || // LDS Load Direct from Data Space
-			o == 0x940c || // JMP Long Jump
-			o == 0x940d || // JMP Long Jump
-			o == 0x940e ||  // CALL Long Call to sub
-			o == 0x940f; // CALL Long Call to sub
+	if (unlikely(pc >= avr->flashend)) {
+		uint16_t o = _avr_flash_read16le(avr, pc) & 0xfc0f;
+		return	o == 0x9200 || // STS ! Store Direct to Data Space
+				o == 0x9000 || // LDS Load Direct from Data Space
+				o == 0x940c || // JMP Long Jump
+				o == 0x940d || // JMP Long Jump
+				o == 0x940e ||  // CALL Long Call to sub
+				o == 0x940f; // CALL Long Call to sub
+	}
+	avr_decoded_t local;
+	return _avr_decoded_get(avr, pc, &local)->size == 4;
 }
 
 /*
- * Main opcode decoder
+ * Main opcode executor
  *
  * The decoder was written by following the datasheet in no particular order.
  * As I went along, I noticed "bit patterns" that could be used to factor opcodes
  * However, a lot of these only became apparent later on, so SOME instructions
  * (skip of bit set etc) are compact, and some could use some refactoring (the ALU
  * ones scream to be factored).
- * I assume that the decoder could easily be 2/3 of it's current size.
+ * The decoding itself now lives in _avr_decode_one(), and is cached per flash
+ * word; this only switches on the pre-decoded operation.
  *
  * + It lacks the "extended" XMega jumps.
  * + It also doesn't check whether the core it's
@@ -641,710 +989,602 @@ run_one_again:
 		return 0;
 	}
 
-	uint32_t		opcode = _avr_flash_read16le(avr, avr->pc);
+	avr_decoded_t	local;
+	const avr_decoded_t * dec = _avr_decoded_get(avr, avr->pc, &local);
+	const uint16_t	opcode = dec->opcode;
+	const uint8_t	d = dec->d;
+	const uint8_t	r = dec->r;
 	avr_flashaddr_t	new_pc = avr->pc + 2;	// future "default" pc
-	int 			cycle = 1;
+	int 			cycle = dec->cycles;	// base cycles, plus pushes, branches and skips
 
-	switch (opcode & 0xf000) {
-		case 0x0000: {
-			switch (opcode) {
-				case 0x0000: {	// NOP
-					STATE("nop\n");
-				}	break;
-				default: {
-					switch (opcode & 0xfc00) {
-						case 0x0400: {	// CPC -- Compare with carry -- 0000 01rd dddd rrrr
-							get_vd5_vr5(opcode);
-							uint8_t res = vd - vr - avr->sreg[S_C];
-							STATE("cpc %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
-							_avr_flags_sub_Rzns(avr, res, vd, vr);
-							SREG();
-						}	break;
-						case 0x0c00: {	// ADD -- Add without carry -- 0000 11rd dddd rrrr
-							get_vd5_vr5(opcode);
-							uint8_t res = vd + vr;
-							if (r == d) {
-								STATE("lsl %s[%02x] = %02x\n", avr_regname(d), vd, res & 0xff);
-							} else {
-								STATE("add %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
-							}
-							_avr_set_r(avr, d, res);
-							_avr_flags_add_zns(avr, res, vd, vr);
-							SREG();
-						}	break;
-						case 0x0800: {	// SBC -- Subtract with carry -- 0000 10rd dddd rrrr
-							get_vd5_vr5(opcode);
-							uint8_t res = vd - vr - avr->sreg[S_C];
-							STATE("sbc %s[%02x], %s[%02x] = %02x\n", avr_regname(d), avr->data[d], avr_regname(r), avr->data[r], res);
-							_avr_set_r(avr, d, res);
-							_avr_flags_sub_Rzns(avr, res, vd, vr);
-							SREG();
-						}	break;
-						default:
-							switch (opcode & 0xff00) {
-								case 0x0100: {	// MOVW -- Copy Register Word -- 0000 0001 dddd rrrr
-									uint8_t d = ((opcode >> 4) & 0xf) << 1;
-									uint8_t r = ((opcode) & 0xf) << 1;
-									STATE("movw %s:%s, %s:%s[%02x%02x]\n", avr_regname(d), avr_regname(d+1), avr_regname(r), avr_regname(r+1), avr->data[r+1], avr->data[r]);
-									uint16_t vr = avr->data[r] | (avr->data[r + 1] << 8);
-									_avr_set_r16le(avr, d, vr);
-								}	break;
-								case 0x0200: {	// MULS -- Multiply Signed -- 0000 0010 dddd rrrr
-									int8_t r = 16 + (opcode & 0xf);
-									int8_t d = 16 + ((opcode >> 4) & 0xf);
-									int16_t res = ((int8_t)avr->data[r]) * ((int8_t)avr->data[d]);
-									STATE("muls %s[%d], %s[%02x] = %d\n", avr_regname(d), ((int8_t)avr->data[d]), avr_regname(r), ((int8_t)avr->data[r]), res);
-									_avr_set_r16le(avr, 0, res);
-									avr->sreg[S_C] = (res >> 15) & 1;
-									avr->sreg[S_Z] = res == 0;
-									cycle++;
-									SREG();
-								}	break;
-								case 0x0300: {	// MUL -- Multiply -- 0000 0011 fddd frrr
-									int8_t r = 16 + (opcode & 0x7);
-									int8_t d = 16 + ((opcode >> 4) & 0x7);
-									int16_t res = 0;
-									uint8_t c = 0;
-									T(const char * name = "";)
-									switch (opcode & 0x88) {
-										case 0x00: 	// MULSU -- Multiply Signed Unsigned -- 0000 0011 0ddd 0rrr
-											res = ((uint8_t)avr->data[r]) * ((int8_t)avr->data[d]);
-											c = (res >> 15) & 1;
-											T(name = "mulsu";)
-											break;
-										case 0x08: 	// FMUL -- Fractional Multiply Unsigned -- 0000 0011 0ddd 1rrr
-											res = ((uint8_t)avr->data[r]) * ((uint8_t)avr->data[d]);
-											c = (res >> 15) & 1;
-											res <<= 1;
-											T(name = "fmul";)
-											break;
-										case 0x80: 	// FMULS -- Multiply Signed -- 0000 0011 1ddd 0rrr
-											res = ((int8_t)avr->data[r]) * ((int8_t)avr->data[d]);
-											c = (res >> 15) & 1;
-											res <<= 1;
-											T(name = "fmuls";)
-											break;
-										case 0x88: 	// FMULSU -- Multiply Signed Unsigned -- 0000 0011 1ddd 1rrr
-											res = ((uint8_t)avr->data[r]) * ((int8_t)avr->data[d]);
-											c = (res >> 15) & 1;
-											res <<= 1;
-											T(name = "fmulsu";)
-											break;
-									}
-									cycle++;
-									STATE("%s %s[%d], %s[%02x] = %d\n", name, avr_regname(d), ((int8_t)avr->data[d]), avr_regname(r), ((int8_t)avr->data[r]), res);
-									_avr_set_r16le(avr, 0, res);
-									avr->sreg[S_C] = c;
-									avr->sreg[S_Z] = res == 0;
-									SREG();
-								}	break;
-								default: _avr_invalid_opcode(avr);
-							}
-					}
+	switch (dec->op) {
+		case AVR_OP_NOP: {	// NOP
+			STATE("nop\n");
+		}	break;
+		case AVR_OP_CPC: {	// CPC -- Compare with carry -- 0000 01rd dddd rrrr
+			const uint8_t vd = avr->data[d], vr = avr->data[r];
+			uint8_t res = vd - vr - avr->sreg[S_C];
+			STATE("cpc %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
+			_avr_flags_sub_Rzns(avr, res, vd, vr);
+			SREG();
+		}	break;
+		case AVR_OP_ADD: {	// ADD -- Add without carry -- 0000 11rd dddd rrrr
+			const uint8_t vd = avr->data[d], vr = avr->data[r];
+			uint8_t res = vd + vr;
+			if (r == d) {
+				STATE("lsl %s[%02x] = %02x\n", avr_regname(d), vd, res & 0xff);
+			} else {
+				STATE("add %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
+			}
+			_avr_set_r(avr, d, res);
+			_avr_flags_add_zns(avr, res, vd, vr);
+			SREG();
+		}	break;
+		case AVR_OP_SBC: {	// SBC -- Subtract with carry -- 0000 10rd dddd rrrr
+			const uint8_t vd = avr->data[d], vr = avr->data[r];
+			uint8_t res = vd - vr - avr->sreg[S_C];
+			STATE("sbc %s[%02x], %s[%02x] = %02x\n", avr_regname(d), avr->data[d], avr_regname(r), avr->data[r], res);
+			_avr_set_r(avr, d, res);
+			_avr_flags_sub_Rzns(avr, res, vd, vr);
+			SREG();
+		}	break;
+		case AVR_OP_MOVW: {	// MOVW -- Copy Register Word -- 0000 0001 dddd rrrr
+			STATE("movw %s:%s, %s:%s[%02x%02x]\n", avr_regname(d), avr_regname(d+1), avr_regname(r), avr_regname(r+1), avr->data[r+1], avr->data[r]);
+			uint16_t vr = avr->data[r] | (avr->data[r + 1] << 8);
+			_avr_set_r16le(avr, d, vr);
+		}	break;
+		case AVR_OP_MULS: {	// MULS -- Multiply Signed -- 0000 0010 dddd rrrr
+			int16_t res = ((int8_t)avr->data[r]) * ((int8_t)avr->data[d]);
+			STATE("muls %s[%d], %s[%02x] = %d\n", avr_regname(d), ((int8_t)avr->data[d]), avr_regname(r), ((int8_t)avr->data[r]), res);
+			_avr_set_r16le(avr, 0, res);
+			avr->sreg[S_C] = (res >> 15) & 1;
+			avr->sreg[S_Z] = res == 0;
+			SREG();
+		}	break;
+		case AVR_OP_FMUL: {	// MUL -- Multiply -- 0000 0011 fddd frrr
+			int16_t res = 0;
+			uint8_t c = 0;
+			T(const char * name = "";)
+			switch (opcode & 0x88) {
+				case 0x00: 	// MULSU -- Multiply Signed Unsigned -- 0000 0011 0ddd 0rrr
+					res = ((uint8_t)avr->data[r]) * ((int8_t)avr->data[d]);
+					c = (res >> 15) & 1;
+					T(name = "mulsu";)
+					break;
+				case 0x08: 	// FMUL -- Fractional Multiply Unsigned -- 0000 0011 0ddd 1rrr
+					res = ((uint8_t)avr->data[r]) * ((uint8_t)avr->data[d]);
+					c = (res >> 15) & 1;
+					res <<= 1;
+					T(name = "fmul";)
+					break;
+				case 0x80: 	// FMULS -- Multiply Signed -- 0000 0011 1ddd 0rrr
+					res = ((int8_t)avr->data[r]) * ((int8_t)avr->data[d]);
+					c = (res >> 15) & 1;
+					res <<= 1;
+					T(name = "fmuls";)
+					break;
+				case 0x88: 	// FMULSU -- Multiply Signed Unsigned -- 0000 0011 1ddd 1rrr
+					res = ((uint8_t)avr->data[r]) * ((int8_t)avr->data[d]);
+					c = (res >> 15) & 1;
+					res <<= 1;
+					T(name = "fmulsu";)
+					break;
+			}
+			STATE("%s %s[%d], %s[%02x] = %d\n", name, avr_regname(d), ((int8_t)avr->data[d]), avr_regname(r), ((int8_t)avr->data[r]), res);
+			_avr_set_r16le(avr, 0, res);
+			avr->sreg[S_C] = c;
+			avr->sreg[S_Z] = res == 0;
+			SREG();
+		}	break;
+		case AVR_OP_SUB: {	// SUB -- Subtract without carry -- 0001 10rd dddd rrrr
+			const uint8_t vd = avr->data[d], vr = avr->data[r];
+			uint8_t res = vd - vr;
+			STATE("sub %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
+			_avr_set_r(avr, d, res);
+			_avr_flags_sub_zns(avr, res, vd, vr);
+			SREG();
+		}	break;
+		case AVR_OP_CPSE: {	// CPSE -- Compare, skip if equal -- 0001 00rd dddd rrrr
+			const uint8_t vd = avr->data[d], vr = avr->data[r];
+			uint16_t res = vd == vr;
+			STATE("cpse %s[%02x], %s[%02x]\t; Will%s skip\n", avr_regname(d), avr->data[d], avr_regname(r), avr->data[r], res ? "":" not");
+			if (res) {
+				if (_avr_is_instruction_32_bits(avr, new_pc)) {
+					new_pc += 4; cycle += 2;
+				} else {
+					new_pc += 2; cycle++;
 				}
 			}
 		}	break;
-
-		case 0x1000: {
-			switch (opcode & 0xfc00) {
-				case 0x1800: {	// SUB -- Subtract without carry -- 0001 10rd dddd rrrr
-					get_vd5_vr5(opcode);
-					uint8_t res = vd - vr;
-					STATE("sub %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
-					_avr_set_r(avr, d, res);
-					_avr_flags_sub_zns(avr, res, vd, vr);
-					SREG();
-				}	break;
-				case 0x1000: {	// CPSE -- Compare, skip if equal -- 0001 00rd dddd rrrr
-					get_vd5_vr5(opcode);
-					uint16_t res = vd == vr;
-					STATE("cpse %s[%02x], %s[%02x]\t; Will%s skip\n", avr_regname(d), avr->data[d], avr_regname(r), avr->data[r], res ? "":" not");
-					if (res) {
-						if (_avr_is_instruction_32_bits(avr, new_pc)) {
-							new_pc += 4; cycle += 2;
-						} else {
-							new_pc += 2; cycle++;
-						}
-					}
-				}	break;
-				case 0x1400: {	// CP -- Compare -- 0001 01rd dddd rrrr
-					get_vd5_vr5(opcode);
-					uint8_t res = vd - vr;
-					STATE("cp %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
-					_avr_flags_sub_zns(avr, res, vd, vr);
-					SREG();
-				}	break;
-				case 0x1c00: {	// ADD -- Add with carry -- 0001 11rd dddd rrrr
-					get_vd5_vr5(opcode);
-					uint8_t res = vd + vr + avr->sreg[S_C];
-					if (r == d) {
-						STATE("rol %s[%02x] = %02x\n", avr_regname(d), avr->data[d], res);
-					} else {
-						STATE("addc %s[%02x], %s[%02x] = %02x\n", avr_regname(d), avr->data[d], avr_regname(r), avr->data[r], res);
-					}
-					_avr_set_r(avr, d, res);
-					_avr_flags_add_zns(avr, res, vd, vr);
-					SREG();
-				}	break;
-				default: _avr_invalid_opcode(avr);
+		case AVR_OP_CP: {	// CP -- Compare -- 0001 01rd dddd rrrr
+			const uint8_t vd = avr->data[d], vr = avr->data[r];
+			uint8_t res = vd - vr;
+			STATE("cp %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
+			_avr_flags_sub_zns(avr, res, vd, vr);
+			SREG();
+		}	break;
+		case AVR_OP_ADC: {	// ADD -- Add with carry -- 0001 11rd dddd rrrr
+			const uint8_t vd = avr->data[d], vr = avr->data[r];
+			uint8_t res = vd + vr + avr->sreg[S_C];
+			if (r == d) {
+				STATE("rol %s[%02x] = %02x\n", avr_regname(d), avr->data[d], res);
+			} else {
+				STATE("addc %s[%02x], %s[%02x] = %02x\n", avr_regname(d), avr->data[d], avr_regname(r), avr->data[r], res);
 			}
+			_avr_set_r(avr, d, res);
+			_avr_flags_add_zns(avr, res, vd, vr);
+			SREG();
 		}	break;
-
-		case 0x2000: {
-			switch (opcode & 0xfc00) {
-				case 0x2000: {	// AND -- Logical AND -- 0010 00rd dddd rrrr
-					get_vd5_vr5(opcode);
-					uint8_t res = vd & vr;
-					if (r == d) {
-						STATE("tst %s[%02x]\n", avr_regname(d), avr->data[d]);
-					} else {
-						STATE("and %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
-					}
-					_avr_set_r(avr, d, res);
-					_avr_flags_znv0s(avr, res);
-					SREG();
-				}	break;
-				case 0x2400: {	// EOR -- Logical Exclusive OR -- 0010 01rd dddd rrrr
-					get_vd5_vr5(opcode);
-					uint8_t res = vd ^ vr;
-					if (r==d) {
-						STATE("clr %s[%02x]\n", avr_regname(d), avr->data[d]);
-					} else {
-						STATE("eor %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
-					}
-					_avr_set_r(avr, d, res);
-					_avr_flags_znv0s(avr, res);
-					SREG();
-				}	break;
-				case 0x2800: {	// OR -- Logical OR -- 0010 10rd dddd rrrr
-					get_vd5_vr5(opcode);
-					uint8_t res = vd | vr;
-					STATE("or %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
-					_avr_set_r(avr, d, res);
-					_avr_flags_znv0s(avr, res);
-					SREG();
-				}	break;
-				case 0x2c00: {	// MOV -- 0010 11rd dddd rrrr
-					get_d5_vr5(opcode);
-					uint8_t res = vr;
-					STATE("mov %s, %s[%02x] = %02x\n", avr_regname(d), avr_regname(r), vr, res);
-					_avr_set_r(avr, d, res);
-				}	break;
-				default: _avr_invalid_opcode(avr);
+		case AVR_OP_AND: {	// AND -- Logical AND -- 0010 00rd dddd rrrr
+			const uint8_t vd = avr->data[d], vr = avr->data[r];
+			uint8_t res = vd & vr;
+			if (r == d) {
+				STATE("tst %s[%02x]\n", avr_regname(d), avr->data[d]);
+			} else {
+				STATE("and %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
 			}
+			_avr_set_r(avr, d, res);
+			_avr_flags_znv0s(avr, res);
+			SREG();
 		}	break;
-
-		case 0x3000: {	// CPI -- Compare Immediate -- 0011 kkkk hhhh kkkk
-			get_vh4_k8(opcode);
+		case AVR_OP_EOR: {	// EOR -- Logical Exclusive OR -- 0010 01rd dddd rrrr
+			const uint8_t vd = avr->data[d], vr = avr->data[r];
+			uint8_t res = vd ^ vr;
+			if (r==d) {
+				STATE("clr %s[%02x]\n", avr_regname(d), avr->data[d]);
+			} else {
+				STATE("eor %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
+			}
+			_avr_set_r(avr, d, res);
+			_avr_flags_znv0s(avr, res);
+			SREG();
+		}	break;
+		case AVR_OP_OR: {	// OR -- Logical OR -- 0010 10rd dddd rrrr
+			const uint8_t vd = avr->data[d], vr = avr->data[r];
+			uint8_t res = vd | vr;
+			STATE("or %s[%02x], %s[%02x] = %02x\n", avr_regname(d), vd, avr_regname(r), vr, res);
+			_avr_set_r(avr, d, res);
+			_avr_flags_znv0s(avr, res);
+			SREG();
+		}	break;
+		case AVR_OP_MOV: {	// MOV -- 0010 11rd dddd rrrr
+			const uint8_t vr = avr->data[r];
+			uint8_t res = vr;
+			STATE("mov %s, %s[%02x] = %02x\n", avr_regname(d), avr_regname(r), vr, res);
+			_avr_set_r(avr, d, res);
+		}	break;
+		case AVR_OP_CPI: {	// CPI -- Compare Immediate -- 0011 kkkk hhhh kkkk
+			const uint8_t h = d, k = r, vh = avr->data[h];
 			uint8_t res = vh - k;
 			STATE("cpi %s[%02x], 0x%02x\n", avr_regname(h), vh, k);
 			_avr_flags_sub_zns(avr, res, vh, k);
 			SREG();
 		}	break;
-
-		case 0x4000: {	// SBCI -- Subtract Immediate With Carry -- 0100 kkkk hhhh kkkk
-			get_vh4_k8(opcode);
+		case AVR_OP_SBCI: {	// SBCI -- Subtract Immediate With Carry -- 0100 kkkk hhhh kkkk
+			const uint8_t h = d, k = r, vh = avr->data[h];
 			uint8_t res = vh - k - avr->sreg[S_C];
 			STATE("sbci %s[%02x], 0x%02x = %02x\n", avr_regname(h), vh, k, res);
 			_avr_set_r(avr, h, res);
 			_avr_flags_sub_Rzns(avr, res, vh, k);
 			SREG();
 		}	break;
-
-		case 0x5000: {	// SUBI -- Subtract Immediate -- 0101 kkkk hhhh kkkk
-			get_vh4_k8(opcode);
+		case AVR_OP_SUBI: {	// SUBI -- Subtract Immediate -- 0101 kkkk hhhh kkkk
+			const uint8_t h = d, k = r, vh = avr->data[h];
 			uint8_t res = vh - k;
 			STATE("subi %s[%02x], 0x%02x = %02x\n", avr_regname(h), vh, k, res);
 			_avr_set_r(avr, h, res);
 			_avr_flags_sub_zns(avr, res, vh, k);
 			SREG();
 		}	break;
-
-		case 0x6000: {	// ORI aka SBR -- Logical OR with Immediate -- 0110 kkkk hhhh kkkk
-			get_vh4_k8(opcode);
+		case AVR_OP_ORI: {	// ORI aka SBR -- Logical OR with Immediate -- 0110 kkkk hhhh kkkk
+			const uint8_t h = d, k = r, vh = avr->data[h];
 			uint8_t res = vh | k;
 			STATE("ori %s[%02x], 0x%02x\n", avr_regname(h), vh, k);
 			_avr_set_r(avr, h, res);
 			_avr_flags_znv0s(avr, res);
 			SREG();
 		}	break;
-
-		case 0x7000: {	// ANDI	-- Logical AND with Immediate -- 0111 kkkk hhhh kkkk
-			get_vh4_k8(opcode);
+		case AVR_OP_ANDI: {	// ANDI	-- Logical AND with Immediate -- 0111 kkkk hhhh kkkk
+			const uint8_t h = d, k = r, vh = avr->data[h];
 			uint8_t res = vh & k;
 			STATE("andi %s[%02x], 0x%02x\n", avr_regname(h), vh, k);
 			_avr_set_r(avr, h, res);
 			_avr_flags_znv0s(avr, res);
 			SREG();
 		}	break;
-
-		case 0xa000:
-		case 0x8000: {
-			/*
-			 * Load (LDD/STD) store instructions
-			 *
-			 * 10q0 qqsd dddd yqqq
-			 * s = 0 = load, 1 = store
-			 * y = 16 bits register index, 1 = Y, 0 = X
-			 * q = 6 bit displacement
-			 */
-			switch (opcode & 0xd008) {
-				case 0xa000:
-				case 0x8000: {	// LD (LDD) -- Load Indirect using Z -- 10q0 qqsd dddd yqqq
-					uint16_t v = avr->data[R_ZL] | (avr->data[R_ZH] << 8);
-					get_d5_q6(opcode);
-					if (opcode & 0x0200) {
-						STATE("st (Z+%d[%04x]), %s[%02x]\n", q, v+q, avr_regname(d), avr->data[d]);
-						_avr_set_ram(avr, v+q, avr->data[d]);
-					} else {
-						STATE("ld %s, (Z+%d[%04x])=[%02x]\n", avr_regname(d), q, v+q, avr->data[v+q]);
-						_avr_set_r(avr, d, _avr_get_ram(avr, v+q));
-					}
-					cycle += 1; // 2 cycles, 3 for tinyavr
-				}	break;
-				case 0xa008:
-				case 0x8008: {	// LD (LDD) -- Load Indirect using Y -- 10q0 qqsd dddd yqqq
-					uint16_t v = avr->data[R_YL] | (avr->data[R_YH] << 8);
-					get_d5_q6(opcode);
-					if (opcode & 0x0200) {
-						STATE("st (Y+%d[%04x]), %s[%02x]\n", q, v+q, avr_regname(d), avr->data[d]);
-						_avr_set_ram(avr, v+q, avr->data[d]);
-					} else {
-						STATE("ld %s, (Y+%d[%04x])=[%02x]\n", avr_regname(d), q, v+q, avr->data[d+q]);
-						_avr_set_r(avr, d, _avr_get_ram(avr, v+q));
-					}
-					cycle += 1; // 2 cycles, 3 for tinyavr
-				}	break;
-				default: _avr_invalid_opcode(avr);
+		/*
+		 * Load (LDD/STD) store instructions
+		 *
+		 * 10q0 qqsd dddd yqqq
+		 * s = 0 = load, 1 = store
+		 * y = 16 bits register index, 1 = Y, 0 = X
+		 * q = 6 bit displacement
+		 */
+		case AVR_OP_LDD_Z: {	// LD (LDD) -- Load Indirect using Z -- 10q0 qqsd dddd yqqq
+			uint16_t v = avr->data[R_ZL] | (avr->data[R_ZH] << 8);
+			const uint8_t q = r;
+			STATE("ld %s, (Z+%d[%04x])=[%02x]\n", avr_regname(d), q, v+q, avr->data[v+q]);
+			_avr_set_r(avr, d, _avr_get_ram(avr, v+q));
+		}	break;
+		case AVR_OP_STD_Z: {	// ST (STD) -- Store Indirect using Z -- 10q0 qqsd dddd yqqq
+			uint16_t v = avr->data[R_ZL] | (avr->data[R_ZH] << 8);
+			const uint8_t q = r;
+			STATE("st (Z+%d[%04x]), %s[%02x]\n", q, v+q, avr_regname(d), avr->data[d]);
+			_avr_set_ram(avr, v+q, avr->data[d]);
+		}	break;
+		case AVR_OP_LDD_Y: {	// LD (LDD) -- Load Indirect using Y -- 10q0 qqsd dddd yqqq
+			uint16_t v = avr->data[R_YL] | (avr->data[R_YH] << 8);
+			const uint8_t q = r;
+			STATE("ld %s, (Y+%d[%04x])=[%02x]\n", avr_regname(d), q, v+q, avr->data[d+q]);
+			_avr_set_r(avr, d, _avr_get_ram(avr, v+q));
+		}	break;
+		case AVR_OP_STD_Y: {	// ST (STD) -- Store Indirect using Y -- 10q0 qqsd dddd yqqq
+			uint16_t v = avr->data[R_YL] | (avr->data[R_YH] << 8);
+			const uint8_t q = r;
+			STATE("st (Y+%d[%04x]), %s[%02x]\n", q, v+q, avr_regname(d), avr->data[d]);
+			_avr_set_ram(avr, v+q, avr->data[d]);
+		}	break;
+		/* these handle all the SREG set/clear opcodes */
+		case AVR_OP_BSET:
+		case AVR_OP_BCLR: {
+			const uint8_t b = d;
+			STATE("%s%c\n", opcode & 0x0080 ? "cl" : "se", _sreg_bit_name[b]);
+			avr_sreg_set(avr, b, dec->op == AVR_OP_BSET);
+			SREG();
+		}	break;
+		case AVR_OP_SLEEP: { // SLEEP -- 1001 0101 1000 1000
+			STATE("sleep\n");
+			/* Don't sleep if there are interrupts about to be serviced.
+			 * Without this check, it was possible to incorrectly enter a state
+			 * in which the cpu was sleeping and interrupts were disabled. For more
+			 * details, see the commit message. */
+			if (!avr_has_pending_interrupts(avr) || !avr->sreg[S_I])
+				avr->state = cpu_Sleeping;
+		}	break;
+		case AVR_OP_BREAK: { // BREAK -- 1001 0101 1001 1000
+			STATE("break\n");
+			if (avr->gdb) {
+				// if gdb is on, we break here as in here
+				// and we do so until gdb restores the instruction
+				// that was here before
+				avr->state = cpu_StepDone;
+				new_pc = avr->pc;
+				cycle = 0;
 			}
 		}	break;
-
-		case 0x9000: {
-			/* this is an annoying special case, but at least these lines handle all the SREG set/clear opcodes */
-			if ((opcode & 0xff0f) == 0x9408) {
-				get_sreg_bit(opcode);
-				STATE("%s%c\n", opcode & 0x0080 ? "cl" : "se", _sreg_bit_name[b]);
-				avr_sreg_set(avr, b, (opcode & 0x0080) == 0);
-				SREG();
-			} else switch (opcode) {
-				case 0x9588: { // SLEEP -- 1001 0101 1000 1000
-					STATE("sleep\n");
-					/* Don't sleep if there are interrupts about to be serviced.
-					 * Without this check, it was possible to incorrectly enter a state
-					 * in which the cpu was sleeping and interrupts were disabled. For more
-					 * details, see the commit message. */
-					if (!avr_has_pending_interrupts(avr) || !avr->sreg[S_I])
-						avr->state = cpu_Sleeping;
-				}	break;
-				case 0x9598: { // BREAK -- 1001 0101 1001 1000
-					STATE("break\n");
-					if (avr->gdb) {
-						// if gdb is on, we break here as in here
-						// and we do so until gdb restores the instruction
-						// that was here before
-						avr->state = cpu_StepDone;
-						new_pc = avr->pc;
-						cycle = 0;
-					}
-				}	break;
-				case 0x95a8: { // WDR -- Watchdog Reset -- 1001 0101 1010 1000
-					STATE("wdr\n");
-					avr_ioctl(avr, AVR_IOCTL_WATCHDOG_RESET, 0);
-				}	break;
-				case 0x95e8: { // SPM -- Store Program Memory -- 1001 0101 1110 1000
-					STATE("spm\n");
-					avr_ioctl(avr, AVR_IOCTL_FLASH_SPM, 0);
-				}	break;
-				case 0x9409:   // IJMP -- Indirect jump -- 1001 0100 0000 1001
-				case 0x9419:   // EIJMP -- Indirect jump -- 1001 0100 0001 1001   bit 4 is "indirect"
-				case 0x9509:   // ICALL -- Indirect Call to Subroutine -- 1001 0101 0000 1001
-				case 0x9519: { // EICALL -- Indirect Call to Subroutine -- 1001 0101 0001 1001   bit 8 is "push pc"
-					int e = opcode & 0x10;
-					int p = opcode & 0x100;
-					if (e && !avr->eind)
-						_avr_invalid_opcode(avr);
-					uint32_t z = avr->data[R_ZL] | (avr->data[R_ZH] << 8);
-					if (e)
-						z |= avr->data[avr->eind] << 16;
-					STATE("%si%s Z[%04x]\n", e?"e":"", p?"call":"jmp", z << 1);
-					if (p)
-						cycle += _avr_push_addr(avr, new_pc) - 1;
-					new_pc = z << 1;
-					cycle++;
-					TRACE_JUMP();
-				}	break;
-				case 0x9518: 	// RETI -- Return from Interrupt -- 1001 0101 0001 1000
-					avr_sreg_set(avr, S_I, 1);
-					avr_interrupt_reti(avr);
-					FALLTHROUGH
-				case 0x9508: {	// RET -- Return -- 1001 0101 0000 1000
-					new_pc = _avr_pop_addr(avr);
-					cycle += 1 + avr->address_size;
-					STATE("ret%s\n", opcode & 0x10 ? "i" : "");
-					TRACE_JUMP();
-					STACK_FRAME_POP();
-				}	break;
-				case 0x95c8: {	// LPM -- Load Program Memory R0 <- (Z) -- 1001 0101 1100 1000
-					uint16_t z = avr->data[R_ZL] | (avr->data[R_ZH] << 8);
-					STATE("lpm %s, (Z[%04x])\n", avr_regname(0), z);
-					cycle += 2; // 3 cycles
-					_avr_set_r(avr, 0, avr->flash[z]);
-				}	break;
-				case 0x95d8: {	// ELPM -- Load Program Memory R0 <- (Z) -- 1001 0101 1101 1000
-					if (!avr->rampz)
-						_avr_invalid_opcode(avr);
-					uint32_t z = avr->data[R_ZL] | (avr->data[R_ZH] << 8) | (avr->data[avr->rampz] << 16);
-					STATE("elpm %s, (Z[%02x:%04x])\n", avr_regname(0), z >> 16, z & 0xffff);
-					_avr_set_r(avr, 0, avr->flash[z]);
-					cycle += 2; // 3 cycles
-				}	break;
-				default:  {
-					switch (opcode & 0xfe0f) {
-						case 0x9000: {	// LDS -- Load Direct from Data Space, 32 bits -- 1001 0000 0000 0000
-							get_d5(opcode);
-							uint16_t x = _avr_flash_read16le(avr, new_pc);
-							new_pc += 2;
-							STATE("lds %s[%02x], 0x%04x\n", avr_regname(d), avr->data[d], x);
-							_avr_set_r(avr, d, _avr_get_ram(avr, x));
-							cycle++; // 2 cycles
-						}	break;
-						case 0x9005:
-						case 0x9004: {	// LPM -- Load Program Memory -- 1001 000d dddd 01oo
-							get_d5(opcode);
-							uint16_t z = avr->data[R_ZL] | (avr->data[R_ZH] << 8);
-							int op = opcode & 1;
-							STATE("lpm %s, (Z[%04x]%s)\n", avr_regname(d), z, op ? "+" : "");
-							_avr_set_r(avr, d, avr->flash[z]);
-							if (op) {
-								z++;
-								_avr_set_r16le_hl(avr, R_ZL, z);
-							}
-							cycle += 2; // 3 cycles
-						}	break;
-						case 0x9006:
-						case 0x9007: {	// ELPM -- Extended Load Program Memory -- 1001 000d dddd 01oo
-							if (!avr->rampz)
-								_avr_invalid_opcode(avr);
-							uint32_t z = avr->data[R_ZL] | (avr->data[R_ZH] << 8) | (avr->data[avr->rampz] << 16);
-							get_d5(opcode);
-							int op = opcode & 1;
-							STATE("elpm %s, (Z[%02x:%04x]%s)\n", avr_regname(d), z >> 16, z & 0xffff, op ? "+" : "");
-							_avr_set_r(avr, d, avr->flash[z]);
-							if (op) {
-								z++;
-								_avr_set_r(avr, avr->rampz, z >> 16);
-								_avr_set_r16le_hl(avr, R_ZL, z);
-							}
-							cycle += 2; // 3 cycles
-						}	break;
-						/*
-						 * Load store instructions
-						 *
-						 * 1001 00sr rrrr iioo
-						 * s = 0 = load, 1 = store
-						 * ii = 16 bits register index, 11 = X, 10 = Y, 00 = Z
-						 * oo = 1) post increment, 2) pre-decrement
-						 */
-						case 0x900c:
-						case 0x900d:
-						case 0x900e: {	// LD -- Load Indirect from Data using X -- 1001 000d dddd 11oo
-							int op = opcode & 3;
-							get_d5(opcode);
-							uint16_t x = (avr->data[R_XH] << 8) | avr->data[R_XL];
-							STATE("ld %s, %sX[%04x]%s\n", avr_regname(d), op == 2 ? "--" : "", x, op == 1 ? "++" : "");
-							cycle++; // 2 cycles (1 for tinyavr, except with inc/dec 2)
-							if (op == 2) x--;
-							uint8_t vd = _avr_get_ram(avr, x);
-							if (op == 1) x++;
-							_avr_set_r16le_hl(avr, R_XL, x);
-							_avr_set_r(avr, d, vd);
-						}	break;
-						case 0x920c:
-						case 0x920d:
-						case 0x920e: {	// ST -- Store Indirect Data Space X -- 1001 001d dddd 11oo
-							int op = opcode & 3;
-							get_vd5(opcode);
-							uint16_t x = (avr->data[R_XH] << 8) | avr->data[R_XL];
-							STATE("st %sX[%04x]%s, %s[%02x] \n", op == 2 ? "--" : "", x, op == 1 ? "++" : "", avr_regname(d), vd);
-							cycle++; // 2 cycles, except tinyavr
-							if (op == 2) x--;
-							_avr_set_ram(avr, x, vd);
-							if (op == 1) x++;
-							_avr_set_r16le_hl(avr, R_XL, x);
-						}	break;
-						case 0x9009:
-						case 0x900a: {	// LD -- Load Indirect from Data using Y -- 1001 000d dddd 10oo
-							int op = opcode & 3;
-							get_d5(opcode);
-							uint16_t y = (avr->data[R_YH] << 8) | avr->data[R_YL];
-							STATE("ld %s, %sY[%04x]%s\n", avr_regname(d), op == 2 ? "--" : "", y, op == 1 ? "++" : "");
-							cycle++; // 2 cycles, except tinyavr
-							if (op == 2) y--;
-							uint8_t vd = _avr_get_ram(avr, y);
-							if (op == 1) y++;
-							_avr_set_r16le_hl(avr, R_YL, y);
-							_avr_set_r(avr, d, vd);
-						}	break;
-						case 0x9209:
-						case 0x920a: {	// ST -- Store Indirect Data Space Y -- 1001 001d dddd 10oo
-							int op = opcode & 3;
-							get_vd5(opcode);
-							uint16_t y = (avr->data[R_YH] << 8) | avr->data[R_YL];
-							STATE("st %sY[%04x]%s, %s[%02x]\n", op == 2 ? "--" : "", y, op == 1 ? "++" : "", avr_regname(d), vd);
-							cycle++;
-							if (op == 2) y--;
-							_avr_set_ram(avr, y, vd);
-							if (op == 1) y++;
-							_avr_set_r16le_hl(avr, R_YL, y);
-						}	break;
-						case 0x9200: {	// STS -- Store Direct to Data Space, 32 bits -- 1001 0010 0000 0000
-							get_vd5(opcode);
-							uint16_t x = _avr_flash_read16le(avr, new_pc);
-							new_pc += 2;
-							STATE("sts 0x%04x, %s[%02x]\n", x, avr_regname(d), vd);
-							cycle++;
-							_avr_set_ram(avr, x, vd);
-						}	break;
-						case 0x9001:
-						case 0x9002: {	// LD -- Load Indirect from Data using Z -- 1001 000d dddd 00oo
-							int op = opcode & 3;
-							get_d5(opcode);
-							uint16_t z = (avr->data[R_ZH] << 8) | avr->data[R_ZL];
-							STATE("ld %s, %sZ[%04x]%s\n", avr_regname(d), op == 2 ? "--" : "", z, op == 1 ? "++" : "");
-							cycle++;; // 2 cycles, except tinyavr
-							if (op == 2) z--;
-							uint8_t vd = _avr_get_ram(avr, z);
-							if (op == 1) z++;
-							_avr_set_r16le_hl(avr, R_ZL, z);
-							_avr_set_r(avr, d, vd);
-						}	break;
-						case 0x9201:
-						case 0x9202: {	// ST -- Store Indirect Data Space Z -- 1001 001d dddd 00oo
-							int op = opcode & 3;
-							get_vd5(opcode);
-							uint16_t z = (avr->data[R_ZH] << 8) | avr->data[R_ZL];
-							STATE("st %sZ[%04x]%s, %s[%02x] \n", op == 2 ? "--" : "", z, op == 1 ? "++" : "", avr_regname(d), vd);
-							cycle++; // 2 cycles, except tinyavr
-							if (op == 2) z--;
-							_avr_set_ram(avr, z, vd);
-							if (op == 1) z++;
-							_avr_set_r16le_hl(avr, R_ZL, z);
-						}	break;
-						case 0x900f: {	// POP -- 1001 000d dddd 1111
-							get_d5(opcode);
-							_avr_set_r(avr, d, _avr_pop8(avr));
-							T(uint16_t sp = _avr_sp_get(avr);)
-							STATE("pop %s (@%04x)[%02x]\n", avr_regname(d), sp, avr->data[sp]);
-							cycle++;
-						}	break;
-						case 0x920f: {	// PUSH -- 1001 001d dddd 1111
-							get_vd5(opcode);
-							_avr_push8(avr, vd);
-							T(uint16_t sp = _avr_sp_get(avr);)
-							STATE("push %s[%02x] (@%04x)\n", avr_regname(d), vd, sp);
-							cycle++;
-						}	break;
-						case 0x9400: {	// COM -- One's Complement -- 1001 010d dddd 0000
-							get_vd5(opcode);
-							uint8_t res = 0xff - vd;
-							STATE("com %s[%02x] = %02x\n", avr_regname(d), vd, res);
-							_avr_set_r(avr, d, res);
-							_avr_flags_znv0s(avr, res);
-							avr->sreg[S_C] = 1;
-							SREG();
-						}	break;
-						case 0x9401: {	// NEG -- Two's Complement -- 1001 010d dddd 0001
-							get_vd5(opcode);
-							uint8_t res = 0x00 - vd;
-							STATE("neg %s[%02x] = %02x\n", avr_regname(d), vd, res);
-							_avr_set_r(avr, d, res);
-							avr->sreg[S_H] = ((res >> 3) | (vd >> 3)) & 1;
-							avr->sreg[S_V] = res == 0x80;
-							avr->sreg[S_C] = res != 0;
-							_avr_flags_zns(avr, res);
-							SREG();
-						}	break;
-						case 0x9402: {	// SWAP -- Swap Nibbles -- 1001 010d dddd 0010
-							get_vd5(opcode);
-							uint8_t res = (vd >> 4) | (vd << 4) ;
-							STATE("swap %s[%02x] = %02x\n", avr_regname(d), vd, res);
-							_avr_set_r(avr, d, res);
-						}	break;
-						case 0x9403: {	// INC -- Increment -- 1001 010d dddd 0011
-							get_vd5(opcode);
-							uint8_t res = vd + 1;
-							STATE("inc %s[%02x] = %02x\n", avr_regname(d), vd, res);
-							_avr_set_r(avr, d, res);
-							avr->sreg[S_V] = res == 0x80;
-							_avr_flags_zns(avr, res);
-							SREG();
-						}	break;
-						case 0x9405: {	// ASR -- Arithmetic Shift Right -- 1001 010d dddd 0101
-							get_vd5(opcode);
-							uint8_t res = (vd >> 1) | (vd & 0x80);
-							STATE("asr %s[%02x]\n", avr_regname(d), vd);
-							_avr_set_r(avr, d, res);
-							_avr_flags_zcnvs(avr, res, vd);
-							SREG();
-						}	break;
-						case 0x9406: {	// LSR -- Logical Shift Right -- 1001 010d dddd 0110
-							get_vd5(opcode);
-							uint8_t res = vd >> 1;
-							STATE("lsr %s[%02x]\n", avr_regname(d), vd);
-							_avr_set_r(avr, d, res);
-							avr->sreg[S_N] = 0;
-							_avr_flags_zcvs(avr, res, vd);
-							SREG();
-						}	break;
-						case 0x9407: {	// ROR -- Rotate Right -- 1001 010d dddd 0111
-							get_vd5(opcode);
-							uint8_t res = (avr->sreg[S_C] ? 0x80 : 0) | vd >> 1;
-							STATE("ror %s[%02x]\n", avr_regname(d), vd);
-							_avr_set_r(avr, d, res);
-							_avr_flags_zcnvs(avr, res, vd);
-							SREG();
-						}	break;
-						case 0x940a: {	// DEC -- Decrement -- 1001 010d dddd 1010
-							get_vd5(opcode);
-							uint8_t res = vd - 1;
-							STATE("dec %s[%02x] = %02x\n", avr_regname(d), vd, res);
-							_avr_set_r(avr, d, res);
-							avr->sreg[S_V] = res == 0x7f;
-							_avr_flags_zns(avr, res);
-							SREG();
-						}	break;
-						case 0x940c:
-						case 0x940d: {	// JMP -- Long Call to sub, 32 bits -- 1001 010a aaaa 110a
-							avr_flashaddr_t a = ((opcode & 0x01f0) >> 3) | (opcode & 1);
-							uint16_t x = _avr_flash_read16le(avr, new_pc);
-							a = (a << 16) | x;
-							STATE("jmp 0x%06x\n", a);
-							new_pc = a << 1;
-							cycle += 2;
-							TRACE_JUMP();
-						}	break;
-						case 0x940e:
-						case 0x940f: {	// CALL -- Long Call to sub, 32 bits -- 1001 010a aaaa 111a
-							avr_flashaddr_t a = ((opcode & 0x01f0) >> 3) | (opcode & 1);
-							uint16_t x = _avr_flash_read16le(avr, new_pc);
-							a = (a << 16) | x;
-							STATE("call 0x%06x\n", a);
-							new_pc += 2;
-							cycle += 1 + _avr_push_addr(avr, new_pc);
-							new_pc = a << 1;
-							TRACE_JUMP();
-							STACK_FRAME_PUSH();
-						}	break;
-
-						default: {
-							switch (opcode & 0xff00) {
-								case 0x9600: {	// ADIW -- Add Immediate to Word -- 1001 0110 KKpp KKKK
-									get_vp2_k6(opcode);
-									uint16_t res = vp + k;
-									STATE("adiw %s:%s[%04x], 0x%02x\n", avr_regname(p), avr_regname(p + 1), vp, k);
-									_avr_set_r16le_hl(avr, p, res);
-									avr->sreg[S_V] = ((~vp & res) >> 15) & 1;
-									avr->sreg[S_C] = ((~res & vp) >> 15) & 1;
-									_avr_flags_zns16(avr, res);
-									SREG();
-									cycle++;
-								}	break;
-								case 0x9700: {	// SBIW -- Subtract Immediate from Word -- 1001 0111 KKpp KKKK
-									get_vp2_k6(opcode);
-									uint16_t res = vp - k;
-									STATE("sbiw %s:%s[%04x], 0x%02x\n", avr_regname(p), avr_regname(p + 1), vp, k);
-									_avr_set_r16le_hl(avr, p, res);
-									avr->sreg[S_V] = ((vp & ~res) >> 15) & 1;
-									avr->sreg[S_C] = ((res & ~vp) >> 15) & 1;
-									_avr_flags_zns16(avr, res);
-									SREG();
-									cycle++;
-								}	break;
-								case 0x9800: {	// CBI -- Clear Bit in I/O Register -- 1001 1000 AAAA Abbb
-									get_io5_b3mask(opcode);
-									uint8_t res = _avr_get_ram(avr, io) & ~mask;
-									STATE("cbi %s[%04x], 0x%02x = %02x\n", avr_regname(io), avr->data[io], mask, res);
-									_avr_set_ram(avr, io, res);
-									cycle++;
-								}	break;
-								case 0x9900: {	// SBIC -- Skip if Bit in I/O Register is Cleared -- 1001 1001 AAAA Abbb
-									get_io5_b3mask(opcode);
-									uint8_t res = _avr_get_ram(avr, io) & mask;
-									STATE("sbic %s[%04x], 0x%02x\t; Will%s branch\n", avr_regname(io), avr->data[io], mask, !res?"":" not");
-									if (!res) {
-										if (_avr_is_instruction_32_bits(avr, new_pc)) {
-											new_pc += 4; cycle += 2;
-										} else {
-											new_pc += 2; cycle++;
-										}
-									}
-								}	break;
-								case 0x9a00: {	// SBI -- Set Bit in I/O Register -- 1001 1010 AAAA Abbb
-									get_io5_b3mask(opcode);
-									uint8_t res = _avr_get_ram(avr, io) | mask;
-									STATE("sbi %s[%04x], 0x%02x = %02x\n", avr_regname(io), avr->data[io], mask, res);
-									_avr_set_ram(avr, io, res);
-									cycle++;
-								}	break;
-								case 0x9b00: {	// SBIS -- Skip if Bit in I/O Register is Set -- 1001 1011 AAAA Abbb
-									get_io5_b3mask(opcode);
-									uint8_t res = _avr_get_ram(avr, io) & mask;
-									STATE("sbis %s[%04x], 0x%02x\t; Will%s branch\n", avr_regname(io), avr->data[io], mask, res?"":" not");
-									if (res) {
-										if (_avr_is_instruction_32_bits(avr, new_pc)) {
-											new_pc += 4; cycle += 2;
-										} else {
-											new_pc += 2; cycle++;
-										}
-									}
-								}	break;
-								default:
-									switch (opcode & 0xfc00) {
-										case 0x9c00: {	// MUL -- Multiply Unsigned -- 1001 11rd dddd rrrr
-											get_vd5_vr5(opcode);
-											uint16_t res = vd * vr;
-											STATE("mul %s[%02x], %s[%02x] = %04x\n", avr_regname(d), vd, avr_regname(r), vr, res);
-											cycle++;
-											_avr_set_r16le(avr, 0, res);
-											avr->sreg[S_Z] = res == 0;
-											avr->sreg[S_C] = (res >> 15) & 1;
-											SREG();
-										}	break;
-										default: _avr_invalid_opcode(avr);
-									}
-							}
-						}	break;
-					}
-				}	break;
+		case AVR_OP_WDR: { // WDR -- Watchdog Reset -- 1001 0101 1010 1000
+			STATE("wdr\n");
+			avr_ioctl(avr, AVR_IOCTL_WATCHDOG_RESET, 0);
+		}	break;
+		case AVR_OP_SPM: { // SPM -- Store Program Memory -- 1001 0101 1110 1000
+			STATE("spm\n");
+			avr_ioctl(avr, AVR_IOCTL_FLASH_SPM, 0);
+		}	break;
+		case AVR_OP_IJMP: {
+			// IJMP -- Indirect jump -- 1001 0100 0000 1001
+			// EIJMP -- Indirect jump -- 1001 0100 0001 1001   bit 4 is "indirect"
+			// ICALL -- Indirect Call to Subroutine -- 1001 0101 0000 1001
+			// EICALL -- Indirect Call to Subroutine -- 1001 0101 0001 1001   bit 8 is "push pc"
+			int e = opcode & 0x10;
+			int p = opcode & 0x100;
+			if (e && !avr->eind)
+				_avr_invalid_opcode(avr);
+			uint32_t z = avr->data[R_ZL] | (avr->data[R_ZH] << 8);
+			if (e)
+				z |= avr->data[avr->eind] << 16;
+			STATE("%si%s Z[%04x]\n", e?"e":"", p?"call":"jmp", z << 1);
+			if (p)
+				cycle += _avr_push_addr(avr, new_pc) - 1;
+			new_pc = z << 1;
+			TRACE_JUMP();
+		}	break;
+		case AVR_OP_RETI: 	// RETI -- Return from Interrupt -- 1001 0101 0001 1000
+			avr_sreg_set(avr, S_I, 1);
+			avr_interrupt_reti(avr);
+			FALLTHROUGH
+		case AVR_OP_RET: {	// RET -- Return -- 1001 0101 0000 1000
+			new_pc = _avr_pop_addr(avr);
+			cycle += avr->address_size;
+			STATE("ret%s\n", opcode & 0x10 ? "i" : "");
+			TRACE_JUMP();
+			STACK_FRAME_POP();
+		}	break;
+		case AVR_OP_LPM_R0: {	// LPM -- Load Program Memory R0 <- (Z) -- 1001 0101 1100 1000
+			uint16_t z = avr->data[R_ZL] | (avr->data[R_ZH] << 8);
+			STATE("lpm %s, (Z[%04x])\n", avr_regname(0), z);
+			_avr_set_r(avr, 0, avr->flash[z]);
+		}	break;
+		case AVR_OP_ELPM_R0: {	// ELPM -- Load Program Memory R0 <- (Z) -- 1001 0101 1101 1000
+			if (!avr->rampz)
+				_avr_invalid_opcode(avr);
+			uint32_t z = avr->data[R_ZL] | (avr->data[R_ZH] << 8) | (avr->data[avr->rampz] << 16);
+			STATE("elpm %s, (Z[%02x:%04x])\n", avr_regname(0), z >> 16, z & 0xffff);
+			_avr_set_r(avr, 0, avr->flash[z]);
+		}	break;
+		case AVR_OP_LDS: {	// LDS -- Load Direct from Data Space, 32 bits -- 1001 0000 0000 0000
+			uint16_t x = dec->k;
+			new_pc += 2;
+			STATE("lds %s[%02x], 0x%04x\n", avr_regname(d), avr->data[d], x);
+			_avr_set_r(avr, d, _avr_get_ram(avr, x));
+		}	break;
+		case AVR_OP_LPM: {	// LPM -- Load Program Memory -- 1001 000d dddd 01oo
+			uint16_t z = avr->data[R_ZL] | (avr->data[R_ZH] << 8);
+			int op = r;
+			STATE("lpm %s, (Z[%04x]%s)\n", avr_regname(d), z, op ? "+" : "");
+			_avr_set_r(avr, d, avr->flash[z]);
+			if (op) {
+				z++;
+				_avr_set_r16le_hl(avr, R_ZL, z);
 			}
 		}	break;
-
-		case 0xb000: {
-			switch (opcode & 0xf800) {
-				case 0xb800: {	// OUT A,Rr -- 1011 1AAd dddd AAAA
-					get_d5_a6(opcode);
-					STATE("out %s, %s[%02x]\n", avr_regname(A), avr_regname(d), avr->data[d]);
-					_avr_set_ram(avr, A, avr->data[d]);
-				}	break;
-				case 0xb000: {	// IN Rd,A -- 1011 0AAd dddd AAAA
-					get_d5_a6(opcode);
-					STATE("in %s, %s[%02x]\n", avr_regname(d), avr_regname(A), avr->data[A]);
-					_avr_set_r(avr, d, _avr_get_ram(avr, A));
-				}	break;
-				default: _avr_invalid_opcode(avr);
+		case AVR_OP_ELPM: {	// ELPM -- Extended Load Program Memory -- 1001 000d dddd 01oo
+			if (!avr->rampz)
+				_avr_invalid_opcode(avr);
+			uint32_t z = avr->data[R_ZL] | (avr->data[R_ZH] << 8) | (avr->data[avr->rampz] << 16);
+			int op = r;
+			STATE("elpm %s, (Z[%02x:%04x]%s)\n", avr_regname(d), z >> 16, z & 0xffff, op ? "+" : "");
+			_avr_set_r(avr, d, avr->flash[z]);
+			if (op) {
+				z++;
+				_avr_set_r(avr, avr->rampz, z >> 16);
+				_avr_set_r16le_hl(avr, R_ZL, z);
 			}
 		}	break;
-
-		case 0xc000: {	// RJMP -- 1100 kkkk kkkk kkkk
-			get_o12(opcode);
+		/*
+		 * Load store instructions
+		 *
+		 * 1001 00sr rrrr iioo
+		 * s = 0 = load, 1 = store
+		 * ii = 16 bits register index, 11 = X, 10 = Y, 00 = Z
+		 * oo = 1) post increment, 2) pre-decrement
+		 */
+		case AVR_OP_LD_X: {	// LD -- Load Indirect from Data using X -- 1001 000d dddd 11oo
+			int op = r;
+			uint16_t x = (avr->data[R_XH] << 8) | avr->data[R_XL];
+			STATE("ld %s, %sX[%04x]%s\n", avr_regname(d), op == 2 ? "--" : "", x, op == 1 ? "++" : "");
+			if (op == 2) x--;
+			uint8_t vd = _avr_get_ram(avr, x);
+			if (op == 1) x++;
+			_avr_set_r16le_hl(avr, R_XL, x);
+			_avr_set_r(avr, d, vd);
+		}	break;
+		case AVR_OP_ST_X: {	// ST -- Store Indirect Data Space X -- 1001 001d dddd 11oo
+			int op = r;
+			const uint8_t vd = avr->data[d];
+			uint16_t x = (avr->data[R_XH] << 8) | avr->data[R_XL];
+			STATE("st %sX[%04x]%s, %s[%02x] \n", op == 2 ? "--" : "", x, op == 1 ? "++" : "", avr_regname(d), vd);
+			if (op == 2) x--;
+			_avr_set_ram(avr, x, vd);
+			if (op == 1) x++;
+			_avr_set_r16le_hl(avr, R_XL, x);
+		}	break;
+		case AVR_OP_LD_Y: {	// LD -- Load Indirect from Data using Y -- 1001 000d dddd 10oo
+			int op = r;
+			uint16_t y = (avr->data[R_YH] << 8) | avr->data[R_YL];
+			STATE("ld %s, %sY[%04x]%s\n", avr_regname(d), op == 2 ? "--" : "", y, op == 1 ? "++" : "");
+			if (op == 2) y--;
+			uint8_t vd = _avr_get_ram(avr, y);
+			if (op == 1) y++;
+			_avr_set_r16le_hl(avr, R_YL, y);
+			_avr_set_r(avr, d, vd);
+		}	break;
+		case AVR_OP_ST_Y: {	// ST -- Store Indirect Data Space Y -- 1001 001d dddd 10oo
+			int op = r;
+			const uint8_t vd = avr->data[d];
+			uint16_t y = (avr->data[R_YH] << 8) | avr->data[R_YL];
+			STATE("st %sY[%04x]%s, %s[%02x]\n", op == 2 ? "--" : "", y, op == 1 ? "++" : "", avr_regname(d), vd);
+			if (op == 2) y--;
+			_avr_set_ram(avr, y, vd);
+			if (op == 1) y++;
+			_avr_set_r16le_hl(avr, R_YL, y);
+		}	break;
+		case AVR_OP_STS: {	// STS -- Store Direct to Data Space, 32 bits -- 1001 0010 0000 0000
+			const uint8_t vd = avr->data[d];
+			uint16_t x = dec->k;
+			new_pc += 2;
+			STATE("sts 0x%04x, %s[%02x]\n", x, avr_regname(d), vd);
+			_avr_set_ram(avr, x, vd);
+		}	break;
+		case AVR_OP_LD_Z: {	// LD -- Load Indirect from Data using Z -- 1001 000d dddd 00oo
+			int op = r;
+			uint16_t z = (avr->data[R_ZH] << 8) | avr->data[R_ZL];
+			STATE("ld %s, %sZ[%04x]%s\n", avr_regname(d), op == 2 ? "--" : "", z, op == 1 ? "++" : "");
+			if (op == 2) z--;
+			uint8_t vd = _avr_get_ram(avr, z);
+			if (op == 1) z++;
+			_avr_set_r16le_hl(avr, R_ZL, z);
+			_avr_set_r(avr, d, vd);
+		}	break;
+		case AVR_OP_ST_Z: {	// ST -- Store Indirect Data Space Z -- 1001 001d dddd 00oo
+			int op = r;
+			const uint8_t vd = avr->data[d];
+			uint16_t z = (avr->data[R_ZH] << 8) | avr->data[R_ZL];
+			STATE("st %sZ[%04x]%s, %s[%02x] \n", op == 2 ? "--" : "", z, op == 1 ? "++" : "", avr_regname(d), vd);
+			if (op == 2) z--;
+			_avr_set_ram(avr, z, vd);
+			if (op == 1) z++;
+			_avr_set_r16le_hl(avr, R_ZL, z);
+		}	break;
+		case AVR_OP_POP: {	// POP -- 1001 000d dddd 1111
+			_avr_set_r(avr, d, _avr_pop8(avr));
+			T(uint16_t sp = _avr_sp_get(avr);)
+			STATE("pop %s (@%04x)[%02x]\n", avr_regname(d), sp, avr->data[sp]);
+		}	break;
+		case AVR_OP_PUSH: {	// PUSH -- 1001 001d dddd 1111
+			const uint8_t vd = avr->data[d];
+			_avr_push8(avr, vd);
+			T(uint16_t sp = _avr_sp_get(avr);)
+			STATE("push %s[%02x] (@%04x)\n", avr_regname(d), vd, sp);
+		}	break;
+		case AVR_OP_COM: {	// COM -- One's Complement -- 1001 010d dddd 0000
+			const uint8_t vd = avr->data[d];
+			uint8_t res = 0xff - vd;
+			STATE("com %s[%02x] = %02x\n", avr_regname(d), vd, res);
+			_avr_set_r(avr, d, res);
+			_avr_flags_znv0s(avr, res);
+			avr->sreg[S_C] = 1;
+			SREG();
+		}	break;
+		case AVR_OP_NEG: {	// NEG -- Two's Complement -- 1001 010d dddd 0001
+			const uint8_t vd = avr->data[d];
+			uint8_t res = 0x00 - vd;
+			STATE("neg %s[%02x] = %02x\n", avr_regname(d), vd, res);
+			_avr_set_r(avr, d, res);
+			avr->sreg[S_H] = ((res >> 3) | (vd >> 3)) & 1;
+			avr->sreg[S_V] = res == 0x80;
+			avr->sreg[S_C] = res != 0;
+			_avr_flags_zns(avr, res);
+			SREG();
+		}	break;
+		case AVR_OP_SWAP: {	// SWAP -- Swap Nibbles -- 1001 010d dddd 0010
+			const uint8_t vd = avr->data[d];
+			uint8_t res = (vd >> 4) | (vd << 4) ;
+			STATE("swap %s[%02x] = %02x\n", avr_regname(d), vd, res);
+			_avr_set_r(avr, d, res);
+		}	break;
+		case AVR_OP_INC: {	// INC -- Increment -- 1001 010d dddd 0011
+			const uint8_t vd = avr->data[d];
+			uint8_t res = vd + 1;
+			STATE("inc %s[%02x] = %02x\n", avr_regname(d), vd, res);
+			_avr_set_r(avr, d, res);
+			avr->sreg[S_V] = res == 0x80;
+			_avr_flags_zns(avr, res);
+			SREG();
+		}	break;
+		case AVR_OP_ASR: {	// ASR -- Arithmetic Shift Right -- 1001 010d dddd 0101
+			const uint8_t vd = avr->data[d];
+			uint8_t res = (vd >> 1) | (vd & 0x80);
+			STATE("asr %s[%02x]\n", avr_regname(d), vd);
+			_avr_set_r(avr, d, res);
+			_avr_flags_zcnvs(avr, res, vd);
+			SREG();
+		}	break;
+		case AVR_OP_LSR: {	// LSR -- Logical Shift Right -- 1001 010d dddd 0110
+			const uint8_t vd = avr->data[d];
+			uint8_t res = vd >> 1;
+			STATE("lsr %s[%02x]\n", avr_regname(d), vd);
+			_avr_set_r(avr, d, res);
+			avr->sreg[S_N] = 0;
+			_avr_flags_zcvs(avr, res, vd);
+			SREG();
+		}	break;
+		case AVR_OP_ROR: {	// ROR -- Rotate Right -- 1001 010d dddd 0111
+			const uint8_t vd = avr->data[d];
+			uint8_t res = (avr->sreg[S_C] ? 0x80 : 0) | vd >> 1;
+			STATE("ror %s[%02x]\n", avr_regname(d), vd);
+			_avr_set_r(avr, d, res);
+			_avr_flags_zcnvs(avr, res, vd);
+			SREG();
+		}	break;
+		case AVR_OP_DEC: {	// DEC -- Decrement -- 1001 010d dddd 1010
+			const uint8_t vd = avr->data[d];
+			uint8_t res = vd - 1;
+			STATE("dec %s[%02x] = %02x\n", avr_regname(d), vd, res);
+			_avr_set_r(avr, d, res);
+			avr->sreg[S_V] = res == 0x7f;
+			_avr_flags_zns(avr, res);
+			SREG();
+		}	break;
+		case AVR_OP_JMP: {	// JMP -- Long Call to sub, 32 bits -- 1001 010a aaaa 110a
+			avr_flashaddr_t a = dec->k;
+			STATE("jmp 0x%06x\n", a);
+			new_pc = a << 1;
+			TRACE_JUMP();
+		}	break;
+		case AVR_OP_CALL: {	// CALL -- Long Call to sub, 32 bits -- 1001 010a aaaa 111a
+			avr_flashaddr_t a = dec->k;
+			STATE("call 0x%06x\n", a);
+			new_pc += 2;
+			cycle += _avr_push_addr(avr, new_pc);
+			new_pc = a << 1;
+			TRACE_JUMP();
+			STACK_FRAME_PUSH();
+		}	break;
+		case AVR_OP_ADIW: {	// ADIW -- Add Immediate to Word -- 1001 0110 KKpp KKKK
+			const uint8_t p = d, k = r;
+			const uint16_t vp = avr->data[p] | (avr->data[p + 1] << 8);
+			uint16_t res = vp + k;
+			STATE("adiw %s:%s[%04x], 0x%02x\n", avr_regname(p), avr_regname(p + 1), vp, k);
+			_avr_set_r16le_hl(avr, p, res);
+			avr->sreg[S_V] = ((~vp & res) >> 15) & 1;
+			avr->sreg[S_C] = ((~res & vp) >> 15) & 1;
+			_avr_flags_zns16(avr, res);
+			SREG();
+		}	break;
+		case AVR_OP_SBIW: {	// SBIW -- Subtract Immediate from Word -- 1001 0111 KKpp KKKK
+			const uint8_t p = d, k = r;
+			const uint16_t vp = avr->data[p] | (avr->data[p + 1] << 8);
+			uint16_t res = vp - k;
+			STATE("sbiw %s:%s[%04x], 0x%02x\n", avr_regname(p), avr_regname(p + 1), vp, k);
+			_avr_set_r16le_hl(avr, p, res);
+			avr->sreg[S_V] = ((vp & ~res) >> 15) & 1;
+			avr->sreg[S_C] = ((res & ~vp) >> 15) & 1;
+			_avr_flags_zns16(avr, res);
+			SREG();
+		}	break;
+		case AVR_OP_CBI: {	// CBI -- Clear Bit in I/O Register -- 1001 1000 AAAA Abbb
+			const uint8_t io = d, mask = r;
+			uint8_t res = _avr_get_ram(avr, io) & ~mask;
+			STATE("cbi %s[%04x], 0x%02x = %02x\n", avr_regname(io), avr->data[io], mask, res);
+			_avr_set_ram(avr, io, res);
+		}	break;
+		case AVR_OP_SBIC: {	// SBIC -- Skip if Bit in I/O Register is Cleared -- 1001 1001 AAAA Abbb
+			const uint8_t io = d, mask = r;
+			uint8_t res = _avr_get_ram(avr, io) & mask;
+			STATE("sbic %s[%04x], 0x%02x\t; Will%s branch\n", avr_regname(io), avr->data[io], mask, !res?"":" not");
+			if (!res) {
+				if (_avr_is_instruction_32_bits(avr, new_pc)) {
+					new_pc += 4; cycle += 2;
+				} else {
+					new_pc += 2; cycle++;
+				}
+			}
+		}	break;
+		case AVR_OP_SBI: {	// SBI -- Set Bit in I/O Register -- 1001 1010 AAAA Abbb
+			const uint8_t io = d, mask = r;
+			uint8_t res = _avr_get_ram(avr, io) | mask;
+			STATE("sbi %s[%04x], 0x%02x = %02x\n", avr_regname(io), avr->data[io], mask, res);
+			_avr_set_ram(avr, io, res);
+		}	break;
+		case AVR_OP_SBIS: {	// SBIS -- Skip if Bit in I/O Register is Set -- 1001 1011 AAAA Abbb
+			const uint8_t io = d, mask = r;
+			uint8_t res = _avr_get_ram(avr, io) & mask;
+			STATE("sbis %s[%04x], 0x%02x\t; Will%s branch\n", avr_regname(io), avr->data[io], mask, res?"":" not");
+			if (res) {
+				if (_avr_is_instruction_32_bits(avr, new_pc)) {
+					new_pc += 4; cycle += 2;
+				} else {
+					new_pc += 2; cycle++;
+				}
+			}
+		}	break;
+		case AVR_OP_MUL: {	// MUL -- Multiply Unsigned -- 1001 11rd dddd rrrr
+			const uint8_t vd = avr->data[d], vr = avr->data[r];
+			uint16_t res = vd * vr;
+			STATE("mul %s[%02x], %s[%02x] = %04x\n", avr_regname(d), vd, avr_regname(r), vr, res);
+			_avr_set_r16le(avr, 0, res);
+			avr->sreg[S_Z] = res == 0;
+			avr->sreg[S_C] = (res >> 15) & 1;
+			SREG();
+		}	break;
+		case AVR_OP_OUT: {	// OUT A,Rr -- 1011 1AAd dddd AAAA
+			const uint8_t A = r;
+			STATE("out %s, %s[%02x]\n", avr_regname(A), avr_regname(d), avr->data[d]);
+			_avr_set_ram(avr, A, avr->data[d]);
+		}	break;
+		case AVR_OP_IN: {	// IN Rd,A -- 1011 0AAd dddd AAAA
+			const uint8_t A = r;
+			STATE("in %s, %s[%02x]\n", avr_regname(d), avr_regname(A), avr->data[A]);
+			_avr_set_r(avr, d, _avr_get_ram(avr, A));
+		}	break;
+		case AVR_OP_RJMP: {	// RJMP -- 1100 kkkk kkkk kkkk
+			const int16_t o = dec->k;
 			STATE("rjmp .%d [%04x]\n", o >> 1, new_pc + o);
 			new_pc = (new_pc + o) % (avr->flashend+1);
-			cycle++;
 			TRACE_JUMP();
 		}	break;
-
-		case 0xd000: {	// RCALL -- 1101 kkkk kkkk kkkk
-			get_o12(opcode);
+		case AVR_OP_RCALL: {	// RCALL -- 1101 kkkk kkkk kkkk
+			const int16_t o = dec->k;
 			STATE("rcall .%d [%04x]\n", o >> 1, new_pc + o);
 			cycle += _avr_push_addr(avr, new_pc);
 			new_pc = (new_pc + o) % (avr->flashend+1);
@@ -1354,66 +1594,53 @@ run_one_again:
 				STACK_FRAME_PUSH();
 			}
 		}	break;
-
-		case 0xe000: {	// LDI Rd, K aka SER (LDI r, 0xff) -- 1110 kkkk dddd kkkk
-			get_h4_k8(opcode);
+		case AVR_OP_LDI: {	// LDI Rd, K aka SER (LDI r, 0xff) -- 1110 kkkk dddd kkkk
+			const uint8_t h = d, k = r;
 			STATE("ldi %s, 0x%02x\n", avr_regname(h), k);
 			_avr_set_r(avr, h, k);
 		}	break;
-
-		case 0xf000: {
-			switch (opcode & 0xfe00) {
-				case 0xf000:
-				case 0xf200:
-				case 0xf400:
-				case 0xf600: {	// BRXC/BRXS -- All the SREG branches -- 1111 0Boo oooo osss
-					int16_t o = ((int16_t)(opcode << 6)) >> 9; // offset
-					uint8_t s = opcode & 7;
-					int set = (opcode & 0x0400) == 0;		// this bit means BRXC otherwise BRXS
-					int branch = (avr->sreg[s] && set) || (!avr->sreg[s] && !set);
-					const char *names[2][8] = {
-							{ "brcc", "brne", "brpl", "brvc", NULL, "brhc", "brtc", "brid"},
-							{ "brcs", "breq", "brmi", "brvs", NULL, "brhs", "brts", "brie"},
-					};
-					if (names[set][s]) {
-						STATE("%s .%d [%04x]\t; Will%s branch\n", names[set][s], o, new_pc + (o << 1), branch ? "":" not");
-					} else {
-						STATE("%s%c .%d [%04x]\t; Will%s branch\n", set ? "brbs" : "brbc", _sreg_bit_name[s], o, new_pc + (o << 1), branch ? "":" not");
-					}
-					if (branch) {
-						cycle++; // 2 cycles if taken, 1 otherwise
-						new_pc = new_pc + (o << 1);
-					}
-				}	break;
-				case 0xf800:
-				case 0xf900: {	// BLD -- Bit Store from T into a Bit in Register -- 1111 100d dddd 0bbb
-					get_vd5_s3_mask(opcode);
-					uint8_t v = (vd & ~mask) | (avr->sreg[S_T] ? mask : 0);
-					STATE("bld %s[%02x], 0x%02x = %02x\n", avr_regname(d), vd, mask, v);
-					_avr_set_r(avr, d, v);
-				}	break;
-				case 0xfa00:
-				case 0xfb00:{	// BST -- Bit Store into T from bit in Register -- 1111 101d dddd 0bbb
-					get_vd5_s3(opcode)
-					STATE("bst %s[%02x], 0x%02x\n", avr_regname(d), vd, 1 << s);
-					avr->sreg[S_T] = (vd >> s) & 1;
-					SREG();
-				}	break;
-				case 0xfc00:
-				case 0xfe00: {	// SBRS/SBRC -- Skip if Bit in Register is Set/Clear -- 1111 11sd dddd 0bbb
-					get_vd5_s3_mask(opcode)
-					int set = (opcode & 0x0200) != 0;
-					int branch = ((vd & mask) && set) || (!(vd & mask) && !set);
-					STATE("%s %s[%02x], 0x%02x\t; Will%s branch\n", set ? "sbrs" : "sbrc", avr_regname(d), vd, mask, branch ? "":" not");
-					if (branch) {
-						if (_avr_is_instruction_32_bits(avr, new_pc)) {
-							new_pc += 4; cycle += 2;
-						} else {
-							new_pc += 2; cycle++;
-						}
-					}
-				}	break;
-				default: _avr_invalid_opcode(avr);
+		case AVR_OP_BRXX: {	// BRXC/BRXS -- All the SREG branches -- 1111 0Boo oooo osss
+			const int16_t o = dec->k; // offset
+			const uint8_t s = d;
+			const int set = r;
+			int branch = (avr->sreg[s] && set) || (!avr->sreg[s] && !set);
+			const char *names[2][8] = {
+					{ "brcc", "brne", "brpl", "brvc", NULL, "brhc", "brtc", "brid"},
+					{ "brcs", "breq", "brmi", "brvs", NULL, "brhs", "brts", "brie"},
+			};
+			if (names[set][s]) {
+				STATE("%s .%d [%04x]\t; Will%s branch\n", names[set][s], o, new_pc + (o << 1), branch ? "":" not");
+			} else {
+				STATE("%s%c .%d [%04x]\t; Will%s branch\n", set ? "brbs" : "brbc", _sreg_bit_name[s], o, new_pc + (o << 1), branch ? "":" not");
+			}
+			if (branch) {
+				cycle++; // 2 cycles if taken, 1 otherwise
+				new_pc = new_pc + (o << 1);
+			}
+		}	break;
+		case AVR_OP_BLD: {	// BLD -- Bit Store from T into a Bit in Register -- 1111 100d dddd 0bbb
+			const uint8_t vd = avr->data[d], mask = 1 << r;
+			uint8_t v = (vd & ~mask) | (avr->sreg[S_T] ? mask : 0);
+			STATE("bld %s[%02x], 0x%02x = %02x\n", avr_regname(d), vd, mask, v);
+			_avr_set_r(avr, d, v);
+		}	break;
+		case AVR_OP_BST: {	// BST -- Bit Store into T from bit in Register -- 1111 101d dddd 0bbb
+			const uint8_t vd = avr->data[d], s = r;
+			STATE("bst %s[%02x], 0x%02x\n", avr_regname(d), vd, 1 << s);
+			avr->sreg[S_T] = (vd >> s) & 1;
+			SREG();
+		}	break;
+		case AVR_OP_SBRX: {	// SBRS/SBRC -- Skip if Bit in Register is Set/Clear -- 1111 11sd dddd 0bbb
+			const uint8_t vd = avr->data[d], mask = 1 << r;
+			int set = (opcode & 0x0200) != 0;
+			int branch = ((vd & mask) && set) || (!(vd & mask) && !set);
+			STATE("%s %s[%02x], 0x%02x\t; Will%s branch\n", set ? "sbrs" : "sbrc", avr_regname(d), vd, mask, branch ? "":" not");
+			if (branch) {
+				if (_avr_is_instruction_32_bits(avr, new_pc)) {
+					new_pc += 4; cycle += 2;
+				} else {
+					new_pc += 2; cycle++;
+				}
 			}
 		}	break;
 
@@ -1422,6 +1649,12 @@ run_one_again:
 	}
 	avr->cycle += cycle;
 
+	/*
+	 * Keep running straight away, without going back to the cycle timers,
+	 * as long as the next timer (or run_cycle_limit) is not due, no
+	 * interrupt is pending and no IO register with side effects was touched
+	 * (see IO_BLOCK_END).
+	 */
 	if ((avr->state == cpu_Running) &&
 		(avr->run_cycle_count > cycle) &&
 		(avr->interrupt_state == 0))
@@ -1433,5 +1666,3 @@ run_one_again:
 
 	return new_pc;
 }
-
-
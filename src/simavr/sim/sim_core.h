@@ -41,6 +41,15 @@ extern "C" {
  */
 avr_flashaddr_t avr_run_one(avr_t * avr);
 
+/*
+ * Pre-decoded instruction cache. avr_run_one() decodes each flash word the
+ * first time it is executed and reuses the result afterward; anything that
+ * writes to avr->flash must call avr_decode_invalidate() for the range.
+ */
+void avr_decode_init(avr_t * avr);
+void avr_decode_free(avr_t * avr);
+void avr_decode_invalidate(avr_t * avr, avr_flashaddr_t addr, uint32_t size);
+
 /*
  * These are for internal access to the stack (for interrupts)
  */
@@ -30,37 +30,128 @@
 		(__e)->next = (__q); \
 		(__q) = __e; \
 	}
-#define DETACH(__q, __l, __e) { \
-		if (__l) \
-			(__l)->next = (__e)->next; \
-		else \
-			(__q) = (__e)->next; \
+
+#define DEFAULT_SLEEP_CYCLES 1000
+
+#define HASH(__timer, __param) \
+	((((uintptr_t)(__timer) >> 4) ^ ((uintptr_t)(__param) >> 3)) % CYCLE_TIMER_HASH_SIZE)
+
+// heap order: earliest first, then in the order they were registered
+#define BEFORE(__a, __b) \
+	((__a)->when < (__b)->when || \
+		((__a)->when == (__b)->when && (int32_t)((__a)->seq - (__b)->seq) < 0))
+
+static void
+avr_cycle_timer_heap_up(
+		avr_cycle_timer_pool_t * pool,
+		uint32_t i)
+{
+	avr_cycle_timer_slot_p t = pool->heap[i];
+	while (i) {
+		uint32_t parent = (i - 1) / 2;
+		if (!BEFORE(t, pool->heap[parent]))
+			break;
+		pool->heap[i] = pool->heap[parent];
+		pool->heap[i]->index = i;
+		i = parent;
 	}
-#define INSERT(__q, __l, __e) { \
-		if (__l) { \
-			(__e)->next = (__l)->next; \
-			(__l)->next = (__e); \
-		} else { \
-			(__e)->next = (__q); \
-			(__q) = (__e); \
-		} \
+	pool->heap[i] = t;
+	t->index = i;
+}
+
+static void
+avr_cycle_timer_heap_down(
+		avr_cycle_timer_pool_t * pool,
+		uint32_t i)
+{
+	avr_cycle_timer_slot_p t = pool->heap[i];
+	for (;;) {
+		uint32_t child = 2 * i + 1;
+		if (child >= pool->count)
+			break;
+		if (child + 1 < pool->count && BEFORE(pool->heap[child + 1], pool->heap[child]))
+			child++;
+		if (!BEFORE(pool->heap[child], t))
+			break;
+		pool->heap[i] = pool->heap[child];
+		pool->heap[i]->index = i;
+		i = child;
 	}
+	pool->heap[i] = t;
+	t->index = i;
+}
 
-#define DEFAULT_SLEEP_CYCLES 1000
+/*
+ * Take a pending timer out of the heap and its hash bucket; the slot
+ * itself is left for the caller to recycle
+ */
+static void
+avr_cycle_timer_detach(
+		avr_cycle_timer_pool_t * pool,
+		avr_cycle_timer_slot_p t)
+{
+	avr_cycle_timer_slot_p * b = &pool->hash[HASH(t->timer, t->param)];
+	while (*b && *b != t)
+		b = &(*b)->next;
+	if (*b)
+		*b = t->next;
+	t->next = NULL;
+
+	uint32_t i = t->index;
+	t->index = -1;
+	if (--pool->count == i)
+		return;
+	pool->heap[i] = pool->heap[pool->count];
+	pool->heap[i]->index = i;
+	if (i && BEFORE(pool->heap[i], pool->heap[(i - 1) / 2]))
+		avr_cycle_timer_heap_up(pool, i);
+	else
+		avr_cycle_timer_heap_down(pool, i);
+}
+
+static avr_cycle_timer_slot_p
+avr_cycle_timer_find(
+		avr_cycle_timer_pool_t * pool,
+		avr_cycle_timer_t timer,
+		void * param)
+{
+	avr_cycle_timer_slot_p t = pool->hash[HASH(timer, param)];
+	while (t && !(t->timer == timer && t->param == param))
+		t = t->next;
+	return t;
+}
 
 void
 avr_cycle_timer_reset(
 		struct avr_t * avr)
 {
 	avr_cycle_timer_pool_t * pool = &avr->cycle_timers;
-	memset(pool, 0, sizeof(*pool));
-	// queue all slots into the free queue
-	for (int i = 0; i < MAX_CYCLE_TIMERS; i++) {
-		avr_cycle_timer_slot_p t = &pool->timer_slots[i];
+	// requeue all the pending slots into the free queue, keep the memory
+	while (pool->count) {
+		avr_cycle_timer_slot_p t = pool->heap[--pool->count];
+		t->index = -1;
 		QUEUE(pool->timer_free, t);
 	}
+	memset(pool->hash, 0, sizeof(pool->hash));
+	pool->seq = 0;
 	avr->run_cycle_count = 1;
 	avr->run_cycle_limit = 1;
+	avr->run_cycle_target = 0;
+}
+
+void
+avr_cycle_timer_free(
+		struct avr_t * avr)
+{
+	avr_cycle_timer_pool_t * pool = &avr->cycle_timers;
+	while (pool->timer_alloc) {
+		avr_cycle_timer_slot_p t = pool->timer_alloc;
+		pool->timer_alloc = t->alloc;
+		free(t);
+	}
+	if (pool->heap)
+		free(pool->heap);
+	memset(pool, 0, sizeof(*pool));
 }
 
 static avr_cycle_count_t
@@ -85,9 +176,9 @@ avr_cycle_timer_reset_sleep_run_cycles_limited(
 	avr_cycle_timer_pool_t * pool = &avr->cycle_timers;
 	avr_cycle_count_t sleep_cycle_count = DEFAULT_SLEEP_CYCLES;
 
-	if(pool->timer) {
-		if(pool->timer->when > avr->cycle) {
-			sleep_cycle_count = pool->timer->when - avr->cycle;
+	if(pool->count) {
+		if(pool->heap[0]->when > avr->cycle) {
+			sleep_cycle_count = pool->heap[0]->when - avr->cycle;
 		} else {
 			sleep_cycle_count = 0;
 		}
@@ -110,26 +201,37 @@ avr_cycle_timer_insert(
 
 	avr_cycle_timer_slot_p t = pool->timer_free;
 
-	if (!t) {
-		AVR_LOG(avr, LOG_ERROR, "CYCLE: %s: ran out of timers (%d)!\n", __func__, MAX_CYCLE_TIMERS);
-		return;
+	if (t) {
+		// detach head
+		pool->timer_free = t->next;
+	} else {
+		t = calloc(1, sizeof(*t));
+		if (!t) {
+			AVR_LOG(avr, LOG_ERROR, "CYCLE: %s: ran out of memory!\n", __func__);
+			return;
+		}
+		t->alloc = pool->timer_alloc;
+		pool->timer_alloc = t;
+	}
+	if (pool->count == pool->size) {
+		uint32_t size = pool->size ? pool->size * 2 : 32;
+		avr_cycle_timer_slot_p * heap = realloc(pool->heap, size * sizeof(*heap));
+		if (!heap) {
+			AVR_LOG(avr, LOG_ERROR, "CYCLE: %s: ran out of memory!\n", __func__);
+			QUEUE(pool->timer_free, t);
+			return;
+		}
+		pool->heap = heap;
+		pool->size = size;
 	}
-	// detach head
-	pool->timer_free = t->next;
-	t->next = NULL;
 	t->timer = timer;
 	t->param = param;
 	t->when = when;
+	t->seq = pool->seq++;
 
-	// find its place in the list
-	avr_cycle_timer_slot_p loop = pool->timer, last = NULL;
-	while (loop) {
-		if (loop->when > when)
-			break;
-		last = loop;
-		loop = loop->next;
-	}
-	INSERT(pool->timer, last, t);
+	QUEUE(pool->hash[HASH(timer, param)], t);
+	pool->heap[pool->count] = t;
+	avr_cycle_timer_heap_up(pool, pool->count++);
 }
 
 void
@@ -142,11 +244,10 @@ avr_cycle_timer_register(
 	avr_cycle_timer_pool_t * pool = &avr->cycle_timers;
 
 	// remove it if it was already scheduled
-	avr_cycle_timer_cancel(avr, timer, param);
-
-	if (!pool->timer_free) {
-		AVR_LOG(avr, LOG_ERROR, "CYCLE: %s: pool is full (%d)!\n", __func__, MAX_CYCLE_TIMERS);
-		return;
+	avr_cycle_timer_slot_p t = avr_cycle_timer_find(pool, timer, param);
+	if (t) {
+		avr_cycle_timer_detach(pool, t);
+		QUEUE(pool->timer_free, t);
 	}
 	avr_cycle_timer_insert(avr, when, timer, param);
 	avr_cycle_timer_reset_sleep_run_cycles_limited(avr);
@@ -170,16 +271,10 @@ avr_cycle_timer_cancel(
 {
 	avr_cycle_timer_pool_t * pool = &avr->cycle_timers;
 
-	// find its place in the list
-	avr_cycle_timer_slot_p t = pool->timer, last = NULL;
-	while (t) {
-		if (t->timer == timer && t->param == param) {
-			DETACH(pool->timer, last, t);
-			QUEUE(pool->timer_free, t);
-			break;
-		}
-		last = t;
-		t = t->next;
+	avr_cycle_timer_slot_p t = avr_cycle_timer_find(pool, timer, param);
+	if (t) {
+		avr_cycle_timer_detach(pool, t);
+		QUEUE(pool->timer_free, t);
 	}
 	avr_cycle_timer_reset_sleep_run_cycles_limited(avr);
 }
@@ -196,17 +291,43 @@ avr_cycle_timer_status(
 {
 	avr_cycle_timer_pool_t * pool = &avr->cycle_timers;
 
-	// find its place in the list
-	avr_cycle_timer_slot_p t = pool->timer;
-	while (t) {
-		if (t->timer == timer && t->param == param) {
-			return 1 + (t->when - avr->cycle);
-		}
-		t = t->next;
-	}
+	avr_cycle_timer_slot_p t = avr_cycle_timer_find(pool, timer, param);
+	if (t)
+		return 1 + (t->when - avr->cycle);
 	return 0;
 }
 
+uint32_t
+avr_cycle_timer_get_pending(
+		struct avr_t * avr,
+		avr_cycle_timer_slot_t * timers)
+{
+	avr_cycle_timer_pool_t * pool = &avr->cycle_timers;
+	if (timers)
+		for (uint32_t i = 0; i < pool->count; i++)
+			timers[i] = *pool->heap[i];
+	return pool->count;
+}
+
+void
+avr_cycle_timer_set_pending(
+		struct avr_t * avr,
+		const avr_cycle_timer_slot_t * timers,
+		uint32_t count,
+		uint32_t seq)
+{
+	avr_cycle_timer_pool_t * pool = &avr->cycle_timers;
+	avr_cycle_timer_reset(avr);
+
+	// heap order only depends on 'when' and 'seq', insertion order doesn't matter
+	for (uint32_t i = 0; i < count; i++) {
+		pool->seq = timers[i].seq;
+		avr_cycle_timer_insert(avr, timers[i].when - avr->cycle,
+				timers[i].timer, timers[i].param);
+	}
+	pool->seq = seq;
+}
+
 /*
  * run through all the timers, call the ones that needs it,
  * clear the ones that wants it, and calculate the next
@@ -218,16 +339,15 @@ avr_cycle_timer_process(
 {
 	avr_cycle_timer_pool_t * pool = &avr->cycle_timers;
 
-	if (pool->timer) do {
-		avr_cycle_timer_slot_p t = pool->timer;
+	while (pool->count) {
+		avr_cycle_timer_slot_p t = pool->heap[0];
 		avr_cycle_count_t when = t->when;
 
 		if (when > avr->cycle)
 			return avr_cycle_timer_return_sleep_run_cycles_limited(avr, when - avr->cycle);
 
 		// detach from active timers
-		pool->timer = t->next;
-		t->next = NULL;
+		avr_cycle_timer_detach(pool, t);
 		do {
 			avr_cycle_count_t w = t->timer(avr, when, t->param);
 			// make sure the return value is either zero, or greater
@@ -240,7 +360,7 @@ avr_cycle_timer_process(
 		
 		// requeue this one into the free ones
 		QUEUE(pool->timer_free, t);
-	} while (pool->timer);
+	}
 
 	// original behavior was to return 1000 cycles when no timers were present...
 	// run_cycles are bound to at least one cycle but no more than requested limit...
@@ -24,9 +24,12 @@
  * these timers are one shots, then get cleared if the timer function returns zero,
  * they get reset if the callback function returns a new cycle number
  *
- * the implementation maintains a list of 'pending' timers, sorted by when they
- * should run, it allows very quick comparison with the next timer to run, and
- * quick removal of then from the pile once dispatched.
+ * the implementation maintains a binary min-heap of 'pending' timers, ordered
+ * by when they should run (and by registration order for the same cycle), it
+ * allows very quick comparison with the next timer to run, and O(log n)
+ * insertion and removal. A small hash on timer/param gives direct access to a
+ * pending timer for cancel and status. There is no limit on the number of
+ * timers, slots are allocated as needed and recycled.
  */
 #ifndef __SIM_CYCLE_TIMERS_H___
 #define __SIM_CYCLE_TIMERS_H___
@@ -37,7 +40,8 @@
 extern "C" {
 #endif
 
-#define MAX_CYCLE_TIMERS	64
+// number of hash buckets used to find a pending timer from its timer/param
+#define CYCLE_TIMER_HASH_SIZE	64
 
 typedef avr_cycle_count_t (*avr_cycle_timer_t)(
 		struct avr_t * avr,
@@ -55,22 +59,29 @@ typedef avr_cycle_count_t (*avr_cycle_timer_t)(
  * repeteadly until it 'caches up'.
  */
 typedef struct avr_cycle_timer_slot_t {
-	struct avr_cycle_timer_slot_t *next;
+	struct avr_cycle_timer_slot_t *next;	// hash bucket, or free queue
+	struct avr_cycle_timer_slot_t *alloc;	// all allocated slots, for freeing
 	avr_cycle_count_t	when;
 	avr_cycle_timer_t	timer;
 	void * param;
+	uint32_t	seq;	// registration order, for timers due on the same cycle
+	int32_t		index;	// position in the heap, -1 when not pending
 } avr_cycle_timer_slot_t, *avr_cycle_timer_slot_p;
 
 /*
  * Timer pool contains a pool of timer slots available, they all
  * start queued into the 'free' qeueue, are migrated to the
- * 'active' queue when needed and are re-queued to the free one
+ * 'active' heap when needed and are re-queued to the free one
  * when done
  */
 typedef struct avr_cycle_timer_pool_t {
-	avr_cycle_timer_slot_t timer_slots[MAX_CYCLE_TIMERS];
+	avr_cycle_timer_slot_p * heap;	// pending timers, heap[0] is the next one due
+	uint32_t	count;				// number of pending timers
+	uint32_t	size;				// allocated size of 'heap'
+	uint32_t	seq;
 	avr_cycle_timer_slot_p timer_free;
-	avr_cycle_timer_slot_p timer;
+	avr_cycle_timer_slot_p timer_alloc;
+	avr_cycle_timer_slot_p hash[CYCLE_TIMER_HASH_SIZE];
 } avr_cycle_timer_pool_t, *avr_cycle_timer_pool_p;
 
 
@@ -113,6 +124,24 @@ avr_cycle_timer_process(
 void
 avr_cycle_timer_reset(
 		struct avr_t * avr);
+void
+avr_cycle_timer_free(
+		struct avr_t * avr);
+
+// snapshots (sim_state.c): copies the pending timers to 'timers' if not
+// NULL, returns their number
+uint32_t
+avr_cycle_timer_get_pending(
+		struct avr_t * avr,
+		avr_cycle_timer_slot_t * timers);
+// cancels all the timers and queues 'timers' back, with their own 'when'
+// and registration order
+void
+avr_cycle_timer_set_pending(
+		struct avr_t * avr,
+		const avr_cycle_timer_slot_t * timers,
+		uint32_t count,
+		uint32_t seq);
 
 #ifdef __cplusplus
 };
@@ -26,12 +26,10 @@
 
 // internal structure for a hook, never seen by the notify procs
 typedef struct avr_irq_hook_t {
-	struct avr_irq_hook_t * next;
-	int busy;	// prevent reentrance of callbacks
-
 	struct avr_irq_t * chain;	// raise the IRQ on this too - optional if "notify" is on
 	avr_irq_notify_t notify;	// called when IRQ is raised - optional if "chain" is on
 	void * param;				// "notify" parameter
+	int busy;	// prevent reentrance of callbacks
 } avr_irq_hook_t;
 
 static void
@@ -103,17 +101,69 @@ avr_alloc_irq(
 	return irq;
 }
 
+/*
+ * Hooks are appended to the irq array, which grows by a few entries at a time
+ * as most irqs have only one or two. Raise calls them from the last one, so
+ * the newest hook is called first.
+ */
 static avr_irq_hook_t *
 _avr_alloc_irq_hook(
 		avr_irq_t * irq)
 {
-	avr_irq_hook_t *hook = malloc(sizeof(avr_irq_hook_t));
+	if (irq->hook_count == irq->hook_size) {
+		irq->hook_size += 4;
+		irq->hook = (avr_irq_hook_t*)realloc(irq->hook,
+				irq->hook_size * sizeof(avr_irq_hook_t));
+	}
+	avr_irq_hook_t *hook = &irq->hook[irq->hook_count++];
 	memset(hook, 0, sizeof(avr_irq_hook_t));
-	hook->next = irq->hook;
-	irq->hook = hook;
 	return hook;
 }
 
+// a hook is busy only while its irq is calling it
+static int
+_avr_irq_hooks_busy(
+		avr_irq_t * irq)
+{
+	for (int i = 0; i < irq->hook_count; i++)
+		if (irq->hook[i].busy)
+			return 1;
+	return 0;
+}
+
+/*
+ * While the hooks are being called removed ones are only cleared, so the
+ * array doesn't move under the raise; they are dropped when it is done.
+ */
+static void
+_avr_free_irq_hook(
+		avr_irq_t * irq,
+		int index)
+{
+	avr_irq_hook_t *hook = &irq->hook[index];
+	hook->chain = NULL;
+	hook->notify = NULL;
+	hook->param = NULL;
+	if (_avr_irq_hooks_busy(irq)) {
+		irq->removed = 1;
+		return;
+	}
+	irq->hook_count--;
+	memmove(hook, hook + 1, (irq->hook_count - index) * sizeof(avr_irq_hook_t));
+}
+
+static void
+_avr_compact_irq_hooks(
+		avr_irq_t * irq)
+{
+	int count = 0;
+	for (int i = 0; i < irq->hook_count; i++)
+		if (irq->hook[i].notify || irq->hook[i].chain)
+			irq->hook[count++] = irq->hook[i];
+	irq->hook_count = count;
+	irq->removed = 0;
+}
+
 void
 avr_free_irq(
 		avr_irq_t * irq,
@@ -129,13 +179,9 @@ avr_free_irq(
 			free((char*)iq->name);
 		iq->name = NULL;
 		// purge hooks
-		avr_irq_hook_t *hook = iq->hook;
-		while (hook) {
-			avr_irq_hook_t * next = hook->next;
-			free(hook);
-			hook = next;
-		}
+		free(iq->hook);
 		iq->hook = NULL;
+		iq->hook_count = iq->hook_size = 0;
 	}
 	// if that irq list was allocated by us, free it
 	if (irq->flags & IRQ_FLAG_ALLOC)
@@ -151,13 +197,10 @@ avr_irq_register_notify(
 	if (!irq || !notify)
 		return;
 
-	avr_irq_hook_t *hook = irq->hook;
-	while (hook) {
-		if (hook->notify == notify && hook->param == param)
+	for (int i = 0; i < irq->hook_count; i++)
+		if (irq->hook[i].notify == notify && irq->hook[i].param == param)
 			return;	// already there
-		hook = hook->next;
-	}
-	hook = _avr_alloc_irq_hook(irq);
+	avr_irq_hook_t *hook = _avr_alloc_irq_hook(irq);
 	hook->notify = notify;
 	hook->param = param;
 }
@@ -168,24 +211,41 @@ avr_irq_unregister_notify(
 		avr_irq_notify_t notify,
 		void * param)
 {
-	avr_irq_hook_t *hook, *prev;
 	if (!irq || !notify)
 		return;
 
-	hook = irq->hook;
-	prev = NULL;
-	while (hook) {
-		if (hook->notify == notify && hook->param == param) {
-			if ( prev )
-				prev->next = hook->next;
-			else
-				irq->hook = hook->next;
-			free(hook);
+	for (int i = 0; i < irq->hook_count; i++)
+		if (irq->hook[i].notify == notify && irq->hook[i].param == param) {
+			_avr_free_irq_hook(irq, i);
 			return;
 		}
-		prev = hook;
-		hook = hook->next;
+}
+
+/*
+ * Hooks added by the callbacks are not called in this raise. The callbacks
+ * can also move the array, so it is read again after each one.
+ */
+static void
+_avr_irq_call_hooks(
+		avr_irq_t * irq,
+		uint32_t output,
+		int floating)
+{
+	for (int i = irq->hook_count - 1; i >= 0; i--) {
+		avr_irq_hook_t * hook = &irq->hook[i];
+		// prevents reentrance / endless calling loops
+		if (hook->busy)
+			continue;
+		hook->busy = 1;
+		if (hook->notify)
+			hook->notify(irq, output, hook->param);
+		hook = &irq->hook[i];
+		if (hook->chain)
+			avr_raise_irq_float(hook->chain, output, floating);
+		irq->hook[i].busy = 0;
 	}
+	if (irq->removed && !_avr_irq_hooks_busy(irq))
+		_avr_compact_irq_hooks(irq);
 }
 
 void
@@ -196,42 +256,25 @@ avr_raise_irq_float(
 {
 	if (!irq)
 		return ;
-	uint32_t output = (irq->flags & IRQ_FLAG_NOT) ? !value : value;
+	uint8_t flags = irq->flags;
+	uint32_t output = (flags & IRQ_FLAG_NOT) ? !value : value;
 	// if value is the same but it's the first time, raise it anyway
 	if (irq->value == output &&
-			(irq->flags & IRQ_FLAG_FILTERED) && !(irq->flags & IRQ_FLAG_INIT))
+			(flags & (IRQ_FLAG_FILTERED | IRQ_FLAG_INIT)) == IRQ_FLAG_FILTERED)
 		return;
-	irq->flags &= ~(IRQ_FLAG_INIT | IRQ_FLAG_FLOATING);
+	flags &= ~(IRQ_FLAG_INIT | IRQ_FLAG_FLOATING);
 	if (floating)
-		irq->flags |= IRQ_FLAG_FLOATING;
-	avr_irq_hook_t *hook = irq->hook;
-	while (hook) {
-		avr_irq_hook_t * next = hook->next;
-			// prevents reentrance / endless calling loops
-		if (hook->busy == 0) {
-			hook->busy++;
-			if (hook->notify)
-				hook->notify(irq, output,  hook->param);
-			if (hook->chain)
-				avr_raise_irq_float(hook->chain, output, floating);
-			hook->busy--;
-		}
-		hook = next;
-	}
+		flags |= IRQ_FLAG_FLOATING;
+	irq->flags = flags;
+
+	if (irq->hook_count)
+		_avr_irq_call_hooks(irq, output, floating);
 	// the value is set after the callbacks are called, so the callbacks
 	// can themselves compare for old/new values between their parameter
 	// they are passed (new value) and the previous irq->value
 	irq->value = output;
 }
 
-void
-avr_raise_irq(
-		avr_irq_t * irq,
-		uint32_t value)
-{
-	avr_raise_irq_float(irq, value, !!(irq->flags & IRQ_FLAG_FLOATING));
-}
-
 void
 avr_connect_irq(
 		avr_irq_t * src,
@@ -241,13 +284,10 @@ avr_connect_irq(
 		fprintf(stderr, "error: %s invalid irq %p/%p", __FUNCTION__, src, dst);
 		return;
 	}
-	avr_irq_hook_t *hook = src->hook;
-	while (hook) {
-		if (hook->chain == dst)
+	for (int i = 0; i < src->hook_count; i++)
+		if (src->hook[i].chain == dst)
 			return;	// already there
-		hook = hook->next;
-	}
-	hook = _avr_alloc_irq_hook(src);
+	avr_irq_hook_t *hook = _avr_alloc_irq_hook(src);
 	hook->chain = dst;
 }
 
@@ -256,26 +296,15 @@ avr_unconnect_irq(
 		avr_irq_t * src,
 		avr_irq_t * dst)
 {
-	avr_irq_hook_t *hook, *prev;
-
 	if (!src || !dst || src == dst) {
 		fprintf(stderr, "error: %s invalid irq %p/%p", __FUNCTION__, src, dst);
 		return;
 	}
-	hook = src->hook;
-	prev = NULL;
-	while (hook) {
-		if (hook->chain == dst) {
-			if ( prev )
-				prev->next = hook->next;
-			else
-				src->hook = hook->next;
-			free(hook);
+	for (int i = 0; i < src->hook_count; i++)
+		if (src->hook[i].chain == dst) {
+			_avr_free_irq_hook(src, i);
 			return;
 		}
-		prev = hook;
-		hook = hook->next;
-	}
 }
 
 uint8_t
@@ -35,8 +35,9 @@ extern "C" {
  * raised. The IRQ definition is up to the module defining it, for example a IOPORT pin change
  * might be an IRQ in which case any piece of code can be notified when a pin has changed state
  *
- * The notify hooks are chained, and duplicates are filtered out so you can't register a
- * notify hook twice on one particular IRQ
+ * The notify hooks are kept in a small array in each IRQ, and duplicates are filtered out so
+ * you can't register a notify hook twice on one particular IRQ. Raising an IRQ with no hooks
+ * only updates its value and flags.
  *
  * IRQ calling order is not defined, so don't rely on it.
  *
@@ -77,7 +78,10 @@ typedef struct avr_irq_t {
 	uint32_t			irq;		//!< any value the user needs
 	uint32_t			value;		//!< current value
 	uint8_t				flags;		//!< IRQ_* flags
-	struct avr_irq_hook_t * hook;	//!< list of hooks to be notified
+	uint8_t				removed;	//!< hooks removed while they were being called
+	uint16_t			hook_count;	//!< hooks in use, including removed ones
+	uint16_t			hook_size;	//!< hooks allocated
+	struct avr_irq_hook_t * hook;	//!< array of hooks to be notified
 } avr_irq_t;
 
 //! allocates 'count' IRQs, initializes their "irq" starting from 'base' and increment
@@ -109,17 +113,27 @@ void
 avr_irq_set_flags(
 		avr_irq_t * irq,
 		uint8_t flags );
-//! 'raise' an IRQ. Ie call their 'hooks', and raise any chained IRQs, and set the new 'value'
-void
-avr_raise_irq(
-		avr_irq_t * irq,
-		uint32_t value);
 //! Same as avr_raise_irq(), but also allow setting the float status
 void
 avr_raise_irq_float(
 		avr_irq_t * irq,
 		uint32_t value,
 		int floating);
+//! 'raise' an IRQ. Ie call their 'hooks', and raise any chained IRQs, and set the new 'value'
+static inline void
+avr_raise_irq(
+		avr_irq_t * irq,
+		uint32_t value)
+{
+	// Most io irqs have no hooks: only value and flags change, no call
+	if (irq && !irq->hook_count) {
+		uint8_t flags = irq->flags;
+		irq->value = (flags & IRQ_FLAG_NOT) ? !value : value;
+		irq->flags = flags & ~IRQ_FLAG_INIT;
+		return;
+	}
+	avr_raise_irq_float(irq, value, irq && (irq->flags & IRQ_FLAG_FLOATING));
+}
 //! this connects a "source" IRQ to a "destination" IRQ
 void
 avr_connect_irq(
@@ -0,0 +1,467 @@
+/*
+	sim_state.c
+
+	Copyright 2026 QtArduSim contributors
+
+ 	This file is part of simavr.
+
+	simavr is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	simavr is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with simavr.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "sim_avr.h"
+#include "sim_core.h"
+#include "sim_io.h"
+#include "sim_cycle_timers.h"
+#include "avr_eeprom.h"
+#include "sim_state.h"
+
+#define STATE_MAGIC		0x52564153	// "SAVR"
+#define STATE_VERSION	3
+
+typedef struct avr_state_header_t {
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	size;			// whole state
+	uint32_t	ptr_size;
+	char		mmcu[32];
+	uint64_t	core_base;		// address of the core block when saved
+	uint64_t	code_base;		// address of the simavr code when saved
+	uint32_t	core_size;
+	uint32_t	ram_size;
+	uint32_t	flash_size;
+	uint32_t	eeprom_size;
+	uint32_t	irq_count;
+	uint32_t	timer_count;
+	uint32_t	timer_seq;
+} avr_state_header_t;
+
+typedef struct avr_state_irq_t {
+	uint64_t	irq;			// address when saved, to relocate timer params
+	uint32_t	value;
+	uint8_t		flags;
+} avr_state_irq_t;
+
+// hooks belong to the host, they are kept when the irq itself is restored
+typedef struct avr_state_hooks_t {
+	struct avr_irq_hook_t *	hook;
+	uint16_t	hook_count;
+	uint16_t	hook_size;
+	uint8_t		removed;
+} avr_state_hooks_t;
+
+// what each word of the core block holds
+enum {
+	STATE_WORD_VALUE = 0,	// state, or pointer to static data/code
+	STATE_WORD_CORE,		// pointer into the core block
+	STATE_WORD_INSTANCE,	// pointer to memory of this instance (irqs, tables)
+};
+
+/*
+ * Layout of the core block of one mcu, built once from two fresh cores:
+ * words pointing into their own block at the same offset are core pointers,
+ * words that differ are instance pointers, the rest are values. 'fresh'
+ * holds the words of a fresh core, a value word still equal to it when
+ * saved is taken from the fresh core of the restoring program (this keeps
+ * pointers to static data and code right).
+ */
+typedef struct avr_state_layout_t {
+	struct avr_state_layout_t * next;
+	char		mmcu[32];
+	uint32_t	core_size;
+	uint8_t *	kind;
+	uintptr_t *	fresh;
+} avr_state_layout_t;
+
+static avr_state_layout_t * avr_state_layouts;
+
+typedef struct avr_state_parts_t {
+	avr_state_header_t	h;
+	const uint8_t *	core;
+	const uint8_t *	fresh;
+	const uint8_t *	ram;
+	const uint8_t *	flash;
+	const uint8_t *	eeprom;
+	const avr_state_irq_t *	irqs;
+	const uint8_t *	timers;
+	avr_state_layout_t * layout;
+} avr_state_parts_t;
+
+static uint8_t *
+avr_state_eeprom(
+		avr_t * avr,
+		uint32_t * size)
+{
+	avr_eeprom_desc_t desc = { .ee = NULL, .offset = 0, .size = avr->e2end + 1 };
+	if (avr->e2end)
+		avr_ioctl(avr, AVR_IOCTL_EEPROM_GET, &desc);
+	*size = desc.ee ? desc.size : 0;
+	return desc.ee;
+}
+
+static void
+avr_state_free_core(
+		avr_t * avr)
+{
+	avr_terminate(avr);
+	free(avr->irq_pool.irq);
+	free(avr);
+}
+
+// pointers the fresh cores leave at NULL, set while running
+static void
+avr_state_core_array(
+		avr_state_layout_t * l,
+		size_t offset,
+		size_t size)
+{
+	for (size_t i = 0; i < size / sizeof(uintptr_t); i++)
+		l->kind[offset / sizeof(uintptr_t) + i] = STATE_WORD_CORE;
+}
+
+static avr_state_layout_t *
+avr_state_layout(
+		avr_t * avr)
+{
+	for (avr_state_layout_t * l = avr_state_layouts; l; l = l->next)
+		if (l->core_size == avr->core_size && !strncmp(l->mmcu, avr->mmcu, sizeof(l->mmcu) - 1))
+			return l;
+
+	avr_t * a = avr_make_mcu_by_name(avr->mmcu);
+	avr_t * b = avr_make_mcu_by_name(avr->mmcu);
+	avr_state_layout_t * l = NULL;
+	if (a)
+		avr_init(a);
+	if (b)
+		avr_init(b);
+
+	if (a && b && a->core_size == avr->core_size && b->core_size == avr->core_size) {
+		uint32_t words = avr->core_size / sizeof(uintptr_t);
+		l = calloc(1, sizeof(*l));
+		strncpy(l->mmcu, avr->mmcu, sizeof(l->mmcu) - 1);
+		l->core_size = avr->core_size;
+		l->kind = calloc(words + 1, 1);
+		l->fresh = calloc(words + 1, sizeof(uintptr_t));
+
+		const uintptr_t * wa = (const uintptr_t *)a;
+		const uintptr_t * wb = (const uintptr_t *)b;
+		for (uint32_t i = 0; i < words; i++) {
+			uintptr_t oa = wa[i] - (uintptr_t)a, ob = wb[i] - (uintptr_t)b;
+			if (oa < a->core_size && oa == ob)
+				l->kind[i] = STATE_WORD_CORE;
+			else if (wa[i] != wb[i])
+				l->kind[i] = STATE_WORD_INSTANCE;
+			l->fresh[i] = wa[i];
+		}
+		avr_state_core_array(l, offsetof(avr_t, interrupts.vector), sizeof(a->interrupts.vector));
+		avr_state_core_array(l, offsetof(avr_t, interrupts.pending.buffer),
+				sizeof(a->interrupts.pending.buffer));
+		avr_state_core_array(l, offsetof(avr_t, interrupts.running), sizeof(a->interrupts.running));
+
+		l->next = avr_state_layouts;
+		avr_state_layouts = l;
+	}
+	if (a)
+		avr_state_free_core(a);
+	if (b)
+		avr_state_free_core(b);
+	return l;
+}
+
+static void
+avr_state_header(
+		avr_t * avr,
+		avr_state_header_t * h)
+{
+	memset(h, 0, sizeof(*h));
+	h->magic = STATE_MAGIC;
+	h->version = STATE_VERSION;
+	h->ptr_size = sizeof(void *);
+	if (avr->mmcu)
+		strncpy(h->mmcu, avr->mmcu, sizeof(h->mmcu) - 1);
+	h->core_base = (uintptr_t)avr;
+	h->code_base = (uintptr_t)&avr_state_save;
+	h->core_size = avr->core_size;
+	h->ram_size = avr->ramend + 1;
+	h->flash_size = avr->flashend + 1;
+	avr_state_eeprom(avr, &h->eeprom_size);
+	h->irq_count = avr->irq_pool.count;
+	h->timer_count = avr_cycle_timer_get_pending(avr, NULL);
+	h->timer_seq = avr->cycle_timers.seq;
+	h->size = sizeof(*h) + 2 * h->core_size + h->ram_size + h->flash_size + h->eeprom_size
+			+ h->irq_count * sizeof(avr_state_irq_t)
+			+ h->timer_count * sizeof(avr_cycle_timer_slot_t);
+}
+
+uint32_t
+avr_state_size(
+		avr_t * avr)
+{
+	avr_state_header_t h;
+	avr_state_header(avr, &h);
+	return h.size;
+}
+
+uint32_t
+avr_state_save(
+		avr_t * avr,
+		void * buffer)
+{
+	avr_state_layout_t * l = avr_state_layout(avr);
+	avr_state_header_t h;
+	avr_state_header(avr, &h);
+
+	uint8_t * dst = buffer;
+	memcpy(dst, &h, sizeof(h));			dst += sizeof(h);
+	memcpy(dst, avr, h.core_size);		dst += h.core_size;
+	if (l)								// without layout the state can't be restored
+		memcpy(dst, l->fresh, (h.core_size / sizeof(uintptr_t)) * sizeof(uintptr_t));
+	else
+		memset(dst, 0, h.core_size);
+	dst += h.core_size;
+	memcpy(dst, avr->data, h.ram_size);	dst += h.ram_size;
+	memcpy(dst, avr->flash, h.flash_size);	dst += h.flash_size;
+	if (h.eeprom_size) {
+		uint32_t size;
+		memcpy(dst, avr_state_eeprom(avr, &size), h.eeprom_size);
+		dst += h.eeprom_size;
+	}
+	avr_state_irq_t * irqs = (avr_state_irq_t *)dst;
+	for (int i = 0; i < h.irq_count; i++) {
+		avr_irq_t * irq = avr->irq_pool.irq[i];
+		memset(&irqs[i], 0, sizeof(irqs[i]));
+		irqs[i].irq = (uintptr_t)irq;
+		if (irq) {
+			irqs[i].value = irq->value;
+			irqs[i].flags = irq->flags;
+		}
+	}
+	dst += h.irq_count * sizeof(avr_state_irq_t);
+	avr_cycle_timer_get_pending(avr, (avr_cycle_timer_slot_t *)dst);
+
+	if (!l)
+		((avr_state_header_t *)buffer)->version = 0;
+	return h.size;
+}
+
+static uintptr_t
+avr_state_word(
+		const uint8_t * block,
+		uint32_t i)
+{
+	uintptr_t w;
+	memcpy(&w, block + i * sizeof(uintptr_t), sizeof(w));
+	return w;
+}
+
+// splits the state and checks it can be restored to 'avr', nothing is changed
+static int
+avr_state_parse(
+		avr_t * avr,
+		const void * buffer,
+		uint32_t size,
+		avr_state_parts_t * p)
+{
+	avr_state_header_t live;
+	if (size < sizeof(p->h))
+		return -1;
+	memcpy(&p->h, buffer, sizeof(p->h));
+	avr_state_header(avr, &live);
+
+	avr_state_header_t * h = &p->h;
+	if (h->magic != STATE_MAGIC || h->version != STATE_VERSION || h->size != size ||
+			h->ptr_size != live.ptr_size || strncmp(h->mmcu, live.mmcu, sizeof(h->mmcu)) ||
+			h->core_size != live.core_size || h->ram_size != live.ram_size ||
+			h->flash_size != live.flash_size || h->eeprom_size != live.eeprom_size ||
+			h->irq_count > live.irq_count) {
+		AVR_LOG(avr, LOG_ERROR, "STATE: %s: state doesn't belong to this core\n", __FUNCTION__);
+		return -1;
+	}
+	p->layout = avr_state_layout(avr);
+	if (!p->layout) {
+		AVR_LOG(avr, LOG_ERROR, "STATE: %s: can't make a %s core\n", __FUNCTION__, h->mmcu);
+		return -1;
+	}
+	const uint8_t * src = (const uint8_t *)buffer + sizeof(*h);
+	p->core = src;		src += h->core_size;
+	p->fresh = src;		src += h->core_size;
+	p->ram = src;		src += h->ram_size;
+	p->flash = src;		src += h->flash_size;
+	p->eeprom = src;	src += h->eeprom_size;
+	p->irqs = (const avr_state_irq_t *)src;
+	src += h->irq_count * sizeof(avr_state_irq_t);
+	p->timers = src;
+
+	// core pointers must point into the saved block
+	uint32_t words = h->core_size / sizeof(uintptr_t);
+	for (uint32_t i = 0; i < words; i++) {
+		uintptr_t saved = avr_state_word(p->core, i);
+		if (p->layout->kind[i] == STATE_WORD_CORE && saved &&
+				saved - h->core_base >= h->core_size) {
+			AVR_LOG(avr, LOG_ERROR, "STATE: %s: bad core pointer\n", __FUNCTION__);
+			return -1;
+		}
+	}
+	// timer params point to the core block or to an irq
+	for (int t = 0; t < h->timer_count; t++) {
+		avr_cycle_timer_slot_t timer;
+		memcpy(&timer, p->timers + t * sizeof(timer), sizeof(timer));
+		uintptr_t param = (uintptr_t)timer.param;
+		int found = !param || param - h->core_base < h->core_size;
+		for (int i = 0; !found && i < h->irq_count; i++)
+			found = p->irqs[i].irq == param && avr->irq_pool.irq[i];
+		if (!found) {
+			AVR_LOG(avr, LOG_ERROR, "STATE: %s: timer param can't be relocated\n", __FUNCTION__);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int
+avr_state_check(
+		avr_t * avr,
+		const void * buffer,
+		uint32_t size)
+{
+	avr_state_parts_t p;
+	return avr_state_parse(avr, buffer, size, &p);
+}
+
+int
+avr_state_restore(
+		avr_t * avr,
+		const void * buffer,
+		uint32_t size)
+{
+	avr_state_parts_t p;
+	if (avr_state_parse(avr, buffer, size, &p))
+		return -1;
+	const avr_state_header_t * h = &p.h;
+	const avr_state_layout_t * l = p.layout;
+	uintptr_t live_core = (uintptr_t)avr;
+	uintptr_t live_code = (uintptr_t)&avr_state_save;
+
+	// timers: params relocated to this core or its irqs, callbacks to this code
+	avr_cycle_timer_slot_t * timers = malloc(h->timer_count * sizeof(avr_cycle_timer_slot_t) + 1);
+	memcpy(timers, p.timers, h->timer_count * sizeof(avr_cycle_timer_slot_t));
+	for (int t = 0; t < h->timer_count; t++) {
+		uintptr_t param = (uintptr_t)timers[t].param;
+		if (param - h->core_base < h->core_size)
+			timers[t].param = (void *)(param - h->core_base + live_core);
+		else for (int i = 0; param && i < h->irq_count; i++)
+			if (p.irqs[i].irq == param) {
+				timers[t].param = avr->irq_pool.irq[i];
+				break;
+			}
+		timers[t].timer = (avr_cycle_timer_t)((uintptr_t)timers[t].timer - h->code_base + live_code);
+	}
+
+	// irqs inside the core block are overwritten below, keep their hooks
+	int irq_count = avr->irq_pool.count;
+	avr_state_hooks_t * hooks = malloc(irq_count * sizeof(avr_state_hooks_t) + 1);
+	for (int i = 0; i < irq_count; i++) {
+		avr_irq_t * irq = avr->irq_pool.irq[i];
+		if (!irq)
+			continue;
+		hooks[i].hook = irq->hook;
+		hooks[i].hook_count = irq->hook_count;
+		hooks[i].hook_size = irq->hook_size;
+		hooks[i].removed = irq->removed;
+	}
+	// parts of avr_t owned by the host or allocated after the core block
+	avr_t * keep = malloc(sizeof(avr_t));
+	memcpy(keep, avr, sizeof(avr_t));
+
+	// merge the block word by word, following the layout of this mcu
+	uint32_t words = h->core_size / sizeof(uintptr_t);
+	uintptr_t * dst = (uintptr_t *)avr;
+	for (uint32_t i = 0; i < words; i++) {
+		uintptr_t saved = avr_state_word(p.core, i);
+		switch (l->kind[i]) {
+			case STATE_WORD_CORE:
+				dst[i] = saved ? saved - h->core_base + live_core : 0;
+				break;
+			case STATE_WORD_INSTANCE:
+				break;
+			default:
+				dst[i] = saved == avr_state_word(p.fresh, i) ? l->fresh[i] : saved;
+		}
+	}
+	memcpy((uint8_t *)avr + words * sizeof(uintptr_t), p.core + words * sizeof(uintptr_t),
+			h->core_size - words * sizeof(uintptr_t));
+
+	avr->init = keep->init;
+	avr->reset = keep->reset;
+	avr->custom = keep->custom;
+	avr->run = keep->run;
+	avr->sleep = keep->sleep;
+	avr->run_cycle_limit = keep->run_cycle_limit;
+	avr->run_cycle_target = keep->run_cycle_target;
+	avr->irq_pool = keep->irq_pool;
+	memcpy(avr->io, keep->io, sizeof(avr->io));
+	avr->io_shared_io_count = keep->io_shared_io_count;
+	memcpy(avr->io_shared_io, keep->io_shared_io, sizeof(avr->io_shared_io));
+	avr->mmcu = keep->mmcu;
+	avr->flash = keep->flash;
+	avr->decoded = keep->decoded;
+	avr->data = keep->data;
+	avr->io_port = keep->io_port;
+	avr->commands = keep->commands;
+	avr->cycle_timers = keep->cycle_timers;
+	avr->trace = keep->trace;
+	avr->log = keep->log;
+	avr->trace_data = keep->trace_data;
+	avr->vcd = keep->vcd;
+	avr->gdb = keep->gdb;
+	avr->gdb_port = keep->gdb_port;
+	avr->io_console_buffer = keep->io_console_buffer;
+	avr->core_size = keep->core_size;
+	free(keep);
+
+	memcpy(avr->data, p.ram, h->ram_size);
+	memcpy(avr->flash, p.flash, h->flash_size);
+	avr_decode_invalidate(avr, 0, h->flash_size);
+	if (h->eeprom_size) {
+		uint32_t size;
+		memcpy(avr_state_eeprom(avr, &size), p.eeprom, h->eeprom_size);
+	}
+
+	for (int i = 0; i < irq_count; i++) {
+		avr_irq_t * irq = avr->irq_pool.irq[i];
+		if (!irq)
+			continue;
+		irq->hook = hooks[i].hook;
+		irq->hook_count = hooks[i].hook_count;
+		irq->hook_size = hooks[i].hook_size;
+		irq->removed = hooks[i].removed;
+		if (i < h->irq_count) {		// irqs allocated later keep their value
+			irq->value = p.irqs[i].value;
+			irq->flags = p.irqs[i].flags;
+		}
+	}
+	free(hooks);
+
+	// set_pending resets the run limits, they were restored with the block
+	avr_cycle_count_t run_cycle_count = avr->run_cycle_count;
+	avr_cycle_count_t run_cycle_limit = avr->run_cycle_limit;
+	avr_cycle_timer_set_pending(avr, timers, h->timer_count, h->timer_seq);
+	avr->run_cycle_count = run_cycle_count;
+	avr->run_cycle_limit = run_cycle_limit;
+	free(timers);
+
+	return 0;
+}
@@ -0,0 +1,82 @@
+/*
+	sim_state.h
+
+	Copyright 2026 QtArduSim contributors
+
+ 	This file is part of simavr.
+
+	simavr is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	simavr is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with simavr.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Core state snapshots.
+ *
+ * A snapshot holds the whole core block (avr_t and the IO modules that
+ * avr_core_allocate() allocates with it: timers, uarts, adc, interrupt
+ * and cycle timer tables...), the registers/IO/SRAM, the flash, the
+ * eeprom and the value of every irq in the pool.
+ *
+ * The core block is full of pointers (IO callbacks, cycle timer callbacks,
+ * interrupt vectors). Which words are pointers is decided once per mcu from
+ * the layout of two fresh cores, never from the saved values: words pointing
+ * into their own block are relocated to the new block, words that differ
+ * between the two cores (memory of each instance) are kept, and the other
+ * words are restored as saved, or from a fresh core if they still had the
+ * fresh value (static data and code pointers, so the snapshot can be
+ * restored in another run of the program). The snapshot holds the fresh
+ * core of the saving program for that. The parts of avr_t owned by the
+ * host (irq hooks, IO callbacks, run/sleep functions, gdb, vcd...) are kept
+ * as they are when restoring; irq hooks are not called.
+ *
+ * Snapshots are only valid for the same build of simavr: the header has a
+ * version, the mmcu name and the sizes, and restore fails if they differ.
+ */
+
+#ifndef __SIM_STATE_H__
+#define __SIM_STATE_H__
+
+#include "sim_avr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// bytes needed by avr_state_save()
+uint32_t
+avr_state_size(
+		avr_t * avr);
+// saves the core state to 'buffer', returns the bytes written
+uint32_t
+avr_state_save(
+		avr_t * avr,
+		void * buffer);
+// checks a state can be restored to 'avr', returns 0 if ok, nothing is changed
+int
+avr_state_check(
+		avr_t * avr,
+		const void * buffer,
+		uint32_t size);
+// restores a state saved from an instance of the same mcu, returns 0 if ok,
+// -1 if the state doesn't belong to this mcu (nothing is changed)
+int
+avr_state_restore(
+		avr_t * avr,
+		const void * buffer,
+		uint32_t size);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif /* __SIM_STATE_H__ */
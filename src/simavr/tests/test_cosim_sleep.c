@@ -0,0 +1,103 @@
+/*
+	test_cosim_sleep.c
+
+	Copyright 2026 QtArduSim contributors
+
+ 	This file is part of simavr.
+
+	simavr is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	simavr is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with simavr.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// In co-simulation, a SLEEP that lands in the middle of a host step must
+// only fast-forward to the end of that step, even if the block of
+// instructions ending in SLEEP already used part of run_cycle_limit.
+//
+// The host loop is the one in AvrProcessor::step().
+//
+// Build and run from src/simavr:
+//   cc -std=gnu99 -I. -Isim -Isim/avr -Icores -o test_cosim_sleep
+//      tests/test_cosim_sleep.c sim/*.c cores/*.c -lelf -lpthread -lm
+//   ./test_cosim_sleep
+
+#include <stdio.h>
+#include <string.h>
+#include "sim_avr.h"
+#include "sim_core.h"
+
+#define STEP_CYCLES	16		// cycles in each host step
+#define STEPS		8
+
+static const uint16_t program[] = {
+	0x9478,		// sei
+	0x0000,		// nop
+	0x0000,		// nop
+	0x0000,		// nop
+	0x0000,		// nop
+	0x0000,		// nop
+	0x9588,		// sleep: at cycle 6, mid step
+	0xcffe,		// rjmp .-4 (back to sleep)
+};
+
+int
+main()
+{
+	avr_t * avr = avr_make_mcu_by_name("atmega328p");
+	if (!avr) {
+		fprintf(stderr, "test_cosim_sleep: no atmega328p core\n");
+		return 1;
+	}
+	avr_init(avr);
+	avr->sleep = avr_callback_sleep_cosim;
+	avr->log = LOG_ERROR;
+
+	for (int i = 0; i < (int)(sizeof(program) / 2); i++) {
+		avr->flash[i * 2] = program[i] & 0xff;
+		avr->flash[i * 2 + 1] = program[i] >> 8;
+	}
+	avr_decode_invalidate(avr, 0, sizeof(program));
+	avr->pc = 0;
+	avr->cycle = 0;
+
+	int slept = 0;
+	avr_cycle_count_t next = STEP_CYCLES;
+
+	for (int step = 0; step < STEPS; step++, next += STEP_CYCLES) {
+		while (avr->cycle < next) {
+			if (avr->state > cpu_StepDone) {
+				fprintf(stderr, "test_cosim_sleep: cpu stopped at step %d\n", step);
+				return 1;
+			}
+			avr_cycle_count_t limit = next - avr->cycle;
+			avr->run_cycle_limit = limit;
+			avr->run_cycle_target = avr->cycle + limit;
+			if (avr->run_cycle_count > limit)
+				avr->run_cycle_count = limit;
+
+			avr->run(avr);
+		}
+		if (avr->state == cpu_Sleeping)
+			slept = 1;
+		if (avr->cycle != next) {
+			fprintf(stderr, "test_cosim_sleep: step %d ended at cycle %lu, expected %lu\n",
+					step, (unsigned long)avr->cycle, (unsigned long)next);
+			return 1;
+		}
+	}
+	if (!slept) {
+		fprintf(stderr, "test_cosim_sleep: cpu never slept\n");
+		return 1;
+	}
+	printf("test_cosim_sleep: OK\n");
+	return 0;
+}
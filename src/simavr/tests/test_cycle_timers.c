@@ -0,0 +1,297 @@
+/*
+	test_cycle_timers.c
+
+	Copyright 2026 QtArduSim contributors
+
+ 	This file is part of simavr.
+
+	simavr is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	simavr is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with simavr.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Randomized differential test of the cycle timers (min-heap and hash)
+// against the sorted list they replaced, kept here as reference.
+//
+// The same random sequence of register, cancel, status and process runs on
+// both, with callbacks that re-arm themselves, cancel or register other
+// timers. Every call and result is logged, both logs must be identical.
+//
+// Build and run from src/simavr:
+//   cc -std=gnu99 -I. -Isim -Isim/avr -Icores -o test_cycle_timers
+//      tests/test_cycle_timers.c sim/*.c cores/*.c -lelf -lpthread -lm
+//   ./test_cycle_timers
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_avr.h"
+#include "sim_cycle_timers.h"
+
+#define SEEDS		200
+#define OPS			2000
+#define TIMERS		4		// callbacks
+#define PARAMS		8		// params for each callback
+#define LOG_SIZE	(OPS * 64)
+
+// Reference: the sorted list implementation, same semantics as the original
+
+typedef struct ref_slot_t {
+	struct ref_slot_t * next;
+	avr_cycle_count_t	when;
+	avr_cycle_timer_t	timer;
+	void * param;
+} ref_slot_t;
+
+static ref_slot_t * ref_timer;
+
+static void
+ref_insert(
+		avr_t * avr,
+		avr_cycle_count_t when,
+		avr_cycle_timer_t timer,
+		void * param)
+{
+	ref_slot_t * t = calloc(1, sizeof(*t));
+	t->timer = timer;
+	t->param = param;
+	t->when = when + avr->cycle;
+
+	ref_slot_t ** l = &ref_timer;		// after the ones due on the same cycle
+	while (*l && (*l)->when <= t->when)
+		l = &(*l)->next;
+	t->next = *l;
+	*l = t;
+}
+
+static void
+ref_cancel(
+		avr_t * avr,
+		avr_cycle_timer_t timer,
+		void * param)
+{
+	for (ref_slot_t ** l = &ref_timer; *l; l = &(*l)->next)
+		if ((*l)->timer == timer && (*l)->param == param) {
+			ref_slot_t * t = *l;
+			*l = t->next;
+			free(t);
+			return;
+		}
+}
+
+static void
+ref_register(
+		avr_t * avr,
+		avr_cycle_count_t when,
+		avr_cycle_timer_t timer,
+		void * param)
+{
+	ref_cancel(avr, timer, param);
+	ref_insert(avr, when, timer, param);
+}
+
+static avr_cycle_count_t
+ref_status(
+		avr_t * avr,
+		avr_cycle_timer_t timer,
+		void * param)
+{
+	for (ref_slot_t * t = ref_timer; t; t = t->next)
+		if (t->timer == timer && t->param == param)
+			return 1 + (t->when - avr->cycle);
+	return 0;
+}
+
+static avr_cycle_count_t
+ref_process(
+		avr_t * avr)
+{
+	while (ref_timer) {
+		ref_slot_t * t = ref_timer;
+		avr_cycle_count_t when = t->when;
+		if (when > avr->cycle)
+			return when - avr->cycle;
+		ref_timer = t->next;
+		do {
+			avr_cycle_count_t w = t->timer(avr, when, t->param);
+			when = w > when ? w : 0;
+		} while (when && when <= avr->cycle);
+		if (when)
+			ref_insert(avr, when - avr->cycle, t->timer, t->param);
+		free(t);
+	}
+	return 1000;
+}
+
+static void
+ref_clear()
+{
+	while (ref_timer) {
+		ref_slot_t * t = ref_timer;
+		ref_timer = t->next;
+		free(t);
+	}
+}
+
+// Both implementations driven through the same calls
+
+static int use_ref;
+static uint32_t rnd_state;
+static char log_buf[LOG_SIZE];
+static int log_len;
+
+static uint32_t
+rnd(uint32_t n)
+{
+	rnd_state = rnd_state * 1103515245 + 12345;
+	return (rnd_state >> 8) % n;
+}
+
+static void
+log_line(const char * fmt, unsigned a, unsigned b, unsigned long long c)
+{
+	if (log_len < LOG_SIZE - 64)
+		log_len += snprintf(log_buf + log_len, LOG_SIZE - log_len, fmt, a, b, c);
+}
+
+static avr_cycle_timer_t timers[TIMERS];
+static int params[PARAMS];
+
+static void
+do_register(avr_t * avr, avr_cycle_count_t when, int ti, int pi)
+{
+	if (use_ref)
+		ref_register(avr, when, timers[ti], &params[pi]);
+	else
+		avr_cycle_timer_register(avr, when, timers[ti], &params[pi]);
+}
+
+static void
+do_cancel(avr_t * avr, int ti, int pi)
+{
+	if (use_ref)
+		ref_cancel(avr, timers[ti], &params[pi]);
+	else
+		avr_cycle_timer_cancel(avr, timers[ti], &params[pi]);
+}
+
+static avr_cycle_count_t
+do_status(avr_t * avr, int ti, int pi)
+{
+	if (use_ref)
+		return ref_status(avr, timers[ti], &params[pi]);
+	return avr_cycle_timer_status(avr, timers[ti], &params[pi]);
+}
+
+static avr_cycle_count_t
+do_process(avr_t * avr)
+{
+	if (use_ref)
+		return ref_process(avr);
+	return avr_cycle_timer_process(avr);
+}
+
+// callbacks never register or cancel themselves: a timer that is running
+// is in neither implementation, both would then queue it twice
+static avr_cycle_count_t
+callback(avr_t * avr, int ti, avr_cycle_count_t when, void * param)
+{
+	int pi = (int *)param - params;
+	log_line("call %u/%u at %llu\n", ti, pi, when);
+
+	int oti = rnd(TIMERS), opi = rnd(PARAMS);
+	if (oti != ti || opi != pi) {
+		switch (rnd(4)) {
+			case 0: do_cancel(avr, oti, opi); break;
+			case 1: do_register(avr, rnd(30), oti, opi); break;
+		}
+	}
+	switch (rnd(3)) {
+		case 0: return 0;
+		case 1: return when + 1 + rnd(40);
+		default: return when + rnd(2);		// same cycle: not re-armed
+	}
+}
+
+static avr_cycle_count_t cb0(avr_t * avr, avr_cycle_count_t when, void * p) { return callback(avr, 0, when, p); }
+static avr_cycle_count_t cb1(avr_t * avr, avr_cycle_count_t when, void * p) { return callback(avr, 1, when, p); }
+static avr_cycle_count_t cb2(avr_t * avr, avr_cycle_count_t when, void * p) { return callback(avr, 2, when, p); }
+static avr_cycle_count_t cb3(avr_t * avr, avr_cycle_count_t when, void * p) { return callback(avr, 3, when, p); }
+
+static void
+run(avr_t * avr, uint32_t seed)
+{
+	rnd_state = seed;
+	log_len = 0;
+	avr->cycle = 0;
+	avr->run_cycle_limit = 1 << 30;
+
+	for (int op = 0; op < OPS; op++) {
+		int ti = rnd(TIMERS), pi = rnd(PARAMS);
+		switch (rnd(5)) {
+			case 0:
+			case 1:
+				do_register(avr, rnd(50), ti, pi);
+				break;
+			case 2:
+				do_cancel(avr, ti, pi);
+				break;
+			case 3:
+				log_line("status %u/%u %llu\n", ti, pi, do_status(avr, ti, pi));
+				break;
+			default:
+				avr->cycle += rnd(20);
+				log_line("process %u/%u %llu\n", 0, 0, do_process(avr));
+				break;
+		}
+	}
+}
+
+int
+main()
+{
+	timers[0] = cb0;
+	timers[1] = cb1;
+	timers[2] = cb2;
+	timers[3] = cb3;
+
+	avr_t * avr = calloc(1, sizeof(avr_t));
+	avr->log = LOG_ERROR;
+	static char ref_log[LOG_SIZE];
+
+	for (uint32_t seed = 1; seed <= SEEDS; seed++) {
+		use_ref = 1;
+		run(avr, seed);
+		ref_clear();
+		memcpy(ref_log, log_buf, log_len + 1);
+		int ref_len = log_len;
+
+		use_ref = 0;
+		avr_cycle_timer_reset(avr);
+		run(avr, seed);
+
+		if (log_len != ref_len || memcmp(log_buf, ref_log, log_len)) {
+			int i = 0;
+			while (i < log_len && log_buf[i] == ref_log[i])
+				i++;
+			while (i && log_buf[i - 1] != '\n')
+				i--;
+			fprintf(stderr, "test_cycle_timers: seed %u differs at:\n  heap: %.40s\n  list: %.40s\n",
+					seed, log_buf + i, ref_log + i);
+			return 1;
+		}
+	}
+	avr_cycle_timer_free(avr);
+	free(avr);
+	printf("test_cycle_timers: OK\n");
+	return 0;
+}
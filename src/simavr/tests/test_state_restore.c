@@ -0,0 +1,139 @@
+/*
+	test_state_restore.c
+
+	Copyright 2026 QtArduSim contributors
+
+ 	This file is part of simavr.
+
+	simavr is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	simavr is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with simavr.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// A snapshot taken from one core must restore to another instance of the
+// same mcu (as after a restart of the program) and both must then run the
+// same way, including a Timer0 overflow interrupt pending as cycle timer.
+// A state word holding a value that looks like a pointer must stay as is.
+//
+// Build and run from src/simavr:
+//   cc -std=gnu99 -I. -Isim -Isim/avr -Icores -o test_state_restore
+//      tests/test_state_restore.c sim/*.c cores/*.c -lelf -lpthread -lm
+//   ./test_state_restore
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_avr.h"
+#include "sim_core.h"
+#include "sim_state.h"
+
+#define RUN_CYCLES	5000
+
+static const uint16_t program[] = {
+	0x940c, 0x0034,	// 0x00: jmp main
+	0x0000, 0x0000,	// vectors 1..15 unused
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+	0x0000, 0x0000, 0x0000, 0x0000,
+	0x940c, 0x003c,	// 0x40: TIMER0_OVF, jmp isr
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+	// 0x68 main:
+	0xe001,		// ldi r16, 1
+	0xbd05,		// out TCCR0B, r16: clk/1
+	0x9300, 0x006e,	// sts TIMSK0, r16: overflow interrupt
+	0x9478,		// sei
+	0x9513,		// loop: inc r17
+	0xcffe,		// rjmp loop
+	0x0000,
+	// 0x78 isr:
+	0x9523,		// inc r18
+	0x9518,		// reti
+};
+
+static avr_t *
+make_core()
+{
+	avr_t * avr = avr_make_mcu_by_name("atmega328p");
+	if (!avr)
+		return NULL;
+	avr_init(avr);
+	avr->log = LOG_ERROR;
+	return avr;
+}
+
+static void
+run(avr_t * avr, avr_cycle_count_t until)
+{
+	while (avr->cycle < until && avr->state < cpu_Done)
+		avr->run(avr);
+}
+
+int
+main()
+{
+	avr_t * a = make_core();
+	if (!a) {
+		fprintf(stderr, "test_state_restore: no atmega328p core\n");
+		return 1;
+	}
+	for (int i = 0; i < (int)(sizeof(program) / 2); i++) {
+		a->flash[i * 2] = program[i] & 0xff;
+		a->flash[i * 2 + 1] = program[i] >> 8;
+	}
+	avr_decode_invalidate(a, 0, sizeof(program));
+	run(a, RUN_CYCLES);
+
+	uint32_t size = avr_state_size(a);
+	uint8_t * state = malloc(size);
+	avr_state_save(a, state);
+
+	avr_t * b = make_core();		// another instance, empty flash
+	if (avr_state_restore(b, state, size) != 0) {
+		fprintf(stderr, "test_state_restore: restore to another core failed\n");
+		return 1;
+	}
+	if (b->cycle != a->cycle || b->pc != a->pc) {
+		fprintf(stderr, "test_state_restore: cycle/pc not restored\n");
+		return 1;
+	}
+	run(a, 2 * RUN_CYCLES);
+	run(b, 2 * RUN_CYCLES);
+
+	if (a->data[17] != b->data[17] || a->data[18] != b->data[18] || a->cycle != b->cycle) {
+		fprintf(stderr, "test_state_restore: runs differ: r17 %d/%d r18 %d/%d\n",
+				a->data[17], b->data[17], a->data[18], b->data[18]);
+		return 1;
+	}
+	if (b->data[18] < 2) {
+		fprintf(stderr, "test_state_restore: timer interrupt didn't run after restore\n");
+		return 1;
+	}
+	// state words are never taken for pointers because of their value
+	avr_cycle_count_t cycle = a->cycle;
+	a->cycle = (uintptr_t)a + 64;
+	avr_state_save(a, state);
+	a->cycle = cycle;
+	if (avr_state_restore(b, state, size) != 0 || b->cycle != (uintptr_t)a + 64) {
+		fprintf(stderr, "test_state_restore: cycle taken for a pointer\n");
+		return 1;
+	}
+	state[8] ^= 1;					// corrupted header: must be rejected
+	if (avr_state_restore(b, state, size) == 0) {
+		fprintf(stderr, "test_state_restore: bad state accepted\n");
+		return 1;
+	}
+	printf("test_state_restore: OK\n");
+	return 0;
+}
@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <math.h>
+
+#include "adaptivestep.h"
+#include "simulator.h"
+
+AdaptiveStep::AdaptiveStep()
+{
+    m_x     = 0;
+    m_xPrev = 0;
+    m_xNew  = 0;
+    m_hPrev = 0;
+    m_hStep = 0;
+    m_order = 0;
+    m_lastStep = 0;
+}
+
+void AdaptiveStep::check( eElement* el, double x, double absTol )
+{
+    Simulator* sim = Simulator::self();
+    double hAcc = sim->reacPoint()-m_lastStep; // Step just integrated
+    bool reject = false;
+
+    if( sim->reacRestart() && (m_order > 0) ) // Step cut by fast changes: value at this point
+    {
+        if( hAcc < m_hStep ) x = m_x+(x-m_x)*hAcc/m_hStep;
+        m_order = 0;                          // Don't use history before fast changes
+    }
+
+    if( !sim->reacRedoing() && (m_order == 2) ) // Error estimation: difference with linear extrapolation
+    {
+        double xLin = m_x+(m_x-m_xPrev)*hAcc/m_hPrev;
+        double err  = fabs( x-xLin )/3;
+        double tol  = 1e-3*fabs( x )+absTol;
+
+        if( err > tol )
+        {
+            sim->reacStepHint( hAcc/2 );
+            reject = true;
+        }
+        else if( err < tol/8 ) sim->reacStepHint( hAcc*2 );
+        else                   sim->reacStepHint( hAcc );
+    }
+    m_xNew = x;
+    sim->reacDone( el, reject );
+}
+
+void AdaptiveStep::accept()
+{
+    Simulator* sim = Simulator::self();
+    uint64_t point = sim->reacPoint();
+
+    if( m_order > 0 )
+    {
+        m_xPrev = m_x;
+        m_hPrev = point-m_lastStep;
+    }
+    m_x = m_xNew;
+    if( m_order < 2 ) m_order++;
+
+    m_lastStep = point;
+    m_hStep = sim->reacTarget()-point;
+}
+
+void AdaptiveStep::reject()
+{
+    m_hStep = Simulator::self()->reacTarget()-m_lastStep;
+}
+
+void AdaptiveStep::coefs( double &a0, double &a1, double &a2 )
+{
+    if( m_order == 1 )                              // Backward Euler
+    {
+        a0 = 1; a1 = 1; a2 = 0;
+        return;
+    }
+    double w = m_hStep/m_hPrev;
+    a0 = (1+2*w)/(1+w);
+    a1 = 1+w;
+    a2 = w*w/(1+w);
+}
+
+void AdaptiveStep::saveState( QDataStream &out )
+{
+    out << m_x << m_xPrev << m_hPrev << m_hStep << m_order << quint64( m_lastStep );
+}
+
+void AdaptiveStep::loadState( QDataStream &in )
+{
+    quint64 lastStep;
+    in >> m_x >> m_xPrev >> m_hPrev >> m_hStep >> m_order >> lastStep;
+    m_lastStep = lastStep;
+}
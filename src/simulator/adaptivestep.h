@@ -0,0 +1,70 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ADAPTIVESTEP_H
+#define ADAPTIVESTEP_H
+
+#include <stdint.h>
+#include <QDataStream>
+
+class eElement;
+
+// Adaptive step of one Reactive element: history of the integrated value
+// (capacitor voltage, inductor current), error estimation and Gear-2
+// (BDF2) coefficients with variable step.
+//
+// All Reactive elements of a step are accepted or rejected together:
+// check() tells the Simulator the error of the value at reacPoint(), then
+// the Simulator calls reacAccept() or reacReject() of every element, which
+// call accept() or reject() here and stamp a step of hStep().
+
+class MAINMODULE_EXPORT AdaptiveStep
+{
+    public:
+        AdaptiveStep();
+
+        void reset() { m_order = 0; }
+
+        // Value at reacPoint(), absTol is added to the relative tolerance
+        void check( eElement* el, double x, double absTol );
+        void accept();     // Value becomes history, next step up to reacTarget()
+        void reject();     // History unchanged, integrate again up to reacTarget()
+
+        // Companion model of step being integrated: dx/dt = (a0*x-a1*last()+a2*prev())/h
+        void coefs( double &a0, double &a1, double &a2 );
+
+        int    order() { return m_order; }
+        double last()  { return m_x; }
+        double prev()  { return m_xPrev; }
+        double hStep() { return m_hStep; }
+
+        void saveState( QDataStream &out );
+        void loadState( QDataStream &in );
+
+    private:
+        double m_x;         // Value at last accepted point
+        double m_xPrev;     // Value at accepted point before it
+        double m_xNew;      // Value at point being checked
+        double m_hPrev;     // Length of previous step (simulation steps)
+        double m_hStep;     // Length of step being integrated
+
+        int      m_order;   // Number of valid steps in history
+        uint64_t m_lastStep;
+};
+
+#endif
@@ -19,9 +19,14 @@
 
 #include <iostream>
 #include <math.h>
+#include <algorithm>
 
 //#include <iomanip>
 
+#include <qtconcurrentmap.h>
+#include <QElapsedTimer>
+#include <QThreadPool>
+
 #include "circmatrix.h"
 #include "simulator.h"
 
@@ -31,8 +36,15 @@ CircMatrix::CircMatrix()
 {
     m_pSelf = this;
     m_numEnodes = 0;
+    m_sparse = false;
+    m_parMinSize = 64;
+    m_parMinWork = 1<<30;
+    m_calibrate  = false;
+}
+CircMatrix::~CircMatrix()
+{
+    for( SparseSolver* solver : m_sparseList ) delete solver;
 }
-CircMatrix::~CircMatrix(){}
 
 void CircMatrix::createMatrix( QList<eNode*> &eNodeList, QList<eElement*> &elementList )
 {
@@ -40,15 +52,13 @@ void CircMatrix::createMatrix( QList<eNode*> &eNodeList, QList<eElement*> &eleme
     m_eNodeList = &eNodeList;
     m_numEnodes = eNodeList.size();
 
-    m_circMatrix.clear();
     m_coefVect.clear();
-
-    m_circMatrix.resize( m_numEnodes , d_vector_t( m_numEnodes , 0 ) );
     m_coefVect.resize( m_numEnodes , 0 );
     
     m_circChanged  = true;
     m_admitChanged = false;
     m_currChanged  = false;
+    m_calibrate    = true;
     
      // Initialize eNodes
     std::cout <<"\nInitializing "<< m_numEnodes << " eNodes"<< std::endl;
@@ -60,140 +70,455 @@ void CircMatrix::createMatrix( QList<eNode*> &eNodeList, QList<eElement*> &eleme
     }
     std::cout <<"\nInitializing "<< m_elementList.size() << " eElements"<< std::endl;
     foreach( eElement* el, m_elementList ) el->initialize();
+
+    // Create compressed Matrix from all possible eNode connections
+    m_rowPtr.assign( m_numEnodes+1, 0 );
+    m_colInd.clear();
+
+    for( int i=0; i<m_numEnodes; i++ )
+    {
+        i_vector_t cols;
+        cols.push_back( i+1 );
+
+        foreach( int nodeNum, m_eNodeList->at(i)->getAllConnections() )
+            if( nodeNum > 0 ) cols.push_back( nodeNum );
+
+        std::sort( cols.begin(), cols.end() );
+        cols.erase( std::unique( cols.begin(), cols.end() ), cols.end() );
+
+        m_rowPtr[i] = m_colInd.size();
+        m_colInd.insert( m_colInd.end(), cols.begin(), cols.end() );
+    }
+    m_rowPtr[m_numEnodes] = m_colInd.size();
+    m_values.assign( m_colInd.size(), 0 );
+
+    for( int i=0; i<m_numEnodes; i++ ) m_eNodeList->at(i)->createSlots();
+
     foreach( eElement* el, m_elementList ) el->stamp();
     for( int i=0; i<m_numEnodes; i++ ) m_eNodeList->at(i)->stampMatrix();
 }
 
-void CircMatrix::stampMatrix( int row, int col, double value )
+int CircMatrix::getSlot( int row, int col )        // eNode numbers start at 1
 {
-    m_admitChanged = true;
-    
-    m_circMatrix[row-1][col-1] = value;      // eNode numbers start at 1
+    const int* first = &m_colInd[0]+m_rowPtr[row-1];
+    const int* last  = &m_colInd[0]+m_rowPtr[row];
+    const int* it = std::lower_bound( first, last, col );
+
+    if( (it == last) || (*it != col) ) return -1;
+    return it-&m_colInd[0];
 }
 
-void CircMatrix::stampCoef( int row, double value )
+int CircMatrix::findRoot( int enodeNum )
 {
-    m_currChanged = true;
-    
-    m_coefVect[row-1] = value;
+    int* root = &m_nodeRoot[0];
+
+    while( root[enodeNum] != enodeNum )
+    {
+        root[enodeNum] = root[ root[enodeNum] ];             // Path halving
+        enodeNum = root[enodeNum];
+    }
+    return enodeNum;
 }
 
-void CircMatrix::addConnections( int enodNum, QList<int>* nodeGroup, QList<int>* allNodes )
+void CircMatrix::joinNodes( int enodeA, int enodeB )
 {
-    nodeGroup->append( enodNum );
-    allNodes->removeOne( enodNum );
+    enodeA = findRoot( enodeA );
+    enodeB = findRoot( enodeB );
 
-    eNode* enod = m_eNodeList->at( enodNum-1 );
-    enod->setSingle( false );
-    
-    QList<int> cons = enod->getConnections();
-    
-    foreach( int nodeNum, cons ) 
+    if     ( enodeA < enodeB ) m_nodeRoot[enodeB] = enodeA;
+    else if( enodeB < enodeA ) m_nodeRoot[enodeA] = enodeB;
+}
+
+void CircMatrix::conChanged( int enodeA, int enodeB, bool connected )
+{
+    if( m_circChanged ) return;              // Full split pending
+
+    // A new connection inside a group doesn't change groups
+    if( connected && ( findRoot( enodeA ) == findRoot( enodeB ) ) ) return;
+
+    m_changedNodes.push_back( enodeA );
+    m_changedNodes.push_back( enodeB );
+}
+
+void CircMatrix::splitCircuit()       // Split Circuit into unconnected parts
+{
+    //qDebug() <<"Spliting Circuit...";
+    std::vector<char> remove( m_groupNodes.size(), 1 );
+    removeGroups( remove );
+
+    m_nodeRoot.resize( m_numEnodes+1 );
+    for( int i=0; i<=m_numEnodes; i++ ) m_nodeRoot[i] = i;
+
+    m_nodeGroup.assign( m_numEnodes+1, -1 );
+    m_nodeMark.assign( m_numEnodes+1, 0 );
+    m_changedNodes.clear();
+
+    i_vector_t nodes( m_numEnodes );
+    for( int i=1; i<=m_numEnodes; i++ )
     {
-        if( nodeNum == 0 ) continue;
-        
-        if( !nodeGroup->contains( nodeNum ) ) addConnections( nodeNum, nodeGroup, allNodes );
+        nodes[i-1] = i;
+
+        m_eNodeList->at(i-1)->getConnections( m_cons );
+        for( int nodeNum : m_cons ) joinNodes( i, nodeNum );
+    }
+    setGroups( nodes );
+    //qDebug() <<"CircMatrix::splitCircuit"<<m_groupNodes.size()<<"Circuits";
+}
+
+void CircMatrix::updateGroups()  // Only groups with open/close events are split again
+{
+    int numGroups = m_groupNodes.size();
+    std::vector<char> remove( numGroups, 0 );
+    i_vector_t nodes;
+
+    for( int nodeNum : m_changedNodes )   // Get eNodes of affected groups
+    {
+        int group = m_nodeGroup[nodeNum];
+
+        if( group < 0 )
+        {
+            if( m_nodeMark[nodeNum] ) continue;
+            m_nodeMark[nodeNum] = 1;
+            nodes.push_back( nodeNum );
+        }
+        else if( !remove[group] )
+        {
+            remove[group] = 1;
+            for( int num : m_groupNodes[group] )
+            {
+                m_nodeMark[num] = 1;
+                nodes.push_back( num );
+            }
+        }
     }
+    m_changedNodes.clear();
+
+    for( int nodeNum : nodes ) m_nodeRoot[nodeNum] = nodeNum;
+
+    for( int nodeNum : nodes )
+    {
+        m_eNodeList->at( nodeNum-1 )->getConnections( m_cons );
+        for( int con : m_cons ) if( m_nodeMark[con] ) joinNodes( nodeNum, con );
+    }
+    for( int nodeNum : nodes ) m_nodeMark[nodeNum] = 0;
+
+    for( int nodeNum : nodes ) m_nodeMark[ findRoot( nodeNum ) ]++; // Size of new groups
+
+    for( int group=0; group<numGroups; group++ )  // Keep groups with same eNodes
+    {
+        if( !remove[group] ) continue;
+
+        const i_vector_t& groupNodes = m_groupNodes[group];
+        int root = findRoot( groupNodes[0] );
+
+        if( m_nodeMark[root] != (int)groupNodes.size() ) continue;
+
+        bool same = true;
+        for( int num : groupNodes ) if( findRoot( num ) != root ) { same = false; break; }
+
+        if( same ) remove[group] = 0;
+    }
+    for( int nodeNum : nodes ) m_nodeMark[ findRoot( nodeNum ) ] = 0;
+
+    i_vector_t newNodes;
+    for( int nodeNum : nodes )
+    {
+        int group = m_nodeGroup[nodeNum];
+        if( (group < 0) || remove[group] ) newNodes.push_back( nodeNum );
+    }
+    removeGroups( remove );
+    setGroups( newNodes );
+}
+
+void CircMatrix::setGroups( i_vector_t &nodes )   // Create groups from eNode sets
+{
+    std::sort( nodes.begin(), nodes.end() );
+
+    std::vector<i_vector_t> groups;
+    for( int nodeNum : nodes )
+    {
+        int root = findRoot( nodeNum );
+        if( m_nodeMark[root] == 0 )
+        {
+            groups.push_back( i_vector_t() );
+            m_nodeMark[root] = groups.size();
+        }
+        groups[ m_nodeMark[root]-1 ].push_back( nodeNum );
+    }
+    for( int nodeNum : nodes ) m_nodeMark[ findRoot( nodeNum ) ] = 0;
+
+    for( i_vector_t& nodeGroup : groups )
+    {
+        if( nodeGroup.size() == 1 )           // Sigle nodes do by themselves
+        {
+            m_nodeGroup[ nodeGroup[0] ] = -1;
+
+            eNode* enod = m_eNodeList->at( nodeGroup[0]-1 );
+            enod->setSingle( true );
+            enod->solveSingle();
+        }
+        else addGroup( nodeGroup );
+    }
+}
+
+template<class T> static void compactList( std::vector<T> &list, const std::vector<int> &newIndex )
+{
+    if( list.empty() ) return;
+
+    for( unsigned i=0; i<newIndex.size(); i++ )
+    {
+        int index = newIndex[i];
+        if( (index >= 0) && (index != (int)i) ) std::swap( list[index], list[i] );
+    }
+    int size = 0;
+    for( int index : newIndex ) if( index >= 0 ) size++;
+
+    list.resize( size );
+}
+
+void CircMatrix::removeGroups( std::vector<char> &remove )
+{
+    int numGroups = remove.size();
+    std::vector<int> newIndex( numGroups, -1 );
+
+    int index = 0;
+    for( int group=0; group<numGroups; group++ )
+    {
+        if( remove[group] )
+        {
+            for( int nodeNum : m_groupNodes[group] ) m_nodeGroup[nodeNum] = -1;
+            if( !m_sparseList.empty() ) delete m_sparseList[group];
+            continue;
+        }
+        newIndex[group] = index;
+        if( index != group ) for( int nodeNum : m_groupNodes[group] ) m_nodeGroup[nodeNum] = index;
+        index++;
+    }
+    compactList( m_aSlotList,    newIndex );
+    compactList( m_aPosList,     newIndex );
+    compactList( m_aFaList,      newIndex );
+    compactList( m_ipvtList,     newIndex );
+    compactList( m_sparseList,   newIndex );
+    compactList( m_groupNodes,   newIndex );
+    compactList( m_groupVolt,    newIndex );
+    compactList( m_groupNew,     newIndex );
+    compactList( m_eNodeActList, newIndex );
 }
 
 bool CircMatrix::solveMatrix()
 {
-    if( !m_admitChanged && !m_currChanged ) return true;
+    if( !m_admitChanged && !m_currChanged && m_changedNodes.empty() ) return true;
+
+    if( m_circChanged )
+    {
+        splitCircuit();
+        m_circChanged = false;
+    }
+    else if( !m_changedNodes.empty() ) updateGroups();
+
+    if( m_calibrate ) calibrate();
+    else              solveGroups();
 
     bool isOk = true;
 
-    if( m_circChanged )          // Split Circuit into unconnected parts
+    for( unsigned group=0; group<m_groupVolt.size(); group++ ) // Set Node Voltages in group order
     {
-        //qDebug() <<"Spliting Circuit...";
-        QList<int> allNodes;
-        
-        for( int i=0; i<m_numEnodes; i++ ) allNodes.append( i+1 );
-        
-        m_aList.clear();
-        m_aFaList.clear();
-        m_bList.clear();
-        m_ipvtList.clear();
-        m_eNodeActList.clear();
-        int group = 0;
-        
-        while( !allNodes.isEmpty() ) // Get a list of groups of nodes interconnected
+        const QList<eNode*>& eNodeActive = m_eNodeActList[group];
+        const d_vector_t&    volts       = m_groupVolt[group];
+        int n = eNodeActive.size();
+
+        for( int i=0; i<n; i++ )
         {
-            QList<int> nodeGroup;
-            addConnections( allNodes.first(), &nodeGroup, &allNodes ); // Get a group of nodes interconnected
-            //qDebug() <<"CircMatrix::solveMatrix split"<<nodeGroup<<allNodes;
-            
-            //foreach( int num, nodeGroup ) allNodes.removeOne(num);
-            
-            int numEnodes = nodeGroup.size();
-            if( numEnodes==1 )           // Sigle nodes do by themselves
-            {
-                eNode* enod = m_eNodeList->at( nodeGroup[0]-1 );
-                enod->setSingle( true );
-                enod->solveSingle();
-                //qDebug() <<"CircMatrix::solveMatrix solve single"<<enod->itemId();
-            }
-            else
+            double volt = volts[i];
+
+            if( std::isnan( volt ) )
             {
-                dp_matrix_t a;
-                d_matrix_t ap;
-                dp_vector_t b;
-                i_vector_t ipvt;
-                QList<eNode*> eNodeActive;
-                
-                a.resize( numEnodes , dp_vector_t( numEnodes , 0 ) );
-                ap.resize( numEnodes , d_vector_t( numEnodes , 0 ) );
-                b.resize( numEnodes , 0 );
-                ipvt.resize( numEnodes , 0 );
-
-                int ny=0;
-                for( int y=0; y<m_numEnodes; y++ )    // Copy data to reduced Matrix
-                {
-                    if( !nodeGroup.contains( y+1 ) ) continue;
-                    int nx=0;
-                    for( int x=0; x<m_numEnodes; x++ )      
-                    {
-                        if( !nodeGroup.contains( x+1 ) ) continue;
-                        a[nx][ny] = &(m_circMatrix[x][y]);
-                        //qDebug() <<"CircMatrix::solveMatrix cell"<<nx<<ny<<*(a[nx][ny]);
-                        nx++;
-                    }
-                    b[ny] = &(m_coefVect[y]);
-                    eNodeActive.append( m_eNodeList->at(y) );
-                    //eNode* enod = m_eNodeList->at(y);
-                    //qDebug() <<"CircMatrix::solveMatrix node"<<enod->itemId();
-                    ny++;
-                }
-                m_aList.append( a );
-                m_aFaList.append( ap );
-                m_bList.append( b );
-                m_ipvtList.append( ipvt );
-                m_eNodeActList.append( eNodeActive );
-                m_eNodeActive = &eNodeActive;
-                
-                factorMatrix( ny, group );
-                isOk &= luSolve( ny, group );
-
-                group++;
+                isOk = false;
+                volt = 0;
             }
+            eNodeActive.at(i)->setVolt( volt );
         }
-        m_circChanged  = false;
-        //qDebug() <<"CircMatrix::solveMatrix"<<group<<"Circuits";
+    }
+    m_currChanged  = false;
+    m_admitChanged = false;
+    return isOk;
+}
+
+void CircMatrix::solveGroups()
+{
+    // Big groups are factored and solved in worker threads, small ones here.
+    // Workers only write their own group data, eNodes are updated later.
+    // Dispatch only pays off if there is enough work: m_parMinWork eNodes.
+    m_parGroups.clear();
+    int parWork = 0;
+
+    int numGroups = m_groupNodes.size();
+    for( int group=0; group<numGroups; group++ )
+    {
+        int size = m_groupNodes[group].size();
+
+        if( size < m_parMinSize ) solveGroup( group );
+        else
+        {
+            m_parGroups.push_back( group );
+            parWork += size;
+        }
+    }
+    if( (m_parGroups.size() > 1) && (parWork >= m_parMinWork) )
+        QtConcurrent::blockingMap( m_parGroups, [this]( int &group ){ solveGroup( group ); } );
+
+    else for( int group : m_parGroups ) solveGroup( group );
+}
+
+void CircMatrix::calibrate()
+{
+    // Measured at first solve after stamping a new circuit, with its groups:
+    // - Cost of one dispatch to the pool: best of 16 empty blockingMaps.
+    // - Cost of solving one eNode: a full step solved inline (after
+    //   factorization of new groups), divided by number of eNodes in groups.
+    // Workers save at most the time of the groups they take off this thread,
+    // so dispatch is used when that time is over twice the dispatch cost.
+    m_calibrate = false;
+
+    int nodes = 0;
+    int numGroups = m_groupNodes.size();
+    for( int group=0; group<numGroups; group++ )
+    {
+        solveGroup( group );                       // Factor new groups
+        nodes += m_groupNodes[group].size();
+    }
+    QElapsedTimer timer;
+    timer.start();
+    for( int group=0; group<numGroups; group++ ) solveGroup( group );
+    qint64 solveNs = timer.nsecsElapsed();
+
+    if( (nodes == 0) || (solveNs == 0) ) return;    // Nothing to solve in groups
+
+    i_vector_t tasks( QThreadPool::globalInstance()->maxThreadCount(), 0 );
+    qint64 dispatchNs = -1;
+    for( int i=0; i<16; i++ )
+    {
+        timer.restart();
+        QtConcurrent::blockingMap( tasks, []( int & ){} );
+        qint64 ns = timer.nsecsElapsed();
+        if( (dispatchNs < 0) || (ns < dispatchNs) ) dispatchNs = ns;
+    }
+    double work = 2.0*dispatchNs*nodes/solveNs;    // eNodes solved in 2 dispatch times
+    m_parMinWork = ( work > (1<<30) ) ? (1<<30) : (int)work;
+}
+
+void CircMatrix::solveGroup( int group )
+{
+    const i_vector_t& nodes = m_groupNodes[group];
+    d_vector_t& b = m_groupVolt[group];
+    int n = nodes.size();
+
+    for( int i=0; i<n; i++ ) b[i] = m_coefVect[ nodes[i]-1 ];
+
+    if( m_sparse )
+    {
+        SparseSolver* solver = m_sparseList[group];
+
+        if     ( m_groupNew[group] ) solver->factor();
+        else if( m_admitChanged )    solver->update(); // Low rank update or refactor
+
+        solver->solve( b );
     }
     else
     {
-        for( int i=0; i<m_bList.size(); i++ )
+        if( m_groupNew[group] || m_admitChanged ) factorMatrix( n, group );
+
+        luSolve( n, group );
+    }
+    m_groupNew[group] = 0;
+}
+
+void CircMatrix::addGroup( i_vector_t &nodeGroup )
+{
+    int n = nodeGroup.size();
+    int group = m_groupNodes.size();
+
+    m_groupIndex.resize( m_numEnodes+1, -1 );
+    for( int i=0; i<n; i++ ) m_groupIndex[ nodeGroup[i] ] = i;
+
+    QList<eNode*> eNodeActive;
+    for( int i=0; i<n; i++ )
+    {
+        eNode* enod = m_eNodeList->at( nodeGroup[i]-1 );
+        enod->setSingle( false );
+        eNodeActive.append( enod );
+
+        m_nodeGroup[ nodeGroup[i] ] = group;
+    }
+    m_eNodeActList.push_back( eNodeActive );
+    m_groupNodes.push_back( nodeGroup );
+    m_groupVolt.push_back( d_vector_t( n, 0 ) );
+    m_groupNew.push_back( 1 );
+
+    if( m_sparse ) createSparse( nodeGroup );
+    else           createDense( nodeGroup );
+
+    for( int i=0; i<n; i++ ) m_groupIndex[ nodeGroup[i] ] = -1;
+}
+
+void CircMatrix::createDense( i_vector_t &nodeGroup )
+{
+    int n = nodeGroup.size();
+
+    i_vector_t aSlots;
+    i_vector_t pos;
+
+    for( int i=0; i<n; i++ )           // Get slots of reduced Matrix
+    {
+        int row = nodeGroup[i];
+
+        for( int slot=m_rowPtr[row-1]; slot<m_rowPtr[row]; slot++ )
         {
-            m_eNodeActive = &(m_eNodeActList[i]);
-            int n = m_eNodeActive->size();
+            int j = m_groupIndex[ m_colInd[slot] ];
+            if( j < 0 ) continue;
+
+            aSlots.push_back( slot );
+            pos.push_back( i*n+j );
+        }
+    }
+    m_aSlotList.push_back( aSlots );
+    m_aPosList.push_back( pos );
+    m_aFaList.push_back( d_matrix_t( n, d_vector_t( n, 0 ) ) );
+    m_ipvtList.push_back( i_vector_t( n, 0 ) );
+}
+
+void CircMatrix::createSparse( i_vector_t &nodeGroup )
+{
+    // Symbolic analysis uses all possible connections in this group,
+    // not only the non zero ones, so admittance changes only need
+    // a numeric refactorization.
+    int n = nodeGroup.size();
 
-            if( m_admitChanged ) factorMatrix( n, i );
+    std::vector<i_vector_t> pattern( n );
+
+    for( int i=0; i<n; i++ )
+    {
+        int row = nodeGroup[i];
 
-            isOk &= luSolve( n, i );
+        for( int slot=m_rowPtr[row-1]; slot<m_rowPtr[row]; slot++ )
+        {
+            int j = m_groupIndex[ m_colInd[slot] ];
+            if( j >= 0 ) pattern[i].push_back( j );
         }
     }
-    m_currChanged  = false;
-    m_admitChanged = false;
-    return isOk;
+    SparseSolver* solver = new SparseSolver();
+    solver->analyze( n, pattern );
+
+    for( int i=0; i<n; i++ )
+    {
+        int row = nodeGroup[i];
+        for( int slot=m_rowPtr[row-1]; slot<m_rowPtr[row]; slot++ )
+        {
+            int j = m_groupIndex[ m_colInd[slot] ];
+            if( j >= 0 ) solver->addSource( i, j, &(m_values[slot]) );
+        }
+    }
+    m_sparseList.push_back( solver );
 }
 
 void CircMatrix::factorMatrix( int n, int group  )
@@ -203,18 +528,15 @@ void CircMatrix::factorMatrix( int n, int group  )
     // matrix to be factored.  ipvt[] returns an integer vector of pivot
     // indices, used in the solve routine.
     
-    dp_matrix_t&  ap  = m_aList[group];
+    const i_vector_t& aSlots = m_aSlotList[group];
+    const i_vector_t& pos   = m_aPosList[group];
     i_vector_t&  ipvt = m_ipvtList[group];
     
     d_matrix_t& a = m_aFaList[group];
-    for( int i=0; i<n; i++ )
-    {
-        for( int j=0; j<n; j++ )
-        {
-             a[i][j] = *(ap[i][j]);             
-             //qDebug() << m_circMatrix[i][j];
-        }
-    }
+    for( int i=0; i<n; i++ ) std::fill( a[i].begin(), a[i].end(), 0 );
+
+    int nonZeros = aSlots.size();
+    for( int k=0; k<nonZeros; k++ ) a[ pos[k]/n ][ pos[k]%n ] = m_values[ aSlots[k] ];
     
     /*std::cout << "\nAdmitance Matrix:\n"<< std::endl;
     for( int i=0; i<n; i++ )
@@ -281,7 +603,6 @@ void CircMatrix::factorMatrix( int n, int group  )
             for( i=j+1; i<n; i++ ) a[i][j] /= div;
         }
     }
-    m_aFaList.replace( group, a );
     
     /*std::cout << "\nFactored Matrix:\n"<< std::endl;
     for( int i=0; i<n; i++ )
@@ -297,19 +618,16 @@ void CircMatrix::factorMatrix( int n, int group  )
     }*/
 }
 
-bool CircMatrix::luSolve( int n, int group )
+void CircMatrix::luSolve( int n, int group )
 {
     // Solves the set of n linear equations using a LU factorization
     // previously performed by solveMatrix.  On input, b[0..n-1] is the right
     // hand side of the equations, and on output, contains the solution.
 
     const d_matrix_t&  a    = m_aFaList[group];
-    const dp_vector_t& bp   = m_bList[group];
     const i_vector_t&  ipvt = m_ipvtList[group];
 
-    d_vector_t b;
-    b.resize( n , 0 );
-    for( int i=0; i<n; i++ ) b[i] = *(bp[i]);
+    d_vector_t& b = m_groupVolt[group];
     
     /*std::cout << "\nAdmitance Matrix luSolve:\n"<< std::endl;
     for( int i=0; i<n; i++ )
@@ -346,8 +664,6 @@ bool CircMatrix::luSolve( int n, int group )
 
         b[i] = tot;
     }
-    bool isOk = true;
-    
     for( i=n-1; i>=0; i-- )
     {
         double tot = b[i];
@@ -355,17 +671,14 @@ bool CircMatrix::luSolve( int n, int group )
         // back-substitution using the upper triangular matrix
         for( int j=i+1; j<n; j++ ) tot -= a[i][j]*b[j];
         
-        double volt = tot/a[i][i];
-        b[i] = volt;
-        
-        if( std::isnan( volt ) ) 
-        {
-            isOk = false;
-            volt = 0;
-        }
-        m_eNodeActive->at(i)->setVolt( volt );      // Set Node Voltages
+        b[i] = tot/a[i][i];                  // Node Voltages set by solveMatrix
     }
-    return isOk;
+}
+
+void CircMatrix::setSparse( bool sparse )
+{
+    m_sparse = sparse;
+    setCircChanged();
 }
 
 void CircMatrix::setCircChanged()
@@ -379,17 +692,17 @@ void CircMatrix::printMatrix()
     std::cout << "\nAdmitance Matrix:\n"<< std::endl;
     for( int i=0; i<m_numEnodes; i++ )
     {
+        int slot = m_rowPtr[i];
         for( int j=0; j<m_numEnodes; j++ )
         {
-            std::cout << m_circMatrix[i][j] <<"\t";
+            double value = 0;
+            if( (slot < m_rowPtr[i+1]) && (m_colInd[slot] == j+1) ) value = m_values[slot++];
+
+            std::cout << value <<"\t";
         }
         std::cout << "\t";
         std::cout << m_coefVect[i]<< std::endl;
         std::cout << std::endl;
         std::cout << std::endl;
     }
-    
-    //std::cout << "\nSantized Matrix:\n"<< std::endl;
-    
 }
-
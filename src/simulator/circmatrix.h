@@ -24,14 +24,13 @@
 #include <QList>
 
 #include "e-node.h"
+#include "sparsesolver.h"
 
 class MAINMODULE_EXPORT CircMatrix
 {
     typedef std::vector<int>                  i_vector_t;
     typedef std::vector<double>               d_vector_t;
-    typedef std::vector<double*>              dp_vector_t;
     typedef std::vector<std::vector<double>>  d_matrix_t;
-    typedef std::vector<std::vector<double*>> dp_matrix_t;
     
     public:
         CircMatrix();
@@ -41,40 +40,86 @@ class MAINMODULE_EXPORT CircMatrix
 
         void printMatrix();
         void createMatrix( QList<eNode*> &eNodeList, QList<eElement*> &elementList  );
-        void stampMatrix( int row, int col, double value );
-        void stampCoef( int row, double value );
         bool solveMatrix();
+
+        // Compressed matrix: one slot for each possible non zero value,
+        // slots are resolved by eNodes at createMatrix time.
+        int  getSlot( int row, int col );
+        void addToSlot( int slot, double delta ) { m_values[slot] += delta; }
+        void setSlot( int slot, double value )   { m_values[slot]  = value; }
+        double slotValue( int slot )             { return m_values[slot]; }
+
+        void   setCoef( int row, double value )   { m_coefVect[row-1] = value; }
+        double coef( int row )                    { return m_coefVect[row-1]; }
+
+        void setAdmitChanged() { m_admitChanged = true; }
+        void setCurrChanged()  { m_currChanged  = true; }
         
         void setCircChanged();
+        void conChanged( int enodeA, int enodeB, bool connected ); // Open/close events
+
+        bool sparse() { return m_sparse; }
+        void setSparse( bool sparse );
         
-        d_matrix_t getMatrix(){return m_circMatrix; }
         d_vector_t getCoeffVect(){ return m_coefVect; }
 
     private:
  static CircMatrix* m_pSelf;
         
         void factorMatrix( int n, int group );
-        bool luSolve( int n, int group );
-        void addConnections( int enodNum, QList<int>* nodeGroup, QList<int>* allNodes );
+        void luSolve( int n, int group );
+        int  findRoot( int enodeNum );
+        void joinNodes( int enodeA, int enodeB );
+        void splitCircuit();
+        void updateGroups();
+        void setGroups( i_vector_t &nodes );
+        void removeGroups( std::vector<char> &remove );
+        void createDense( i_vector_t &nodeGroup );
+        void createSparse( i_vector_t &nodeGroup );
+        void addGroup( i_vector_t &nodeGroup );
+        void solveGroups();
+        void calibrate();
+        void solveGroup( int group );
         
         int m_numEnodes;
         QList<eNode*>* m_eNodeList;
         QList<eElement*> m_elementList;
-        
-        QList<dp_matrix_t> m_aList;
-        QList<d_matrix_t>  m_aFaList;
-        QList<dp_vector_t> m_bList;
-        QList<i_vector_t>  m_ipvtList;
-        
-        QList<eNode*>*       m_eNodeActive;
-        QList<QList<eNode*>> m_eNodeActList;
 
-        d_matrix_t m_circMatrix;
+        // Group data is accessed from worker threads: use std containers
+        std::vector<i_vector_t>    m_aSlotList;   // Slots of group non zero values
+        std::vector<i_vector_t>    m_aPosList;    // Position of each slot in group matrix
+        std::vector<d_matrix_t>    m_aFaList;
+        std::vector<i_vector_t>    m_ipvtList;
+        std::vector<SparseSolver*> m_sparseList;
+
+        std::vector<i_vector_t> m_groupNodes;     // eNode numbers of each group
+        std::vector<d_vector_t> m_groupVolt;      // Solution of each group
+        std::vector<char>       m_groupNew;       // Group needs full factorization
+
+        std::vector<QList<eNode*>> m_eNodeActList;
+
+        i_vector_t m_parGroups;     // Groups solved in parallel
+        int        m_parMinSize;    // Min size of a group to be solved in parallel
+        int        m_parMinWork;    // Min eNodes in parallel groups to use workers (calibrate)
+
+        i_vector_t m_nodeRoot;      // Disjoint sets of connected eNodes (union-find)
+        i_vector_t m_nodeGroup;     // eNode number -> group, -1 if single
+        i_vector_t m_changedNodes;  // eNodes with open/close events
+        i_vector_t m_nodeMark;
+        i_vector_t m_cons;
+
+        i_vector_t m_rowPtr;        // Compressed matrix (CSR)
+        i_vector_t m_colInd;
+        d_vector_t m_values;
         d_vector_t m_coefVect;
+
+        i_vector_t m_groupIndex;    // eNode number -> index in group
         
+        bool m_sparse;
         bool m_admitChanged;
         bool m_circChanged;
         bool m_currChanged;
+        bool m_calibrate;
 };
  #endif
 
@@ -0,0 +1,71 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef DELAYLINE_H
+#define DELAYLINE_H
+
+#include <deque>
+#include <stdint.h>
+
+// Changes of a logic output waiting for their step (transport delay).
+//
+// Every change comes out at its own step, so a pulse shorter than the
+// delay reaches the output too. A change added at or before the step of
+// changes already queued replaces them: the last one set wins.
+
+class DelayLine
+{
+    public:
+        // True if the change is now the first one: event must be scheduled
+        bool push( uint64_t time, bool value )
+        {
+            while( !m_changes.empty() && (m_changes.back().time >= time) ) m_changes.pop_back();
+
+            Change change = { time, value };
+            m_changes.push_back( change );
+            return m_changes.size() == 1;
+        }
+
+        // Next change due at step time, false if none
+        bool pop( uint64_t time, bool &value )
+        {
+            if( m_changes.empty() || (m_changes.front().time > time) ) return false;
+
+            value = m_changes.front().value;
+            m_changes.pop_front();
+            return true;
+        }
+
+        bool     isEmpty()  { return m_changes.empty(); }
+        uint64_t nextTime() { return m_changes.front().time; }
+        void     clear()    { m_changes.clear(); }
+
+        int      size()           { return m_changes.size(); }
+        uint64_t timeAt( int i )  { return m_changes[i].time; }
+        bool     valueAt( int i ) { return m_changes[i].value; }
+
+    private:
+        struct Change
+        {
+            uint64_t time;
+            bool     value;
+        };
+        std::deque<Change> m_changes;
+};
+
+#endif
@@ -0,0 +1,73 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef DIRTYLIST_H
+#define DIRTYLIST_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+// List of objects waiting to be processed by the Simulator.
+//
+// Objects carry one stamp for each list they can be queued in, the stamp
+// holds the list epoch when the object was added. Checking membership is
+// then a single compare, and clear() just moves to a new epoch so stamps
+// don't need to be reset. Storage is reused from step to step.
+
+template <class T> class DirtyList
+{
+    public:
+        DirtyList( uint64_t T::* stamp )
+        {
+            m_stamp = stamp;
+            m_epoch = 1;                  // Stamp 0 = never queued
+        }
+
+        void add( T* obj )
+        {
+            if( obj->*m_stamp == m_epoch ) return;
+            obj->*m_stamp = m_epoch;
+            m_list.push_back( obj );
+        }
+
+        void remove( T* obj )
+        {
+            if( obj->*m_stamp != m_epoch ) return;
+            obj->*m_stamp = 0;
+            m_list.erase( std::find( m_list.begin(), m_list.end(), obj ) );
+        }
+
+        void clear()
+        {
+            m_list.clear();
+            m_epoch++;
+        }
+
+        bool isEmpty()   { return m_list.empty(); }
+        int  size()      { return m_list.size(); }
+        T*   at( int i ) { return m_list[i]; }
+
+    private:
+        uint64_t T::* m_stamp;
+        uint64_t      m_epoch;
+
+        std::vector<T*> m_list;
+};
+
+#endif
@@ -27,6 +27,13 @@ eElement::eElement( std::string id )
 {
     m_elmId = id;
 
+    m_fastStamp  = 0;
+    m_reacStamp  = 0;
+    m_noLinStamp = 0;
+    m_eventTime  = 0;
+    m_eventSlot  = -1;
+    m_eventPos   = 0;
+
     Simulator::self()->addToElementList( this );
     //qDebug() << "eElement::eElement" << QString::fromStdString( m_elmId );
     
@@ -35,6 +42,10 @@ eElement::~eElement()
 {
     //qDebug() << "eElement::~eElement deleting" << QString::fromStdString( m_elmId );
     Simulator::self()->remFromElementList( this );
+    Simulator::self()->remFromChangedFast( this );
+    Simulator::self()->remFromReactiveList( this );
+    Simulator::self()->remFromNoLinList( this );
+    Simulator::self()->cancelEvent( this );
     /*foreach (ePin* epin, m_ePin)
     {
         delete epin;
@@ -21,9 +21,11 @@
 #define EELEMENT_H
 
 #include <string>
+#include <stdint.h>
 #include <math.h>
 #include <QPointer>
 #include <QDebug>
+#include <QDataStream>
 #include "e-pin.h"
 
 
@@ -37,6 +39,9 @@
 
 class MAINMODULE_EXPORT eElement
 {
+    friend class Simulator;
+    friend class EventWheel;
+
     public:
         eElement( std::string id=0 );
         virtual ~eElement();
@@ -58,6 +63,16 @@ class MAINMODULE_EXPORT eElement
         virtual void simuClockStep(){;}
         virtual void updateStep(){;}
         virtual void setVChanged(){;}
+        virtual void runEvent(){;}     // Event scheduled with Simulator::addEvent()
+
+        // Adaptive step: Reactive elements checked with Simulator::reacDone()
+        virtual void reacAccept(){;}
+        virtual void reacReject(){;}
+
+        // Runtime state for Simulator snapshots, pin stamps and eNode
+        // voltages are saved and restored by the Simulator.
+        virtual void saveState( QDataStream &out ){ Q_UNUSED(out); }
+        virtual void loadState( QDataStream &in ) { Q_UNUSED(in); }
 
         static GNU_CONST_STATIC_FLOAT_DECLARATION double cero_doub         = 1e-14;
         static GNU_CONST_STATIC_FLOAT_DECLARATION double high_imp          = 1e14;
@@ -69,6 +84,14 @@ class MAINMODULE_EXPORT eElement
         std::vector<ePin*> m_ePin;
 
         std::string m_elmId;
+
+    private:
+        uint64_t m_fastStamp;  // Simulator list stamps (see DirtyList)
+        uint64_t m_reacStamp;
+        uint64_t m_noLinStamp;
+        uint64_t m_eventTime;  // Step of pending event, 0 = none
+        int      m_eventSlot;  // EventWheel list of pending event, -1 = none
+        int      m_eventPos;   // Position in that list
 };
 
 #endif
@@ -21,6 +21,7 @@
 #include <QDebug>
 
 #include "e-logic_device.h"
+#include "simulator.h"
 #include "circuit.h"
 
 eLogicDevice::eLogicDevice( std::string id )
@@ -37,6 +38,8 @@ eLogicDevice::eLogicDevice( std::string id )
     m_inputImp = high_imp;
     m_outImp   = 40;
 
+    m_propDelay = 0;
+
     m_invInputs = false;
     m_inverted  = false;
     m_clock     = false;
@@ -49,7 +52,7 @@ eLogicDevice::eLogicDevice( std::string id )
 }
 eLogicDevice::~eLogicDevice()
 {
-    foreach( eSource* esource, m_output ) delete esource;
+    foreach( eLogicOut* esource, m_output ) delete esource;
     foreach( eSource* esource, m_input ) delete esource;
 
     if( m_clockPin )     delete m_clockPin;
@@ -85,6 +88,25 @@ void eLogicDevice::resetState()
         eLogicDevice::setOut( i, false );
 }
 
+void eLogicDevice::saveState( QDataStream &out )
+{
+    out << m_clock << m_outEnable << m_inEnable << qint32( m_inputState.size() );
+    for( unsigned i=0; i<m_inputState.size(); i++ ) out << bool( m_inputState[i] );
+}
+
+void eLogicDevice::loadState( QDataStream &in )
+{
+    qint32 inputs = 0;
+    in >> m_clock >> m_outEnable >> m_inEnable >> inputs;
+
+    for( int i=0; i<inputs; i++ )
+    {
+        bool state;
+        in >> state;
+        if( i < (int)m_inputState.size() ) m_inputState[i] = state;
+    }
+}
+
 bool eLogicDevice::outputEnabled()
 {
     if( !m_outEnablePin ) return true;
@@ -266,7 +288,7 @@ void eLogicDevice::createOutput( ePin* epin )
 
     std::stringstream ssesource;
     ssesource << m_elmId << "-eSource-output" << m_numOutputs;
-    m_output[m_numOutputs] = new eSource( ssesource.str(), epin );
+    m_output[m_numOutputs] = new eLogicOut( ssesource.str(), epin );
     m_output[m_numOutputs]->setVoltHigh( m_outHighV );
     m_output[m_numOutputs]->setImp( m_outImp );
 
@@ -286,7 +308,7 @@ void eLogicDevice::createOutputs( int outputs )
 
         std::stringstream ssesource;
         ssesource << m_elmId << "-eSource-output" << i;
-        m_output[i] = new eSource( ssesource.str(), epin );
+        m_output[i] = new eLogicOut( ssesource.str(), epin );
         m_output[i]->setVoltHigh( m_outHighV );
         m_output[i]->setImp( m_outImp );
     }
@@ -333,8 +355,20 @@ void eLogicDevice::setNumOuts( int outputs )
 
 void eLogicDevice::setOut( int num, bool out )
 {
-    m_output[num]->setOut( out );
-    m_output[num]->stampOutput();
+    Simulator* sim = Simulator::self();
+
+    if( !sim->isRunning() )          // Reset or changes while stopped: stamp now
+    {
+        m_output[num]->setOutNow( out );
+        return;
+    }
+    m_output[num]->setOutAt( out, sim->step()+m_propDelay ); // Same step if no delay
+}
+
+void eLogicDevice::setPropDelay( int steps )
+{
+    if( steps < 0 ) steps = 0;
+    m_propDelay = steps;
 }
 
 void eLogicDevice::setOutHighV( double volt )
@@ -439,9 +473,9 @@ bool eLogicDevice::getInputState( int input )
     return state;
 }
 
-bool eLogicDevice::getOutputState( int output )
+bool eLogicDevice::getOutputState( int num ) // Including changes not stamped yet
 {
-    return m_output[output]->out();
+    return m_output[num]->nextOut();
 }
 
 /*ePin* eLogicDevice::getEpin( int pin )  // First InPuts, then OutPuts
@@ -24,6 +24,7 @@
 #include <math.h>
 
 #include "e-source.h"
+#include "e-logic_out.h"
 #include "e-pin.h"
 
 #define CLow    0
@@ -70,6 +71,11 @@ class MAINMODULE_EXPORT eLogicDevice : public eElement
 
         bool invertInps() { return m_invInputs; }
         void setInvertInps( bool invert );
+
+        // Steps from input change to output change, each output changes
+        // through its own Simulator events (0 = in same step)
+        int  propDelay() { return m_propDelay; }
+        void setPropDelay( int steps );
         
         void setOutputEnabled( bool enabled );
         void updateOutEnabled();
@@ -85,6 +91,9 @@ class MAINMODULE_EXPORT eLogicDevice : public eElement
         virtual void initialize();
         virtual void resetState();
 
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
+
         virtual void createPins( int inputs, int outputs );
         void createClockPin();
         void createOutEnablePin();
@@ -119,6 +128,7 @@ class MAINMODULE_EXPORT eLogicDevice : public eElement
 
         int m_numInputs;
         int m_numOutputs;
+        int m_propDelay;
 
         bool m_clock;
         bool m_outEnable;
@@ -130,9 +140,9 @@ class MAINMODULE_EXPORT eLogicDevice : public eElement
         eSource* m_outEnablePin;
         eSource* m_inEnablePin;
 
-        std::vector<eSource*> m_output;
-        std::vector<eSource*> m_input;
-        std::vector<bool>     m_inputState;
+        std::vector<eLogicOut*> m_output;
+        std::vector<eSource*>   m_input;
+        std::vector<bool>       m_inputState;
 };
 
 #endif
@@ -0,0 +1,98 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "e-logic_out.h"
+#include "simulator.h"
+
+eLogicOut::eLogicOut( std::string id, ePin* epin )
+         : eSource( id, epin )
+{
+}
+eLogicOut::~eLogicOut(){}
+
+void eLogicOut::initialize()
+{
+    bool out;                  // Simulator events were cleared: changes now
+    while( m_delay.pop( UINT64_MAX, out ) ) eSource::setOut( out );
+
+    eSource::initialize();
+}
+
+void eLogicOut::setOutAt( bool out, uint64_t time )
+{
+    if( m_delay.push( time, out ) ) Simulator::self()->addEvent( time, this );
+}
+
+void eLogicOut::setOutNow( bool out )
+{
+    m_delay.clear();
+    Simulator::self()->cancelEvent( this );
+
+    eSource::setOut( out );
+    stampOutput();
+}
+
+bool eLogicOut::nextOut()
+{
+    if( m_delay.isEmpty() ) return m_out;
+
+    bool out = m_delay.valueAt( m_delay.size()-1 );
+    return m_inverted ? !out : out;
+}
+
+void eLogicOut::runEvent() // Changes due at this step, then next one
+{
+    Simulator* sim = Simulator::self();
+
+    bool out;
+    bool changed = false;
+    while( m_delay.pop( sim->step(), out ) )
+    {
+        eSource::setOut( out );
+        changed = true;
+    }
+    if( changed ) stampOutput();
+
+    if( !m_delay.isEmpty() ) sim->addEvent( m_delay.nextTime(), this );
+}
+
+void eLogicOut::saveState( QDataStream &out )
+{
+    eSource::saveState( out );
+
+    out << qint32( m_delay.size() );
+    for( int i=0; i<m_delay.size(); i++ )
+        out << quint64( m_delay.timeAt( i ) ) << m_delay.valueAt( i );
+}
+
+void eLogicOut::loadState( QDataStream &in ) // Event time is restored by Simulator
+{
+    eSource::loadState( in );
+
+    qint32 size = 0;
+    in >> size;
+
+    m_delay.clear();
+    for( int i=0; i<size; i++ )
+    {
+        quint64 time;
+        bool    value;
+        in >> time >> value;
+        m_delay.push( time, value );
+    }
+}
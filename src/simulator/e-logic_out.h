@@ -0,0 +1,50 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ELOGICOUT_H
+#define ELOGICOUT_H
+
+#include "e-source.h"
+#include "delayline.h"
+
+// Output of an eLogicDevice. Each output has its own Simulator event and
+// keeps all changes not yet due, so every change reaches the output after
+// the propagation delay, also pulses shorter than the delay.
+
+class MAINMODULE_EXPORT eLogicOut : public eSource
+{
+    public:
+        eLogicOut( std::string id, ePin* epin );
+        ~eLogicOut();
+
+        virtual void initialize();
+        virtual void runEvent();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
+
+        void setOutAt( bool out, uint64_t time ); // Output changes at step time
+        void setOutNow( bool out );               // Pending changes are dropped
+
+        bool nextOut();    // out() after all pending changes
+
+    private:
+        DelayLine m_delay;
+};
+
+#endif
@@ -28,7 +28,9 @@ eNode::eNode( QString id )
     m_nodeNum = 0;
     m_numCons = 0;
     m_volt    = 0;
+    m_dispVolt = 0;
     m_isBus = false;
+    m_changedStamp = 0;
     
     initialize();
     //qDebug() << "+eNode" << m_id;
@@ -49,17 +51,32 @@ void eNode::initialize()
     m_switched     = false;
     m_single       = false;
     m_changed      = false;
-    m_currChanged  = false;
-    m_admitChanged = false;
     m_fastUpdated  = false;
+
+    m_diagSlot = -1;
+    m_admitDirty = false;
+    m_currDirty  = false;
+    m_gndCount = 0;
+    m_nonCero  = 0;
+    m_bias     = 0;
     
     m_ePinSubList.clear();
     m_changedFast.clear();
     m_nonLinear.clear();
     m_reactiveList.clear();
-    m_admitList.clear();
-    m_currList.clear();
     m_nodeList.clear();
+
+    m_conNode.clear();
+    m_conSlot.clear();
+    m_conCount.clear();
+    m_conAdmit.clear();
+
+    foreach( ePin* epin, m_ePinList )
+    {
+        epin->m_conIdx  = -1;
+        epin->m_admit   = 0;
+        epin->m_current = 0;
+    }
     
     m_volt = 0;
     
@@ -72,130 +89,198 @@ void eNode::initialize()
     }
 }
 
-void eNode::stampCurrent( ePin* epin, double data )
+void eNode::createSlots()
 {
-    if( m_nodeList[epin] == m_nodeNum  ) return; // Be sure msg doesn't come from this node
-    
-    m_currList[epin] = data;
-    
-    //qDebug()<< m_nodeNum << epin << data << m_totalCurr;
+    // Resolve Matrix slots for each ePin and stamp values stored
+    // before Matrix creation, slots and coef are summed at stampMatrix().
+    CircMatrix* matrix = CircMatrix::self();
 
-    m_currChanged = true;
-    
-    if( !m_changed ) 
+    m_diagSlot = matrix->getSlot( m_nodeNum, m_nodeNum );
+
+    foreach( ePin* epin, m_ePinList )
     {
-        m_changed = true;
-        Simulator::self()->addToChangedNodeList( this );
+        int enodeCon = m_nodeList.value( epin );
+        int conIdx = -1;                                // Ground
+
+        if( enodeCon == m_nodeNum ) conIdx = -2;        // Same eNode at both sides
+        else if( enodeCon > 0 )
+        {
+            conIdx = std::find( m_conNode.begin(), m_conNode.end(), enodeCon )-m_conNode.begin();
+
+            if( conIdx == (int)m_conNode.size() )
+            {
+                m_conNode.push_back( enodeCon );
+                m_conSlot.push_back( matrix->getSlot( m_nodeNum, enodeCon ) );
+                m_conCount.push_back( 0 );
+            }
+        }
+        epin->m_conIdx = conIdx;
+        if( conIdx == -2 ) continue;
+
+        if( epin->m_admit != 0 ) conChanged( conIdx, true );
     }
+    m_conAdmit.resize( m_conSlot.size() );
+    updateBias();
+    m_admitDirty = true;
+    m_currDirty  = true;
 }
 
-void eNode::stampAdmitance( ePin* epin, double data )
+void eNode::stampCurrent( ePin* epin, double data )
 {
-    if( m_nodeList[epin] == m_nodeNum  ) return; // Be sure msg doesn't come from this node
-    
-    m_admitList[epin] = data;
-
-    m_admitChanged = true;
-    
-    if( !m_changed ) 
+    if( m_diagSlot < 0 )                       // Matrix not created yet
     {
-        m_changed = true;
-        Simulator::self()->addToChangedNodeList( this );
+        if( m_nodeList[epin] == m_nodeNum  ) return; // Be sure msg doesn't come from this node
+        epin->m_current = data;
+        setChanged();
+        return;
     }
-}
+    if( epin->m_conIdx == -2 ) return;             // Be sure msg doesn't come from this node
 
-void eNode::setNodeNumber( int n ) { m_nodeNum = n; }
+    if( data == epin->m_current ) return;
 
-void eNode::stampMatrix()
+    epin->m_current = data;
+    m_currDirty = true;                 // Coef summed again at stampMatrix()
+
+    if( !m_single ) CircMatrix::self()->setCurrChanged();
+    setChanged();
+}
+
+void eNode::stampAdmitance( ePin* epin, double data )
 {
-    if( m_nodeNum == 0 ) return; 
-    
-    m_changed = false;
-    
-    if( m_admitChanged )
+    if( m_diagSlot < 0 )                       // Matrix not created yet
     {
-        m_admit.clear();
-        m_totalAdmit = 0;
-        
-        QHashIterator<ePin*, double> i(m_admitList); // ePin-Admit
-        while ( i.hasNext() ) 
-        {
-            i.next();
+        if( m_nodeList[epin] == m_nodeNum  ) return; // Be sure msg doesn't come from this node
+        epin->m_admit = data;
+        setChanged();
+        return;
+    }
+    int conIdx = epin->m_conIdx;
+    if( conIdx == -2 ) return;                     // Be sure msg doesn't come from this node
 
-            double adm = i.value();
+    if( data == epin->m_admit ) return;
 
-            ePin* epin = i.key();
-            int enode = m_nodeList[epin];
+    bool wasCon = ( epin->m_admit != 0 );
+    epin->m_admit = data;
+    m_admitDirty = true;                // Slots summed again at stampMatrix()
 
-            m_admit[enode] += adm;
-            m_totalAdmit   += adm;
-        }
-        if( !m_single || m_switched ) stampAdmit();
-        
-        m_admitChanged = false;
-    }
-    
-    if( m_currChanged )
+    if( wasCon != (data != 0) ) conChanged( conIdx, !wasCon );
+
+    if( !m_single ) CircMatrix::self()->setAdmitChanged();
+    setChanged();
+}
+
+void eNode::sumAdmit()
+{
+    // Slots are summed from ePin admitances, not changed by deltas:
+    // rounding errors don't build up in long runs.
+    m_admitDirty = false;
+
+    double diag = m_bias;
+    std::fill( m_conAdmit.begin(), m_conAdmit.end(), 0 );
+
+    foreach( ePin* epin, m_ePinList )
     {
-        m_totalCurr  = 0;
-        foreach( double current, m_currList ) m_totalCurr += current;
+        int conIdx = epin->m_conIdx;
+        if( conIdx == -2 ) continue;
 
-        if( !m_single || m_switched ) stampCurr();
-        
-        m_currChanged  = false;
+        diag += epin->m_admit;
+        if( conIdx >= 0 ) m_conAdmit[conIdx] += epin->m_admit;
     }
-    if( m_single ) solveSingle();
+    CircMatrix* matrix = CircMatrix::self();
+    matrix->setSlot( m_diagSlot, diag );
+
+    for( unsigned i=0; i<m_conSlot.size(); i++ ) matrix->setSlot( m_conSlot[i], -m_conAdmit[i] );
 }
 
-void eNode::stampAdmit()
+void eNode::sumCurrent()
 {
-    int nonCero = 0;
-    QHashIterator<int, double> ai(m_admit); // iterate admitance hash: eNode-Admit
-    while ( ai.hasNext() ) 
-    {
-        ai.next();
-        int enode = ai.key();
-        double admit = ai.value();
-        if( enode>0 ) CircMatrix::self()->stampMatrix( m_nodeNum, enode, -admit );
-        
-        if( m_switched )                       // Find open/close events
-        {
-            if( admit > 0 ) nonCero++;
-            double admitP = m_admitPrev[enode];
+    // Same as admitances: summed from ePin currents, not changed by deltas
+    m_currDirty = false;
 
-            if(( admit != admitP )
-              &&((admit==0)||(admitP==0))) CircMatrix::self()->setCircChanged();
-        }
+    double current = 0;
+    foreach( ePin* epin, m_ePinList )
+        if( epin->m_conIdx != -2 ) current += epin->m_current;
+
+    CircMatrix::self()->setCoef( m_nodeNum, current );
+}
+
+void eNode::setChanged()
+{
+    if( !m_changed ) 
+    {
+        m_changed = true;
+        Simulator::self()->addToChangedNodeList( this );
     }
+}
+
+void eNode::conChanged( int conIdx, bool connected ) // Find open/close events
+{
+    CircMatrix* matrix = CircMatrix::self();
+    int inc = connected ? 1 : -1;
+    int count;
+
+    if( conIdx >= 0 ) count = m_conCount[conIdx] += inc;
+    else              count = m_gndCount += inc;
+
+    if( count != (connected ? 1 : 0) ) return;       // Connection didn't change
+
+    m_nonCero += inc;
+
     if( m_switched )
     {
-        m_admitPrev = m_admit;
-        if( nonCero < 2 ) m_totalAdmit += 1e-12; //pnpBias example error
+        if( conIdx >= 0 ) matrix->conChanged( m_nodeNum, m_conNode[conIdx], connected );
+        updateBias();
     }
-    CircMatrix::self()->stampMatrix( m_nodeNum, m_nodeNum, m_totalAdmit );
 }
 
-void eNode::stampCurr()
+void eNode::updateBias()
 {
-    CircMatrix::self()->stampCoef( m_nodeNum, m_totalCurr );
+    double bias = 0;
+    if( m_switched && (m_nonCero < 2) ) bias = 1e-12; //pnpBias example error
+
+    if( bias == m_bias ) return;
+
+    m_bias = bias;
+    m_admitDirty = true;
+}
+
+void eNode::setNodeNumber( int n ) { m_nodeNum = n; }
+
+void eNode::stampMatrix()
+{
+    if( m_nodeNum == 0 ) return; 
+    
+    m_changed = false;
+
+    if( m_admitDirty ) sumAdmit();
+    if( m_currDirty )  sumCurrent();
+    if( m_single ) solveSingle();
 }
 
 void eNode::solveSingle()
 {
     double volt = 0;
-    
-    if( m_totalAdmit > 0 ) volt = m_totalCurr/m_totalAdmit;
+
+    if( m_diagSlot >= 0 )
+    {
+        double admit = CircMatrix::self()->slotValue( m_diagSlot );
+        if( admit > 0 ) volt = CircMatrix::self()->coef( m_nodeNum )/admit;
+    }
     setVolt( volt );
 }
 
-QList<int> eNode::getConnections()
+void eNode::getConnections( std::vector<int> &cons )
 {
-    QList<int> cons;
-    foreach( int nodeNum, m_nodeList ) 
+    cons.clear();
+    for( unsigned i=0; i<m_conNode.size(); i++ ) 
     {
-        if( m_admit[nodeNum] > 0 ) cons.append( nodeNum );
+        if( m_conCount[i] > 0 ) cons.push_back( m_conNode[i] );
     }
-    return cons;
+}
+
+QList<int> eNode::getAllConnections()
+{
+    return m_nodeList.values();
 }
 
 void  eNode::setVolt( double v )
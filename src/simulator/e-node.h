@@ -25,6 +25,8 @@
 
 class MAINMODULE_EXPORT eNode
 {
+    friend class Simulator;
+
     public:
         eNode( QString id );
         ~eNode();
@@ -55,15 +57,17 @@ class MAINMODULE_EXPORT eNode
 
         double getVolt();
         void  setVolt( double volt );
+
+        // Voltage published by Simulator at last frame, for GUI painting
+        double dispVolt() { return m_dispVolt; }
         
         void solveSingle();
         
         bool needFastUpdate() { return m_fastUpdated; }
 
         void initialize();
+        void createSlots();
         void stampMatrix();
-        void stampAdmit();
-        void stampCurr();
         
         void setSingle( bool single );// This eNode can calculate it's own Volt
         bool isSingle();
@@ -77,7 +81,8 @@ class MAINMODULE_EXPORT eNode
 
         QList<ePin*> getEpins();
         QList<ePin*> getSubEpins();
-        QList<int> getConnections();
+        void getConnections( std::vector<int> &cons );
+        QList<int> getAllConnections();  // Including not conducting ones
 
     private:
         QList<ePin*>     m_ePinList;
@@ -90,29 +95,41 @@ class MAINMODULE_EXPORT eNode
         QList<eElement*> m_reactiveList;
         QList<eElement*> m_nonLinear;
 
-        QHash<ePin*, double> m_admitList;
-        QHash<ePin*, double> m_currList;
+        void setChanged();
+        void conChanged( int conIdx, bool connected );
+        void updateBias();
+        void sumAdmit();
+        void sumCurrent();
+
         QHash<ePin*, int>    m_nodeList;
-        
-        QHash<int, double>   m_admit;
-        QHash<int, double>   m_admitPrev;
-        
-        double m_totalCurr;
-        double m_totalAdmit;
+
+        std::vector<int> m_conNode;  // eNode number of each connection
+        std::vector<int> m_conSlot;  // Matrix slot of each connection
+        std::vector<int> m_conCount; // Num of ePins conducting to each connection
+        std::vector<double> m_conAdmit; // Admitance to each connection (sumAdmit)
+
+        int m_diagSlot;
+        int m_gndCount;  // Num of ePins conducting to ground
+        int m_nonCero;   // Num of connections conducting
+
+        double m_bias;
 
         double m_volt;
+        double m_dispVolt;
         int   m_nodeNum;
         int   m_numCons;
 
         QString m_id;
         
+        bool m_admitDirty;   // Slots must be summed again
+        bool m_currDirty;    // Coefficient must be summed again
         bool m_fastUpdated;
-        bool m_currChanged;
-        bool m_admitChanged;
         bool m_changed;
         bool m_single;
         bool m_switched;
         bool m_isBus;
+
+        uint64_t m_changedStamp;  // Simulator changed list stamp (see DirtyList)
 };
 #endif
 
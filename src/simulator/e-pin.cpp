@@ -32,6 +32,9 @@ ePin::ePin( std::string id, int index )
     m_enodeCon = 0l;
     m_connected = false;
     m_inverted  = false;
+    m_conIdx    = -1;
+    m_admit     = 0;
+    m_current   = 0;
 }
 ePin::~ePin()
 {
@@ -97,6 +100,13 @@ double ePin::getVolt()
     return 0;
 }
 
+double ePin::dispVolt()
+{
+    if( m_connected )return m_enode->dispVolt();
+    if( m_enodeCon ) return m_enodeCon->dispVolt();
+    return 0;
+}
+
 void ePin::setConnected( bool connected )  { m_connected = connected; }
 
 bool ePin::isConnected() { return m_connected; }
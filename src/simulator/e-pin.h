@@ -27,6 +27,9 @@ class eNode;
 
 class MAINMODULE_EXPORT ePin
 {
+    friend class eNode;
+    friend class Simulator;
+
     public:
         ePin( std::string id, int index );
         ~ePin();
@@ -35,6 +38,7 @@ class MAINMODULE_EXPORT ePin
         void setConnected( bool connected );
 
         double getVolt();
+        double dispVolt();  // Voltage published at last frame (see eNode)
 
         eNode* getEnode();
         void   setEnode( eNode* enode );
@@ -60,6 +64,10 @@ class MAINMODULE_EXPORT ePin
         std::string m_id;
         int m_index;
 
+        int    m_conIdx;     // Index of m_enodeCon in eNode connections (set by eNode)
+        double m_admit;      // Last admittance stamped
+        double m_current;    // Last current stamped
+
         bool m_connected;
         bool m_inverted;
 };
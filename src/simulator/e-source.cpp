@@ -78,6 +78,18 @@ void eSource::stampOutput()                               // Stamp Output
     m_ePin[0]->stampCurrent( m_voltOut/m_imp );
 }
 
+void eSource::saveState( QDataStream &out )
+{
+    out << m_out << m_voltOut << m_imp;
+}
+
+void eSource::loadState( QDataStream &in )
+{
+    in >> m_out >> m_voltOut >> m_imp;
+    m_admit = 1/m_imp;
+    m_scrEnode->setVolt( m_voltOut );
+}
+
 void eSource::setVoltHigh( double v )
 {
     m_voltHigh = v;
@@ -35,6 +35,9 @@ class MAINMODULE_EXPORT eSource : public eElement
         void stamp();
         void stampOutput();
 
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
+
         double voltHight();
         void  setVoltHigh( double v );
 
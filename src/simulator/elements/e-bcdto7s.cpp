@@ -43,6 +43,27 @@ void eBcdTo7S::initialize()
     eLogicDevice::initialize();
 }
 
+void eBcdTo7S::saveState( QDataStream &out )
+{
+    eLogicDevice::saveState( out );
+    out << m_changed << qint32( m_outValue.size() );
+    for( unsigned i=0; i<m_outValue.size(); i++ ) out << bool( m_outValue[i] );
+}
+
+void eBcdTo7S::loadState( QDataStream &in )
+{
+    eLogicDevice::loadState( in );
+    qint32 outputs = 0;
+    in >> m_changed >> outputs;
+
+    for( int i=0; i<outputs; i++ )
+    {
+        bool value;
+        in >> value;
+        if( i < (int)m_outValue.size() ) m_outValue[i] = value;
+    }
+}
+
 void eBcdTo7S::setVChanged()
 {
     eLogicDevice::updateOutEnabled();
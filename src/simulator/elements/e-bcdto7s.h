@@ -31,6 +31,9 @@ class MAINMODULE_EXPORT eBcdTo7S : public eLogicDevice
 
         virtual void initialize();
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
         void createPins();
 
@@ -54,6 +54,18 @@ void eBinCounter::createPins()
     m_input[0]->setInverted( true );
 }
 
+void eBinCounter::saveState( QDataStream &out )
+{
+    eLogicDevice::saveState( out );
+    out << m_Counter;
+}
+
+void eBinCounter::loadState( QDataStream &in )
+{
+    eLogicDevice::loadState( in );
+    in >> m_Counter;
+}
+
 void eBinCounter::setVChanged()
 {
     bool clkRising = (eLogicDevice::getClockState() == Rising);
@@ -39,6 +39,9 @@ class MAINMODULE_EXPORT eBinCounter : public eLogicDevice
         void createPins();
         virtual void setVChanged();
 
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
+
         bool resetInv() { return m_resetInv; }
         void setResetInv( bool inv );
 
@@ -19,7 +19,6 @@
 
 #include <math.h>   // fabs(x,y)
 #include <sstream>
-#include <QDebug>
 
 #include "e-bjt.h"
 #include "e-node.h"
@@ -44,11 +43,20 @@ eBJT::eBJT( std::string id )
     ssb << m_elmId << "-BCdiode";
     m_BCdiode = new eDiode( ssb.str() );
     m_BCdiode->initEpins();
+
+    for( int i=0; i<3; i++ )
+    {
+        std::stringstream ssg;
+        ssg << m_elmId << "-gmPin" << i;
+        m_gmPin[i] = new ePin( ssg.str(), i );
+    }
 }
 eBJT::~eBJT()
 { 
     delete m_BEdiode;
     delete m_BCdiode;
+
+    for( int i=0; i<3; i++ ) delete m_gmPin[i];
 }
 
 void eBJT::initialize()
@@ -96,12 +104,24 @@ void eBJT::initialize()
             if( m_BCdiodeOn ) m_BCdiode->getEpin( 0 )->setEnode( enod2 );
         }
     }
+    // Collector current controlled by Base-Emiter voltage:
+    // C row: +gm*Vb -gm*Ve, E row: -gm*Vb +gm*Ve
+    eNode* enodC = m_ePin[0]->getEnode();
+    eNode* enodE = m_ePin[1]->getEnode();
+    eNode* enodB = m_ePin[2]->getEnode();
+
+    m_gmPin[0]->setEnode( enodC );     // Stamps -gm
+    m_gmPin[0]->setEnodeComp( enodB );
+    m_gmPin[1]->setEnode( enodC );     // Stamps +gm
+    m_gmPin[1]->setEnodeComp( enodE );
+    m_gmPin[2]->setEnode( enodE );     // Stamps +gm
+    m_gmPin[2]->setEnodeComp( enodB );
+
     eResistor::initialize();
 }
 
 void eBJT::resetState()
 {
-    //eResistor::setRes( 400/m_gain );
     eResistor::setAdmit( 0 );
     eResistor::stamp();
 
@@ -109,11 +129,23 @@ void eBJT::resetState()
     if( m_BCdiodeOn ) m_BCdiode->resetState();
     
     m_accuracy = Simulator::self()->NLaccuracy();
-    //m_stage = 0;
-    m_lastOut = 0;
     m_baseCurr = 0;
-    m_voltE = 0;
-    m_Efollow = false;
+    m_voltBE = 0;
+    m_voltCE = 0;
+    m_currCE = 0;
+    m_gm     = 0;
+}
+
+void eBJT::saveState( QDataStream &out )
+{
+    eResistor::saveState( out );
+    out << m_baseCurr << m_voltBE << m_voltCE << m_currCE << m_gm;
+}
+
+void eBJT::loadState( QDataStream &in )
+{
+    eResistor::loadState( in );
+    in >> m_baseCurr >> m_voltBE >> m_voltCE >> m_currCE >> m_gm;
 }
 
 void eBJT::setVChanged() 
@@ -123,7 +155,7 @@ void eBJT::setVChanged()
     double voltC = m_ePin[0]->getVolt();
     double voltE = m_ePin[1]->getVolt();
     double voltB = m_ePin[2]->getVolt();
-    //qDebug()<<voltC<<voltE<<voltB;
+
     if( m_PNP )
     {
         voltCE = voltE-voltC;
@@ -134,74 +166,88 @@ void eBJT::setVChanged()
         voltCE = voltC-voltE;
         voltBE = voltB-voltE;
     }
-    if( voltCE < cero_doub ) voltCE = cero_doub;
-    
-    double maxCurrCE = voltCE/m_resist;
-    double current = maxCurrCE;
-    
-    if( !m_Efollow )
-    {
-        if( m_PNP )
-        {
-            if( fabs( voltE-m_voltE )<0 ){ m_Efollow = true; }
-        }
-        else if(( fabs(m_voltE) > 1e-3 )&&( m_voltE != voltE ))
-        { 
-            m_Efollow = true; 
-            eResistor::setRes( 400/m_gain );
-            eResistor::stamp();
-        }
-        m_voltE = voltE;
-    }
-    double satK = 0;
+    if( isConverged( voltBE, voltCE ) ) return;
+
+    voltBE = m_BEdiode->limitVolt( voltBE, m_voltBE );
+
+    double gm, go;
+    m_currCE = collectorCurrent( voltBE, voltCE, gm, go );
+    m_voltBE = voltBE;
+    m_voltCE = voltCE;
 
-    if( voltCE < voltBE )          
+    if( fabs( gm ) < 1e-12 ) gm = 0;
+    if( go < 1e-12 )         go = 0;
+
+    // Norton equivalent: Ic = current + gm*Vbe + go*Vce
+    double current = m_currCE-gm*voltBE-go*voltCE;
+    if( m_PNP ) current = -current;
+
+    if( go != m_admit ) eResistor::setAdmit( go );
+
+    if( gm != m_gm )
     {
-        satK = voltCE/voltBE-1;
-        satK = pow( satK, 2 );
+        m_gm = gm;
+        m_gmPin[0]->stampAdmitance(-gm );
+        m_gmPin[1]->stampAdmitance( gm );
+        m_gmPin[2]->stampAdmitance( gm );
     }
-    m_baseCurr = m_BEdiode->current();
+    m_ePin[0]->stampCurrent(-current );
+    m_ePin[1]->stampCurrent( current );
+}
 
-    double currentCE = m_baseCurr*m_gain*(1+voltCE/75);
-    currentCE -= currentCE*satK;
-    
-    //qDebug()<<"m_baseCurr"<<m_baseCurr<<"    currentCE"<<currentCE<<"     maxCurrCE"<<maxCurrCE<<"     voltBE"<<voltBE <<"    m_Efollow"<<m_Efollow;
+bool eBJT::isConverged( double voltBE, double voltCE )
+{
+    double deltaBE = voltBE-m_voltBE;
+    double deltaCE = voltCE-m_voltCE;
 
-    if( m_Efollow )
-    {
-        current = maxCurrCE-currentCE;
-        
-        current = m_lastOut+(current-m_lastOut)/5;
+    if( fabs( deltaBE ) > m_accuracy ) return false;
+    if( fabs( deltaCE ) > m_accuracy ) return false;
 
-        if( current < 0 ) current = 0;
-        
-        //qDebug()<<"current"<<current<<"  m_baseCurr"<<m_baseCurr<<"  currentCE"<<currentCE<<"  maxCurrCE"<<maxCurrCE<<"  voltBE"<<voltBE <<" m_Efollow"<<m_Efollow;
+    // Current predicted by last linearization must match the model
+    double gm, go;
+    double current = collectorCurrent( voltBE, voltCE, gm, go );
+    double linCurr = m_currCE+m_gm*deltaBE+m_admit*deltaCE;
 
-        if( m_PNP ) current = -current;
+    return ( fabs( current-linCurr ) <= m_accuracy*(fabs( current )+1e-3) );
+}
 
-        double accuracy = m_accuracy/5;
+double eBJT::collectorCurrent( double voltBE, double voltCE, double &gm, double &go )
+{
+    // Ic = gain*Ib*(1+Vce/75)*(1-satK), satK = (Vce/Vbe-1)^2 if Vce < Vbe
+    double admitBE;
+    m_baseCurr = m_BEdiode->junctionCurrent( voltBE, admitBE );
 
-        if( fabs(current-m_lastOut) < accuracy ) return;
-        
-        m_lastOut = current;
-        m_ePin[0]->stampCurrent( current );
-        m_ePin[1]->stampCurrent(-current );
+    gm = 0;
+    go = 0;
+    if( m_baseCurr <= 0 ) 
+    {
+        m_baseCurr = 0;
+        return 0;
     }
-    else
+    double currCE = m_gain*m_baseCurr;
+
+    if( voltCE <= 0 ) // Continue with slope at Vce = 0
     {
-        double admit = 0;
-        if( currentCE!=0 && voltCE!=0 ) admit = currentCE/voltCE;
-        if( admit < 0 ) admit = 0;
-        //admit = m_lastOut+(admit-m_lastOut)/2;
-        admit *= 1.1;
-        
-        if( fabs(admit-m_lastOut) < m_accuracy ) return;
-        
-        eResistor::setAdmit( admit );
-        eResistor::stamp();
-        m_lastOut = admit;
-        //qDebug()<< QString::fromStdString( m_elmId )<<" voltBE"<<voltBE << " admit" <<admit;
+        go = 2*currCE/voltBE;
+        gm = voltCE*2*m_gain*( admitBE-m_baseCurr/voltBE )/voltBE;
+        return go*voltCE;
     }
+    double early = 1+voltCE/75;
+    double satK   = 0;
+    double dSatCE = 0;
+    double dSatBE = 0;
+
+    if( voltCE < voltBE )
+    {
+        double x = voltCE/voltBE-1;
+        satK   = x*x;
+        dSatCE = 2*x/voltBE;
+        dSatBE =-2*x*voltCE/(voltBE*voltBE);
+    }
+    go = currCE*( (1-satK)/75-early*dSatCE );
+    gm = m_gain*admitBE*early*(1-satK)-currCE*early*dSatBE;
+
+    return currCE*early*(1-satK);
 }
 
 double eBJT::BEthr()
@@ -33,6 +33,9 @@ class MAINMODULE_EXPORT eBJT : public eResistor
         virtual void initialize();
         virtual void resetState();
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
         virtual double gain()              { return m_gain; }
         virtual void setGain( double gain ){ m_gain = gain; }
@@ -50,20 +53,27 @@ class MAINMODULE_EXPORT eBJT : public eResistor
         virtual void initEpins();
         
     protected:
+        bool isConverged( double voltBE, double voltCE );
+        double collectorCurrent( double voltBE, double voltCE, double &gm, double &go );
+
         double m_accuracy;
-        double m_lastOut;
         double m_baseCurr;
-        double m_voltE;
         double m_BEthr;
-        
+
+        double m_voltBE;    // Voltages at last linearization point
+        double m_voltCE;
+        double m_currCE;    // Collector current at last linearization point
+        double m_gm;        // Transconductance: dIc/dVbe
+
         int m_gain;
-        bool m_Efollow;
-        
+
         bool m_PNP;
         bool m_BCdiodeOn;
-        
+
         ePN* m_BEdiode;
         eDiode* m_BCdiode;
+
+        ePin* m_gmPin[3];   // Voltage controlled current source: gm*Vbe
 };
 
 #endif
@@ -19,6 +19,7 @@
 
 // Capacitor model using backward euler  approximation
 // consists of a current source in parallel with a resistor.
+// In adaptive step mode uses Gear-2 (BDF2) with variable step.
 
 #include "e-capacitor.h"
 #include "simulator.h"
@@ -33,6 +34,8 @@ eCapacitor::eCapacitor( std::string id )
     m_resist = m_tStep/m_cap;
     m_curSource = 0;
     m_volt = 0;
+
+    m_adaptive = false;
 }
 eCapacitor::~eCapacitor()
 { 
@@ -48,13 +51,31 @@ void eCapacitor::initialize()
 void eCapacitor::resetState()
 {
     m_tStep = (double)Simulator::self()->reaClock()/1e6;
+    m_adaptive = Simulator::self()->adaptiveStep();
+    m_step.reset();
     
     eResistor::setRes( m_tStep/m_cap );
 }
 
+void eCapacitor::saveState( QDataStream &out )
+{
+    eResistor::saveState( out );
+    out << m_curSource << m_tStep;
+    m_step.saveState( out );
+}
+
+void eCapacitor::loadState( QDataStream &in )
+{
+    eResistor::loadState( in );
+    in >> m_curSource >> m_tStep;
+    m_step.loadState( in );
+}
+
 void eCapacitor::setVChanged()
 {
     double volt = m_ePin[0]->getVolt() - m_ePin[1]->getVolt();
+
+    if( m_adaptive ) { m_step.check( this, volt, 1e-3 ); return; }
     
     if( fabs(volt) < 1e-9 ) return;
 
@@ -66,6 +87,37 @@ void eCapacitor::setVChanged()
     m_ePin[1]->stampCurrent(-m_curSource );
 }
 
+void eCapacitor::reacAccept()
+{
+    m_step.accept();
+    stampStep();
+}
+
+void eCapacitor::reacReject()
+{
+    m_step.reject();
+    stampStep();
+}
+
+void eCapacitor::stampStep() // Companion model to integrate m_step.hStep()
+{
+    double a0, a1, a2;
+    m_step.coefs( a0, a1, a2 );
+
+    double g     = m_cap/(m_step.hStep()/1e6);
+    double admit = g*a0;
+    m_curSource  = g*( a1*m_step.last()-a2*m_step.prev() );
+
+    if( admit != m_admit )
+    {
+        m_resist = 1/admit;
+        eResistor::setAdmit( admit );
+    }
+
+    m_ePin[0]->stampCurrent( m_curSource );
+    m_ePin[1]->stampCurrent(-m_curSource );
+}
+
 double eCapacitor::cap()             
 { 
     return m_cap; 
@@ -21,6 +21,7 @@
 #define ECAPACITOR_H
 
 #include "e-resistor.h"
+#include "adaptivestep.h"
 
 class MAINMODULE_EXPORT eCapacitor : public eResistor
 {
@@ -31,15 +32,25 @@ class MAINMODULE_EXPORT eCapacitor : public eResistor
         virtual void initialize();
         virtual void resetState();
         void setVChanged();
+        void reacAccept();
+        void reacReject();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
 
         double cap();
         void setCap( double c );
 
     protected:
+        void stampStep();
+
         double m_cap;
         double m_curSource;
         double m_tStep;
         double m_volt;
+
+        bool         m_adaptive;
+        AdaptiveStep m_step;    // Voltage history
 };
 
 #endif
@@ -36,30 +36,23 @@ eClock::eClock( std::string id )
     m_output->setOut( false );
     
     m_stepsPC = 0;
-    m_step = 0;
     setFreq( 1000 );
-    
-    Simulator::self()->addToSimuClockList( this );
 }
 eClock::~eClock()
 { 
 }
 
-void eClock::resetState()
+void eClock::initialize()
 {
-    m_step = 0;
+    Simulator::self()->addEvent( Simulator::self()->step()+m_stepsPC/2, this );
 }
 
-void eClock::simuClockStep()
+void eClock::runEvent()
 {
-    m_step++;
+    m_output->setOut( !m_output->out() );
+    m_output->stampOutput();
 
-    if ( m_step >= m_stepsPC/2 )
-    {
-        m_output->setOut( !m_output->out() );
-        m_output->stampOutput();
-        m_step = 0;
-    }
+    Simulator::self()->addEvent( Simulator::self()->step()+m_stepsPC/2, this );
 }
 
 void eClock::setFreq( double freq )
@@ -30,8 +30,8 @@ class MAINMODULE_EXPORT eClock : public eElement
         eClock( std::string id );
         ~eClock();
 
-        virtual void resetState();
-        virtual void simuClockStep();
+        virtual void initialize();
+        virtual void runEvent();
         
         void setFreq( double freq );
         void setVolt( double v );
@@ -44,7 +44,6 @@ class MAINMODULE_EXPORT eClock : public eElement
         
         double m_freq;
         
-        int m_step;
         int m_stepsPC;
 };
 
@@ -17,94 +17,69 @@
  *                                                                         *
  ***************************************************************************/
 
-//#include <QDebug>
-//#include <math.h>
+#include <math.h>
 
 #include "e-diode.h"
-#include "e-node.h"
 #include "simulator.h"
 
 eDiode::eDiode( std::string id ) 
-      : eResistor( id )
+      : ePN( id )
 {
-    m_imped = 0.6;
-    m_threshold = 0.7;
     m_zenerV = 0;
+
+    updateModel();
 }
 eDiode::~eDiode()
 { 
 }
 
-void eDiode::initialize()
+void eDiode::updateModel()
 {
-    if( m_ePin[0]->isConnected() )
-    {
-        eNode* node = m_ePin[0]->getEnode();
-        node->addToNoLinList(this);
-        if( node ) node->setSwitched( true );
-    }
-    if( m_ePin[1]->isConnected() )
+    ePN::updateModel();
+
+    if( m_zenerV > 0 ) // Reverse breakdown is a junction with threshold = m_zenerV
     {
-        eNode* node = m_ePin[1]->getEnode();
-        node->addToNoLinList(this);
-        if( node ) node->setSwitched( true );
-    }
-    eResistor::initialize();
-}
+        m_zSatCur = m_satCur*exp( (m_threshold-m_zenerV)/m_vt );
 
-void eDiode::resetState()
-{
-    m_resist = high_imp;
-    m_admit = 0;
-    m_converged = true;
-    m_voltPN  = 0;
-    m_deltaV  = 0;
-    m_current = 0;
+        m_vzLin  = m_vt*log( m_vt/(m_imped*m_zSatCur) );
+        m_izLin  = m_zSatCur*(exp( m_vzLin/m_vt )-1);
+        m_vzCrit = m_vt*log( m_vt/(sqrt(2)*m_zSatCur) );
+    }
 }
 
-void eDiode::setVChanged()
+double eDiode::junctionCurrent( double volt, double &admit )
 {
-    m_voltPN = m_ePin[0]->getVolt()-m_ePin[1]->getVolt();
-
-    double deltaR = m_imped;
-    double deltaV = m_threshold;
+    double current = ePN::junctionCurrent( volt, admit );
 
-    if( (m_threshold-m_voltPN) > 1e-6 )   // Not conducing
+    if( m_zenerV > 0 )
     {
-        if( (m_zenerV > 0)&&(m_voltPN <-m_zenerV) )
-            deltaV =-m_zenerV;
-        else                        
+        double zenerV = -volt;
+        double zAdmit;
+        double zCurrent;
+
+        if( zenerV > m_vzLin )
         {
-            deltaV = m_voltPN;
-            deltaR = high_imp;
+            zAdmit = 1/m_imped;
+            zCurrent = m_izLin+(zenerV-m_vzLin)*zAdmit;
         }
+        else
+        {
+            double expV = exp( zenerV/m_vt );
+            zAdmit = m_zSatCur*expV/m_vt;
+            zCurrent = m_zSatCur*(expV-1);
+        }
+        admit   += zAdmit;
+        current -= zCurrent;
     }
-    //qDebug() <<"eDiode::setVChanged,  deltaR: "<< deltaR << "  deltaV" << deltaV << "m_voltPN" << m_voltPN<<m_threshold<<m_imped ;
-    //qDebug() <<"eDiode::setVChanged : "<< (m_voltPN==m_threshold);
-
-    if( deltaR != m_resist )
-    {
-        m_resist = deltaR;
-        if( deltaR == high_imp ) eResistor::setAdmit( 0 );
-        else                     eResistor::setAdmit( 1/m_resist );
-        //m_converged = false;
-    }
-    //if( fabs(deltaV - m_deltaV) > 1e-18 ) 
-    {
-        m_deltaV = deltaV;
-
-        double current = deltaV/m_resist;
-        //qDebug() <<"eDiode::setVChanged current: "<< current;
-        if( deltaR == high_imp ) current = 0;
-
-        m_ePin[0]->stampCurrent( current );
-        m_ePin[1]->stampCurrent(-current );
-    }
+    return current;
 }
 
-void eDiode::setThreshold( double threshold )
+double eDiode::limitVolt( double vnew, double vold )
 {
-    m_threshold = threshold;
+    if( (m_zenerV > 0)&&(vnew < 0) )
+        return -pnjLimit( -vnew, -vold, m_vzCrit, m_vzLin );
+
+    return ePN::limitVolt( vnew, vold );
 }
 
 double eDiode::res()
@@ -118,8 +93,10 @@ void eDiode::setRes( double resist )
     if( pauseSim ) Simulator::self()->pauseSim();
 
     if( resist == 0 ) resist = 0.1;
-    m_imped = resist;
-    setVChanged();
+    m_imped  = resist;
+    m_resist = resist;
+    updateModel();
+    stampJunction( m_voltPN );
 
     if( pauseSim ) Simulator::self()->resumeSim();
 }
@@ -128,20 +105,6 @@ void  eDiode::setZenerV( double zenerV )
 { 
     if( zenerV > 0 ) m_zenerV = zenerV; 
     else             m_zenerV = 0;
-    setResSafe( m_imped );
-}
-
-void eDiode::updateVI()
-{
-    m_current = 0;
-    
-    if( m_resist == high_imp ) return;
 
-    if( m_ePin[0]->isConnected() && m_ePin[1]->isConnected() )
-    {
-        double volt = m_voltPN - m_deltaV;
-        if( volt>0 ) m_current = volt/m_resist;
-        //qDebug() << "m_voltPN"<<m_voltPN<<"m_deltaV"<<m_deltaV<<"volt"<<volt;
-    }
+    setResSafe( m_imped );
 }
-
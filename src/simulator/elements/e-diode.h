@@ -20,39 +20,32 @@
 #ifndef EDIODE_H
 #define EDIODE_H
 
-#include "e-resistor.h"
+#include "e-pn.h"
 
-class MAINMODULE_EXPORT eDiode : public eResistor
+class MAINMODULE_EXPORT eDiode : public ePN
 {
     public:
+
         eDiode(  std::string id );
         ~eDiode();
 
-        virtual double threshold() { return m_threshold; }
-        virtual void  setThreshold( double threshold );
-        
         virtual double zenerV(){ return m_zenerV; }
         virtual void  setZenerV( double zenerV );
 
-        virtual void initialize();
-        virtual void resetState();
-
-        virtual void setVChanged();
-
         virtual void    setRes( double resist );
         virtual double  res();
 
+        virtual double junctionCurrent( double volt, double &admit );
+        virtual double limitVolt( double vnew, double vold );
+
     protected:
-        void updateVI();
+        virtual void updateModel();
 
-        double m_voltPN;
-        double m_deltaV;
-        double m_threshold;
-        double m_imped;
         double m_zenerV;
-
-        bool m_converged;
+        double m_zSatCur;   // Reverse breakdown: same as forward constants
+        double m_vzCrit;
+        double m_vzLin;
+        double m_izLin;
 };
-#endif
-
 
+#endif
@@ -49,6 +49,20 @@ void eGate::initialize()
     m_lastStep = Simulator::self()->step();
 }
 
+void eGate::saveState( QDataStream &out )
+{
+    eLogicDevice::saveState( out );
+    out << m_oscCount << quint64( m_lastStep );
+}
+
+void eGate::loadState( QDataStream &in )
+{
+    eLogicDevice::loadState( in );
+    quint64 lastStep;
+    in >> m_oscCount >> lastStep;
+    m_lastStep = lastStep;
+}
+
 void eGate::setVChanged()
 {
     uint64_t step = Simulator::self()->step();
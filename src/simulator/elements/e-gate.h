@@ -31,6 +31,9 @@ class MAINMODULE_EXPORT eGate : public eLogicDevice
 
         virtual void initialize();
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
         bool tristate();
         void setTristate( bool t );
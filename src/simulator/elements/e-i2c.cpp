@@ -52,6 +52,18 @@ void eI2C::resetState()
     m_input[0]->setImp( high_imp );
 }
 
+void eI2C::saveState( QDataStream &out )
+{
+    eLogicDevice::saveState( out );
+    out << m_txReg << m_rxReg << m_state << m_lastState << m_bitPtr << m_SDA << m_lastSDA;
+}
+
+void eI2C::loadState( QDataStream &in )
+{
+    eLogicDevice::loadState( in );
+    in >> m_txReg >> m_rxReg >> m_state >> m_lastState >> m_bitPtr >> m_SDA >> m_lastSDA;
+}
+
 void eI2C::setVChanged()            // Some Pin Changed State, Manage it
 {
     int sclState = eLogicDevice::getClockState(); // Get Clk to don't miss any clock changes
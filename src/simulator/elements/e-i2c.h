@@ -43,6 +43,9 @@ class MAINMODULE_EXPORT eI2C : public eLogicDevice
         virtual void initialize();
         virtual void resetState();
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         virtual void writeByte();
         virtual void readByte();
         
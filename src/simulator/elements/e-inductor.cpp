@@ -19,6 +19,7 @@
 
 // Inductor model using backward euler  approximation
 // consists of a current source in parallel with a resistor.
+// In adaptive step mode uses Gear-2 (BDF2) with variable step.
 
 #include "simulator.h"
 #include "e-inductor.h"
@@ -33,6 +34,9 @@ eInductor::eInductor( std::string id ) : eResistor( id )
     m_resist = m_ind/m_tStep;
     m_curSource = 0;
     m_volt = 0;
+
+    m_adaptive = false;
+    m_srcCurr = 0;
 }
 eInductor::~eInductor()
 {
@@ -49,14 +53,34 @@ void eInductor::resetState()
 {
     m_tStep = (double)Simulator::self()->reaClock()/1e6;
     
+    m_adaptive = Simulator::self()->adaptiveStep();
+    m_step.reset();
+
     eResistor::setRes( m_ind/m_tStep );
     
     m_curSource = 0;
+    m_srcCurr = 0;
+}
+
+void eInductor::saveState( QDataStream &out )
+{
+    eResistor::saveState( out );
+    out << m_curSource << m_tStep << m_volt << m_srcCurr;
+    m_step.saveState( out );
+}
+
+void eInductor::loadState( QDataStream &in )
+{
+    eResistor::loadState( in );
+    in >> m_curSource >> m_tStep >> m_volt >> m_srcCurr;
+    m_step.loadState( in );
 }
 
 void eInductor::setVChanged()
 {
     double volt = m_ePin[0]->getVolt() - m_ePin[1]->getVolt();
+
+    if( m_adaptive ) { m_step.check( this, m_srcCurr+volt*m_admit, 1e-6 ); return; }
     
     if( fabs(volt) < 1e-9 ) return;
 
@@ -68,6 +92,36 @@ void eInductor::setVChanged()
     m_ePin[1]->stampCurrent( m_curSource );
 }
 
+void eInductor::reacAccept()
+{
+    m_step.accept();
+    m_curSource = m_step.last();
+    stampStep();
+}
+
+void eInductor::reacReject()
+{
+    m_step.reject();
+    stampStep();
+}
+
+void eInductor::stampStep() // Companion model to integrate m_step.hStep()
+{
+    double a0, a1, a2;
+    m_step.coefs( a0, a1, a2 );
+
+    double admit = (m_step.hStep()/1e6)/(m_ind*a0);
+    m_srcCurr = ( a1*m_step.last()-a2*m_step.prev() )/a0;
+
+    if( admit != m_admit )
+    {
+        m_resist = 1/admit;
+        eResistor::setAdmit( admit );
+    }
+    m_ePin[0]->stampCurrent(-m_srcCurr );
+    m_ePin[1]->stampCurrent( m_srcCurr );
+}
+
 double eInductor::ind()
 { 
     return m_ind; 
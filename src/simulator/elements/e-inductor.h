@@ -21,6 +21,7 @@
 #define EINDUCTOR_H
 
 #include "e-resistor.h"
+#include "adaptivestep.h"
 
 class LibraryItem;
 
@@ -33,15 +34,27 @@ class MAINMODULE_EXPORT eInductor : public eResistor
         virtual void initialize();
         virtual void resetState();
         virtual void setVChanged();
+        void reacAccept();
+        void reacReject();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
 
         double ind();
         void   setInd( double h );
 
     protected:
+        void stampStep();
+
         double m_ind;
-        double m_curSource;
+        double m_curSource; // Inductor current
         double m_tStep;
         double m_volt;
+
+        double m_srcCurr;   // Current source of companion model (adaptive step)
+
+        bool         m_adaptive;
+        AdaptiveStep m_step;    // Current history
 };
 
 #endif
@@ -41,6 +41,22 @@ void eLed::resetState()
     eDiode::resetState();
 }
 
+void eLed::saveState( QDataStream &out )
+{
+    eDiode::saveState( out );
+    out << quint64( m_prevStep ) << m_bright << m_lastCurrent << m_lastUpdatePeriod
+        << m_avg_brightness << m_disp_brightness;
+}
+
+void eLed::loadState( QDataStream &in )
+{
+    eDiode::loadState( in );
+    quint64 prevStep;
+    in >> prevStep >> m_bright >> m_lastCurrent >> m_lastUpdatePeriod >> m_avg_brightness
+       >> m_disp_brightness;
+    m_prevStep = prevStep;
+}
+
 void eLed::setVChanged()
 {
     eDiode::setVChanged();
@@ -35,6 +35,9 @@ class MAINMODULE_EXPORT eLed : public eDiode
 
         virtual void resetState();
 
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
+
     protected:
         void updateBright();
         virtual void updateVI();
@@ -53,6 +53,16 @@ void eLm555::resetState()
     m_volt = 0;
 }
 
+void eLm555::saveState( QDataStream &out )
+{
+    out << m_volt << m_outState;
+}
+
+void eLm555::loadState( QDataStream &in )
+{
+    in >> m_volt >> m_outState;
+}
+
 void eLm555::setVChanged()
 {
     double voltPos = m_ePin[7]->getVolt();
@@ -35,6 +35,9 @@ class MAINMODULE_EXPORT eLm555 : public eElement
         virtual void resetState();
 
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
         virtual void initEpins();
 
@@ -69,6 +69,18 @@ void eMosfet::resetState()
     //if( m_depletion ) m_Gth = -m_Gth;
 }
 
+void eMosfet::saveState( QDataStream &out )
+{
+    eResistor::saveState( out );
+    out << m_lastCurrent << m_gateV << m_Vs << m_Sfollow << m_converged;
+}
+
+void eMosfet::loadState( QDataStream &in )
+{
+    eResistor::loadState( in );
+    in >> m_lastCurrent >> m_gateV >> m_Vs >> m_Sfollow >> m_converged;
+}
+
 void eMosfet::setVChanged()
 {
     double Vgs;
@@ -34,6 +34,9 @@ class MAINMODULE_EXPORT eMosfet : public eResistor
         virtual void initialize();
         virtual void resetState();
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
         virtual bool pChannel();
         virtual void setPchannel( bool pc );
@@ -64,6 +64,16 @@ void eMuxAnalog::initialize()
     m_enabled = false;
 }
 
+void eMuxAnalog::saveState( QDataStream &out )
+{
+    out << m_address << m_enabled;
+}
+
+void eMuxAnalog::loadState( QDataStream &in )
+{
+    in >> m_address >> m_enabled;
+}
+
 void eMuxAnalog::setVChanged()
 {
     bool enabled = m_enablePin->getVolt() < 2.5;
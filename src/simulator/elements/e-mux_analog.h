@@ -34,6 +34,9 @@ class MAINMODULE_EXPORT eMuxAnalog : public eElement
 
         virtual void initialize();
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
         double resist();
         void setResist( double r );
@@ -54,6 +54,16 @@ void eOpAmp::resetState()
     m_converged = true;
 }
 
+void eOpAmp::saveState( QDataStream &out )
+{
+    out << m_converged << m_lastOut << m_lastIn << m_voltPos << m_voltNeg;
+}
+
+void eOpAmp::loadState( QDataStream &in )
+{
+    in >> m_converged >> m_lastOut >> m_lastIn >> m_voltPos >> m_voltNeg;
+}
+
 void eOpAmp::setVChanged() // Called when input pins nodes change volt
 {
     if( m_powerPins )
@@ -34,6 +34,9 @@ class MAINMODULE_EXPORT eOpAmp : public eElement
         virtual void initialize();
         virtual void resetState();
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
         virtual double gain();
         virtual void setGain( double gain );
@@ -17,16 +17,23 @@
  *                                                                         *
  ***************************************************************************/
 
-#include <QDebug>
 #include <math.h>   // fabs(x,y)
 
 #include "e-pn.h"
 #include "simulator.h"
 
+static const double thermal_volt = 0.025865;   // kT/q at 27 ºC
+static const double thr_current  = 1e-3;       // Current at threshold voltage
+static const double min_admit    = 1e-12;      // Below this junction is open
+
 ePN::ePN( std::string id ) 
    : eResistor(id )
 {
     m_threshold = 0.7;
+    m_imped     = 0.6;
+    m_accuracy  = 1e-6;
+
+    updateModel();
 }
 ePN::~ePN()
 { 
@@ -51,44 +58,118 @@ void ePN::initialize()
 
 void ePN::resetState()
 {
-    eResistor::setRes( 0.6 );
+    updateModel();
+
     m_accuracy = Simulator::self()->NLaccuracy();
+    m_resist  = m_imped;
+    m_admit   = 0;
     m_voltPN  = 0;
-    m_deltaV  = 0;
+    m_currPN  = 0;
     m_current = 0;
 }
 
+void ePN::saveState( QDataStream &out )
+{
+    eResistor::saveState( out );
+    out << m_voltPN << m_currPN;
+}
+
+void ePN::loadState( QDataStream &in )
+{
+    eResistor::loadState( in );
+    in >> m_voltPN >> m_currPN;
+}
+
+void ePN::updateModel()
+{
+    m_vt = thermal_volt;
+    m_satCur = thr_current/exp( m_threshold/m_vt );
+
+    m_vLin  = m_vt*log( m_vt/(m_imped*m_satCur) ); // Conductance = 1/m_imped
+    m_iLin  = m_satCur*(exp( m_vLin/m_vt )-1);
+    m_vCrit = m_vt*log( m_vt/(sqrt(2)*m_satCur) );
+}
+
 void ePN::setVChanged()
 {
-    m_voltPN = m_ePin[0]->getVolt()-m_ePin[1]->getVolt();
+    double voltPN = m_ePin[0]->getVolt()-m_ePin[1]->getVolt();
 
-    double deltaV = m_threshold;
+    if( isConverged( voltPN ) ) return;
 
-    if( m_voltPN < m_threshold ) 
-    {
-        eResistor::setAdmit( 0 );
-        m_ePin[0]->stampCurrent( 0 );
-        m_ePin[1]->stampCurrent( 0 );
-        m_deltaV = m_voltPN;
-        return;
-    }
-    if( m_admit != 1/m_resist ) eResistor::setAdmit( 1/m_resist );
+    stampJunction( limitVolt( voltPN, m_voltPN ) );
+}
+
+bool ePN::isConverged( double volt )
+{
+    if( fabs( volt-m_voltPN ) > m_accuracy ) return false;
 
-    //qDebug() <<"ePN::setVChanged,  deltaR: "<< deltaR << "  deltaV" << deltaV << "m_voltPN" << m_voltPN ;
+    // Current predicted by last linearization must match the model
+    double admit;
+    double current = junctionCurrent( volt, admit );
+    double linCurr = m_currPN+m_admit*(volt-m_voltPN);
+
+    return ( fabs( current-linCurr ) <= m_accuracy*(fabs( current )+thr_current) );
+}
 
-    if( fabs(deltaV-m_deltaV) < m_accuracy/10 ) return;
+void ePN::stampJunction( double volt )
+{
+    double admit;
+    m_voltPN = volt;
+    m_currPN = junctionCurrent( volt, admit );
 
-    m_deltaV = deltaV;
+    double current = admit*volt-m_currPN;      // Norton equivalent source
 
-    double current = deltaV/m_resist;
+    if( admit < min_admit )
+    {
+        admit   = 0;
+        current = 0;
+    }
+    if( admit != m_admit ) eResistor::setAdmit( admit );
 
     m_ePin[0]->stampCurrent( current );
     m_ePin[1]->stampCurrent(-current );
 }
 
+double ePN::junctionCurrent( double volt, double &admit )
+{
+    if( volt > m_vLin )
+    {
+        admit = 1/m_imped;
+        return m_iLin+(volt-m_vLin)*admit;
+    }
+    double expV = exp( volt/m_vt );
+    admit = m_satCur*expV/m_vt;
+
+    return m_satCur*(expV-1);
+}
+
+double ePN::limitVolt( double vnew, double vold )
+{
+    return pnjLimit( vnew, vold, m_vCrit, m_vLin );
+}
+
+double ePN::pnjLimit( double vnew, double vold, double vcrit, double vlin )
+{
+    // Limit junction voltage steps in the exponential region (as in Spice)
+    if( vnew <= vcrit )                  return vnew;
+    if( fabs( vnew-vold ) <= 2*m_vt )    return vnew;
+    if( (vnew > vlin)&&(vold > vlin) ) return vnew; // Linear region
+
+    if( vold > vcrit )
+    {
+        double arg = 1+(vnew-vold)/m_vt;
+        if( arg > 0 ) vnew = vold+m_vt*log( arg );
+        else          vnew = vcrit;
+    }
+    else vnew = vcrit+m_vt*log( 1+(vnew-vcrit)/m_vt );
+
+    return vnew;
+}
+
 void ePN::setThreshold( double threshold )
 {
     m_threshold = threshold;
+    updateModel();
 }
 
 void ePN::updateVI()
@@ -97,11 +178,9 @@ void ePN::updateVI()
 
     if( m_ePin[0]->isConnected() && m_ePin[1]->isConnected() )
     {
-        double volt = m_voltPN - m_deltaV;
-        if( volt>0 )
-        {
-            m_current = volt/m_resist;
-            //qDebug() << " current " <<m_current<<volt<<m_deltaV;
-        }
+        double admit;
+        double volt = m_ePin[0]->getVolt()-m_ePin[1]->getVolt();
+        m_current = junctionCurrent( volt, admit );
     }
 }
+
@@ -22,9 +22,14 @@
 
 #include "e-resistor.h"
 
+// PN junction solved by Newton-Raphson: I = Is*(exp(V/Vt)-1)
+// Is is calculated to get 1 mA at threshold voltage.
+// Above the point where conductance reaches 1/m_imped it becomes linear,
+// this way m_imped behaves like a series resistance.
 class MAINMODULE_EXPORT ePN : public eResistor
 {
     public:
+
         ePN(  std::string id );
         ~ePN();
 
@@ -33,15 +38,34 @@ class MAINMODULE_EXPORT ePN : public eResistor
 
         virtual void initialize();
         virtual void resetState();
-
         virtual void setVChanged();
 
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
+
+        virtual double junctionCurrent( double volt, double &admit );
+        virtual double limitVolt( double vnew, double vold );
+
     protected:
         virtual void updateVI();
+        virtual void updateModel();
 
-        double m_voltPN;
-        double m_deltaV;
+        bool isConverged( double volt );
+        void stampJunction( double volt );
+
+        double pnjLimit( double vnew, double vold, double vcrit, double vlin );
+
+        double m_voltPN;    // Voltage at last linearization point
+        double m_currPN;    // Current at last linearization point
         double m_threshold;
+        double m_imped;
         double m_accuracy;
+
+        double m_vt;        // Thermal voltage
+        double m_satCur;    // Saturation current
+        double m_vCrit;     // Above this voltage steps are limited
+        double m_vLin;      // Above this voltage junction is linear
+        double m_iLin;      // Current at m_vLin
 };
+
 #endif
@@ -51,6 +51,22 @@ void eRam8bit::resetState()
     eLogicDevice::resetState();
 }
 
+void eRam8bit::saveState( QDataStream &out )
+{
+    eLogicDevice::saveState( out );
+    for( int i=0; i<256; i++ ) out << m_ram[i];
+    for( int i=0; i<8; i++ )   out << m_dataPinState[i];
+    out << m_cs << m_oe;
+}
+
+void eRam8bit::loadState( QDataStream &in )
+{
+    eLogicDevice::loadState( in );
+    for( int i=0; i<256; i++ ) in >> m_ram[i];
+    for( int i=0; i<8; i++ )   in >> m_dataPinState[i];
+    in >> m_cs >> m_oe;
+}
+
 void eRam8bit::setVChanged()        // Some Pin Changed State, Manage it
 {
     bool CS = eLogicDevice::getInputState(9);
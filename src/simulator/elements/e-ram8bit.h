@@ -31,6 +31,9 @@ class MAINMODULE_EXPORT eRam8bit : public eLogicDevice
         virtual void initialize();
         virtual void resetState();
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
     private:
         int m_ram[256];
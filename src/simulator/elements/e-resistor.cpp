@@ -49,6 +49,16 @@ void eResistor::stamp()
     //qDebug() << "eResistor::stamp" << m_resist;
 }
 
+void eResistor::saveState( QDataStream &out )
+{
+    out << m_resist << m_admit << m_current;
+}
+
+void eResistor::loadState( QDataStream &in )
+{
+    in >> m_resist >> m_admit >> m_current;
+}
+
 double eResistor::res() 
 { 
     return m_resist; 
@@ -39,6 +39,9 @@ class MAINMODULE_EXPORT eResistor : public eElement
 
         virtual void initialize();
         virtual void stamp();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
         virtual void initEpins();
 
@@ -85,6 +85,22 @@ void eShiftReg::resetState()
     eLogicDevice::resetState();
 }
 
+void eShiftReg::saveState( QDataStream &out )
+{
+    eLogicDevice::saveState( out );
+    out << quint8( m_shiftReg.to_ulong() ) << quint8( m_latch.to_ulong() )
+        << m_latchClock << m_changed << m_reset;
+}
+
+void eShiftReg::loadState( QDataStream &in )
+{
+    eLogicDevice::loadState( in );
+    quint8 shiftReg, latch;
+    in >> shiftReg >> latch >> m_latchClock >> m_changed >> m_reset;
+    m_shiftReg = shiftReg;
+    m_latch = latch;
+}
+
 void eShiftReg::setVChanged()
 {
     eLogicDevice::updateOutEnabled();
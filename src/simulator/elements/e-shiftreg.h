@@ -34,6 +34,9 @@ class MAINMODULE_EXPORT eShiftReg : public eLogicDevice
         virtual void initialize();
         virtual void resetState();
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
         virtual ePin* getEpin( QString pinName );
 
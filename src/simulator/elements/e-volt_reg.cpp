@@ -50,6 +50,18 @@ void eVoltReg::resetState()
     m_lastOut = 0;
 }
 
+void eVoltReg::saveState( QDataStream &out )
+{
+    eResistor::saveState( out );
+    out << m_lastOut << m_voltPos << m_voltNeg;
+}
+
+void eVoltReg::loadState( QDataStream &in )
+{
+    eResistor::loadState( in );
+    in >> m_lastOut >> m_voltPos >> m_voltNeg;
+}
+
 void eVoltReg::setVChanged() 
 {
     double inVolt = m_ePin[0]->getVolt();
@@ -33,6 +33,9 @@ class MAINMODULE_EXPORT eVoltReg : public eResistor
         virtual void initialize();
         virtual void resetState();
         virtual void setVChanged();
+
+        virtual void saveState( QDataStream &out );
+        virtual void loadState( QDataStream &in );
         
         virtual double vRef()              {return m_vRef;}
         virtual void setVRef( double vref ){m_vRef = vref;}
@@ -26,6 +26,7 @@
 #include "sim_elf.h"
 #include "sim_hex.h"
 #include "sim_core.h"
+#include "sim_state.h"
 #include "avr_uart.h"
 
 //AvrProcessor* AvrProcessor::m_pSelf = 0l;
@@ -163,6 +164,10 @@ bool AvrProcessor::loadFirmware( QString fileN )
         }
         int started = avr_init( m_avrProcessor );
 
+        // The circuit drives the time: sleeping fast-forwards cycles
+        // up to the next timer or circuit step, never waits on the OS clock
+        m_avrProcessor->sleep = avr_callback_sleep_cosim;
+
         // Usart interface
             // Irq to send data to terminal panel
         avr_irq_t* src = avr_io_getirq(m_avrProcessor, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT);
@@ -214,7 +219,15 @@ void AvrProcessor::step()
             //qDebug() << "AvrProcessor::step() CRASHED!!!";
             break;
         }
-        else m_avrProcessor->run(m_avrProcessor);
+        // Let the core run blocks of instructions up to the next cycle timer,
+        // IO access or the end of this circuit step, timers and interrupts
+        // are only processed between blocks.
+        avr_cycle_count_t limit = m_nextCycle - m_avrProcessor->cycle;
+        m_avrProcessor->run_cycle_limit  = limit;
+        m_avrProcessor->run_cycle_target = m_avrProcessor->cycle + limit;
+        if( m_avrProcessor->run_cycle_count > limit ) m_avrProcessor->run_cycle_count = limit;
+
+        m_avrProcessor->run(m_avrProcessor);
     }
     m_nextCycle += m_mcuStepsPT;
     //qDebug() << "AvrProcessor::step"<<m_nextCycle<< m_avrProcessor->cycle;
@@ -224,11 +237,12 @@ void AvrProcessor::stepOne()
 {
     //qDebug() <<"AvrProcessor::stepOne()"<<m_avrProcessor->cycle << m_nextCycle;
 
+    singleStep();
     m_avrProcessor->run(m_avrProcessor);
 
     while( m_avrProcessor->cycle >= m_nextCycle )
     {
-        m_nextCycle += McuComponent::self()->freq(); //m_mcuStepsPT;
+        m_nextCycle += m_mcu->freq(); //m_mcuStepsPT;
         runSimuStep(); // 1 simu step = 1uS
     }
 }
@@ -239,7 +253,18 @@ void AvrProcessor::stepCpu()
     {
         //qDebug() << "AvrProcessor::step() CRASHED!!!";
     }
-    else m_avrProcessor->run(m_avrProcessor);
+    else
+    {
+        singleStep();
+        m_avrProcessor->run(m_avrProcessor);
+    }
+}
+
+void AvrProcessor::singleStep() // Debugger steps: one instruction per run()
+{
+    m_avrProcessor->run_cycle_limit  = 1;
+    m_avrProcessor->run_cycle_count  = 1;
+    m_avrProcessor->run_cycle_target = m_avrProcessor->cycle+1;
 }
 
 int AvrProcessor::pc()
@@ -247,6 +272,44 @@ int AvrProcessor::pc()
     return m_avrProcessor->pc;
 }
 
+void AvrProcessor::saveState( QDataStream &out )
+{
+    QByteArray core;
+    if( m_avrProcessor )
+    {
+        core.resize( avr_state_size( m_avrProcessor ) );
+        avr_state_save( m_avrProcessor, core.data() );
+    }
+    out << core;
+    BaseProcessor::saveState( out );
+}
+
+bool AvrProcessor::checkState( QDataStream &in )
+{
+    QByteArray core;
+    in >> core;
+
+    if( !core.isEmpty() )
+    {
+        if( !m_avrProcessor ) return false;
+        if( avr_state_check( m_avrProcessor, core.constData(), core.size() ) != 0 ) return false;
+    }
+    return BaseProcessor::checkState( in );
+}
+
+bool AvrProcessor::loadState( QDataStream &in )
+{
+    QByteArray core;
+    in >> core;
+
+    if( !core.isEmpty() )        // Fails if state is from other mcu or simavr build
+    {
+        if( !m_avrProcessor ) return false;
+        if( avr_state_restore( m_avrProcessor, core.constData(), core.size() ) != 0 ) return false;
+    }
+    return BaseProcessor::loadState( in );
+}
+
 int AvrProcessor::getRamValue( int address )
 {
     return m_avrProcessor->data[address];
@@ -46,6 +46,10 @@ class AvrProcessor : public BaseProcessor
         int pc();
 
         int getRamValue( int address );
+
+        void saveState( QDataStream &out );
+        bool checkState( QDataStream &in );
+        bool loadState( QDataStream &in );
         
         avr_t* getCpu() { return m_avrProcessor; }
         void setCpu( avr_t* avrProc ) { m_avrProcessor = avrProc; }
@@ -64,6 +68,8 @@ class AvrProcessor : public BaseProcessor
     private:
         virtual int  validate( int address );
 
+        void singleStep();
+
         //From simavr
         avr_t*     m_avrProcessor;
         avr_irq_t* m_uartInIrq;
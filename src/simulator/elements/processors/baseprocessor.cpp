@@ -17,8 +17,13 @@
  *                                                                         *
  ***************************************************************************/
 
+#include <chrono>
+#include <QCryptographicHash>
+#include <QFile>
+
 #include "baseprocessor.h"
 #include "mcucomponent.h"
+#include "mcucomponentpin.h"
 #include "circuitwidget.h"
 #include "mainwindow.h"
 #include "simulator.h"
@@ -27,9 +32,27 @@
 
 BaseProcessor* BaseProcessor::m_pSelf = 0l;
 
+static inline void threadWait( int &spins ) // Spin, then yield, then sleep
+{
+    spins++;
+    if     ( spins < 64 )    return;
+    else if( spins < 20000 ) std::this_thread::yield(); // Also if less cores than threads
+    else std::this_thread::sleep_for( std::chrono::microseconds( 50 ) );
+}
+
 BaseProcessor::BaseProcessor( QObject* parent )
              : QObject( parent )
 {
+    m_mcu      = 0l;
+    m_terminal = 0l;
+    m_thread   = 0l;
+    m_quantum  = 0;
+    m_threadRun  = false;
+    m_threadInit = true;
+    m_mcuStep  = 0;
+    m_circStep = 0;
+    m_threadStep = 0;
+    m_stepEvents.reserve( 64 );
     m_loadStatus = false;
     m_resetStatus = false;
     m_usartTerm  = false;
@@ -39,12 +62,16 @@ BaseProcessor::BaseProcessor( QObject* parent )
 }
 BaseProcessor::~BaseProcessor() 
 {
+    stopThread();
 }
 
 void BaseProcessor::terminate()
 {
     //qDebug() <<"\nBaseProcessor::terminate "<<m_device<<m_symbolFile<<"\n";
-    m_pSelf = 0l;
+    if( m_pSelf == this ) m_pSelf = 0l;
+    stopThread();
+    resetThread();
+    Simulator::self()->remFromMcuList( this );
     m_loadStatus = false;
     m_symbolFile = "";
 }
@@ -57,10 +84,296 @@ void BaseProcessor::initialized()
     m_loadStatus = true;
     m_nextCycle = m_mcuStepsPT;
     m_msimStep = 0;
+    resetThread();
+
+    Simulator::self()->addToMcuList( this );
+}
+
+void BaseProcessor::circuitStep( uint64_t step )
+{
+    if( m_quantum == 0 )                               // Run in circuit thread
+    {
+        this->step();
+        runStepEvents();
+        return;
+    }
+
+    if( !m_thread ) startThread( step );
+
+    // Events from circuit up to last step are in the queue: Mcu can run
+    // up to last step + quantum. Then wait for Mcu to reach this step.
+    int spins = 0;
+    while( !flushInEvents() ) { takeOutEvents(); threadWait( spins ); }
+    m_circStep.store( step-1, std::memory_order_release );
+
+    while( m_mcuStep.load( std::memory_order_acquire ) < step )
+    {
+        takeOutEvents();
+        threadWait( spins );
+    }
+    takeOutEvents();
+
+    while( !m_outPending.empty() && (m_outPending.front().step <= step) )
+    {
+        McuPinEvent ev = m_outPending.front();
+        m_outPending.pop_front();
+        runEvent( ev );
+    }
+}
+
+void BaseProcessor::startThread( uint64_t step )
+{
+    if( m_threadInit )                      // Mcu and circuit start together
+    {
+        m_threadInit = false;
+        m_threadStep = step-1;
+        m_mcuStep    = step-1;
+        m_circStep   = step-1;
+    }
+    // Pins keep the voltage seen by Mcu thread, start from current one
+    foreach( McuComponentPin* pin, m_mcu->getPinList() ) pin->syncMcuVolt();
+
+    m_threadRun = true;
+    m_thread = new std::thread( &BaseProcessor::runThread, this );
+}
+
+void BaseProcessor::stopThread()
+{
+    if( !m_thread ) return;
+
+    m_threadRun = false;
+    m_thread->join();
+    delete m_thread;
+    m_thread = 0l;
+}
+
+void BaseProcessor::resetThread()
+{
+    m_threadInit = true;
+    m_outEvents.clear();
+    m_inEvents.clear();
+    m_outPending.clear();
+    m_inPending.clear();
+    m_outBacklog.clear();
+    m_inBacklog.clear();
+    m_stepEvents.clear();
+}
+
+void BaseProcessor::runThread()
+{
+    int spins = 0;
+    
+    while( m_threadRun.load( std::memory_order_relaxed ) )
+    {
+        // Publish last step when all its events are in the queue
+        if( !flushOutEvents() ) { takeInEvents(); threadWait( spins ); continue; }
+        m_mcuStep.store( m_threadStep, std::memory_order_release );
+
+        uint64_t step = m_threadStep+1;        // Don't get more than quantum ahead
+        if( m_circStep.load( std::memory_order_acquire )+m_quantum < step )
+        {
+            takeInEvents();
+            threadWait( spins );
+            continue;
+        }
+        spins = 0;
+        takeInEvents();
+        m_threadStep = step;
+
+        while( !m_inPending.empty() && (m_inPending.front().step+m_quantum <= step) )
+        {
+            McuPinEvent ev = m_inPending.front();
+            m_inPending.pop_front();
+            runEvent( ev );
+        }
+        this->step();
+    }
+}
+
+void BaseProcessor::takeOutEvents()
+{
+    McuPinEvent ev;
+    while( m_outEvents.pop( ev ) ) m_outPending.push_back( ev );
+}
+
+void BaseProcessor::takeInEvents()
+{
+    McuPinEvent ev;
+    while( m_inEvents.pop( ev ) ) m_inPending.push_back( ev );
+}
+
+bool BaseProcessor::flushOutEvents()
+{
+    while( !m_outBacklog.empty() )
+    {
+        if( !m_outEvents.push( m_outBacklog.front() ) ) return false;
+        m_outBacklog.pop_front();
+    }
+    return true;
+}
+
+bool BaseProcessor::flushInEvents()
+{
+    while( !m_inBacklog.empty() )
+    {
+        if( !m_inEvents.push( m_inBacklog.front() ) ) return false;
+        m_inBacklog.pop_front();
+    }
+    return true;
+}
+
+void BaseProcessor::pushOutEvent( McuComponentPin* pin, int type, uint32_t value )
+{
+    McuPinEvent ev = { m_threadStep, pin, type, value, 0 };
+
+    // Queue full: keep it until the step is published
+    if( !m_outBacklog.empty() || !m_outEvents.push( ev ) ) m_outBacklog.push_back( ev );
+}
+
+void BaseProcessor::pushInEvent( McuComponentPin* pin, double volt )
+{
+    McuPinEvent ev = { Simulator::self()->step(), pin, McuPinEvent::Input, 0, volt };
+
+    if( !m_inBacklog.empty() || !m_inEvents.push( ev ) ) m_inBacklog.push_back( ev );
+}
+
+void BaseProcessor::addStepEvent( McuComponentPin* pin, int type, uint32_t value )
+{
+    McuPinEvent ev = { Simulator::self()->step(), pin, type, value, 0 };
+    m_stepEvents.push_back( ev );
+}
+
+void BaseProcessor::runStepEvents()
+{
+    if( m_stepEvents.empty() ) return;
+
+    // Same order as they happened, matrix is solved at end of circuit step
+    for( size_t i=0; i<m_stepEvents.size(); i++ ) runEvent( m_stepEvents[i] );
+    m_stepEvents.clear();
+}
+
+void BaseProcessor::saveState( QDataStream &out )
+{
+    takeOutEvents();              // Thread stopped: all events to the deques
+    takeInEvents();
+
+    std::deque<McuPinEvent> outEvents( m_outPending );
+    outEvents.insert( outEvents.end(), m_outBacklog.begin(), m_outBacklog.end() );
+    std::deque<McuPinEvent> inEvents( m_inPending );
+    inEvents.insert( inEvents.end(), m_inBacklog.begin(), m_inBacklog.end() );
+    std::deque<McuPinEvent> stepEvents( m_stepEvents.begin(), m_stepEvents.end() );
+
+    out << m_threadInit << quint64( m_threadStep )
+        << quint64( m_mcuStep.load() ) << quint64( m_circStep.load() )
+        << m_nextCycle << qint32( m_msimStep ) << m_resetStatus;
+
+    saveEvents( out, outEvents );
+    saveEvents( out, inEvents );
+    saveEvents( out, stepEvents );
+}
+
+bool BaseProcessor::checkState( QDataStream &in )
+{
+    bool    flag;
+    quint64 step;
+    double  nextCycle;
+    qint32  msimStep;
+
+    in >> flag >> step >> step >> step >> nextCycle >> msimStep >> flag;
+
+    std::deque<McuPinEvent> events;
+    return loadEvents( in, events )
+        && loadEvents( in, events )
+        && loadEvents( in, events );
+}
+
+bool BaseProcessor::loadState( QDataStream &in )
+{
+    bool threadInit, resetStatus;
+    quint64 threadStep, mcuStep, circStep;
+    double  nextCycle;
+    qint32  msimStep;
+
+    in >> threadInit >> threadStep >> mcuStep >> circStep
+       >> nextCycle >> msimStep >> resetStatus;
+
+    std::deque<McuPinEvent> outEvents, inEvents, stepEvents;
+    if( !loadEvents( in, outEvents )
+     || !loadEvents( in, inEvents )
+     || !loadEvents( in, stepEvents ) ) return false;
+
+    resetThread();
+    m_threadInit  = threadInit;
+    m_threadStep  = threadStep;
+    m_mcuStep     = mcuStep;
+    m_circStep    = circStep;
+    m_nextCycle   = nextCycle;
+    m_msimStep    = msimStep;
+    m_resetStatus = resetStatus;
+
+    m_outPending = outEvents;
+    m_inPending  = inEvents;
+    m_stepEvents.assign( stepEvents.begin(), stepEvents.end() );
+
+    return true;
+}
+
+QByteArray BaseProcessor::firmwareHash()
+{
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    hash.addData( m_device.toUtf8() );
+
+    QFile file( m_symbolFile );
+    if( file.open( QFile::ReadOnly ) ) hash.addData( file.readAll() );
+
+    return hash.result();
+}
+
+void BaseProcessor::saveEvents( QDataStream &out, std::deque<McuPinEvent> &events )
+{
+    QList<McuComponentPin*> pins = m_mcu->getPinList();
+
+    out << qint32( events.size() );
+    for( McuPinEvent &ev : events )
+        out << quint64( ev.step ) << qint32( pins.indexOf( ev.pin ) )
+            << qint32( ev.type ) << quint32( ev.value ) << ev.volt;
+}
+
+bool BaseProcessor::loadEvents( QDataStream &in, std::deque<McuPinEvent> &events )
+{
+    QList<McuComponentPin*> pins = m_mcu->getPinList();
+
+    qint32 size = 0;
+    in >> size;
+    for( int i=0; i<size; i++ )
+    {
+        quint64 step;
+        qint32  pin, type;
+        quint32 value;
+        double  volt;
+        in >> step >> pin >> type >> value >> volt;
+
+        if( (in.status() != QDataStream::Ok) || (pin >= pins.size()) ) return false;
+
+        McuPinEvent ev = { step, (pin < 0) ? 0l : pins.at( pin ), type, value, volt };
+        events.push_back( ev );
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+void BaseProcessor::runEvent( McuPinEvent &ev )
+{
+    if( ev.pin ) ev.pin->runPinEvent( ev );
+    else if( ev.type == McuPinEvent::Uart ) uartToTerm( ev.value );
+    else if( ev.type == McuPinEvent::Reset )
+    {
+        foreach( McuComponentPin* pin, m_mcu->getPinList() ) pin->resetOutput();
+    }
 }
 
 void BaseProcessor::runSimuStep()
 {
+    runStepEvents();
     Simulator::self()->runCircuitStep();
     
     m_msimStep++;
@@ -69,7 +382,6 @@ void BaseProcessor::runSimuStep()
         m_msimStep = 0;
         
         Simulator::self()->runGraphicStep();
-        PlotterWidget::self()->step();
     }
 }
 
@@ -91,7 +403,14 @@ void BaseProcessor::hardReset( bool rst )
 {
     m_resetStatus = rst;
     
-    if( rst ) McuComponent::self()->reset();
+    if( !rst ) return;
+    
+    if( isThreaded() )        // Mcu thread: pins are reset in circuit thread
+    {
+        reset();
+        pushOutEvent( 0l, McuPinEvent::Reset, 0 );
+    }
+    else if( m_mcu ) m_mcu->reset();
 }
 
 int BaseProcessor::getRegAddress( QString name ) 
@@ -260,13 +579,37 @@ void BaseProcessor::setRegisters() // get register addresses from data file
     }
 }
 
+void BaseProcessor::setUsart( bool usart )
+{
+    m_usartTerm = usart;
+    
+    if( usart ) 
+    {
+        QString name = m_mcu ? m_mcu->itemID() : m_device;
+        m_terminal = CircuitWidget::self()->openTerminal( this, name );
+    }
+    else if( m_terminal )
+    {
+        CircuitWidget::self()->closeTerminal( this );
+        m_terminal = 0l;
+    }
+}
+
 void BaseProcessor::uartOut( uint32_t value ) // Send value to OutPanelText
+{
+    if( isThreaded() ) pushOutEvent( 0l, McuPinEvent::Uart, value );
+    else               uartToTerm( value );
+}
+
+void BaseProcessor::uartToTerm( uint32_t value )
 {
     //qDebug()<<"BaseProcessor::uartOut" << value;
-    if( m_usartTerm )
+    emit uartDataOut( value );
+
+    if( m_usartTerm && m_terminal )
     {
         if( value != 13 ) // '\r'
-            TerminalWidget::self()->uartOut( value );
+            m_terminal->uartOut( value );
     }
     if( m_serialPort )
     {
@@ -281,9 +624,9 @@ void BaseProcessor::uartOut( uint32_t value ) // Send value to OutPanelText
 void BaseProcessor::uartIn( uint32_t value ) // Receive one byte on Uart
 {
     //qDebug()<<"BaseProcessor::uartIn" << value;
-    if( m_usartTerm )
+    if( m_usartTerm && m_terminal )
     {
-        TerminalWidget::self()->uartIn( value );
+        m_terminal->uartIn( value );
     }
 }
 
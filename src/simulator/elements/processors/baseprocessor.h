@@ -20,8 +20,29 @@
 #ifndef PROCESSOR_H
 #define PROCESSOR_H
 
+#include <thread>
+#include <deque>
+#include <vector>
+
 #include "terminalwidget.h"
+#include "spscqueue.h"
+
+class McuComponent;
+class McuComponentPin;
 
+// Pin event passed between the circuit and Mcu threads.
+// Events from Mcu are run in circuit thread at their step, events from
+// circuit are run in Mcu thread m_quantum steps after they happened.
+struct McuPinEvent
+{
+    enum Type { Output=0, Direction, Pullup, Input, Uart, Reset };
+
+    uint64_t step;           // Circuit step when it happened
+    McuComponentPin* pin;    // 0 for processor events: Uart, Reset
+    int      type;
+    uint32_t value;
+    double   volt;
+};
 
 class MAINMODULE_EXPORT BaseProcessor : public QObject
 {
@@ -34,6 +55,9 @@ class MAINMODULE_EXPORT BaseProcessor : public QObject
  
         QString getFileName();
 
+        McuComponent* mcu() { return m_mcu; }
+        void setMcu( McuComponent* mcu ) { m_mcu = mcu; }
+
         virtual void    setDevice( QString device );
         virtual QString getDevice();
         
@@ -43,6 +67,32 @@ class MAINMODULE_EXPORT BaseProcessor : public QObject
         virtual bool getLoadStatus() { return m_loadStatus; }
         virtual void terminate();
 
+        // Threaded Mcu: core runs in its own thread up to quantum steps
+        // ahead of the circuit, pin events are exchanged through queues.
+        void setQuantum( int quantum ) { m_quantum = quantum; }
+        bool isThreaded() { return m_threadRun.load( std::memory_order_relaxed ); }
+        void circuitStep( uint64_t step ); // Run (or wait for) Mcu up to this step
+        void stopThread();                 // Join Mcu thread, keep pending events
+        void resetThread();                // Discard pending events
+
+        void pushOutEvent( McuComponentPin* pin, int type, uint32_t value ); // Mcu thread
+        void pushInEvent( McuComponentPin* pin, double volt );              // Circuit thread
+
+        // Not threaded: pin changes are kept until the end of the Mcu step,
+        // then all stamped at once so circuit is solved only once per step.
+        void addStepEvent( McuComponentPin* pin, int type, uint32_t value );
+        void runStepEvents();
+
+        // Snapshot of core and pending events (see Simulator::saveState),
+        // Mcu thread must be stopped. loadState fails if state is not ours,
+        // checkState tells it before loading without changing anything.
+        virtual void saveState( QDataStream &out );
+        virtual bool checkState( QDataStream &in );
+        virtual bool loadState( QDataStream &in );
+
+        // Identifies the firmware loaded, states are only valid for it
+        virtual QByteArray firmwareHash();
+
         virtual void setSteps( double steps );
         virtual void step()=0;
         virtual void stepOne()=0;
@@ -57,7 +107,7 @@ class MAINMODULE_EXPORT BaseProcessor : public QObject
         virtual void addWatchVar( QString name, int address, QString type );
         virtual void updateRamValue( QString name );
         
-        virtual void setUsart( bool usart ) { m_usartTerm = usart; }
+        virtual void setUsart( bool usart );
         virtual void setSerPort( bool serport ) { m_serialPort = serport; }
         virtual void uartOut( uint32_t value );
         virtual void uartIn( uint32_t value );
@@ -66,14 +116,49 @@ class MAINMODULE_EXPORT BaseProcessor : public QObject
         virtual QStringList getRegList() { return m_regList; }
         
         virtual void setRegisters();
+
+    signals:
+        void uartDataOut( uint32_t value );
     
     protected:
  static BaseProcessor* m_pSelf;
+
+        McuComponent*   m_mcu;        // Component owning this processor
+        TerminalWidget* m_terminal;   // Serial Monitor attached to this processor
         
         virtual int  validate( int address )=0;
         
         void runSimuStep();
 
+        void startThread( uint64_t step );
+        void runThread();
+        void takeOutEvents();
+        void takeInEvents();
+        bool flushOutEvents();
+        bool flushInEvents();
+        void runEvent( McuPinEvent &ev );
+        void saveEvents( QDataStream &out, std::deque<McuPinEvent> &events );
+        bool loadEvents( QDataStream &in, std::deque<McuPinEvent> &events );
+        void uartToTerm( uint32_t value );
+
+        int m_quantum;                       // Max steps Mcu runs ahead, 0 = no thread
+        bool m_threadInit;
+
+        std::thread* m_thread;
+        std::atomic<bool>     m_threadRun;
+        std::atomic<uint64_t> m_mcuStep;    // Last step published by Mcu
+        std::atomic<uint64_t> m_circStep;   // Last step done by circuit
+        uint64_t m_threadStep;              // Last step run in Mcu thread
+
+        SpscQueue<McuPinEvent> m_outEvents;   // Mcu -> circuit
+        SpscQueue<McuPinEvent> m_inEvents;    // circuit -> Mcu
+        std::deque<McuPinEvent> m_outPending; // Taken from queue, not run yet
+        std::deque<McuPinEvent> m_inPending;
+        std::deque<McuPinEvent> m_outBacklog; // Queue was full, not sent yet
+        std::deque<McuPinEvent> m_inBacklog;
+
+        std::vector<McuPinEvent> m_stepEvents; // Pin changes in this step
+
         QString m_symbolFile;
         QString m_dataFile;
         QString m_device;
@@ -0,0 +1,176 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <algorithm>
+
+#include "eventwheel.h"
+#include "e-element.h"
+
+EventWheel::EventWheel()
+          : m_slots( m_size+1 )
+          , m_overflow( m_slots[m_overSlot] )
+{
+    m_time = 0;
+    m_overflowMin = UINT64_MAX;
+
+    for( int i=0; i<m_size/64; i++ ) m_bits[i] = 0;
+}
+EventWheel::~EventWheel(){}
+
+void EventWheel::clear( uint64_t time )
+{
+    for( int slot=0; slot<=m_size; slot++ )
+    {
+        for( eElement* el : m_slots[slot] )
+        {
+            el->m_eventTime = 0;
+            el->m_eventSlot = -1;
+        }
+        m_slots[slot].clear();
+    }
+    m_overflowMin = UINT64_MAX;
+
+    for( int i=0; i<m_size/64; i++ ) m_bits[i] = 0;
+
+    m_time = time;
+}
+
+void EventWheel::insert( int slot, eElement* el )
+{
+    std::vector<eElement*> &list = m_slots[slot];
+
+    el->m_eventSlot = slot;
+    el->m_eventPos  = list.size();
+    list.push_back( el );
+
+    if( slot < m_size ) m_bits[slot>>6] |= 1ULL << (slot&63);
+}
+
+void EventWheel::remove( eElement* el ) // Last entry of the list takes its place
+{
+    int slot = el->m_eventSlot;
+    el->m_eventSlot = -1;
+
+    if( slot == m_runSlot ) { m_running[el->m_eventPos] = 0l; return; }
+
+    std::vector<eElement*> &list = m_slots[slot];
+    eElement* last = list.back();
+
+    list[el->m_eventPos] = last;
+    last->m_eventPos = el->m_eventPos;
+    list.pop_back();
+
+    if( list.empty() && (slot < m_size) ) m_bits[slot>>6] &= ~(1ULL << (slot&63));
+}
+
+void EventWheel::addEvent( uint64_t time, eElement* el )
+{
+    if( time <= m_time ) time = m_time+1;       // Can't schedule in the past
+    if( el->m_eventTime == time ) return;
+
+    if( el->m_eventSlot != -1 ) remove( el );
+    el->m_eventTime = time;
+
+    if( time-m_time < m_size ) insert( time & m_mask, el );
+    else
+    {
+        insert( m_overSlot, el );
+        if( time < m_overflowMin ) m_overflowMin = time;
+    }
+}
+
+void EventWheel::cancelEvent( eElement* el )
+{
+    if( el->m_eventTime == 0 ) return;
+    el->m_eventTime = 0;
+
+    if( el->m_eventSlot != -1 ) remove( el );  // m_overflowMin can be early, that's fine
+}
+
+void EventWheel::checkOverflow()   // Move to wheel events that are close enough
+{
+    if( m_overflowMin-m_time >= m_size ) return;
+
+    m_overflowMin = UINT64_MAX;
+
+    unsigned i = 0;
+    while( i<m_overflow.size() )
+    {
+        eElement* el = m_overflow[i];
+        uint64_t time = el->m_eventTime;
+
+        if( time-m_time < m_size )              // Its place is taken by last one
+        {
+            remove( el );
+            insert( time & m_mask, el );
+        }
+        else
+        {
+            if( time < m_overflowMin ) m_overflowMin = time;
+            i++;
+        }
+    }
+}
+
+void EventWheel::runEvents( uint64_t time )
+{
+    m_time = time;
+    checkOverflow();
+
+    int slot = time & m_mask;
+    uint64_t bit = 1ULL << (slot&63);
+
+    if( !(m_bits[slot>>6] & bit) ) return;
+    m_bits[slot>>6] &= ~bit;
+
+    // Events can add or cancel others: run them from a separate list
+    // New events never go to this slot
+    m_running.swap( m_slots[slot] );
+
+    for( unsigned i=0; i<m_running.size(); i++ ) m_running[i]->m_eventSlot = m_runSlot;
+
+    for( unsigned i=0; i<m_running.size(); i++ )
+    {
+        eElement* el = m_running[i];
+        if( !el ) continue;                      // Canceled or rescheduled
+
+        el->m_eventSlot = -1;
+        el->m_eventTime = 0;
+        el->runEvent();
+    }
+    m_running.clear();
+}
+
+uint64_t EventWheel::nextEvent()
+{
+    // Search set bits from next slot, words are searched from the bit position
+    // so wrapped bits found in the last word belong to already searched slots
+    for( int d=1; d<m_size; )
+    {
+        int slot = (m_time+d) & m_mask;
+        uint64_t word = m_bits[slot>>6] >> (slot&63);
+
+        if( word )
+        {
+            while( !(word & 1) ) { word >>= 1; d++; }
+            return std::min( m_time+d, m_overflowMin );
+        }
+        d += 64-(slot&63);
+    }
+    return m_overflowMin;
+}
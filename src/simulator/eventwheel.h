@@ -0,0 +1,74 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef EVENTWHEEL_H
+#define EVENTWHEEL_H
+
+#include <vector>
+#include <stdint.h>
+
+class eElement;
+
+// Timing wheel for events scheduled at a simulation step.
+//
+// Each eElement can have one pending event (eElement::m_eventTime), adding
+// a new one replaces it. Events closer than the wheel size are stored in
+// the slot of their step, others wait in an overflow list until they get
+// close enough. A bit per slot allows finding the next event quickly, so
+// the Simulator can skip steps where nothing happens.
+// Each eElement keeps its list and position (m_eventSlot, m_eventPos),
+// so events are removed without searching.
+
+class EventWheel
+{
+    public:
+        EventWheel();
+        ~EventWheel();
+
+        void clear( uint64_t time );
+
+        void addEvent( uint64_t time, eElement* el );
+        void cancelEvent( eElement* el );
+
+        void runEvents( uint64_t time );   // Run events scheduled at this step
+
+        uint64_t nextEvent();              // Step of next event or UINT64_MAX
+
+    private:
+        void checkOverflow();
+        void insert( int slot, eElement* el );
+        void remove( eElement* el );
+
+ static const int m_size = 1024;          // Power of 2
+ static const int m_mask = m_size-1;
+
+ static const int m_overSlot = m_size;    // eElement::m_eventSlot values
+ static const int m_runSlot  = -2;
+
+        std::vector<std::vector<eElement*>> m_slots; // Last one is overflow list
+        uint64_t m_bits[m_size/64];            // Slots with events
+
+        std::vector<eElement*>& m_overflow;    // Events beyond wheel size
+        uint64_t m_overflowMin;
+
+        std::vector<eElement*> m_running;      // Events being run, canceled ones are null
+
+        uint64_t m_time;                       // Current step
+};
+
+#endif
@@ -0,0 +1,88 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "plotsampler.h"
+#include "e-pin.h"
+
+PlotSampler::PlotSampler()
+           : m_queue( 1<<18 )
+{
+    m_period   = 1000;
+    m_nextStep = 1;
+    m_sample   = 0;
+    m_lost     = 0;
+}
+PlotSampler::~PlotSampler(){}
+
+void PlotSampler::addChannel( int channel )
+{
+    for( unsigned i=0; i<m_channels.size(); i++ )
+        if( m_channels[i].channel == channel ) return;
+
+    Channel ch;
+    ch.channel = channel;
+    ch.pin = 0l;
+    m_channels.push_back( ch );
+}
+
+void PlotSampler::remChannel( int channel )
+{
+    for( unsigned i=0; i<m_channels.size(); i++ )
+    {
+        if( m_channels[i].channel != channel ) continue;
+
+        m_channels.erase( m_channels.begin()+i );
+        return;
+    }
+}
+
+void PlotSampler::setPin( int channel, ePin* pin )
+{
+    for( unsigned i=0; i<m_channels.size(); i++ )
+        if( m_channels[i].channel == channel ) m_channels[i].pin = pin;
+}
+
+void PlotSampler::setPeriod( int steps )
+{
+    if( steps < 1 ) steps = 1;
+    m_period = steps;
+}
+
+void PlotSampler::reset( uint64_t step )
+{
+    m_nextStep = step+1;
+}
+
+void PlotSampler::sample( uint64_t step )
+{
+    m_nextStep = step+m_period;
+    m_sample++;
+
+    PlotSample s;
+    s.sample = m_sample;
+
+    for( unsigned i=0; i<m_channels.size(); i++ )
+    {
+        ePin* pin = m_channels[i].pin;
+
+        s.channel = m_channels[i].channel;
+        s.volt    = pin ? pin->getVolt() : 0;
+
+        if( !m_queue.push( s ) ) m_lost++;           // GUI is behind
+    }
+}
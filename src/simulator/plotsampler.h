@@ -0,0 +1,88 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PLOTSAMPLER_H
+#define PLOTSAMPLER_H
+
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+
+#include "spscqueue.h"
+
+class ePin;
+
+// Voltage of one Plotter channel at one sample
+struct PlotSample
+{
+    uint64_t sample;    // Sample number, same for all channels of one sample
+    int32_t  channel;
+    float    volt;
+};
+
+// Samples Plotter channels every period() circuit steps.
+//
+// Samples go to a lock-free queue that the GUI empties at each frame
+// while the circuit keeps running. The circuit thread never waits: if the
+// queue is full samples are dropped and counted in lost().
+//
+// Channels are added, removed or changed with the circuit thread stopped.
+
+class MAINMODULE_EXPORT PlotSampler
+{
+    public:
+        PlotSampler();
+        ~PlotSampler();
+
+        void addChannel( int channel );
+        void remChannel( int channel );
+        void setPin( int channel, ePin* pin ); // Null pin: 0 V
+
+        bool isActive() { return !m_channels.empty(); }
+
+        int  period() { return m_period; }
+        void setPeriod( int steps );       // Any thread, from next sample
+
+        void reset( uint64_t step );       // Next sample at step+1
+        uint64_t nextSample() { return m_nextStep; }
+
+        void step( uint64_t step ) { if( step >= m_nextStep ) sample( step ); }
+
+        bool pop( PlotSample &s ) { return m_queue.pop( s ); } // GUI thread
+        uint64_t lost() { return m_lost; }
+
+    private:
+        struct Channel
+        {
+            int   channel;
+            ePin* pin;
+        };
+
+        void sample( uint64_t step );
+
+        std::vector<Channel> m_channels;
+
+        SpscQueue<PlotSample> m_queue;
+
+        std::atomic<int> m_period;
+        uint64_t m_nextStep;
+        uint64_t m_sample;
+        std::atomic<uint64_t> m_lost;
+};
+
+#endif
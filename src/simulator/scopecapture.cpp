@@ -0,0 +1,122 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <math.h>
+
+#include "scopecapture.h"
+#include "e-pin.h"
+
+ScopeCapture::ScopeCapture()
+{
+    m_mask = (1ull<<depthBits)-1;
+    reset( 0 );
+}
+ScopeCapture::~ScopeCapture()
+{
+    for( unsigned i=0; i<m_channels.size(); i++ ) delete m_channels[i];
+}
+
+ScopeChannel* ScopeCapture::addChannel( ePin* pinP, ePin* pinN )
+{
+    ScopeChannel* ch = new ScopeChannel;
+    ch->pinP = pinP;
+    ch->pinN = pinN;
+    ch->data.assign( m_mask+1, 0 );
+    ch->last = 0;
+    m_channels.push_back( ch );
+
+    return ch;
+}
+
+void ScopeCapture::remChannel( ScopeChannel* ch )
+{
+    for( unsigned i=0; i<m_channels.size(); i++ )
+    {
+        if( m_channels[i] != ch ) continue;
+
+        m_channels.erase( m_channels.begin()+i );
+        delete ch;
+        return;
+    }
+}
+
+void ScopeCapture::reset( uint64_t step )
+{
+    m_first = step+1;
+    m_last  = step;
+    for( unsigned i=0; i<m_channels.size(); i++ ) m_channels[i]->last = 0;
+}
+
+void ScopeCapture::step( uint64_t step )
+{
+    if( m_channels.empty() ) return;
+
+    uint64_t from = m_last+1;                  // First step not stored yet
+    if( step-from > m_mask ) from = step-m_mask;
+
+    for( unsigned i=0; i<m_channels.size(); i++ )
+    {
+        ScopeChannel* ch = m_channels[i];
+        float* data = ch->data.data();
+
+        for( uint64_t s=from; s<step; s++ ) data[s & m_mask] = ch->last; // Skipped steps
+
+        double volt = ch->pinP->getVolt();
+        if( ch->pinN ) volt -= ch->pinN->getVolt();
+
+        ch->last = volt;
+        data[step & m_mask] = ch->last;
+    }
+    m_last = step;
+    if( m_last-m_first > m_mask ) m_first = m_last-m_mask;
+}
+
+void ScopeCapture::minMax( ScopeChannel* ch, double start, double stepsPerCol
+                         , int cols, float* min, float* max )
+{
+    const float* data = ch->data.data();
+
+    for( int c=0; c<cols; c++ )
+    {
+        double b = floor( start+c*stepsPerCol );
+        double e = floor( start+(c+1)*stepsPerCol );
+        if( e <= b ) e = b+1;                       // At least one sample
+
+        if( b < (double)m_first )  b = m_first;
+        if( e > (double)m_last+1 ) e = (double)m_last+1;
+
+        if( b >= e )                               // Nothing held here
+        {
+            min[c] = 1;
+            max[c] = 0;
+            continue;
+        }
+        uint64_t s   = b;
+        uint64_t end = e;
+        float mn = data[s & m_mask];
+        float mx = mn;
+        for( s++; s<end; s++ )
+        {
+            float v = data[s & m_mask];
+            if     ( v < mn ) mn = v;
+            else if( v > mx ) mx = v;
+        }
+        min[c] = mn;
+        max[c] = mx;
+    }
+}
@@ -0,0 +1,83 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SCOPECAPTURE_H
+#define SCOPECAPTURE_H
+
+#include <vector>
+#include <stdint.h>
+
+class ePin;
+
+// Voltage between two pins, one value per circuit step in a ring buffer
+struct ScopeChannel
+{
+    ePin* pinP;
+    ePin* pinN;               // Can be null: voltage to ground
+
+    std::vector<float> data;  // Ring, index is step & mask
+    float last;
+};
+
+// Sampling service shared by all Oscopes.
+//
+// All channels are sampled at the end of each circuit step: one store per
+// channel. Steps skipped by the Simulator (nothing changed) are filled
+// with the last value at next sample, so captures don't prevent skipping.
+// All channels share the same time base: steps firstStep() to lastStep().
+//
+// Readers work with the circuit thread stopped (updateStep), channels are
+// added or removed with simulation paused.
+
+class MAINMODULE_EXPORT ScopeCapture
+{
+    public:
+        ScopeCapture();
+        ~ScopeCapture();
+
+        static const int depthBits = 21;        // 2M samples (~2 s)
+
+        ScopeChannel* addChannel( ePin* pinP, ePin* pinN=0l );
+        void remChannel( ScopeChannel* ch );
+
+        bool isActive() { return !m_channels.empty(); }
+        uint64_t depth() { return m_mask+1; }
+
+        void reset( uint64_t step );   // Empty all channels, next sample is step+1
+        void step( uint64_t step );    // Circuit thread: sample all channels
+
+        // Steps held are firstStep() to lastStep(), empty if first > last
+        uint64_t firstStep() { return m_first; }
+        uint64_t lastStep()  { return m_last; }
+
+        float sample( ScopeChannel* ch, uint64_t step ) { return ch->data[step & m_mask]; }
+
+        // Min and max of each column, column c is steps from start+c*stepsPerCol
+        // Columns out of held steps get min > max
+        void minMax( ScopeChannel* ch, double start, double stepsPerCol
+                   , int cols, float* min, float* max );
+
+    private:
+        std::vector<ScopeChannel*> m_channels;
+
+        uint64_t m_mask;
+        uint64_t m_first;
+        uint64_t m_last;
+};
+
+#endif
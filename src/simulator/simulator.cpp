@@ -18,6 +18,8 @@
  ***************************************************************************/
 
 #include <iostream>
+#include <QCryptographicHash>
+#include <QFile>
 
 #include "simulator.h"
 #include "circuit.h"
@@ -35,12 +37,18 @@ Simulator* Simulator::m_pSelf = 0l;
 
 Simulator::Simulator( QObject* parent ) 
          : QObject(parent)
+         , m_eChangedNodeList( &eNode::m_changedStamp )
+         , m_changedFast( &eElement::m_fastStamp )
+         , m_reactiveList( &eElement::m_reacStamp )
+         , m_nonLinear( &eElement::m_noLinStamp )
 {
     m_pSelf = this;
 
     m_isrunning = false;
     m_debugging = false;
     m_paused    = false;
+    m_batch     = false;
+    m_error     = false;
 
     m_step       = 0;
     m_numEnodes  = 0;
@@ -52,18 +60,130 @@ Simulator::Simulator( QObject* parent )
     m_stepsPrea  = 50;
     m_stepsNolin = 10;
     m_simuRate   = 1000000;
+    m_mcuQuantum = 0;
     m_noLinAcc = 5; // Non-Linear accuracy
+    m_maxNoLinIter = 200;
+    m_noLinMaxIter = 0;
+    m_noLinSolves  = 0;
+    m_noLinIters   = 0;
+    m_noLinFails   = 0;
+
+    m_adaptStep    = false;
+    m_reacMaxMult  = 64;
+    m_reacStep     = m_stepsPrea;
+    m_reacHint     = m_stepsPrea;
+    m_reacTickStep = 0;
+    m_reacLastTick = 0;
+    m_reacPoint    = 0;
+    m_reacTarget   = 0;
+    m_reacActivity = false;
+    m_reacRestart  = false;
+    m_reacReject   = false;
+    m_reacRedo     = false;
 
     m_RefTimer.start();
 }
 Simulator::~Simulator()
 {
     m_CircuitFuture.waitForFinished();
+    stopMcuThreads( false );
+    m_recorder.stop();
+}
+
+inline void Simulator::runList( DirtyList<eElement> &list )
+{
+    // Elements added while running are discarded by clear(), as before
+    int n = list.size();
+    for( int i=0; i<n; i++ ) list.at(i)->setVChanged();
+    list.clear();
+}
+
+void Simulator::updateReacStep()   // Choose next step of Reactive elements
+{
+    int maxStep = m_stepsPrea*m_reacMaxMult;
+    int step;
+
+    if( m_reacActivity ) step = m_stepsPrea;   // Fast changes: keep minimum step
+    else
+    {
+        step = m_reacStep*2;                     // Grow as allowed by element errors
+        if( step > m_reacHint ) step = m_reacHint;
+    }
+    if     ( step < m_stepsPrea ) step = m_stepsPrea;
+    else if( step > maxStep )     step = maxStep;
+
+    m_reacStep     = step;
+    m_reacHint     = maxStep;
+    m_reacActivity = false;
+    m_reacLastTick = m_reacTickStep;
+    m_reacTickStep = m_step;
+}
+
+void Simulator::cutReacStep() // Fast changes in a long step: end it now, restart with minimum step
+{
+    m_reacRestart  = true;
+    m_reacStep     = m_stepsPrea;
+    m_reacHint     = m_stepsPrea*m_reacMaxMult;
+    m_reacCounter  = 0;
+    m_reacLastTick = m_reacTickStep;
+    m_reacTickStep = m_step;
+
+    m_reacPoint = m_step;
+    runList( m_reactiveList );
+    m_reacRestart = false;
+
+    endReacStep();
+}
+
+void Simulator::reacDone( eElement* el, bool reject )
+{
+    m_reacStepList.append( el );
+    if( reject ) m_reacReject = true;
+}
+
+void Simulator::endReacStep() // All Reactive elements accept or reject the step together
+{
+    while( !m_reacStepList.isEmpty() )
+    {
+        QList<eElement*> stepList = m_reacStepList;
+        m_reacStepList.clear();
+
+        if( m_reacReject && !m_reacRedo && (m_step-m_reacLastTick >= 2) )
+        {                          // Integrate first half again from saved history
+            m_reacRedo   = true;
+            m_reacTarget = m_step-(m_step-m_reacLastTick)/2;
+            foreach( eElement* el, stepList ) el->reacReject();
+            m_reacPoint  = m_reacTarget;
+        }
+        else
+        {
+            bool last = (m_reacPoint == m_step);
+            m_reacTarget = last ? m_step+m_reacStep : m_step;  // Next step or the rest of this one
+            foreach( eElement* el, stepList ) el->reacAccept();
+            if( last ) break;
+            m_reacPoint = m_step;
+        }
+        m_reacReject = false;
+
+        solveMatrix();
+        if( m_error ) break;
+
+        foreach( eElement* el, stepList ) el->setVChanged();
+    }
+    m_reacStepList.clear();
+    m_reacReject = false;
+    m_reacRedo   = false;
+}
+
+void Simulator::reacStepHint( int steps )
+{
+    if( steps < m_reacHint ) m_reacHint = steps;
 }
 
 inline void Simulator::solveMatrix()
 {
-    foreach( eNode* node,  m_eChangedNodeList ) node->stampMatrix();
+    int n = m_eChangedNodeList.size();
+    for( int i=0; i<n; i++ ) m_eChangedNodeList.at(i)->stampMatrix();
     m_eChangedNodeList.clear();
 
     if( !m_matrix.solveMatrix() )                // Try to solve matrix,
@@ -102,86 +222,160 @@ void Simulator::timerEvent( QTimerEvent* e )  //update at m_timerTick rate (50 m
         m_lastStep    = m_step;
         m_lastRefTime = refTime;
     }
-    runGraphicStep();
+    publishState();
     
     // Run Circuit in parallel thread
     m_CircuitFuture = QtConcurrent::run( this, &Simulator::runCircuit ); // Run Circuit in a parallel thread
+
+    renderGraphics();     // GUI works on published state while Circuit runs
 }
 
 void Simulator::runCircuit()
 {
-    for( int i=0; i<m_circuitRate; i++ )
+    runSteps( m_circuitRate );
+}
+
+void Simulator::runSteps( int steps )
+{
+    for( int i=0; i<steps; i++ )
     {
         if( !m_isrunning ) return;
         
         runCircuitStep();
+        skipIdleSteps( i, steps );
     }
 }
 
-void Simulator::runCircuitStep()
+inline void Simulator::skipIdleSteps( int &i, int steps )
 {
-    m_step ++;
-    
-    // Run Plotter
-    if( ++m_updtCounter >= m_circuitRate )
+    // Nothing pending until next event: jump to the step before it
+    if( !m_eChangedNodeList.isEmpty() || !m_changedFast.isEmpty() ) return;
+    if( !m_nonLinear.isEmpty() ) return;
+    if( !m_simuClock.isEmpty() ) return;
+    if( !m_mcuList.isEmpty() && !m_debugging ) return;
+
+    int maxSkip = steps-1-i;                             // End of this circuit run
+    if( !m_batch && m_plotSampler.isActive() )
+    {
+        int64_t toPlot = (int64_t)(m_plotSampler.nextSample()-m_step)-1; // Keep Plotter samples
+        if( maxSkip > toPlot ) maxSkip = toPlot;
+    }
+
+    if( !m_reactiveList.isEmpty() )                      // Stop before next Reactive step
     {
-        m_updtCounter = 0;
-        PlotterWidget::self()->step();
+        int toReac = m_reacStep-1-m_reacCounter;
+        if( maxSkip > toReac ) maxSkip = toReac;
     }
+    if( maxSkip <= 0 ) return;
+
+    uint64_t skip = m_events.nextEvent()-m_step-1;
+    if( skip > (uint64_t)maxSkip ) skip = maxSkip;
+    if( skip == 0 ) return;
+
+    m_step += skip;
+    i += skip;
+    m_reacCounter  = (m_reacCounter+skip) % m_reacStep;
+    m_noLinCounter = (m_noLinCounter+skip) % m_stepsNolin;
+}
+
+void Simulator::runCircuitStep()
+{
+    m_step ++;
 
     // Run Reactive Elements
-    if( ++m_reacCounter >= m_stepsPrea )
+    if( ++m_reacCounter >= m_reacStep )
     {
         m_reacCounter = 0;
-        foreach( eElement* el, m_reactiveList ) el->setVChanged();
-        m_reactiveList.clear();
+        if( m_adaptStep ) updateReacStep();
+        m_reacPoint = m_step;
+        runList( m_reactiveList );
+        if( m_adaptStep ) endReacStep();
     }
 
     // Run Sinchronized to Simulation Clock elements
     foreach( eElement* el, m_simuClock ) el->simuClockStep();
 
-    // Run Fast elements
-    foreach( eElement* el, m_changedFast ) el->setVChanged();
-    m_changedFast.clear();
+    // Run Fast elements, logic outputs are scheduled as events
+    runList( m_changedFast );
+
+    // Run events of this step, including logic outputs without delay
+    m_events.runEvents( m_step );
 
-    if( BaseProcessor::self() && !m_debugging ) BaseProcessor::self()->step();
+    // Run Mcus, each one up to the end of this step
+    if( !m_debugging ) 
+        for( int i=0; i<m_mcuList.size(); i++ ) m_mcuList.at(i)->circuitStep( m_step );
 
-    // Run Non-Linear elements
+    // Circuit changed by non reactive elements: reactive step must be reduced
+    if( m_adaptStep && !m_eChangedNodeList.isEmpty() && (m_step != m_reacTickStep) )
+    {
+        if( m_reacStep > m_stepsPrea ) cutReacStep();
+        else                           m_reacActivity = true;
+    }
+
+    // Run Non-Linear elements: Newton-Raphson iterations,
+    // elements not converged restamp and are added again by their eNodes
     if( ++m_noLinCounter >= m_stepsNolin )
     {
         m_noLinCounter = 0;
-        int counter = 0;
+        int iter = 0;
         while( !m_nonLinear.isEmpty() ) // Run untill all converged
         {
-            foreach( eElement* el, m_nonLinear ) el->setVChanged();
-            m_nonLinear.clear();
+            runList( m_nonLinear );
+
+            if( !m_eChangedNodeList.isEmpty() ) solveMatrix();
 
-            if( !m_eChangedNodeList.isEmpty() ) 
-            { 
-                solveMatrix();
-                //if( !m_isrunning ) return;
+            if( ++iter >= m_maxNoLinIter ) // Limit the number of loops
+            {
+                m_noLinFails++;
+                break;
             }
-            if( ++counter > 200 ) break; // Limit the number of loops
         }
-        //if( counter > 0 ) qDebug() << "\nSimulator::runCircuit  Non-Linear Solved in steps:"<<counter;
+        if( iter > 0 )
+        {
+            m_noLinSolves++;
+            m_noLinIters += iter;
+            if( iter > m_noLinMaxIter ) m_noLinMaxIter = iter;
+        }
     }
     if( !m_eChangedNodeList.isEmpty() ) 
     { 
         solveMatrix();
         if( !m_isrunning ) return;
     }
+    if( m_recorder.isRecording() ) m_recorder.step( m_step );
+    if( m_capture.isActive() )     m_capture.step( m_step );
+    if( m_plotSampler.isActive() && !m_batch ) m_plotSampler.step( m_step );
 }
 
 void Simulator::runGraphicStep()
 {
     //qDebug() <<"Simulator::runGraphicStep";
+    publishState();
+    renderGraphics();
+}
+
+void Simulator::publishState() // Circuit thread stopped: GUI takes live state here
+{
     CircuitView::self()->setCircTime( m_step);
     
+    // Elements take user changes and copy what they paint
     foreach( eElement* el, m_updateList ) el->updateStep();
-    TerminalWidget::self()->step();
+    CircuitWidget::self()->publishTerminals();
+    
+    if( Circuit::self()->animate() ) publishVolts();
+}
+
+void Simulator::publishVolts()
+{
+    foreach( eNode* node, m_eNodeList ) node->m_dispVolt = node->m_volt;
+}
+
+void Simulator::renderGraphics() // Circuit may be running: use published state only
+{
+    CircuitWidget::self()->stepTerminals();
     PlotterWidget::self()->updateStep();
     
-    if( Circuit::self()->animate() ) Circuit::self()->update();
+    if( Circuit::self()->animate() ) Circuit::self()->animateStep();
 }
  
 void Simulator::runExtraStep()
@@ -193,8 +387,7 @@ void Simulator::runExtraStep()
     }
 
     // Run Fast elements
-    foreach( eElement* el, m_changedFast ) el->setVChanged();
-    m_changedFast.clear();
+    runList( m_changedFast );
 }
 
 void Simulator::runContinuous()
@@ -221,6 +414,8 @@ void Simulator::debug()
 
 void Simulator::startSim()
 {
+    m_events.clear( m_step );
+
     foreach( eNode* busNode, m_eNodeBusList ) busNode->initialize(); // Clear Buses
     foreach( eElement* el, m_elementList )    // Initialize all Elements
     {
@@ -254,10 +449,26 @@ void Simulator::startSim()
     std::cout << "\nCircuit Matrix looks good" <<  std::endl;
     if( !m_paused )
     {
+        m_capture.reset( m_step );
+        m_plotSampler.reset( m_step );
+
         m_lastStep    = 0;
         m_lastRefTime = 0;
         m_reacCounter  = 0;
         m_noLinCounter = 0;
+
+        m_noLinSolves  = 0;
+        m_noLinIters   = 0;
+        m_noLinMaxIter = 0;
+        m_noLinFails   = 0;
+
+        m_reacStep     = m_stepsPrea;
+        m_reacHint     = m_stepsPrea;
+        m_reacActivity = false;
+        m_reacRestart  = false;
+        m_reacReject   = false;
+        m_reacRedo     = false;
+        m_reacStepList.clear();
     }
     m_isrunning = true;
     m_paused = false;
@@ -277,9 +488,11 @@ void Simulator::stopSim()
     
     m_paused = false;
     m_isrunning = false;
-    m_step = 0;
     
     stopTimer();
+    stopMcuThreads( true );
+    m_recorder.stop();
+    m_step = 0;
 
     foreach( eNode* node,  m_eNodeList  )  node->setVolt( 0 );
     foreach( eElement* el, m_elementList )
@@ -289,11 +502,20 @@ void Simulator::stopSim()
     }
     foreach( eElement* el, m_updateList )  el->updateStep();
 
-    if( McuComponent::self() ) McuComponent::self()->reset();
+    foreach( BaseProcessor* proc, m_mcuList )
+        if( proc->mcu() ) proc->mcu()->reset();
 
     CircuitWidget::self()->setRate( 0 );
     Circuit::self()->update();
-    
+
+    if( m_noLinSolves > 0 )
+    {
+        std::cout << "\nNon-Linear Solves:      " << m_noLinSolves
+                  << "\nNon-Linear Iterations:  " << noLinAvgIter()
+                  << " avg, " << m_noLinMaxIter << " max"
+                  << "\nNon-Linear Unconverged: " << m_noLinFails
+                  << std::endl;
+    }
     std::cout << "\n    Simulation Stopped \n" << std::endl;
 }
 
@@ -305,6 +527,7 @@ void Simulator::pauseSim()
     m_paused = true;
     
     stopTimer();
+    stopMcuThreads( false );
     
     std::cout << "\n    Simulation Paused \n" << std::endl;
 }
@@ -338,6 +561,297 @@ void Simulator::resumeTimer()
     if( m_timerId == 0 ) m_timerId = this->startTimer( m_timerTick );
 }
 
+bool Simulator::startRecording( QString fileName )
+{
+    bool timer = (m_timerId != 0);
+    stopTimer();                            // Circuit thread not running now
+
+    bool ok = m_recorder.start( fileName, m_step );
+
+    if( timer ) resumeTimer();
+    return ok;
+}
+
+void Simulator::stopRecording()
+{
+    bool timer = (m_timerId != 0);
+    stopTimer();
+
+    m_recorder.stop();
+
+    if( timer ) resumeTimer();
+}
+
+static const quint32 stateMagic   = 0x51415353;  // "QASS"
+static const quint32 stateVersion = 4;
+
+template <class T> static void saveList( QDataStream &out, DirtyList<T> &list, QHash<T*, int> &index )
+{
+    out << qint32( list.size() );
+    for( int i=0; i<list.size(); i++ ) out << qint32( index.value( list.at(i), -1 ) );
+}
+
+static void loadList( QDataStream &in, QVector<qint32> &list )
+{
+    qint32 size = 0;
+    in >> size;
+    if( size < 0 ) size = 0;
+    for( int i=0; (i<size) && (in.status() == QDataStream::Ok); i++ )
+    {
+        qint32 index;
+        in >> index;
+        list.append( index );
+    }
+}
+
+QByteArray Simulator::circuitHash()    // Elements and how they are connected
+{
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+
+    foreach( eElement* el, m_elementList ) hash.addData( el->getId().c_str() );
+    foreach( eNode* node, m_eNodeList )
+    {
+        hash.addData( "\n" );
+        foreach( ePin* epin, node->m_ePinList ) hash.addData( epin->getId().c_str() );
+    }
+    return hash.result();
+}
+
+bool Simulator::saveState( QByteArray &state )
+{
+    if( !m_isrunning && !m_paused ) return false;
+
+    bool timer = (m_timerId != 0);
+    stopTimer();                            // Circuit thread not running now
+    stopMcuThreads( false );
+
+    QHash<eElement*, int> elIndex;
+    for( int i=0; i<m_elementList.size(); i++ ) elIndex[ m_elementList.at(i) ] = i;
+    QHash<eNode*, int> nodeIndex;
+    for( int i=0; i<m_eNodeList.size(); i++ ) nodeIndex[ m_eNodeList.at(i) ] = i;
+
+    state.clear();
+    QDataStream out( &state, QIODevice::WriteOnly );
+
+    out << stateMagic << stateVersion << circuitHash()
+        << qint32( m_elementList.size() ) << qint32( m_eNodeList.size() ) << qint32( m_mcuList.size() );
+
+    foreach( BaseProcessor* proc, m_mcuList ) out << proc->firmwareHash();
+
+    out << quint64( m_step )
+        << qint32( m_plotSampler.nextSample()-m_step ) << qint32( m_reacCounter ) << qint32( m_noLinCounter )
+        << qint32( m_reacStep ) << qint32( m_reacHint ) << m_reacActivity << quint64( m_reacTickStep )
+        << quint64( m_noLinSolves ) << quint64( m_noLinIters ) << quint64( m_noLinFails )
+        << qint32( m_noLinMaxIter );
+
+    foreach( eElement* el, m_elementList )
+    {
+        QByteArray elState;
+        QDataStream elOut( &elState, QIODevice::WriteOnly );
+        el->saveState( elOut );
+
+        out << QByteArray( el->getId().c_str() ) << quint64( el->m_eventTime ) << elState;
+    }
+    foreach( eNode* node, m_eNodeList )
+    {
+        out << node->m_volt << qint32( node->m_ePinList.size() );
+        foreach( ePin* epin, node->m_ePinList ) out << epin->m_admit << epin->m_current;
+    }
+    saveList( out, m_changedFast,  elIndex );
+    saveList( out, m_reactiveList, elIndex );
+    saveList( out, m_nonLinear,    elIndex );
+    saveList( out, m_eChangedNodeList, nodeIndex );
+
+    foreach( BaseProcessor* proc, m_mcuList )
+    {
+        QByteArray mcuState;
+        QDataStream mcuOut( &mcuState, QIODevice::WriteOnly );
+        proc->saveState( mcuOut );
+        out << mcuState;
+    }
+    if( timer ) resumeTimer();
+
+    return true;
+}
+
+bool Simulator::loadState( const QByteArray &state )
+{
+    if( !m_isrunning && !m_paused ) return false;
+
+    QDataStream in( state );
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if( (magic != stateMagic) || (version != stateVersion) ) return false;
+
+    QByteArray circHash;
+    qint32 numElements, numNodes, numMcus;
+    in >> circHash >> numElements >> numNodes >> numMcus;
+
+    if( (circHash != circuitHash())
+     || (numElements != m_elementList.size())
+     || (numNodes != m_eNodeList.size())
+     || (numMcus  != m_mcuList.size()) ) return false;
+
+    foreach( BaseProcessor* proc, m_mcuList )
+    {
+        QByteArray fwHash;
+        in >> fwHash;
+        if( fwHash != proc->firmwareHash() ) return false;
+    }
+
+    quint64 step, reacTickStep, noLinSolves, noLinIters, noLinFails;
+    qint32  plotWait, reacCounter, noLinCounter, reacStep, reacHint, noLinMaxIter;
+    bool    reacActivity;
+
+    in >> step
+       >> plotWait >> reacCounter >> noLinCounter
+       >> reacStep >> reacHint >> reacActivity >> reacTickStep
+       >> noLinSolves >> noLinIters >> noLinFails
+       >> noLinMaxIter;
+
+    // Read and check everything before touching the circuit
+    QVector<quint64>    eventTimes;
+    QList<QByteArray>   elStates;
+    for( int i=0; i<numElements; i++ )
+    {
+        QByteArray id, elState;
+        quint64 eventTime;
+        in >> id >> eventTime >> elState;
+
+        if( id != QByteArray( m_elementList.at(i)->getId().c_str() ) ) return false;
+        eventTimes.append( eventTime );
+        elStates.append( elState );
+    }
+    QVector<double> volts;
+    QVector<double> pinStamps;               // Admitance and current of each ePin
+    for( int i=0; i<numNodes; i++ )
+    {
+        double volt;
+        qint32 numPins;
+        in >> volt >> numPins;
+
+        if( numPins != m_eNodeList.at(i)->m_ePinList.size() ) return false;
+        volts.append( volt );
+
+        for( int j=0; j<numPins; j++ )
+        {
+            double admit, current;
+            in >> admit >> current;
+            pinStamps.append( admit );
+            pinStamps.append( current );
+        }
+    }
+    QVector<qint32> changedFast, reactive, nonLinear, changedNodes;
+    loadList( in, changedFast );
+    loadList( in, reactive );
+    loadList( in, nonLinear );
+    loadList( in, changedNodes );
+
+    QList<QByteArray> mcuStates;
+    for( int i=0; i<numMcus; i++ )
+    {
+        QByteArray mcuState;
+        in >> mcuState;
+        mcuStates.append( mcuState );
+    }
+    if( in.status() != QDataStream::Ok ) return false;
+
+    for( int i=0; i<numMcus; i++ )      // Mcu cores check the state is theirs
+    {
+        QDataStream mcuIn( mcuStates.at(i) );
+        if( !m_mcuList.at(i)->checkState( mcuIn ) ) return false;
+    }
+    bool timer = (m_timerId != 0);
+    stopTimer();
+    stopMcuThreads( false );
+
+    for( int i=0; i<numMcus; i++ )      // All checked: none fails here
+    {
+        QDataStream mcuIn( mcuStates.at(i) );
+        m_mcuList.at(i)->loadState( mcuIn );
+    }
+    m_step         = step;
+    m_plotSampler.reset( step+plotWait-1 );
+    m_reacCounter  = reacCounter;
+    m_noLinCounter = noLinCounter;
+    m_reacStep     = reacStep;
+    m_reacHint     = reacHint;
+    m_reacActivity = reacActivity;
+    m_reacTickStep = reacTickStep;
+    m_noLinSolves  = noLinSolves;
+    m_noLinIters   = noLinIters;
+    m_noLinFails   = noLinFails;
+    m_noLinMaxIter = noLinMaxIter;
+    m_lastStep     = step;
+
+    // Same as resuming from pause, then elements and stamps as saved
+    m_matrix.createMatrix( m_eNodeList, m_elementList );
+
+    for( int i=0; i<numElements; i++ )
+    {
+        QDataStream elIn( elStates.at(i) );
+        m_elementList.at(i)->loadState( elIn );
+    }
+    int stamp = 0;
+    for( int i=0; i<numNodes; i++ )
+    {
+        eNode* node = m_eNodeList.at(i);
+        foreach( ePin* epin, node->m_ePinList )
+        {
+            node->stampAdmitance( epin, pinStamps.at( stamp++ ) );
+            node->stampCurrent(   epin, pinStamps.at( stamp++ ) );
+        }
+    }
+    for( int i=0; i<numNodes; i++ )   // Voltages as solved, nothing scheduled
+    {
+        eNode* node = m_eNodeList.at(i);
+        node->m_volt    = volts.at(i);
+        node->m_changed = false;
+    }
+    m_changedFast.clear();
+    m_reactiveList.clear();
+    m_nonLinear.clear();
+    m_eChangedNodeList.clear();
+
+    foreach( qint32 i, changedFast )  if( i >= 0 && i < numElements ) m_changedFast.add( m_elementList.at(i) );
+    foreach( qint32 i, reactive )     if( i >= 0 && i < numElements ) m_reactiveList.add( m_elementList.at(i) );
+    foreach( qint32 i, nonLinear )    if( i >= 0 && i < numElements ) m_nonLinear.add( m_elementList.at(i) );
+    foreach( qint32 i, changedNodes ) if( i >= 0 && i < numNodes ) m_eNodeList.at(i)->setChanged();
+
+    m_capture.reset( m_step );                 // Captures don't go back in time
+
+    m_events.clear( m_step );
+    for( int i=0; i<numElements; i++ )
+        if( eventTimes.at(i) > 0 ) m_events.addEvent( eventTimes.at(i), m_elementList.at(i) );
+
+    m_error = false;
+
+    if( !m_batch ) runGraphicStep();
+    if( timer ) resumeTimer();
+
+    return true;
+}
+
+bool Simulator::saveStateFile( QString fileName )
+{
+    QByteArray state;
+    if( !saveState( state ) ) return false;
+
+    QFile file( fileName );
+    if( !file.open( QFile::WriteOnly | QFile::Truncate ) ) return false;
+
+    return file.write( state ) == state.size();
+}
+
+bool Simulator::loadStateFile( QString fileName )
+{
+    QFile file( fileName );
+    if( !file.open( QFile::ReadOnly ) ) return false;
+
+    return loadState( file.readAll() );
+}
+
 int Simulator::simuRateChanged( int rate )
 {
     if( rate > 1e6 ) rate = 1e6;
@@ -345,8 +859,6 @@ int Simulator::simuRateChanged( int rate )
 
     m_timerTick  = 50/m_timerSc;
     int fps = 1000/m_timerTick;
-    int mult = 20;
-    if( fps == 40 ) mult = 40;
 
     m_circuitRate = rate/fps;
 
@@ -363,8 +875,6 @@ int Simulator::simuRateChanged( int rate )
         resumeSim();
     }
     
-    PlotterWidget::self()->setPlotterTick( m_circuitRate*mult );
-
     m_simuRate = m_circuitRate*fps;
 
     std::cout << "\nFPS:              " << fps
@@ -404,6 +914,7 @@ void Simulator::setReaClock( int value )
     else if( value > 100 ) value = 100;
 
     m_stepsPrea = value;
+    m_reacStep  = value;
 
     if( running ) runContinuous();
 }
@@ -443,6 +954,35 @@ double Simulator::NLaccuracy()
     return 1/pow(10,m_noLinAcc)/2;
 }
 
+double Simulator::noLinAvgIter()
+{
+    if( m_noLinSolves == 0 ) return 0;
+    return (double)m_noLinIters/m_noLinSolves;
+}
+
+bool Simulator::adaptiveStep() { return m_adaptStep; }
+void Simulator::setAdaptiveStep( bool adaptive )
+{
+    bool running = m_isrunning;
+    if( running ) stopSim();
+
+    m_adaptStep = adaptive;
+    m_reacStep  = m_stepsPrea;
+
+    if( running ) runContinuous();
+}
+
+bool Simulator::sparseSolver() { return m_matrix.sparse(); }
+void Simulator::setSparseSolver( bool sparse )
+{
+    bool running = m_isrunning;
+    if( running ) stopSim();
+
+    m_matrix.setSparse( sparse );
+
+    if( running ) runContinuous();
+}
+
 uint64_t Simulator::step()
 {
     return m_step;
@@ -467,16 +1007,20 @@ void Simulator::remFromEnodeList( eNode* nod, bool del )
 {
     if( m_eNodeList.contains(nod) ) m_eNodeList.removeOne( nod );
 
-    if( del ){ delete nod; }
+    if( del )
+    {
+        m_eChangedNodeList.remove( nod );
+        delete nod;
+    }
 }
 
 void Simulator::addToChangedNodeList( eNode* nod )
 {
-    if( !m_eChangedNodeList.contains(nod) ) m_eChangedNodeList.append( nod );
+    m_eChangedNodeList.add( nod );
 }
 void Simulator::remFromChangedNodeList( eNode* nod )
 {
-    m_eChangedNodeList.removeOne( nod );
+    m_eChangedNodeList.remove( nod );
 }
 
 void Simulator::addToElementList( eElement* el )
@@ -511,36 +1055,69 @@ void Simulator::remFromSimuClockList( eElement* el )
 
 void Simulator::addToChangedFast( eElement* el )
 {
-    if( !m_changedFast.contains(el) ) m_changedFast.append(el);
+    m_changedFast.add( el );
 }
 
 void Simulator::remFromChangedFast( eElement* el )
 {
-    m_changedFast.removeOne(el);
+    m_changedFast.remove( el );
 }
 
 void Simulator::addToReactiveList( eElement* el )
 {
-    if( !m_reactiveList.contains(el) ) m_reactiveList.append(el);
+    m_reactiveList.add( el );
 }
 
 void Simulator::remFromReactiveList( eElement* el )
 {
-    m_reactiveList.removeOne(el);
+    m_reactiveList.remove( el );
 }
 
 void Simulator::addToNoLinList( eElement* el )
 {
-    if( !m_nonLinear.contains(el) ) m_nonLinear.append(el);
+    m_nonLinear.add( el );
 }
 
 void Simulator::remFromNoLinList( eElement* el )
 {
-    m_nonLinear.removeOne(el);
+    m_nonLinear.remove( el );
+}
+
+void Simulator::addEvent( uint64_t time, eElement* el )
+{
+    m_events.addEvent( time, el );
+}
+
+void Simulator::cancelEvent( eElement* el )
+{
+    m_events.cancelEvent( el );
+}
+
+void Simulator::stopMcuThreads( bool reset ) // Circuit thread must be stopped
+{
+    foreach( BaseProcessor* proc, m_mcuList ) 
+    {
+        proc->stopThread();
+        if( reset ) proc->resetThread();
+    }
+}
+
+void Simulator::setMcuQuantum( int quantum )
+{
+    if( quantum < 0 ) quantum = 0;
+    
+    bool running = m_isrunning;
+    if( running ) stopSim();
+
+    m_mcuQuantum = quantum;
+    foreach( BaseProcessor* proc, m_mcuList ) proc->setQuantum( quantum );
+
+    if( running ) runContinuous();
 }
 
 void Simulator::addToMcuList( BaseProcessor* proc )
 {
+    proc->setQuantum( m_mcuQuantum );
     if( !m_mcuList.contains(proc) ) m_mcuList.append( proc );
 }
 void Simulator::remFromMcuList( BaseProcessor* proc ) { m_mcuList.removeOne( proc ); }
@@ -24,6 +24,11 @@
 #include <QElapsedTimer>
 
 #include "circmatrix.h"
+#include "dirtylist.h"
+#include "eventwheel.h"
+#include "waverecorder.h"
+#include "scopecapture.h"
+#include "plotsampler.h"
 
 class BaseProcessor;
 class eElement;
@@ -66,12 +71,74 @@ class MAINMODULE_EXPORT Simulator : public QObject
         int  noLinAcc();
         void setNoLinAcc( int ac );
         double NLaccuracy();
+
+        // Newton-Raphson statistics since simulation started
+        uint64_t noLinSolves()  { return m_noLinSolves; }
+        uint64_t noLinFails()   { return m_noLinFails; }
+        int      noLinMaxIter() { return m_noLinMaxIter; }
+        double   noLinAvgIter();
+
+        // Adaptive step for Reactive elements: reaClock() is the minimum step,
+        // reacStep() is the step being integrated, elements send step hints
+        // from their error estimation. reacRestart() is true when a long
+        // step is cut by fast changes in the circuit.
+        // Elements check their value at reacPoint() and call reacDone(), if
+        // any error is over tolerance the whole step is rejected: all of
+        // them stamp the first half again (reacReject()) and the step is
+        // solved in two parts, else they accept it (reacAccept()). Both
+        // stamp up to reacTarget(). reacRedoing() is true in a redone step.
+        bool adaptiveStep();
+        void setAdaptiveStep( bool adaptive );
+
+        int  reacStep() { return m_reacStep; }
+        bool reacRestart() { return m_reacRestart; }
+        void reacStepHint( int steps );
+        void reacDone( eElement* el, bool reject );
+        uint64_t reacPoint()  { return m_reacPoint; }
+        uint64_t reacTarget() { return m_reacTarget; }
+        bool     reacRedoing() { return m_reacRedo; }
+
+        bool sparseSolver();
+        void setSparseSolver( bool sparse );
+
+        // Mcus run in their own thread up to this number of steps ahead
+        // of the circuit, 0 = Mcus run in circuit thread.
+        int  mcuQuantum() { return m_mcuQuantum; }
+        void setMcuQuantum( int quantum );
         
         bool isRunning();
         bool isPaused();
+        bool hasError() { return m_error; }
+
+        // Node voltages shown in animate mode, only with circuit thread stopped
+        void publishVolts();
+
+        // Batch mode: no timer, no GUI updates, steps run by runSteps()
+        bool batchMode() { return m_batch; }
+        void setBatchMode( bool batch ) { m_batch = batch; }
+        void runSteps( int steps );
         
         uint64_t step();
 
+        // Record signals to wave files, can start and stop while running
+        WaveRecorder* recorder() { return &m_recorder; }
+        bool startRecording( QString fileName );
+        void stopRecording();
+
+        // Oscope samples, shared by all Oscopes
+        ScopeCapture* capture() { return &m_capture; }
+
+        // Plotter samples, read by the GUI while circuit runs
+        PlotSampler* plotSampler() { return &m_plotSampler; }
+
+        // Snapshot of circuit and Mcus state, simulation must be running or
+        // paused. Valid for the same circuit and firmwares, checked by hash,
+        // also after a restart. Returns false if it doesn't match the circuit.
+        bool saveState( QByteArray &state );
+        bool loadState( const QByteArray &state );
+        bool saveStateFile( QString fileName );
+        bool loadStateFile( QString fileName );
+
         QList<eNode*> geteNodes() { return m_eNodeList; }
 
         void addToEnodeBusList( eNode* nod );
@@ -101,6 +168,9 @@ class MAINMODULE_EXPORT Simulator : public QObject
         void addToNoLinList( eElement* el );
         void remFromNoLinList( eElement* el );
         
+        void addEvent( uint64_t time, eElement* el ); // Call el->runEvent() at step time
+        void cancelEvent( eElement* el );
+
         void addToMcuList( BaseProcessor* proc );
         void remFromMcuList( BaseProcessor* proc );
 
@@ -116,7 +186,20 @@ class MAINMODULE_EXPORT Simulator : public QObject
  static Simulator* m_pSelf;
         
         void runCircuit();
+        void stopMcuThreads( bool reset );
+
+        QByteArray circuitHash();
+
+        // Graphic step is split so GUI renders while Circuit runs:
+        // publishState() with circuit thread stopped, renderGraphics() after.
+        void publishState();
+        void renderGraphics();
         
+        inline void runList( DirtyList<eElement> &list );
+        inline void skipIdleSteps( int &i, int steps );
+        void updateReacStep();
+        void cutReacStep();
+        void endReacStep();
         inline void solveMatrix();
 
         QFuture<void> m_CircuitFuture;
@@ -124,25 +207,37 @@ class MAINMODULE_EXPORT Simulator : public QObject
         CircMatrix m_matrix;
 
         QList<eNode*>    m_eNodeList;
-        QList<eNode*>    m_eChangedNodeList;
+        DirtyList<eNode> m_eChangedNodeList;
         QList<eNode*>    m_eNodeBusList;
         
         QList<eElement*> m_elementList;
         QList<eElement*> m_updateList;
         
-        QList<eElement*> m_changedFast;
-        QList<eElement*> m_reactiveList;
-        QList<eElement*> m_nonLinear;
+        DirtyList<eElement> m_changedFast;
+        DirtyList<eElement> m_reactiveList;
+        DirtyList<eElement> m_nonLinear;
+        EventWheel          m_events;
         QList<eElement*> m_simuClock;
+        QList<eElement*> m_reacStepList;   // Elements checked in this reactive step
         QList<BaseProcessor*> m_mcuList;
 
+        WaveRecorder m_recorder;
+        ScopeCapture m_capture;
+        PlotSampler  m_plotSampler;
+
         bool m_isrunning;
         bool m_debugging;
         bool m_paused;
+        bool m_batch;
         bool m_error;
         int  m_timerId;
         
         int m_noLinAcc;
+        int m_maxNoLinIter;
+        int m_noLinMaxIter;
+        uint64_t m_noLinSolves;
+        uint64_t m_noLinIters;
+        uint64_t m_noLinFails;
 
         int m_numEnodes;
         int m_simuRate;
@@ -152,9 +247,22 @@ class MAINMODULE_EXPORT Simulator : public QObject
         int m_timerSc;
         
         int m_circuitRate;
+        int m_mcuQuantum;
         int m_noLinCounter;
         int m_reacCounter;
-        int m_updtCounter;
+
+        bool m_adaptStep;
+        bool m_reacActivity;
+        bool m_reacRestart;
+        bool m_reacReject;
+        bool m_reacRedo;
+        int  m_reacStep;
+        int  m_reacHint;
+        int  m_reacMaxMult;
+        uint64_t m_reacTickStep;
+        uint64_t m_reacLastTick; // Start of step being integrated
+        uint64_t m_reacPoint;    // Step of solution being checked
+        uint64_t m_reacTarget;   // End of step to stamp
 
         uint64_t m_step;
         uint64_t m_lastStep;
@@ -0,0 +1,359 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <set>
+#include <algorithm>
+#include <cmath>
+
+#include "sparsesolver.h"
+
+SparseSolver::SparseSolver()
+{
+    m_n = 0;
+    m_maxRank = 0;
+}
+SparseSolver::~SparseSolver(){}
+
+void SparseSolver::analyze( int n, const std::vector<std::vector<int>> &pattern )
+{
+    m_n = n;
+
+    m_src.clear();
+    m_srcSlot.clear();
+    m_srcRow.clear();
+    m_srcCol.clear();
+    m_srcFact.clear();
+    m_srcUpd.clear();
+
+    m_updCol.clear();
+    m_updZ.clear();
+    m_colUpd.assign( n, -1 );
+    m_colState.assign( n, 0 );
+
+    m_maxRank = std::min( 8, n/4 );   // Above this a full factorization is cheaper
+
+    // Build symmetric adjacency graph (without diagonal)
+    std::vector<std::set<int>> adj( n );
+    for( int row=0; row<n; row++ )
+    {
+        for( int col : pattern[row] )
+        {
+            if( col == row ) continue;
+            adj[row].insert( col );
+            adj[col].insert( row );
+        }
+    }
+
+    // Minimum degree ordering, eliminated node neighbours become a clique (fill-in)
+    std::vector<std::vector<int>> upper( n );   // Later neighbours when eliminated
+    std::vector<bool> done( n, false );
+
+    m_perm.assign( n, 0 );
+    m_invPerm.assign( n, 0 );
+
+    for( int step=0; step<n; step++ )
+    {
+        int v = -1;
+        unsigned minDeg = 0;
+        for( int i=0; i<n; i++ )
+        {
+            if( done[i] ) continue;
+            if( (v < 0) || (adj[i].size() < minDeg) )
+            {
+                v = i;
+                minDeg = adj[i].size();
+                if( minDeg == 0 ) break;
+            }
+        }
+        done[v] = true;
+        m_perm[step] = v;
+        m_invPerm[v] = step;
+
+        std::vector<int> nbrs( adj[v].begin(), adj[v].end() );
+        upper[v] = nbrs;
+
+        for( int a : nbrs )
+        {
+            adj[a].erase( v );
+            for( int b : nbrs ) if( b != a ) adj[a].insert( b );
+        }
+        adj[v].clear();
+    }
+
+    // Filled pattern in new numbering: row = lower part + diagonal + upper part
+    std::vector<std::vector<int>> rows( n );
+    for( int v=0; v<n; v++ )
+    {
+        int i = m_invPerm[v];
+        rows[i].push_back( i );
+
+        for( int a : upper[v] )
+        {
+            int j = m_invPerm[a];
+            rows[i].push_back( j );   // U(i,j)
+            rows[j].push_back( i );   // L(j,i)
+        }
+    }
+    m_rowPtr.assign( n+1, 0 );
+    m_colInd.clear();
+    m_diag.assign( n, 0 );
+
+    for( int i=0; i<n; i++ )
+    {
+        std::vector<int> &row = rows[i];
+        std::sort( row.begin(), row.end() );
+
+        m_rowPtr[i] = m_colInd.size();
+        for( int col : row )
+        {
+            if( col == i ) m_diag[i] = m_colInd.size();
+            m_colInd.push_back( col );
+        }
+    }
+    m_rowPtr[n] = m_colInd.size();
+
+    m_lu.assign( m_colInd.size(), 0 );
+    m_work.assign( n, 0 );
+    m_x.assign( n, 0 );
+}
+
+int SparseSolver::findSlot( int row, int col )
+{
+    const int* first = &m_colInd[0]+m_rowPtr[row];
+    const int* last  = &m_colInd[0]+m_rowPtr[row+1];
+    const int* it = std::lower_bound( first, last, col );
+
+    if( (it == last) || (*it != col) ) return -1;
+    return it-&m_colInd[0];
+}
+
+bool SparseSolver::addSource( int row, int col, double* src )
+{
+    row = m_invPerm[row];
+    col = m_invPerm[col];
+
+    int slot = findSlot( row, col );
+    if( slot < 0 ) return false;
+
+    m_srcSlot.push_back( slot );
+    m_srcRow.push_back( row );
+    m_srcCol.push_back( col );
+    m_src.push_back( src );
+    m_srcFact.push_back( *src );
+    m_srcUpd.push_back( *src );
+    return true;
+}
+
+void SparseSolver::factor()
+{
+    std::fill( m_lu.begin(), m_lu.end(), 0 );
+
+    int numSrc = m_src.size();
+    for( int i=0; i<numSrc; i++ )
+    {
+        double value = *(m_src[i]);
+        m_lu[ m_srcSlot[i] ] += value;
+        m_srcFact[i] = value;
+        m_srcUpd[i]  = value;
+    }
+    for( int col : m_updCol ) m_colUpd[col] = -1;   // Factors are exact now
+    m_updCol.clear();
+    m_updZ.clear();
+
+    double* w = &m_work[0];
+
+    for( int i=0; i<m_n; i++ )          // Row oriented Doolittle over filled pattern
+    {
+        int start = m_rowPtr[i];
+        int end   = m_rowPtr[i+1];
+        int diag  = m_diag[i];
+
+        for( int s=start; s<end; s++ ) w[ m_colInd[s] ] = m_lu[s]; // Scatter
+
+        for( int s=start; s<diag; s++ )
+        {
+            int k = m_colInd[s];
+            double lik = w[k]/m_lu[ m_diag[k] ];
+            w[k] = lik;
+
+            if( lik == 0 ) continue;
+
+            int kEnd = m_rowPtr[k+1];
+            for( int t=m_diag[k]+1; t<kEnd; t++ ) w[ m_colInd[t] ] -= lik*m_lu[t];
+        }
+        if( w[i] == 0.0 ) w[i] = 1e-18;                            // avoid zeros
+
+        for( int s=start; s<end; s++ ) m_lu[s] = w[ m_colInd[s] ]; // Gather
+    }
+}
+
+void SparseSolver::update()
+{
+    // Find columns with values different from the factored ones (state bit 1)
+    // and columns changed since their correction was calculated (state bit 2)
+    int numSrc = m_src.size();
+    std::vector<int> touched;
+
+    for( int i=0; i<numSrc; i++ )
+    {
+        double value = *(m_src[i]);
+        int state = 0;
+
+        if( value != m_srcFact[i] ) state |= 1;
+        if( value != m_srcUpd[i] )  state |= 2;
+        if( state == 0 ) continue;
+
+        int col = m_srcCol[i];
+        if( m_colState[col] == 0 ) touched.push_back( col );
+        m_colState[col] |= state;
+    }
+    std::vector<int> newCol;
+    for( int col : touched ) if( m_colState[col] & 1 ) newCol.push_back( col );
+
+    if( (int)newCol.size() > m_maxRank )           // Too many changes: refactor
+    {
+        for( int col : touched ) m_colState[col] = 0;
+        factor();
+        return;
+    }
+    bool changed = ( newCol.size() != m_updCol.size() );
+
+    std::vector<std::vector<double>> newZ( newCol.size() );
+    for( unsigned k=0; k<newCol.size(); k++ )
+    {
+        int col = newCol[k];
+        int old = m_colUpd[col];
+
+        if( (old >= 0) && !(m_colState[col] & 2) )   // Correction still valid
+        {
+            newZ[k].swap( m_updZ[old] );
+            if( old != (int)k ) changed = true;
+            continue;
+        }
+        changed = true;
+
+        std::vector<double> &z = newZ[k];            // z = A0^-1 * (A-A0)(:,col)
+        z.assign( m_n, 0 );
+        for( int i=0; i<numSrc; i++ )
+        {
+            if( m_srcCol[i] != col ) continue;
+
+            double value = *(m_src[i]);
+            z[ m_srcRow[i] ] += value-m_srcFact[i];
+            m_srcUpd[i] = value;
+        }
+        luSolve( &z[0] );
+    }
+    for( int col : touched ) m_colState[col] = 0;
+    for( int col : m_updCol ) m_colUpd[col] = -1;
+
+    m_updCol.swap( newCol );
+    m_updZ.swap( newZ );
+
+    for( unsigned k=0; k<m_updCol.size(); k++ ) m_colUpd[ m_updCol[k] ] = k;
+
+    if( changed ) factorUpdate();
+}
+
+void SparseSolver::factorUpdate()
+{
+    // S = I + V'*Z  where V selects changed columns, factored with partial pivoting
+    int k = m_updCol.size();
+
+    m_updS.assign( k, std::vector<double>( k, 0 ) );
+    m_updPivot.assign( k, 0 );
+    m_updT.assign( k, 0 );
+
+    for( int a=0; a<k; a++ )
+        for( int b=0; b<k; b++ ) m_updS[a][b] = ( a==b ? 1 : 0 ) + m_updZ[b][ m_updCol[a] ];
+
+    for( int j=0; j<k; j++ )
+    {
+        int p = j;
+        for( int i=j+1; i<k; i++ )
+            if( std::abs( m_updS[i][j] ) > std::abs( m_updS[p][j] ) ) p = i;
+
+        m_updPivot[j] = p;
+        if( p != j ) m_updS[p].swap( m_updS[j] );
+
+        if( m_updS[j][j] == 0.0 ) m_updS[j][j] = 1e-18;           // avoid zeros
+
+        for( int i=j+1; i<k; i++ )
+        {
+            double lij = m_updS[i][j] /= m_updS[j][j];
+            for( int c=j+1; c<k; c++ ) m_updS[i][c] -= lij*m_updS[j][c];
+        }
+    }
+}
+
+void SparseSolver::luSolve( double* x )
+{
+    for( int i=0; i<m_n; i++ )                       // Forward substitution (unit L)
+    {
+        double tot = x[i];
+        for( int s=m_rowPtr[i]; s<m_diag[i]; s++ ) tot -= m_lu[s]*x[ m_colInd[s] ];
+        x[i] = tot;
+    }
+    for( int i=m_n-1; i>=0; i-- )                    // Back substitution (U)
+    {
+        double tot = x[i];
+        int end = m_rowPtr[i+1];
+        for( int s=m_diag[i]+1; s<end; s++ ) tot -= m_lu[s]*x[ m_colInd[s] ];
+        x[i] = tot/m_lu[ m_diag[i] ];
+    }
+}
+
+void SparseSolver::solve( std::vector<double> &b )
+{
+    double* x = &m_x[0];
+
+    for( int i=0; i<m_n; i++ ) x[i] = b[ m_perm[i] ];
+
+    if( m_updCol.empty() ) luSolve( x );
+    else                   updSolve( x );
+
+    for( int i=0; i<m_n; i++ ) b[ m_perm[i] ] = x[i];
+}
+
+void SparseSolver::updSolve( double* x )
+{
+    luSolve( x );                         // x = y - Z * S^-1 * V'*y
+
+    int k = m_updCol.size();
+    double* t = &m_updT[0];
+    for( int a=0; a<k; a++ ) t[a] = x[ m_updCol[a] ];
+
+    for( int j=0; j<k; j++ )
+    {
+        int p = m_updPivot[j];
+        if( p != j ) std::swap( t[p], t[j] );
+    }
+    for( int j=0; j<k; j++ )
+        for( int i=j+1; i<k; i++ ) t[i] -= m_updS[i][j]*t[j];
+    for( int i=k-1; i>=0; i-- )
+    {
+        for( int c=i+1; c<k; c++ ) t[i] -= m_updS[i][c]*t[c];
+        t[i] /= m_updS[i][i];
+    }
+    for( int b=0; b<k; b++ )
+    {
+        const double* z = &m_updZ[b][0];
+        double tb = t[b];
+        for( int i=0; i<m_n; i++ ) x[i] -= z[i]*tb;
+    }
+}
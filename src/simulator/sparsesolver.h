@@ -0,0 +1,97 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SPARSESOLVER_H
+#define SPARSESOLVER_H
+
+#include <vector>
+
+// Sparse LU solver for one group of interconnected eNodes.
+//
+// analyze() computes a fill-reducing ordering (minimum degree) and the
+// symbolic structure of the factors, this is only needed when circuit
+// topology changes. factor() redoes only the numeric factorization over
+// that fixed structure and solve() does forward/back substitution.
+// Cost of factor and solve scales with the nonzeros of the factors.
+//
+// update() is used when only some values changed (switching elements):
+// changed columns are handled as a low rank correction of the existing
+// factors (Woodbury formula) and a full factor() is done only when the
+// number of changed columns crosses a threshold.
+
+class SparseSolver
+{
+    public:
+        SparseSolver();
+        ~SparseSolver();
+
+        // pattern[row] = columns with possible non zero values (row included)
+        void analyze( int n, const std::vector<std::vector<int>> &pattern );
+
+        // Bind matrix entry (row,col) to a source value, returns false if
+        // entry is not part of the pattern given to analyze()
+        bool addSource( int row, int col, double* src );
+
+        void factor();
+        void update();
+        void solve( std::vector<double> &b );
+
+        int updateRank() { return m_updCol.size(); }
+
+        int size()    { return m_n; }
+        int nonZeros(){ return m_rowPtr.empty() ? 0 : m_rowPtr[m_n]; }
+
+    private:
+        int  findSlot( int row, int col );
+        void luSolve( double* x );
+        void updSolve( double* x );
+        void factorUpdate();
+
+        int m_n;
+
+        std::vector<int> m_perm;     // new index -> original index
+        std::vector<int> m_invPerm;  // original index -> new index
+
+        std::vector<int>    m_rowPtr;  // Filled pattern in CSR (permuted)
+        std::vector<int>    m_colInd;
+        std::vector<int>    m_diag;    // Slot of diagonal for each row
+        std::vector<double> m_lu;      // L (unit, below diag) and U values
+
+        std::vector<int>     m_srcSlot; // Slot in m_lu for each source
+        std::vector<int>     m_srcRow;  // Row and column of each source (permuted)
+        std::vector<int>     m_srcCol;
+        std::vector<double*> m_src;     // Source values
+        std::vector<double>  m_srcFact; // Source values when factored
+        std::vector<double>  m_srcUpd;  // Source values when update column calculated
+
+        int m_maxRank;
+
+        std::vector<int> m_colUpd;      // Index in update columns or -1
+        std::vector<int> m_colState;    // 0 = equal to factors, 1 = changed, 2 = changed since update
+
+        std::vector<int>                 m_updCol;  // Changed columns (permuted)
+        std::vector<std::vector<double>> m_updZ;    // A0^-1 * changed column of A-A0
+        std::vector<std::vector<double>> m_updS;    // LU of I + Z rows of changed columns
+        std::vector<int>                 m_updPivot;
+        std::vector<double>              m_updT;
+
+        std::vector<double> m_work;
+        std::vector<double> m_x;
+};
+
+#endif
@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+
+// Fixed size queue for one producer thread and one consumer thread.
+//
+// No locks: the producer only writes m_tail and the consumer only writes
+// m_head, each side reads the other index with acquire ordering so the
+// items written before an index update are visible after reading it.
+// Each side keeps a copy of the other index and reloads it only when the
+// queue looks full or empty. Size must be a power of 2.
+
+template <class T> class SpscQueue
+{
+    public:
+        SpscQueue( uint32_t size=4096 )
+        {
+            m_buffer.resize( size );
+            m_mask = size-1;
+            m_head = 0;
+            m_tail = 0;
+            m_headCache = 0;
+            m_tailCache = 0;
+        }
+
+        bool push( const T &item )                 // Producer thread
+        {
+            uint32_t tail = m_tail.load( std::memory_order_relaxed );
+
+            if( tail-m_headCache > m_mask )                   // Looks full
+            {
+                m_headCache = m_head.load( std::memory_order_acquire );
+                if( tail-m_headCache > m_mask ) return false;
+            }
+            m_buffer[ tail & m_mask ] = item;
+            m_tail.store( tail+1, std::memory_order_release );
+            return true;
+        }
+
+        bool pop( T &item )                        // Consumer thread
+        {
+            uint32_t head = m_head.load( std::memory_order_relaxed );
+
+            if( head == m_tailCache )                        // Looks empty
+            {
+                m_tailCache = m_tail.load( std::memory_order_acquire );
+                if( head == m_tailCache ) return false;
+            }
+            item = m_buffer[ head & m_mask ];
+            m_head.store( head+1, std::memory_order_release );
+            return true;
+        }
+
+        void clear()                  // Only when no thread is using it
+        {
+            m_head = 0;
+            m_tail = 0;
+            m_headCache = 0;
+            m_tailCache = 0;
+        }
+
+    private:
+        std::vector<T> m_buffer;
+        uint32_t       m_mask;
+
+        std::atomic<uint32_t> m_head;          // Written by consumer
+        uint32_t m_tailCache;                  // Consumer copy of m_tail
+        char     m_pad[64];                    // Keep sides in different cache lines
+        std::atomic<uint32_t> m_tail;          // Written by producer
+        uint32_t m_headCache;                  // Producer copy of m_head
+};
+
+#endif
@@ -0,0 +1,97 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+// Logic outputs with propagation delay (DelayLine, used by eLogicOut):
+// a pulse shorter than the delay must still reach the output, delayed,
+// with its width, and a change set before queued ones replaces them.
+//
+// The output is driven the way eLogicOut does it: an event at the step of
+// the first change, changes due then are applied and the next one is
+// scheduled.
+//
+// Build and run from src/simulator:
+//   c++ -I. -o test_delay_line tests/test_delay_line.cpp
+//   ./test_delay_line
+
+#include <stdio.h>
+
+#include "delayline.h"
+
+static const int delay = 10;
+
+static DelayLine line;
+static uint64_t  event;        // Step of pending event, 0 = none
+static bool      output;
+
+static void setOut( uint64_t step, bool out )    // eLogicOut::setOutAt()
+{
+    if( line.push( step+delay, out ) ) event = step+delay;
+}
+
+static void run( uint64_t step )                 // eLogicOut::runEvent()
+{
+    if( event != step ) return;
+    event = 0;
+
+    bool out;
+    while( line.pop( step, out ) ) output = out;
+
+    if( !line.isEmpty() ) event = line.nextTime();
+}
+
+static int check( const char* name, const bool* expected, int steps )
+{
+    for( int step=1; step<=steps; step++ )
+    {
+        run( step );
+        if( output != expected[step] )
+        {
+            printf( "test_delay_line: %s: output %d at step %d\n", name, output, step );
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main()
+{
+    bool expected[64];
+
+    // Pulse of 3 steps at step 5: output high from 15 to 17
+    for( int i=0; i<64; i++ ) expected[i] = (i >= 15) && (i < 18);
+    setOut( 5, true );
+    setOut( 8, false );
+    if( check( "short pulse", expected, 40 ) ) return 1;
+
+    // Two pulses closer than the delay: both come out
+    for( int i=0; i<64; i++ ) expected[i] = ((i >= 11) && (i < 13)) || ((i >= 15) && (i < 16));
+    setOut( 1, true );
+    setOut( 3, false );
+    setOut( 5, true );
+    setOut( 6, false );
+    if( check( "two pulses", expected, 40 ) ) return 1;
+
+    // Changes in the same step: the last one wins
+    for( int i=0; i<64; i++ ) expected[i] = false;
+    setOut( 2, true );
+    setOut( 2, false );
+    if( check( "same step", expected, 40 ) ) return 1;
+
+    printf( "test_delay_line: OK\n" );
+    return 0;
+}
@@ -0,0 +1,359 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <chrono>
+#include <string.h>
+
+#include <QDateTime>
+#include <QtEndian>
+
+#include "waverecorder.h"
+#include "e-pin.h"
+#include "sim_irq.h"
+
+static const double logicThreshold = 2.5;      // Same as Probe
+
+static QByteArray vcdId( int index ) // Identifier codes: printable chars
+{
+    QByteArray id;
+    do
+    {
+        id.append( char( '!' + index%94 ) );
+        index /= 94;
+    }while( index > 0 );
+    return id;
+}
+
+WaveRecorder::WaveRecorder()
+            : m_queue( 1<<16 )
+{
+    m_recording = false;
+    m_startStep = 0;
+    m_endStep   = 0;
+    m_writer    = 0l;
+    m_writerRun = false;
+    m_lastVcdStep = 0;
+    m_lastBinStep = 0;
+}
+WaveRecorder::~WaveRecorder()
+{
+    stop();
+    foreach( Signal* s, m_signals ) delete s;
+}
+
+void WaveRecorder::addPin( ePin* pin, QString name, bool logic )
+{
+    if( !pin ) return;
+    foreach( Signal* s, m_signals ) if( s->pin == pin ) return;
+
+    Signal* s = new Signal;
+    s->name = name;
+    s->bits = logic ? 1 : 0;
+    s->pin  = pin;
+    s->irq  = 0l;
+    s->irqValue = 0;
+    s->lastVolt = 0;
+    s->lastBits = 0;
+    m_signals.push_back( s );
+}
+
+void WaveRecorder::remPin( ePin* pin )
+{
+    if( !pin ) return;
+    for( unsigned i=0; i<m_signals.size(); i++ )
+    {
+        Signal* s = m_signals[i];
+        if( s->pin != pin ) continue;
+
+        m_signals.erase( m_signals.begin()+i );
+        s->pin = 0l;
+        if( m_recording ) m_remSignals.push_back( s ); // Still in file header
+        else              delete s;
+        return;
+    }
+}
+
+void WaveRecorder::addIrq( avr_irq_t* irq, QString name, int bits )
+{
+    if( !irq ) return;
+    foreach( Signal* s, m_signals ) if( s->irq == irq ) return;
+
+    Signal* s = new Signal;
+    s->name = name;
+    s->bits = bits;
+    s->pin  = 0l;
+    s->irq  = irq;
+    s->irqValue = irq->value;
+    s->lastVolt = 0;
+    s->lastBits = 0;
+    m_signals.push_back( s );
+
+    avr_irq_register_notify( irq, irq_hook, s );
+}
+
+void WaveRecorder::remIrq( avr_irq_t* irq )
+{
+    if( !irq ) return;
+    for( unsigned i=0; i<m_signals.size(); i++ )
+    {
+        Signal* s = m_signals[i];
+        if( s->irq != irq ) continue;
+
+        avr_irq_unregister_notify( irq, irq_hook, s );
+        m_signals.erase( m_signals.begin()+i );
+        s->irq = 0l;
+        if( m_recording ) m_remSignals.push_back( s );
+        else              delete s;
+        return;
+    }
+}
+
+void WaveRecorder::irq_hook( struct avr_irq_t* irq, uint32_t value, void* param )
+{
+    Q_UNUSED( irq );
+    // Can be called from a Mcu thread: only store the value
+    Signal* s = reinterpret_cast<Signal*>( param );
+    s->irqValue.store( value, std::memory_order_relaxed );
+}
+
+bool WaveRecorder::start( QString fileName, uint64_t step )
+{
+    stop();
+    if( m_signals.empty() ) return false;
+
+    if( fileName.endsWith( ".vcd" ) ) fileName.chop( 4 );
+    m_vcdFile.setFileName( fileName+".vcd" );
+    m_binFile.setFileName( fileName+".wvb" );
+
+    if( !m_vcdFile.open( QFile::WriteOnly | QFile::Truncate )
+     || !m_binFile.open( QFile::WriteOnly | QFile::Truncate ) )
+    {
+        m_vcdFile.close();
+        m_binFile.close();
+        return false;
+    }
+    m_recSignals = m_signals;
+    m_startStep = step;
+    m_endStep   = step;
+    m_lastVcdStep = ~0ull;
+    m_lastBinStep = 0;
+    m_queue.clear();
+    m_backlog.clear();
+
+    writeHeaders();
+
+    m_recording = true;
+    for( unsigned i=0; i<m_recSignals.size(); i++ ) sample( i, step, true ); // Initial values
+
+    m_writerRun = true;
+    m_writer = new std::thread( &WaveRecorder::runWriter, this );
+    return true;
+}
+
+void WaveRecorder::stop()
+{
+    if( !m_recording ) return;
+
+    // Writer is emptying the queue: wait for the backlog to fit
+    while( !flushBacklog() ) std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+    m_writerRun.store( false, std::memory_order_release );
+    m_writer->join();
+    delete m_writer;
+    m_writer = 0l;
+
+    // Last time mark, so viewers show the whole run
+    uint64_t time = m_endStep-m_startStep;
+    if( time != m_lastVcdStep ) m_vcdBuf.append( "#"+QByteArray::number( qulonglong(time) )+"\n" );
+    flushFiles( true );
+
+    m_vcdFile.close();
+    m_binFile.close();
+
+    m_recording = false;
+    m_recSignals.clear();
+    foreach( Signal* s, m_remSignals ) delete s;
+    m_remSignals.clear();
+}
+
+void WaveRecorder::step( uint64_t step )
+{
+    m_endStep = step;
+    if( !m_backlog.empty() ) flushBacklog(); // If still full new ones go to backlog
+
+    for( unsigned i=0; i<m_recSignals.size(); i++ ) sample( i, step, false );
+}
+
+void WaveRecorder::sample( int id, uint64_t step, bool force )
+{
+    Signal* s = m_recSignals[id];
+    WaveSample ws = { step, uint32_t(id), 0, 0 };
+
+    if( s->bits == 0 )                                     // Voltage
+    {
+        if( !s->pin ) return;                   // Removed while recording
+
+        double volt = s->pin->getVolt();
+        if( !force && (volt == s->lastVolt) ) return;
+        s->lastVolt = volt;
+        ws.volt = volt;
+    }
+    else                                                  // Logic or irq
+    {
+        uint32_t bits;
+        if     ( s->pin ) bits = ( s->pin->getVolt() > logicThreshold ) ? 1 : 0;
+        else if( s->irq ) bits = s->irqValue.load( std::memory_order_relaxed );
+        else return;
+
+        if( s->bits < 32 ) bits &= (1u<<s->bits)-1;
+        if( !force && (bits == s->lastBits) ) return;
+        s->lastBits = bits;
+        ws.bits = bits;
+    }
+    push( ws );
+}
+
+void WaveRecorder::push( WaveSample &s )
+{
+    if( !m_backlog.empty() || !m_queue.push( s ) ) m_backlog.push_back( s );
+}
+
+bool WaveRecorder::flushBacklog()
+{
+    while( !m_backlog.empty() )
+    {
+        if( !m_queue.push( m_backlog.front() ) ) return false;
+        m_backlog.pop_front();
+    }
+    return true;
+}
+
+void WaveRecorder::runWriter()
+{
+    WaveSample s;
+
+    while( true )
+    {
+        // Read flag before emptying queue: all samples pushed before stop are written
+        bool run = m_writerRun.load( std::memory_order_acquire );
+
+        int count = 0;
+        while( m_queue.pop( s ) ) { writeSample( s ); count++; }
+        flushFiles( false );
+
+        if( !run ) break;
+        if( count == 0 ) std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+}
+
+void WaveRecorder::writeHeaders()
+{
+    m_vcdBuf.clear();
+    m_binBuf.clear();
+
+    m_vcdBuf.append( "$date "+QDateTime::currentDateTime().toString().toUtf8()+" $end\n" );
+    m_vcdBuf.append( "$version QtArduSim $end\n" );
+    m_vcdBuf.append( "$timescale 1us $end\n" );
+    m_vcdBuf.append( "$scope module circuit $end\n" );
+
+    m_binBuf.append( "QAWV" );
+    m_binBuf.append( char(1) );                                  // Version
+    uint32_t count = qToLittleEndian( uint32_t(m_recSignals.size()) );
+    m_binBuf.append( (const char*)&count, 4 );
+
+    for( unsigned i=0; i<m_recSignals.size(); i++ )
+    {
+        Signal* s = m_recSignals[i];
+        QByteArray name = s->name.toUtf8().replace( ' ', '_' );
+
+        if( s->bits == 0 ) m_vcdBuf.append( "$var real 64 " );
+        else               m_vcdBuf.append( "$var wire "+QByteArray::number( s->bits )+" " );
+        m_vcdBuf.append( vcdId( i )+" "+name+" $end\n" );
+
+        m_binBuf.append( char(s->bits) );
+        uint16_t len = qToLittleEndian( uint16_t(name.size()) );
+        m_binBuf.append( (const char*)&len, 2 );
+        m_binBuf.append( name );
+    }
+    m_vcdBuf.append( "$upscope $end\n" );
+    m_vcdBuf.append( "$enddefinitions $end\n" );
+
+    m_recBits.clear();                         // Used by writer thread
+    m_vcdIds.clear();
+    for( unsigned i=0; i<m_recSignals.size(); i++ )
+    {
+        m_recBits.push_back( m_recSignals[i]->bits );
+        m_vcdIds.append( vcdId( i ) );
+    }
+}
+
+void WaveRecorder::writeSample( WaveSample &s )
+{
+    uint64_t time = s.step-m_startStep;
+    int bits = m_recBits[ s.signal ];
+
+    if( time != m_lastVcdStep )
+    {
+        m_lastVcdStep = time;
+        m_vcdBuf.append( "#"+QByteArray::number( qulonglong(time) )+"\n" );
+    }
+    if( bits == 0 )
+        m_vcdBuf.append( "r"+QByteArray::number( s.volt, 'g', 9 )+" " );
+    else if( bits == 1 )
+        m_vcdBuf.append( (s.bits) ? '1' : '0' );
+    else
+        m_vcdBuf.append( "b"+QByteArray::number( s.bits, 2 )+" " );
+    m_vcdBuf.append( m_vcdIds.at( s.signal )+"\n" );
+
+    writeVarint( time-m_lastBinStep );
+    m_lastBinStep = time;
+    writeVarint( s.signal );
+
+    if( bits == 0 )
+    {
+        uint64_t raw;
+        memcpy( &raw, &s.volt, 8 );
+        raw = qToLittleEndian( raw );
+        m_binBuf.append( (const char*)&raw, 8 );
+    }
+    else writeVarint( s.bits );
+}
+
+void WaveRecorder::writeVarint( uint64_t value )
+{
+    while( value >= 0x80 )
+    {
+        m_binBuf.append( char( (value & 0x7F) | 0x80 ) );
+        value >>= 7;
+    }
+    m_binBuf.append( char(value) );
+}
+
+void WaveRecorder::flushFiles( bool force )
+{
+    if( force || (m_vcdBuf.size() > 65536) )
+    {
+        m_vcdFile.write( m_vcdBuf );
+        m_vcdBuf.clear();
+    }
+    if( force || (m_binBuf.size() > 65536) )
+    {
+        m_binFile.write( m_binBuf );
+        m_binBuf.clear();
+    }
+}
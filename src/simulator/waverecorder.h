@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the QtArduSim contributors                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef WAVERECORDER_H
+#define WAVERECORDER_H
+
+#include <thread>
+#include <deque>
+#include <vector>
+#include <atomic>
+
+#include <QString>
+#include <QFile>
+#include <QByteArray>
+#include <QList>
+
+#include "spscqueue.h"
+
+class ePin;
+struct avr_irq_t;
+
+// Value change of one signal at one circuit step
+struct WaveSample
+{
+    uint64_t step;
+    uint32_t signal;
+    uint32_t bits;     // Logic and irq signals
+    double   volt;     // Voltage signals
+};
+
+// Records signal changes to a VCD file and to a compact binary file.
+//
+// Signals are pin voltages (as real or as logic level) and simavr irqs.
+// They are sampled at the end of each circuit step and only changes are
+// sent to a lock-free queue, a background thread writes the files, so the
+// circuit thread never waits for the disk. If the queue is full changes
+// are kept in a backlog, nothing is lost.
+//
+// Irq hooks only store the last value, the recorder takes it at the end
+// of the step: faster changes inside one step (1 us) are not recorded.
+//
+// Binary file (.wvb), little endian, varint = LEB128:
+//   "QAWV", u8 version, u32 signals,
+//   each signal: u8 bits (0 = voltage), u16 name length, name (utf8)
+//   then records: varint step delta, varint signal,
+//                 value: f64 voltage or varint bits
+
+class MAINMODULE_EXPORT WaveRecorder
+{
+    public:
+        WaveRecorder();
+        ~WaveRecorder();
+
+        // Signals are added or removed with simulation paused, signals
+        // added while recording are recorded from next start.
+        void addPin( ePin* pin, QString name, bool logic=false );
+        void remPin( ePin* pin );
+        void addIrq( avr_irq_t* irq, QString name, int bits=1 );
+        void remIrq( avr_irq_t* irq );
+
+        bool hasSignals() { return !m_signals.empty(); }
+
+        // fileName.vcd and fileName.wvb, time 0 is this step
+        bool start( QString fileName, uint64_t step );
+        void stop();
+        bool isRecording() { return m_recording; }
+
+        void step( uint64_t step ); // Circuit thread: sample all signals
+
+    private:
+        struct Signal
+        {
+            QString    name;
+            int        bits;        // 0 = voltage as real
+            ePin*      pin;
+            avr_irq_t* irq;
+            std::atomic<uint32_t> irqValue;
+
+            double   lastVolt;      // Last value recorded
+            uint32_t lastBits;
+        };
+
+ static void irq_hook( struct avr_irq_t* irq, uint32_t value, void* param );
+
+        void sample( int id, uint64_t step, bool force );
+        void push( WaveSample &s );
+        bool flushBacklog();
+
+        void runWriter();
+        void writeHeaders();
+        void writeSample( WaveSample &s );
+        void writeVarint( uint64_t value );
+        void flushFiles( bool force );
+
+        std::vector<Signal*> m_signals;    // Signals to record
+        std::vector<Signal*> m_recSignals; // Recording now, index is signal id
+        std::vector<Signal*> m_remSignals; // Removed while recording
+
+        bool m_recording;
+        uint64_t m_startStep;
+        uint64_t m_endStep;
+
+        std::thread*      m_writer;
+        std::atomic<bool> m_writerRun;
+
+        SpscQueue<WaveSample>  m_queue;
+        std::deque<WaveSample> m_backlog;   // Queue was full, not sent yet
+
+        // Writer thread only (set up in start)
+        std::vector<int>  m_recBits;
+        QList<QByteArray> m_vcdIds;
+        QFile m_vcdFile;
+        QFile m_binFile;
+        QByteArray m_vcdBuf;
+        QByteArray m_binBuf;
+        uint64_t   m_lastVcdStep;
+        uint64_t   m_lastBinStep;
+};
+
+#endif
+